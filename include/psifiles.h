@@ -83,6 +83,7 @@
 // DFCC 3-index files
 #define PSIF_DF_TENSOR         66   /*-  -*/
 #define PSIF_PS_TENSOR         67   /*-  -*/
+#define PSIF_DFT_COLLOCATION   68   /*- Cached basis function values on the DFT grid -*/
 
 #define PSIF_TPDM_PRESORT      71   /*-  -*/
 #define PSIF_MO_TEI            72   /*-  -*/
@@ -50,6 +50,7 @@ procedures = {
             'mp2.5'         : run_mp2_5,
             'mp2'           : run_mp2_select,
             'omp2'          : run_omp2,
+            'df-omp2'       : run_dfomp2,
             'scs-omp2'      : run_scs_omp2,
             'scsn-omp2'     : run_scs_omp2,
             'scs-mi-omp2'   : run_scs_omp2,
@@ -267,6 +268,8 @@ def energy(name, **kwargs):
     +-------------------------+---------------------------------------------------------------------------------------+
     | omp2                    | orbital-optimized second-order MP perturbation theory :ref:`[manual] <sec:occ>`       |
     +-------------------------+---------------------------------------------------------------------------------------+
+    | df-omp2                 | density-fitted orbital-optimized MP2 (RHF, C1) :ref:`[manual] <sec:occ>`              |
+    +-------------------------+---------------------------------------------------------------------------------------+
     | omp3                    | orbital-optimized third-order MP perturbation theory :ref:`[manual] <sec:occ>`        |
     +-------------------------+---------------------------------------------------------------------------------------+
     | omp2.5                  | orbital-optimized MP2.5 :ref:`[manual] <sec:occ>`                                     |
@@ -89,6 +89,46 @@ def run_omp2(name, **kwargs):
     return psi4.occ()
 
 
+def run_dfomp2(name, **kwargs):
+    """Function encoding sequence of PSI module calls for
+    a density-fitted orbital-optimized MP2 computation
+
+    """
+    optstash = p4util.OptionsState(
+        ['OCC', 'OMP2_TYPE'],
+        ['DF_BASIS_SCF'],
+        ['DF_BASIS_CC'])
+
+    psi4.set_local_option('OCC', 'OMP2_TYPE', 'DF')
+
+    # if the df_basis_scf basis is not set, pick a sensible one.
+    if psi4.get_global_option('DF_BASIS_SCF') == '':
+        jkbasis = p4util.corresponding_jkfit(psi4.get_global_option('BASIS'))
+        if jkbasis:
+            psi4.set_global_option('DF_BASIS_SCF', jkbasis)
+            psi4.print_out('\n  No DF_BASIS_SCF auxiliary basis selected, defaulting to %s\n\n' % (jkbasis))
+        else:
+            raise ValidationError('Keyword DF_BASIS_SCF is required.')
+
+    # if the df_basis_cc basis is not set, pick a sensible one.
+    if psi4.get_global_option('DF_BASIS_CC') == '':
+        ribasis = p4util.corresponding_rifit(psi4.get_global_option('BASIS'))
+        if ribasis:
+            psi4.set_global_option('DF_BASIS_CC', ribasis)
+            psi4.print_out('\n  No DF_BASIS_CC auxiliary basis selected, defaulting to %s\n\n' % (ribasis))
+        else:
+            raise ValidationError('Keyword DF_BASIS_CC is required.')
+
+    # Bypass routine scf if user did something special to get it to converge
+    if not (('bypass_scf' in kwargs) and yes.match(str(kwargs['bypass_scf']))):
+        scf_helper(name, **kwargs)
+
+    returnvalue = psi4.occ()
+
+    optstash.restore()
+    return returnvalue
+
+
 def run_omp2_gradient(name, **kwargs):
     """Function encoding sequence of PSI module calls for
     OMP2 gradient calculation.
@@ -1525,6 +1565,11 @@ def run_dfmp2(name, **kwargs):
         else:
             raise ValidationError('Keyword DF_BASIS_MP2 is required.')
 
+    # The Laplace and THC algorithms form only the opposite-spin energy
+    if (name.upper() == 'SCS-MP2') and (psi4.get_option('DFMP2', 'DFMP2_ENERGY_ALGORITHM') in ['LAPLACE', 'THC']):
+        raise ValidationError('SCS-MP2 is not available with DFMP2_ENERGY_ALGORITHM %s.' %
+            (psi4.get_option('DFMP2', 'DFMP2_ENERGY_ALGORITHM')))
+
     e_dfmp2 = psi4.dfmp2()
     e_scs_dfmp2 = psi4.get_variable('SCS-MP2 TOTAL ENERGY')
 
@@ -1657,7 +1702,8 @@ def run_sapt(name, **kwargs):
 
     """
     optstash = p4util.OptionsState(
-        ['SCF', 'SCF_TYPE'])
+        ['SCF', 'SCF_TYPE'],
+        ['SCF', 'GUESS'])
 
     # Alter default algorithm
     if not psi4.has_option_changed('SCF', 'SCF_TYPE'):
@@ -1712,25 +1758,46 @@ def run_sapt(name, **kwargs):
     if (sapt_basis == 'dimer'):
         psi4.set_global_option('DF_INTS_IO', 'LOAD')
 
-    activate(monomerA)
-    if (ri == 'DF' and sapt_basis == 'dimer'):
-        psi4.IO.change_file_namespace(97, 'dimer', 'monomerA')
-    psi4.IO.set_default_namespace('monomerA')
-    psi4.set_local_option('SCF', 'SAPT', '2-monomer_A')
-    psi4.print_out('\n')
-    p4util.banner('Monomer A HF')
-    psi4.print_out('\n')
-    e_monomerA = scf_helper('RHF', **kwargs)
+    # Monomer orbitals of the previous point of a scan are the monomer SCF
+    # guesses; HF::load_orbitals rotates them onto the current frame. Only
+    # the monomer orbital files are retained, and the first SAPT computation
+    # without the cache releases them again.
+    psioh = psi4.IOManager.shared_object()
+    monomer_cache = psi4.get_option('SAPT', 'SAPT_MONOMER_CACHE')
+    if monomer_cache:
+        psioh.set_specific_retention(p4const.PSIF_SCF_MOS, True)
+        psi4.set_local_option('SCF', 'GUESS', 'READ')
+    else:
+        for monomer in ['monomerA', 'monomerB']:
+            psioh.mark_file_for_retention(psioh.get_file_path(p4const.PSIF_SCF_MOS) + 'psi.' +
+                str(os.getpid()) + '.' + monomer + '.' + str(p4const.PSIF_SCF_MOS), False)
 
-    activate(monomerB)
-    if (ri == 'DF' and sapt_basis == 'dimer'):
-        psi4.IO.change_file_namespace(97, 'monomerA', 'monomerB')
-    psi4.IO.set_default_namespace('monomerB')
-    psi4.set_local_option('SCF', 'SAPT', '2-monomer_B')
-    psi4.print_out('\n')
-    p4util.banner('Monomer B HF')
-    psi4.print_out('\n')
-    e_monomerB = scf_helper('RHF', **kwargs)
+    try:
+        activate(monomerA)
+        if (ri == 'DF' and sapt_basis == 'dimer'):
+            psi4.IO.change_file_namespace(97, 'dimer', 'monomerA')
+        psi4.IO.set_default_namespace('monomerA')
+        psi4.set_local_option('SCF', 'SAPT', '2-monomer_A')
+        psi4.print_out('\n')
+        p4util.banner('Monomer A HF')
+        psi4.print_out('\n')
+        e_monomerA = scf_helper('RHF', **kwargs)
+        psi4.set_variable('SAPT MONOMER A SCF ITERATIONS', psi4.get_variable('SCF ITERATIONS'))
+
+        activate(monomerB)
+        if (ri == 'DF' and sapt_basis == 'dimer'):
+            psi4.IO.change_file_namespace(97, 'monomerA', 'monomerB')
+        psi4.IO.set_default_namespace('monomerB')
+        psi4.set_local_option('SCF', 'SAPT', '2-monomer_B')
+        psi4.print_out('\n')
+        p4util.banner('Monomer B HF')
+        psi4.print_out('\n')
+        e_monomerB = scf_helper('RHF', **kwargs)
+        psi4.set_variable('SAPT MONOMER B SCF ITERATIONS', psi4.get_variable('SCF ITERATIONS'))
+    finally:
+        # The monomer files opened above stay retained; nothing else is
+        if monomer_cache:
+            psioh.set_specific_retention(p4const.PSIF_SCF_MOS, False)
     psi4.set_global_option('DF_INTS_IO', df_ints_io)
 
     psi4.IO.change_file_namespace(p4const.PSIF_SAPT_MONOMERA, 'monomerA', 'dimer')
@@ -96,6 +96,7 @@ ADC::ADC(): Wavefunction(Process::environment.options, _default_psio_lib_)
     pole_max_ = options_.get_int("POLE_MAXITER");
     sem_max_  = options_.get_int("SEM_MAXITER");
     num_amps_ = options_.get_int("NUM_AMPS_PRINT");
+    block_sigma_ = options_.get_bool("BLOCK_SIGMA");
 
   if(options_["ROOTS_PER_IRREP"].size() > 0){
         int i = options_["ROOTS_PER_IRREP"].size();
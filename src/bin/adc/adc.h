@@ -80,7 +80,9 @@ protected:
     double rhf_differentiate_omega(int irrep, int root);
     void rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, double *eps);
     void rhf_construct_sigma(int irrep, int root);
-    void shift_denom2(int root, int irrep, double omega);
+    void rhf_construct_sigma_block(int irrep, int first, int last);
+    void rhf_sigma_doubles(int irrep, int root, dpdbuf4 *Vovvv, dpdbuf4 *Voovo);
+    void shift_denom2(int irrep, int nroot, double *omega);
     void shift_denom4(int irrep, double omega);
 
     // Number of the singly excited configurations
@@ -97,6 +99,8 @@ protected:
     double norm_tol_;
     // Number of components of transition amplitudes printed in outfile
     int num_amps_;
+    // Build the sigma vectors of all trial vectors of an irrep in one pass?
+    bool block_sigma_;
     // Number of alpha active occupied MOs per irrep
     int *aoccpi_;
     // Number of alpha active virtual MOs per irrep
@@ -0,0 +1,179 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+#include "psi4-dec.h"
+#include <libtrans/integraltransform.h>
+#include <libciomr/libciomr.h>
+#include <libqt/qt.h>
+#include "adc.h"
+
+namespace psi{ namespace adc{
+
+//
+//  Sigma vectors of the trial vectors first ... last-1 in one pass.
+//
+//  The frequency independent OV-OV part of the response matrix is applied to all trial vectors
+//  at once: each of A3h3p and the (ia|jb)-ordered 2 V - V and 2 K - K tensors is read once and
+//  contracted with the packed trial vectors as a single DGEMM. The 2h-2p part is evaluated
+//  root by root, but with <OV|VV> and <OO|VO> kept in core for the whole block if they fit.
+//
+//  Bmat, Smat : Trial and sigma vectors packed as [root][ia].
+//  Dmat       : \sum_{jb} (2 <ij|ab> - <ij|ba>) b_{jb} for each root.
+//  Emat       : \sum_{jb} (2 K_{ijab} - K_{ijba}) b_{jb} for each root.
+//
+
+namespace {
+
+/* Number of doubles of a whole buffer */
+long int
+buffer_size(dpdbuf4 *Buf)
+{
+    long int size = 0;
+    for(int h = 0;h < Buf->params->nirreps;h++)
+        size += (long int) Buf->params->rowtot[h] * Buf->params->coltot[h^Buf->file.my_irrep];
+    return size;
+}
+
+/* Keeps a whole integral buffer in core until file4_cache_del(), if it fits
+   while still leaving reserve doubles free */
+bool
+pin_buffer(dpdbuf4 *Buf, long int reserve)
+{
+    if(Buf->file.incore) return false;
+    if(buffer_size(Buf) + reserve > dpd_memfree()) return false;
+    global_dpd_->file4_cache_add(&(Buf->file), 0);
+    global_dpd_->file4_cache_lock(&(Buf->file));
+    return true;
+}
+
+}
+
+void
+ADC::rhf_construct_sigma_block(int irrep, int first, int last)
+{
+    char lbl[32];
+    int nroot = last - first;
+    dpdfile2 B, S;
+    dpdbuf4 A, V, K;
+
+    if(nroot <= 0) return;
+
+    global_dpd_->buf4_init(&A, PSIF_ADC_SEM, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "A3h3p1234");
+    int nov = A.params->rowtot[irrep];
+    int **ovorb = A.params->roworb[irrep];
+    if(!nov){
+        global_dpd_->buf4_close(&A);
+        return;
+    }
+
+    double **Bmat = block_matrix(nroot, nov);
+    double **Smat = block_matrix(nroot, nov);
+    double **Dmat = block_matrix(nroot, nov);
+    double **Emat = block_matrix(nroot, nov);
+
+    for(int root = 0;root < nroot;root++){
+        sprintf(lbl, "B^(%d)_[%d]12", first+root, irrep);
+        global_dpd_->file2_init(&B, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
+        global_dpd_->file2_mat_init(&B);
+        global_dpd_->file2_mat_rd(&B);
+        for(int ia = 0;ia < nov;ia++){
+            int i = ovorb[ia][0];
+            int a = ovorb[ia][1];
+            Bmat[root][ia] = B.matrix[B.params->psym[i]][B.params->rowidx[i]][B.params->colidx[a]];
+        }
+        global_dpd_->file2_mat_close(&B);
+        global_dpd_->file2_close(&B);
+    }
+
+    // CIS term and the two 3h-3p diagrams: \sigma_{ia} <-- \sum_{jb} A_{iajb} b_{jb}
+    global_dpd_->buf4_mat_irrep_init(&A, irrep);
+    global_dpd_->buf4_mat_irrep_rd(&A, irrep);
+    C_DGEMM('n', 't', nroot, nov, nov, 1.0, Bmat[0], nov, A.matrix[irrep][0], nov, 0.0, Smat[0], nov);
+    global_dpd_->buf4_mat_irrep_close(&A, irrep);
+    global_dpd_->buf4_close(&A);
+
+    global_dpd_->buf4_init(&V, PSIF_ADC, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "2 V1234 - V1243 (OV|OV)");
+    global_dpd_->buf4_init(&K, PSIF_ADC, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "2 K1234 - K1243 (OV|OV)");
+
+    // D_{ia} <-- \sum_{jb} (2 <ij|ab> - <ij|ba>) b_{jb}
+    global_dpd_->buf4_mat_irrep_init(&V, irrep);
+    global_dpd_->buf4_mat_irrep_rd(&V, irrep);
+    C_DGEMM('n', 't', nroot, nov, nov, 1.0, Bmat[0], nov, V.matrix[irrep][0], nov, 0.0, Dmat[0], nov);
+    global_dpd_->buf4_mat_irrep_close(&V, irrep);
+
+    global_dpd_->buf4_mat_irrep_init(&K, irrep);
+    global_dpd_->buf4_mat_irrep_rd(&K, irrep);
+    // E_{ia} <-- \sum_{jb} (2 K_{ijab} - K_{ijba}) b_{jb}
+    C_DGEMM('n', 't', nroot, nov, nov, 1.0, Bmat[0], nov, K.matrix[irrep][0], nov, 0.0, Emat[0], nov);
+    // \sigma_{ia} <-- 0.5 \sum_{jb} (2 K_{ijab} - K_{ijba}) D_{jb}
+    C_DGEMM('n', 't', nroot, nov, nov, 0.5, Dmat[0], nov, K.matrix[irrep][0], nov, 1.0, Smat[0], nov);
+    global_dpd_->buf4_mat_irrep_close(&K, irrep);
+
+    // \sigma_{ia} <-- 0.5 \sum_{jb} (2 <ij|ab> - <ij|ba>) E_{jb}
+    global_dpd_->buf4_mat_irrep_init(&V, irrep);
+    global_dpd_->buf4_mat_irrep_rd(&V, irrep);
+    C_DGEMM('n', 't', nroot, nov, nov, 0.5, Emat[0], nov, V.matrix[irrep][0], nov, 1.0, Smat[0], nov);
+    global_dpd_->buf4_mat_irrep_close(&V, irrep);
+
+    global_dpd_->buf4_close(&K);
+    global_dpd_->buf4_close(&V);
+
+    for(int root = 0;root < nroot;root++){
+        sprintf(lbl, "S^(%d)_[%d]12", first+root, irrep);
+        global_dpd_->file2_init(&S, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
+        global_dpd_->file2_mat_init(&S);
+        for(int ia = 0;ia < nov;ia++){
+            int i = ovorb[ia][0];
+            int a = ovorb[ia][1];
+            S.matrix[S.params->psym[i]][S.params->rowidx[i]][S.params->colidx[a]] = Smat[root][ia];
+        }
+        global_dpd_->file2_mat_wrt(&S);
+        global_dpd_->file2_mat_close(&S);
+        global_dpd_->file2_close(&S);
+    }
+
+    free_block(Bmat);
+    free_block(Smat);
+    free_block(Dmat);
+    free_block(Emat);
+
+    // The 2h-2p part, with the integrals read from disk once for the whole block
+    global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,V]"), ID("[V,V]"), ID("[O,V]"), ID("[V,V]"), 0, "MO Ints <OV|VV>");
+    global_dpd_->buf4_init(&K, PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,O]"), ID("[O,O]"), ID("[V,O]"), 0, "MO Ints <OO|VO>");
+    // rhf_sigma_doubles() holds Z and B_{ijab} in core and the sorts need a third buffer of that size
+    sprintf(lbl, "ZOOVV_[%d]1234", irrep);
+    global_dpd_->buf4_init(&A, PSIF_ADC_SEM, irrep, ID("[O,O]"), ID("[V,V]"), ID("[O,O]"), ID("[V,V]"), 0, lbl);
+    long int reserve = 3 * buffer_size(&A);
+    global_dpd_->buf4_close(&A);
+    bool pinned_V = pin_buffer(&V, reserve);
+    bool pinned_K = pin_buffer(&K, reserve);
+
+    for(int root = first;root < last;root++)
+        rhf_sigma_doubles(irrep, root, &V, &K);
+
+    if(pinned_K) global_dpd_->file4_cache_del(&(K.file));
+    if(pinned_V) global_dpd_->file4_cache_del(&(V.file));
+    global_dpd_->buf4_close(&V);
+    global_dpd_->buf4_close(&K);
+}
+
+}} // End Namespaces
@@ -41,7 +41,7 @@ ADC::rhf_construct_sigma(int irrep, int root)
 {
     char lbl[32];
     dpdfile2 B, S, D, E, Bt, C;
-    dpdbuf4 A, V, K, Z, BT, XT;
+    dpdbuf4 A, V, K, BT, XT;
             
     sprintf(lbl, "S^(%d)_[%d]12", root, irrep);
     global_dpd_->file2_init(&S, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
@@ -76,17 +76,40 @@ ADC::rhf_construct_sigma(int irrep, int root)
     global_dpd_->buf4_close(&K);
     global_dpd_->buf4_close(&V);
 
+    global_dpd_->file2_close(&S);
+    global_dpd_->file2_close(&B);
+
     global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,V]"), ID("[V,V]"), ID("[O,V]"), ID("[V,V]"), 0, "MO Ints <OV|VV>");
+    global_dpd_->buf4_init(&K, PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,O]"), ID("[O,O]"), ID("[V,O]"), 0, "MO Ints <OO|VO>");
+    rhf_sigma_doubles(irrep, root, &V, &K);
+    global_dpd_->buf4_close(&V);
+    global_dpd_->buf4_close(&K);
+}
+
+//
+//  The 2h-2p part of the sigma vector of the given root, which is added to S.
+//  Vovvv and Voovo are <OV|VV> and <OO|VO>, which the caller may keep in core
+//  across the roots.
+//
+void
+ADC::rhf_sigma_doubles(int irrep, int root, dpdbuf4 *Vovvv, dpdbuf4 *Voovo)
+{
+    char lbl[32];
+    dpdfile2 B, S;
+    dpdbuf4 A, Z;
+
+    sprintf(lbl, "S^(%d)_[%d]12", root, irrep);
+    global_dpd_->file2_init(&S, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
+    sprintf(lbl, "B^(%d)_[%d]12", root, irrep);
+    global_dpd_->file2_init(&B, PSIF_ADC,     irrep, ID('O'), ID('V'), lbl);
+
     sprintf(lbl, "ZOOVV_[%d]1234", irrep);
     global_dpd_->buf4_init(&Z, PSIF_ADC_SEM, irrep, ID("[O,O]"), ID("[V,V]"), ID("[O,O]"), ID("[V,V]"), 0, lbl);
     // ZOVOV_{jiab} <--  \sum_{c} <jc|ab> b_{ic}
-    global_dpd_->contract424(&V, &B, &Z, 1, 1, 1,  1, 0);
-    global_dpd_->buf4_close(&V);
+    global_dpd_->contract424(Vovvv, &B, &Z, 1, 1, 1,  1, 0);
     
-    global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,O]"), ID("[O,O]"), ID("[V,O]"), 0, "MO Ints <OO|VO>");
     // ZOVOV_{ijab} <-- - \sum_{k} <ij|ak> b_{kb}
-    global_dpd_->contract424(&V, &B, &Z, 3, 0, 0, -1, 1);
-    global_dpd_->buf4_close(&V);
+    global_dpd_->contract424(Voovo, &B, &Z, 3, 0, 0, -1, 1);
     
     // B_{iajb} <-- (2Z_{ijab}-Z_{ijba}+2Z_{jiab}-Z_{jiba}) / (\omega+e_i-e_a+e_j-e_b)
     sprintf(lbl, "BOOVV_[%d]1234", irrep);
@@ -102,15 +125,11 @@ ADC::rhf_construct_sigma(int irrep, int root)
     global_dpd_->buf4_dirprd(&A, &Z);
     global_dpd_->buf4_close(&A);
  
-    global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,V]"), ID("[V,V]"), ID("[O,V]"), ID("[V,V]"), 0, "MO Ints <OV|VV>");
     // \sigma_{ia} <-- \sum_{jbc} B_{jicb} <ja|cb>
-    global_dpd_->contract442(&Z, &V, &S, 1, 1, 1, 1);
-    global_dpd_->buf4_close(&V);
+    global_dpd_->contract442(&Z, Vovvv, &S, 1, 1, 1, 1);
     
-    global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,O]"), ID("[O,O]"), ID("[V,O]"), 0, "MO Ints <OO|VO>");
     // \sigma_{ia} <-- - \sum_{jkb} <kj|bi> B_{jkab}
-    global_dpd_->contract442(&V, &Z, &S, 3, 3, -1, 1); //This is genuine
-    global_dpd_->buf4_close(&V);
+    global_dpd_->contract442(Voovo, &Z, &S, 3, 3, -1, 1); //This is genuine
     global_dpd_->buf4_close(&Z);
 
     global_dpd_->file2_close(&S);
@@ -26,36 +26,49 @@
 
 namespace psi{ namespace adc{
     
+//
+//  L^(k)_{ia} = 1 / (\omega_k - D_{ia}) for all roots k at once, reading the diagonal D only once.
+//  The roots are independent and are filled in concurrently.
+//
 void 
-ADC::shift_denom2(int root, int irrep, double omega)
+ADC::shift_denom2(int irrep, int nroot, double *omega)
 {
     char lbl[32];
-    dpdfile2 D, L;
+    dpdfile2 D;
+    dpdfile2 *L = new dpdfile2[nroot];
 
     sprintf(lbl, "D_[%d]12", irrep);
     global_dpd_->file2_init(&D, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
     global_dpd_->file2_mat_init(&D);
     global_dpd_->file2_mat_rd(&D);
     
-    sprintf(lbl, "L^(%d)_[%d]12", root, irrep);
-    global_dpd_->file2_init(&L, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-    global_dpd_->file2_mat_init(&L);
-    global_dpd_->file2_mat_rd(&L);
+    for(int root = 0;root < nroot;root++){
+        sprintf(lbl, "L^(%d)_[%d]12", root, irrep);
+        global_dpd_->file2_init(&L[root], PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
+        global_dpd_->file2_mat_init(&L[root]);
+    }
     
-    for(int Isym = 0;Isym < nirrep_;Isym++){
-        for(int i = 0;i < D.params->rowtot[Isym];i++){
-            for(int a = 0;a < D.params->coltot[Isym^irrep];a++){
-                double denom = omega - D.matrix[Isym][i][a];
-                if(fabs(denom) > 1e-6)
-                    L.matrix[Isym][i][a] = 1 / denom;
-                else 
-                    L.matrix[Isym][i][a] = 0;
+    #pragma omp parallel for
+    for(int root = 0;root < nroot;root++){
+        for(int Isym = 0;Isym < nirrep_;Isym++){
+            for(int i = 0;i < D.params->rowtot[Isym];i++){
+                for(int a = 0;a < D.params->coltot[Isym^irrep];a++){
+                    double denom = omega[root] - D.matrix[Isym][i][a];
+                    if(fabs(denom) > 1e-6)
+                        L[root].matrix[Isym][i][a] = 1 / denom;
+                    else 
+                        L[root].matrix[Isym][i][a] = 0;
+                }
             }
         }
     }
-    global_dpd_->file2_mat_wrt(&L);
-    global_dpd_->file2_mat_close(&L);
-    global_dpd_->file2_close(&L);
+    
+    for(int root = 0;root < nroot;root++){
+        global_dpd_->file2_mat_wrt(&L[root]);
+        global_dpd_->file2_mat_close(&L[root]);
+        global_dpd_->file2_close(&L[root]);
+    }
+    delete [] L;
     global_dpd_->file2_mat_close(&D);
     global_dpd_->file2_close(&D);
 }
@@ -71,6 +84,7 @@ ADC::shift_denom4(int irrep, double omega)
     for(int Gij = 0;Gij < nirrep_;Gij++){
         global_dpd_->buf4_mat_irrep_init(&D, Gij);
         
+        #pragma omp parallel for
         for(int ij = 0;ij < D.params->rowtot[Gij];ij++){
             int i = D.params->roworb[Gij][ij][0];
             int j = D.params->roworb[Gij][ij][1];
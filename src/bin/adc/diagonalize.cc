@@ -44,7 +44,7 @@ void
 ADC::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, double *eps)
 {
     char lbl[32];
-    int iter, converged, length, *conv, skip_check, maxdim, *residual_ok;
+    int iter, converged, length, nsigma, *conv, skip_check, maxdim, *residual_ok;
     double **Alpha, **G, *lambda, *lambda_o, *residual_norm, cutoff;
     dpdfile2 B, S, Bp, Bn, F, L, V;
     dpdfile4 A;
@@ -55,6 +55,7 @@ ADC::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, doubl
     converged = 0;
     cutoff = conv_;
     length = rpi_[irrep];
+    nsigma = 0;
     
     residual_ok   = init_int_array(rpi_[irrep]);
     residual_norm = init_array(rpi_[irrep]);
@@ -75,10 +76,17 @@ ADC::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, doubl
         skip_check = 0;
         fprintf(iter_adc, "\niter = %d, dim = %d\n", iter, length);
 
-        // Evaluating the sigma vectors
+        // Evaluating the sigma vectors. The block build only needs those of the trial
+        // vectors added since the last iteration, as the denominators are fixed here.
         timer_on("Sigma construction");
-        for(int I = 0;I < length;I++)
-            if(!nopen_) rhf_construct_sigma(irrep, I);
+        if(block_sigma_){
+            if(!nopen_) rhf_construct_sigma_block(irrep, nsigma, length);
+            nsigma = length;
+        }
+        else {
+            for(int I = 0;I < length;I++)
+                if(!nopen_) rhf_construct_sigma(irrep, I);
+        }
         timer_off("Sigma construction");
 
         // Making so called Davidson mini-Hamiltonian, or Rayleigh matrix
@@ -101,6 +109,7 @@ ADC::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, doubl
         sq_rsp(length, length, G, lambda, 1, Alpha, 1e-12);
 
         // Constructing the corretion vectors
+        shift_denom2(irrep, rpi_[irrep], lambda);
         for(int k = 0;k < rpi_[irrep];k++){
             sprintf(lbl, "F^(%d)_[%d]12", k, irrep);
             global_dpd_->file2_init(&F, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
@@ -115,7 +124,6 @@ ADC::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, doubl
                 global_dpd_->file2_axpy(&S, &F, Alpha[I][k], 0);
                 global_dpd_->file2_close(&S);
             }
-            shift_denom2(k, irrep, lambda[k]);
             sprintf(lbl, "L^(%d)_[%d]12", k, irrep);
             global_dpd_->file2_init(&L, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
             global_dpd_->file2_dirprd(&L, &F);
@@ -187,6 +195,7 @@ ADC::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, doubl
             }
             skip_check = 1;
             length = rpi_[irrep];
+            nsigma = 0;
         }
     
         if(!skip_check){
@@ -149,6 +149,17 @@ ADC::rhf_prepare_tensors()
     global_dpd_->buf4_close(&K);
     global_dpd_->buf4_close(&V);
 
+    if(block_sigma_){
+        // (ia|jb)-ordered 2 V - V and 2 K - K for the block sigma build, so that the
+        // 3h-3p terms become plain matrix products with the packed trial vectors
+        global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,V]"), ID("[O,O]"), ID("[V,V]"), 0, "MO Ints 2 V1234 - V1243");
+        global_dpd_->buf4_sort(&V, PSIF_ADC, prqs, ID("[O,V]"), ID("[O,V]"), "2 V1234 - V1243 (OV|OV)");
+        global_dpd_->buf4_close(&V);
+        global_dpd_->buf4_init(&K, PSIF_ADC, 0, ID("[O,O]"), ID("[V,V]"), ID("[O,O]"), ID("[V,V]"), 0, "2 K1234 - K1243");
+        global_dpd_->buf4_sort(&K, PSIF_ADC, prqs, ID("[O,V]"), ID("[O,V]"), "2 K1234 - K1243 (OV|OV)");
+        global_dpd_->buf4_close(&K);
+    }
+
     // A3h3p_{iajb} <-- \delta_{ij}(XVV)_{ab} + \delta_{ab}(XOO)_{ij}
     global_dpd_->buf4_init(&Aovov, PSIF_ADC_SEM, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "A3h3p1234");
     for(int h = 0;h < nirrep_;h++){
@@ -37,16 +37,162 @@
 
 namespace psi { namespace ccenergy {
 
+/* AO_contribute_int(): Adds the contributions of the SO integral
+** (pq|rs), given in canonical order (p>=q, r>=s, pq>=rs), to tau2_AO.
+** Only columns col0[h] through col0[h]+ncol[h]-1 of each irrep h are
+** touched, so that threads working on disjoint column ranges can share
+** the same integral.
+*/
+void AO_contribute_int(int p, int q, int r, int s, double value,
+                       dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int *col0, int *ncol)
+{
+  int Gp, Gq, Gr, Gs, Gpr, Gps, Gqr, Gqs, Grp, Gsp, Grq, Gsq;
+  int pr, ps, qr, qs, rp, rq, sp, sq, pq, rs;
+
+  Gp = tau1_AO->params->psym[p];
+  Gq = tau1_AO->params->psym[q];
+  Gr = tau1_AO->params->psym[r];
+  Gs = tau1_AO->params->psym[s];
+
+  Gpr = Grp = Gp^Gr;
+  Gps = Gsp = Gp^Gs;
+  Gqr = Grq = Gq^Gr;
+  Gqs = Gsq = Gq^Gs;
+
+  pq = tau1_AO->params->rowidx[p][q];
+  rs = tau1_AO->params->rowidx[r][s];
+
+  pr = tau1_AO->params->rowidx[p][r];
+  rp = tau1_AO->params->rowidx[r][p];
+  ps = tau1_AO->params->rowidx[p][s];
+  sp = tau1_AO->params->rowidx[s][p];
+  qr = tau1_AO->params->rowidx[q][r];
+  rq = tau1_AO->params->rowidx[r][q];
+  qs = tau1_AO->params->rowidx[q][s];
+  sq = tau1_AO->params->rowidx[s][q];
+
+  /* (pq|rs) */
+  if(ncol[Gpr])
+    C_DAXPY(ncol[Gpr], value, &(tau1_AO->matrix[Gpr][qs][col0[Gpr]]), 1,
+            &(tau2_AO->matrix[Gpr][pr][col0[Gpr]]), 1);
+
+  if(p!=q && r!=s && pq != rs) {
+
+    /* (pq|sr) */
+    if(ncol[Gps])
+      C_DAXPY(ncol[Gps], value, &(tau1_AO->matrix[Gps][qr][col0[Gps]]), 1,
+              &(tau2_AO->matrix[Gps][ps][col0[Gps]]), 1);
+
+    /* (qp|rs) */
+    if(ncol[Gqr])
+      C_DAXPY(ncol[Gqr], value, &(tau1_AO->matrix[Gqr][ps][col0[Gqr]]), 1,
+              &(tau2_AO->matrix[Gqr][qr][col0[Gqr]]), 1);
+
+    /* (qp|sr) */
+    if(ncol[Gqs])
+      C_DAXPY(ncol[Gqs], value, &(tau1_AO->matrix[Gqs][pr][col0[Gqs]]), 1,
+              &(tau2_AO->matrix[Gqs][qs][col0[Gqs]]), 1);
+
+    /* (rs|pq) */
+    if(ncol[Grp])
+      C_DAXPY(ncol[Grp], value, &(tau1_AO->matrix[Grp][sq][col0[Grp]]), 1,
+              &(tau2_AO->matrix[Grp][rp][col0[Grp]]), 1);
+
+    /* (sr|pq) */
+    if(ncol[Gsp])
+      C_DAXPY(ncol[Gsp], value, &(tau1_AO->matrix[Gsp][rq][col0[Gsp]]), 1,
+              &(tau2_AO->matrix[Gsp][sp][col0[Gsp]]), 1);
+
+    /* (rs|qp) */
+    if(ncol[Grq])
+      C_DAXPY(ncol[Grq], value, &(tau1_AO->matrix[Grq][sp][col0[Grq]]), 1,
+              &(tau2_AO->matrix[Grq][rq][col0[Grq]]), 1);
+
+    /* (sr|qp) */
+    if(ncol[Gsq])
+      C_DAXPY(ncol[Gsq], value, &(tau1_AO->matrix[Gsq][rp][col0[Gsq]]), 1,
+              &(tau2_AO->matrix[Gsq][sq][col0[Gsq]]), 1);
+
+  }
+  else if(p!=q && r!=s && pq==rs) {
+
+    /* (pq|sr) */
+    if(ncol[Gps])
+      C_DAXPY(ncol[Gps], value, &(tau1_AO->matrix[Gps][qr][col0[Gps]]), 1,
+              &(tau2_AO->matrix[Gps][ps][col0[Gps]]), 1);
+
+    /* (qp|rs) */
+    if(ncol[Gqr])
+      C_DAXPY(ncol[Gqr], value, &(tau1_AO->matrix[Gqr][ps][col0[Gqr]]), 1,
+              &(tau2_AO->matrix[Gqr][qr][col0[Gqr]]), 1);
+
+    /* (qp|sr) */
+    if(ncol[Gqs])
+      C_DAXPY(ncol[Gqs], value, &(tau1_AO->matrix[Gqs][pr][col0[Gqs]]), 1,
+              &(tau2_AO->matrix[Gqs][qs][col0[Gqs]]), 1);
+
+  }
+  else if(p!=q && r==s) {
+
+    /* (qp|rs) */
+    if(ncol[Gqr])
+      C_DAXPY(ncol[Gqr], value, &(tau1_AO->matrix[Gqr][ps][col0[Gqr]]), 1,
+              &(tau2_AO->matrix[Gqr][qr][col0[Gqr]]), 1);
+
+    /* (rs|pq) */
+    if(ncol[Grp])
+      C_DAXPY(ncol[Grp], value, &(tau1_AO->matrix[Grp][sq][col0[Grp]]), 1,
+              &(tau2_AO->matrix[Grp][rp][col0[Grp]]), 1);
+
+    /* (rs|qp) */
+    if(ncol[Grq])
+      C_DAXPY(ncol[Grq], value, &(tau1_AO->matrix[Grq][sp][col0[Grq]]), 1,
+              &(tau2_AO->matrix[Grq][rq][col0[Grq]]), 1);
+
+  }
+
+  else if(p==q && r!=s) {
+
+    /* (pq|sr) */
+    if(ncol[Gps])
+      C_DAXPY(ncol[Gps], value, &(tau1_AO->matrix[Gps][qr][col0[Gps]]), 1,
+              &(tau2_AO->matrix[Gps][ps][col0[Gps]]), 1);
+
+    /* (rs|pq) */
+    if(ncol[Grp])
+      C_DAXPY(ncol[Grp], value, &(tau1_AO->matrix[Grp][sq][col0[Grp]]), 1,
+              &(tau2_AO->matrix[Grp][rp][col0[Grp]]), 1);
+
+    /* (sr|pq) */
+    if(ncol[Gsp])
+      C_DAXPY(ncol[Gsp], value, &(tau1_AO->matrix[Gsp][rq][col0[Gsp]]), 1,
+              &(tau2_AO->matrix[Gsp][sp][col0[Gsp]]), 1);
+
+  }
+
+  else if(p==q && r==s && pq != rs) {
+
+    /* (rs|pq) */
+    if(ncol[Grp])
+      C_DAXPY(ncol[Grp], value, &(tau1_AO->matrix[Grp][sq][col0[Grp]]), 1,
+              &(tau2_AO->matrix[Grp][rp][col0[Grp]]), 1);
+
+  }
+}
+
 int AO_contribute(struct iwlbuf *InBuf, dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO)
 {
-  int idx, p, q, r, s;
+  int idx, p, q, r, s, h;
   double value;
   Value *valptr;
   Label *lblptr;
-  int Gp, Gq, Gr, Gs, Gpr, Gps, Gqr, Gqs, Grp, Gsp, Grq, Gsq;
-  int pr, ps, qr, qs, rp, rq, sp, sq, pq, rs;
+  int *col0, *ncol;
   int count=0;
 
+  col0 = init_int_array(tau1_AO->params->nirreps);
+  ncol = init_int_array(tau1_AO->params->nirreps);
+  for(h=0; h < tau1_AO->params->nirreps; h++) ncol[h] = tau1_AO->params->coltot[h];
+
   lblptr = InBuf->labels;
   valptr = InBuf->values;
 
@@ -63,137 +209,12 @@ int AO_contribute(struct iwlbuf *InBuf, dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO)
     */
     count++;
 
-    Gp = tau1_AO->params->psym[p]; 
-    Gq = tau1_AO->params->psym[q]; 
-    Gr = tau1_AO->params->psym[r]; 
-    Gs = tau1_AO->params->psym[s];
-
-    Gpr = Grp = Gp^Gr;
-    Gps = Gsp = Gp^Gs;
-    Gqr = Grq = Gq^Gr;
-    Gqs = Gsq = Gq^Gs;
-
-    pq = tau1_AO->params->rowidx[p][q];  
-    rs = tau1_AO->params->rowidx[r][s];
-
-    pr = tau1_AO->params->rowidx[p][r];
-    rp = tau1_AO->params->rowidx[r][p];
-    ps = tau1_AO->params->rowidx[p][s];
-    sp = tau1_AO->params->rowidx[s][p];
-    qr = tau1_AO->params->rowidx[q][r];
-    rq = tau1_AO->params->rowidx[r][q];
-    qs = tau1_AO->params->rowidx[q][s];
-    sq = tau1_AO->params->rowidx[s][q];
-
-    /* (pq|rs) */
-    if(tau1_AO->params->coltot[Gpr])
-      C_DAXPY(tau1_AO->params->coltot[Gpr], value, tau1_AO->matrix[Gpr][qs], 1,
-	      tau2_AO->matrix[Gpr][pr], 1);
-
-    if(p!=q && r!=s && pq != rs) {
-
-      /* (pq|sr) */
-      if(tau1_AO->params->coltot[Gps])
-	C_DAXPY(tau1_AO->params->coltot[Gps], value, tau1_AO->matrix[Gps][qr], 1,
-		tau2_AO->matrix[Gps][ps], 1);
-
-      /* (qp|rs) */
-      if(tau1_AO->params->coltot[Gqr])
-	C_DAXPY(tau1_AO->params->coltot[Gqr], value, tau1_AO->matrix[Gqr][ps], 1,
-		tau2_AO->matrix[Gqr][qr], 1);
-
-      /* (qp|sr) */
-      if(tau1_AO->params->coltot[Gqs])
-	C_DAXPY(tau1_AO->params->coltot[Gqs], value, tau1_AO->matrix[Gqs][pr], 1,
-		tau2_AO->matrix[Gqs][qs], 1);
-
-      /* (rs|pq) */
-      if(tau1_AO->params->coltot[Grp])
-	C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-		tau2_AO->matrix[Grp][rp], 1);
-
-      /* (sr|pq) */
-      if(tau1_AO->params->coltot[Gsp])
-	C_DAXPY(tau1_AO->params->coltot[Gsp], value, tau1_AO->matrix[Gsp][rq], 1, 
-		tau2_AO->matrix[Gsp][sp], 1);
-
-      /* (rs|qp) */
-      if(tau1_AO->params->coltot[Grq])
-	C_DAXPY(tau1_AO->params->coltot[Grq], value, tau1_AO->matrix[Grq][sp], 1,
-		tau2_AO->matrix[Grq][rq], 1);
-
-      /* (sr|qp) */
-      if(tau1_AO->params->coltot[Gsq])
-	C_DAXPY(tau1_AO->params->coltot[Gsq], value, tau1_AO->matrix[Gsq][rp], 1,
-		tau2_AO->matrix[Gsq][sq],1 );
-
-    }
-    else if(p!=q && r!=s && pq==rs) {
-
-      /* (pq|sr) */
-      if(tau1_AO->params->coltot[Gps])
-	C_DAXPY(tau1_AO->params->coltot[Gps], value, tau1_AO->matrix[Gps][qr], 1,
-		tau2_AO->matrix[Gps][ps], 1);
-
-      /* (qp|rs) */
-      if(tau1_AO->params->coltot[Gqr])
-	C_DAXPY(tau1_AO->params->coltot[Gqr], value, tau1_AO->matrix[Gqr][ps], 1,
-		tau2_AO->matrix[Gqr][qr], 1);
-
-      /* (qp|sr) */
-      if(tau1_AO->params->coltot[Gqs])
-	C_DAXPY(tau1_AO->params->coltot[Gqs], value, tau1_AO->matrix[Gqs][pr], 1,
-		tau2_AO->matrix[Gqs][qs], 1);
-
-    }
-    else if(p!=q && r==s) {
-
-      /* (qp|rs) */
-      if(tau1_AO->params->coltot[Gqr])
-	C_DAXPY(tau1_AO->params->coltot[Gqr], value, tau1_AO->matrix[Gqr][ps], 1,
-		tau2_AO->matrix[Gqr][qr], 1);
-
-      /* (rs|pq) */
-      if(tau1_AO->params->coltot[Grp])
-	C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-		tau2_AO->matrix[Grp][rp], 1);
-
-      /* (rs|qp) */
-      if(tau1_AO->params->coltot[Grq])
-	C_DAXPY(tau1_AO->params->coltot[Grq], value, tau1_AO->matrix[Grq][sp], 1,
-		tau2_AO->matrix[Grq][rq], 1);
-
-    }
-
-    else if(p==q && r!=s) {
-
-      /* (pq|sr) */
-      if(tau1_AO->params->coltot[Gps])
-	C_DAXPY(tau1_AO->params->coltot[Gps], value, tau1_AO->matrix[Gps][qr], 1,
-		tau2_AO->matrix[Gps][ps], 1);
-
-      /* (rs|pq) */
-      if(tau1_AO->params->coltot[Grp])
-	C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-		tau2_AO->matrix[Grp][rp], 1);
-
-      /* (sr|pq) */
-      if(tau1_AO->params->coltot[Gsp])
-	C_DAXPY(tau1_AO->params->coltot[Gsp], value, tau1_AO->matrix[Gsp][rq], 1, 
-		tau2_AO->matrix[Gsp][sp], 1);
-
-    }
-
-    else if(p==q && r==s && pq != rs) {
-
-      /* (rs|pq) */
-      if(tau1_AO->params->coltot[Grp])
-	C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-		tau2_AO->matrix[Grp][rp], 1);
-
-    }
+    AO_contribute_int(p, q, r, s, value, tau1_AO, tau2_AO, col0, ncol);
   }
 
+  free(col0);
+  free(ncol);
+
   return count;
 }
 
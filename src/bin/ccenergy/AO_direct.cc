@@ -0,0 +1,114 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+/*! \file
+    \ingroup CCENERGY
+    \brief Integral-direct SO-basis ladder contribution for AO_BASIS = DIRECT
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <libciomr/libciomr.h>
+#include <libdpd/dpd.h>
+#include <libmints/mints.h>
+#include <libmints/sointegral_direct.h>
+#include <psi4-dec.h>
+#include "Params.h"
+#include "MOInfo.h"
+#define EXTERN
+#include "globals.h"
+
+namespace psi { namespace ccenergy {
+
+void AO_contribute_int(int p, int q, int r, int s, double value,
+                       dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int *col0, int *ncol);
+
+/* AO_contribute_direct(): The integral-direct counterpart of the
+** AO_contribute() loop over PSIF_SO_TEI.  The SO integrals are
+** recomputed shell quartet by shell quartet, skipping quartets whose
+** Schwarz bound is below INTS_TOLERANCE, and are never written to disk.
+**
+** Quartets are processed in batches sized to the memory left in the DPD
+** pool.  The integral buffer of a batch is taken from the DPD pool, so
+** it is charged against the cache like any other block.  Every slice of
+** the ij columns of tau2_AO is updated with all integrals of the batch
+** by one thread, so no two threads ever update the same element.
+**
+** Returns the number of SO integrals processed.
+*/
+int AO_contribute_direct(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO)
+{
+  int t, nthreads, nirreps;
+  int **col0, **ncol;
+  long int size, nints, n;
+  int count=0, nbatch=0;
+  double **buf;
+
+  nthreads = 1;
+#ifdef _OPENMP
+  nthreads = params.nthreads;
+#endif
+  if(nthreads < 1) nthreads = 1;
+  nirreps = tau1_AO->params->nirreps;
+
+  boost::shared_ptr<BasisSetParser> parser(new Gaussian94BasisSetParser());
+  boost::shared_ptr<BasisSet> basis = BasisSet::construct(parser, Process::environment.molecule(), "BASIS");
+  boost::shared_ptr<IntegralFactory> factory(new IntegralFactory(basis, basis, basis, basis));
+  DirectSOIntegrals ints(factory, nthreads, params.ints_tol);
+
+  /* Each slice is a contiguous range of the ij columns of every irrep */
+  col0 = init_int_matrix(nthreads, nirreps);
+  ncol = init_int_matrix(nthreads, nirreps);
+  DirectSOIntegrals::split_columns(nirreps, tau2_AO->params->coltot, nthreads, col0, ncol);
+
+  /* Four labels and a value per integral */
+  size = dpd_memfree()/5;
+  if(size > ints.max_total_size()) size = ints.max_total_size();
+  if(size < ints.max_quartet_size()) size = ints.max_quartet_size();
+  buf = global_dpd_->dpd_block_matrix(5, size);
+
+  for(ints.first(); !ints.is_done(); ) {
+    nints = ints.compute_next(buf, size);
+
+    /* Every slice is done exactly once, however many threads we get */
+#pragma omp parallel for schedule(static) num_threads(nthreads) private(n)
+    for(t=0; t < nthreads; t++) {
+      for(n=0; n < nints; n++)
+        AO_contribute_int((int) buf[0][n], (int) buf[1][n], (int) buf[2][n], (int) buf[3][n], buf[4][n],
+                          tau1_AO, tau2_AO, col0[t], ncol[t]);
+    }
+
+    count += nints;
+    nbatch++;
+  }
+
+  if(params.print & 2)
+    fprintf(outfile, "     *** %ld of %ld SO shell quartets survive Schwarz screening, %d batches\n",
+            ints.nquartet(), ints.ntotal(), nbatch);
+
+  global_dpd_->free_dpd_block(buf, 5, size);
+  free_int_matrix(col0);
+  free_int_matrix(ncol);
+
+  return count;
+}
+
+}} // namespace psi::ccenergy
@@ -29,9 +29,12 @@
 #include <cstring>
 #include <string>
 #include <cmath>
+#include <pthread.h>
 #include <libpsio/psio.h>
 #include <libdpd/dpd.h>
 #include <libqt/qt.h>
+#include <exception.h>
+#include <psifiles.h>
 #include "Params.h"
 #include "MOInfo.h"
 #define EXTERN
@@ -39,6 +42,273 @@
 
 namespace psi { namespace ccenergy {
 
+namespace {
+
+/* n elements of type T, allocated from (and charged to) the DPD memory pool */
+template <class T>
+T *dpd_alloc(size_t n, double **&block)
+{
+  block = global_dpd_->dpd_block_matrix(1, (n * sizeof(T) + sizeof(double) - 1)/sizeof(double));
+  return (T *) block[0];
+}
+
+template <class T>
+void dpd_free(size_t n, double **block)
+{
+  global_dpd_->free_dpd_block(block, 1, (n * sizeof(T) + sizeof(double) - 1)/sizeof(double));
+}
+
+/* One bucket of rows to be read by the helper thread of stream_rows() */
+struct RowRead {
+  int filenum;
+  const char *label;
+  char *buffer;
+  ULI size;
+  psio_address start;
+  psio_address next;
+};
+
+void *read_rows(void *arg)
+{
+  RowRead *rd = (RowRead *) arg;
+  psio_read(rd->filenum, rd->label, rd->buffer, rd->size, rd->start, &(rd->next));
+  return NULL;
+}
+
+/*
+** stream_rows(): Reads nrows rows of ncols elements of type T from the PSIO
+** entry label, starting at address start, in buckets of at most bucket rows,
+** and hands each bucket to op(rows, row_start, nrows).  The next bucket is
+** read into a second buffer on a helper thread while op() works on the
+** current one, so op() must not touch PSIO itself; op.sync() is called
+** once the read-ahead has finished and may use PSIO.  Both buffers are
+** taken from the DPD memory pool.
+*/
+template <class T, class Op>
+void stream_rows(int filenum, const char *label, psio_address start,
+                 int nrows, int ncols, int bucket, Op &op)
+{
+  int m, nbuckets, row_start, rows, ahead;
+  T *buf[2];
+  double **block[2];
+  RowRead rd;
+  pthread_t reader;
+
+  if(!nrows || !ncols) return;
+  if(bucket < 1) bucket = 1;
+  if(bucket > nrows) bucket = nrows;
+
+  buf[0] = dpd_alloc<T>((size_t) bucket * ncols, block[0]);
+  buf[1] = dpd_alloc<T>((size_t) bucket * ncols, block[1]);
+  nbuckets = (nrows + bucket - 1)/bucket;
+
+  rd.filenum = filenum;
+  rd.label = label;
+  rd.buffer = (char *) buf[0];
+  rd.size = (ULI) bucket * ncols * sizeof(T);
+  rd.start = start;
+  read_rows(&rd);
+
+  for(m=0; m < nbuckets; m++) {
+    row_start = m * bucket;
+    rows = (nrows - row_start < bucket) ? nrows - row_start : bucket;
+
+    ahead = (m+1 < nbuckets);
+    if(ahead) {
+      rd.start = rd.next;
+      rd.buffer = (char *) buf[(m+1)%2];
+      rd.size = (ULI) ((nrows - row_start - rows < bucket) ? nrows - row_start - rows : bucket)
+                * ncols * sizeof(T);
+      if(pthread_create(&reader, NULL, read_rows, (void *) &rd))
+        throw PsiException("pthread_create in stream_rows() failed", __FILE__, __LINE__);
+    }
+
+    op(buf[m%2], row_start, rows);
+
+    if(ahead && pthread_join(reader, NULL))
+      throw PsiException("pthread_join in stream_rows() failed", __FILE__, __LINE__);
+    op.sync();
+  }
+
+  dpd_free<T>((size_t) bucket * ncols, block[0]);
+  dpd_free<T>((size_t) bucket * ncols, block[1]);
+}
+
+/* Z(ab,ij) += alpha B(ab,cd) tau(ij,cd), B in double precision */
+struct LadderDouble {
+  double alpha;
+  double **tau, **Z;
+  int nij, ncd;
+  void operator()(double *B, int row_start, int nrows) {
+    C_DGEMM('n', 't', nrows, nij, ncd, alpha, B, ncd, tau[0], ncd, 1.0, Z[row_start], nij);
+  }
+  void sync(void) {}
+};
+
+/* Z(ab,ij) += alpha B(ab,cd) tau(ij,cd) with B and tau in single precision,
+   accumulated in double */
+struct LadderSingle {
+  float alpha;
+  float *tau, *Zf;
+  double **Z;
+  int nij, ncd;
+  void operator()(float *B, int row_start, int nrows) {
+    int ab, ij;
+    C_SGEMM('n', 't', nrows, nij, ncd, alpha, B, ncd, tau, ncd, 0.0, Zf, nij);
+    for(ab=0; ab < nrows; ab++)
+      for(ij=0; ij < nij; ij++)
+        Z[row_start+ab][ij] += (double) Zf[(size_t) ab*nij+ij];
+  }
+  void sync(void) {}
+};
+
+/*
+** Double-precision ladder which also writes a single-precision copy of B to
+** the entry flabel and compares the single-precision product with the
+** double one.  dZ_max and dE collect max |dZ(ab,ij)| and sum tau(ij,ab)
+** dZ(ab,ij), the change in the ladder's contribution to the pair energies.
+*/
+struct LadderConvert {
+  LadderDouble exact;
+  float alpha;
+  float *tau, *Bf, *Zf;
+  int nij, ncd, nrows;
+  const char *flabel;
+  psio_address next;
+  double dZ_max, dE;
+  void operator()(double *B, int row_start, int rows) {
+    size_t n, size = (size_t) rows * ncd;
+    int ab, ij;
+    double dZ;
+    exact(B, row_start, rows);
+    for(n=0; n < size; n++) Bf[n] = (float) B[n];
+    C_SGEMM('n', 't', rows, nij, ncd, alpha, Bf, ncd, tau, ncd, 0.0, Zf, nij);
+    for(ab=0; ab < rows; ab++)
+      for(ij=0; ij < nij; ij++) {
+        dZ = (double) Zf[(size_t) ab*nij+ij] - exact.Z[row_start+ab][ij];
+        if(fabs(dZ) > dZ_max) dZ_max = fabs(dZ);
+        dE += dZ * exact.tau[ij][row_start+ab];
+      }
+    nrows = rows;
+  }
+  void sync(void) {
+    psio_write(PSIF_CC_BINTS, flabel, (char *) Bf, (ULI) nrows * ncd * sizeof(float), next, &next);
+  }
+};
+
+/* -1/4 B(ab,cc) tau_diag(ij,c) term of the S(ab,ij) ladder */
+struct DiagLadder {
+  double **tau_diag, **S;
+  int nij, nvirt;
+  void operator()(double *B_diag, int row_start, int nrows) {
+    C_DGEMM('n', 't', nrows, nij, nvirt, -0.25, B_diag, nvirt,
+            tau_diag[0], nvirt, 1, S[row_start], nij);
+  }
+  void sync(void) {}
+};
+
+} // namespace
+
+/*
+** ladder_stream(): Z(ab,ij) = alpha B(ab,cd) tau(ij,cd) for the B(+)/B(-)
+** buffers of the RHF ladder, i.e. contract444(B, tau, Z, 0, 0, alpha, 0),
+** with B streamed from disk by stream_rows().  With ABCD_PRECISION SINGLE,
+** B is read from the single-precision copy flabel, which the first
+** iteration writes while doing the contraction in double.
+*/
+void ladder_stream(dpdbuf4 *B, dpdbuf4 *tau, dpdbuf4 *Z, double alpha, const char *flabel)
+{
+  int h, nab, nij, ncd, bucket;
+  long int memfree;
+  float *tauf;
+  double **tauf_block, **Bf_block, **Zf_block;
+  psio_address fstart;
+  LadderDouble ld;
+  LadderSingle ls;
+  LadderConvert lc;
+  double dZ_max = 0.0, dE = 0.0;
+  bool single, convert;
+
+  /* B held in core by the cache: nothing to stream */
+  if(B->file.incore) {
+    global_dpd_->contract444(B, tau, Z, 0, 0, alpha, 0);
+    return;
+  }
+
+  single = params.abcd_single;
+  convert = single && (moinfo.iter <= 1 || psio_tocscan(PSIF_CC_BINTS, flabel) == NULL);
+
+  fstart = PSIO_ZERO;
+  for(h=0; h < moinfo.nirreps; h++) {
+    nab = B->params->rowtot[h];
+    ncd = B->params->coltot[h];
+    nij = tau->params->rowtot[h];
+
+    global_dpd_->buf4_mat_irrep_init(tau, h);
+    global_dpd_->buf4_mat_irrep_rd(tau, h);
+    global_dpd_->buf4_mat_irrep_init(Z, h);
+
+    tauf = NULL;
+    if(single && nij && ncd) {
+      tauf = dpd_alloc<float>((size_t) nij * ncd, tauf_block);
+      for(size_t n=0; n < (size_t) nij * ncd; n++) tauf[n] = (float) tau->matrix[h][0][n];
+    }
+
+    /* Two buffers of B rows, plus float work rows for a single-precision
+       run, all taken from the DPD pool; a few doubles are kept back for the
+       rounding of the float blocks to whole doubles */
+    memfree = dpd_memfree() - 4;
+    if(!single) bucket = (int) (memfree / (2*ncd));
+    else if(convert) bucket = (int) (2*memfree / (5*ncd + nij));
+    else bucket = (int) (2*memfree / (2*ncd + nij));
+    if(bucket < 1) bucket = 1;
+    if(bucket > nab) bucket = nab;
+
+    if(nab && nij && ncd) {
+      if(!single) {
+        ld.alpha = alpha; ld.tau = tau->matrix[h]; ld.Z = Z->matrix[h];
+        ld.nij = nij; ld.ncd = ncd;
+        stream_rows<double>(B->file.filenum, B->file.label, B->file.lfiles[h], nab, ncd, bucket, ld);
+      }
+      else if(convert) {
+        lc.exact.alpha = alpha; lc.exact.tau = tau->matrix[h]; lc.exact.Z = Z->matrix[h];
+        lc.exact.nij = nij; lc.exact.ncd = ncd;
+        lc.alpha = (float) alpha; lc.tau = tauf; lc.nij = nij; lc.ncd = ncd;
+        lc.Bf = dpd_alloc<float>((size_t) bucket * ncd, Bf_block);
+        lc.Zf = dpd_alloc<float>((size_t) bucket * nij, Zf_block);
+        lc.flabel = flabel; lc.next = fstart;
+        lc.dZ_max = 0.0; lc.dE = 0.0;
+        stream_rows<double>(B->file.filenum, B->file.label, B->file.lfiles[h], nab, ncd, bucket, lc);
+        if(lc.dZ_max > dZ_max) dZ_max = lc.dZ_max;
+        dE += lc.dE;
+        dpd_free<float>((size_t) bucket * ncd, Bf_block);
+        dpd_free<float>((size_t) bucket * nij, Zf_block);
+      }
+      else {
+        ls.alpha = (float) alpha; ls.tau = tauf; ls.Z = Z->matrix[h];
+        ls.nij = nij; ls.ncd = ncd;
+        ls.Zf = dpd_alloc<float>((size_t) bucket * nij, Zf_block);
+        stream_rows<float>(PSIF_CC_BINTS, flabel, fstart, nab, ncd, bucket, ls);
+        dpd_free<float>((size_t) bucket * nij, Zf_block);
+      }
+
+      /* the single-precision copy stores the irreps back to back */
+      fstart = psio_get_address(fstart, (ULI) nab * ncd * sizeof(float));
+    }
+
+    if(tauf != NULL) dpd_free<float>((size_t) nij * ncd, tauf_block);
+    global_dpd_->buf4_mat_irrep_wrt(Z, h);
+    global_dpd_->buf4_mat_irrep_close(Z, h);
+    global_dpd_->buf4_mat_irrep_close(tau, h);
+  }
+
+  if(convert) {
+    fprintf(outfile, "\tSingle-precision %s: max |dZ| = %10.3e, ladder pair-energy error = %10.3e\n",
+            B->file.label, dZ_max, dE);
+    fflush(outfile);
+  }
+}
+
 void BT2(void)
 {
   int h;
@@ -49,11 +319,10 @@ void BT2(void)
   dpdbuf4 tau_a, tau_s, tau;
   dpdbuf4 B_a, B_s;
   dpdbuf4 S, A;
-  double **B_diag, **tau_diag;
+  double **tau_diag;
   int ij, Gc, C, c, cc;
-  int nbuckets, rows_per_bucket, rows_left, m, row_start, ab, cd, dc, d;
-  int nrows, ncols, nlinks;
-  psio_address next;
+  int rows_per_bucket;
+  DiagLadder diag;
 
   if(params.ref == 0) { /** RHF **/
     if(params.abcd == "OLD") {
@@ -97,7 +366,7 @@ void BT2(void)
       global_dpd_->buf4_init(&tau_s, PSIF_CC_TAMPS, 0, 3, 8, 3, 8, 0, "tau(+)(ij,ab)");
       global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
       global_dpd_->buf4_init(&S, PSIF_CC_TMP0, 0, 8, 3, 8, 3, 0, "S(ab,ij)");
-      global_dpd_->contract444(&B_s, &tau_s, &S, 0, 0, 0.5, 0);
+      ladder_stream(&B_s, &tau_s, &S, 0.5, "B(+) <ab|cd> + <ab|dc> [float]");
       global_dpd_->buf4_close(&S);
       global_dpd_->buf4_close(&B_s);
       global_dpd_->buf4_close(&tau_s);
@@ -124,39 +393,19 @@ void BT2(void)
       global_dpd_->buf4_mat_irrep_init(&S, 0);
       global_dpd_->buf4_mat_irrep_rd(&S, 0);
 
-      rows_per_bucket = dpd_memfree()/(B_s.params->coltot[0] + moinfo.nvirt);
-      if(rows_per_bucket > B_s.params->rowtot[0]) rows_per_bucket = B_s.params->rowtot[0];
-      nbuckets = (int) ceil((double) B_s.params->rowtot[0]/(double) rows_per_bucket);
-      rows_left = B_s.params->rowtot[0] % rows_per_bucket;
-
-      B_diag = global_dpd_->dpd_block_matrix(rows_per_bucket, moinfo.nvirt);
-      next = PSIO_ZERO;
-      ncols = tau.params->rowtot[0];
-      nlinks = moinfo.nvirt;
-      for(m=0; m < (rows_left ? nbuckets-1:nbuckets); m++) {
-	row_start = m * rows_per_bucket;
-	nrows = rows_per_bucket;
-	if(nrows && ncols && nlinks) {
-	  psio_read(PSIF_CC_BINTS,"B(+) <ab|cc>",(char *) B_diag[0],nrows*nlinks*sizeof(double),next, &next);
-	  C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks,
-		  tau_diag[0], nlinks, 1, S.matrix[0][row_start], ncols);
-	}
-
-      }
-      if(rows_left) {
-	row_start = m * rows_per_bucket;
-	nrows = rows_left;
-	if(nrows && ncols && nlinks) {
-	  psio_read(PSIF_CC_BINTS,"B(+) <ab|cc>",(char *) B_diag[0],nrows*nlinks*sizeof(double),next, &next);
-	  C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks,
-		  tau_diag[0], nlinks, 1, S.matrix[0][row_start], ncols);
-	}
-      }
+      /* B(+) <ab|cc> holds only the totally symmetric rows */
+      rows_per_bucket = dpd_memfree()/(2 * moinfo.nvirt);
+      diag.tau_diag = tau_diag;
+      diag.S = S.matrix[0];
+      diag.nij = tau.params->rowtot[0];
+      diag.nvirt = moinfo.nvirt;
+      if(diag.nij)
+        stream_rows<double>(PSIF_CC_BINTS, "B(+) <ab|cc>", PSIO_ZERO, B_s.params->rowtot[0],
+                            moinfo.nvirt, rows_per_bucket, diag);
       global_dpd_->buf4_mat_irrep_wrt(&S, 0);
       global_dpd_->buf4_mat_irrep_close(&S, 0);
       global_dpd_->buf4_close(&S);
       global_dpd_->buf4_close(&B_s);
-      global_dpd_->free_dpd_block(B_diag, rows_per_bucket, moinfo.nvirt);
       global_dpd_->free_dpd_block(tau_diag, tau.params->rowtot[0], moinfo.nvirt);
       global_dpd_->buf4_close(&tau);
 
@@ -166,7 +415,7 @@ void BT2(void)
       global_dpd_->buf4_init(&tau_a, PSIF_CC_TAMPS, 0, 4, 9, 4, 9, 0, "tau(-)(ij,ab)");
       global_dpd_->buf4_init(&B_a, PSIF_CC_BINTS, 0, 9, 9, 9, 9, 0, "B(-) <ab|cd> - <ab|dc>");
       global_dpd_->buf4_init(&A, PSIF_CC_TMP0, 0, 9, 4, 9, 4, 0, "A(ab,ij)");
-      global_dpd_->contract444(&B_a, &tau_a, &A, 0, 0, 0.5, 0);
+      ladder_stream(&B_a, &tau_a, &A, 0.5, "B(-) <ab|cd> - <ab|dc> [float]");
       global_dpd_->buf4_close(&A);
       global_dpd_->buf4_close(&B_a);
       global_dpd_->buf4_close(&tau_a);
@@ -46,6 +46,38 @@ void halftrans(dpdbuf4 *Buf1, int dpdnum1, dpdbuf4 *Buf2, int dpdnum2, double **
                int *sospi, int type, double alpha, double beta);
 
 int AO_contribute(struct iwlbuf *InBuf, dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO);
+int AO_contribute_direct(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO);
+
+/* AO_ladder(): tau2_AO += (pr|qs) tau1_AO over all SO integrals, which
+** are read from PSIF_SO_TEI for AO_BASIS = DISK and recomputed for
+** AO_BASIS = DIRECT */
+int AO_ladder(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO)
+{
+  struct iwlbuf InBuf;
+  int lastbuf;
+  double tolerance=1e-14;
+  int count=0;
+
+  if(params.aobasis == "DIRECT")
+    return AO_contribute_direct(tau1_AO, tau2_AO);
+
+  iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
+
+  lastbuf = InBuf.lastbuf;
+
+  count += AO_contribute(&InBuf, tau1_AO, tau2_AO);
+
+  while(!lastbuf) {
+    iwl_buf_fetch(&InBuf);
+    lastbuf = InBuf.lastbuf;
+
+    count += AO_contribute(&InBuf, tau1_AO, tau2_AO);
+  }
+
+  iwl_buf_close(&InBuf, 1);
+
+  return count;
+}
 
 void BT2_AO(void)
 {
@@ -57,11 +89,7 @@ void BT2_AO(void)
   int **T2_cd_row_start, **T2_pq_row_start, offset, cd, pq;
   int **T2_CD_row_start, **T2_Cd_row_start;
   dpdbuf4 tau, t2, tau1_AO, tau2_AO;
-  dpdfile4 T;
   psio_address next;
-  struct iwlbuf InBuf;
-  int lastbuf;
-  double tolerance=1e-14;
   double **integrals;
   int **tau1_cols, **tau2_cols, *num_ints;
   int counter=0, counterAA=0, counterBB=0, counterAB=0;
@@ -126,98 +154,64 @@ void BT2_AO(void)
 
   if(params.ref == 0) { /** RHF **/
 
-    if(params.aobasis == "DISK") {
-
-      dpd_set_default(1);
-      global_dpd_->buf4_init(&tau1_AO, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjPq (1)");
-      global_dpd_->buf4_scm(&tau1_AO, 0.0);
+    dpd_set_default(1);
+    global_dpd_->buf4_init(&tau1_AO, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjPq (1)");
+    global_dpd_->buf4_scm(&tau1_AO, 0.0);
 
-      dpd_set_default(0);
-      global_dpd_->buf4_init(&tau, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjAb");
+    dpd_set_default(0);
+    global_dpd_->buf4_init(&tau, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjAb");
 
-      halftrans(&tau, 0, &tau1_AO, 1, C, C, nirreps, T2_cd_row_start, T2_pq_row_start, 
-		virtpi, virtpi, sopi, 0, 1.0, 0.0);
+    halftrans(&tau, 0, &tau1_AO, 1, C, C, nirreps, T2_cd_row_start, T2_pq_row_start, 
+              virtpi, virtpi, sopi, 0, 1.0, 0.0);
 
-      global_dpd_->buf4_close(&tau);
-      global_dpd_->buf4_close(&tau1_AO);
+    global_dpd_->buf4_close(&tau);
+    global_dpd_->buf4_close(&tau1_AO);
 
-      /* Transpose tau1_AO for better memory access patterns */
-      dpd_set_default(1);
-      global_dpd_->buf4_init(&tau1_AO, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjPq (1)");
-      global_dpd_->buf4_sort(&tau1_AO, PSIF_CC_TMP0, rspq, 5, 0, "tauPqIj (1)");
-      global_dpd_->buf4_close(&tau1_AO);
+    /* Transpose tau1_AO for better memory access patterns */
+    dpd_set_default(1);
+    global_dpd_->buf4_init(&tau1_AO, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjPq (1)");
+    global_dpd_->buf4_sort(&tau1_AO, PSIF_CC_TMP0, rspq, 5, 0, "tauPqIj (1)");
+    global_dpd_->buf4_close(&tau1_AO);
 
-    
-      global_dpd_->buf4_init(&tau1_AO, PSIF_CC_TMP0, 0, 5, 0, 5, 0, 0, "tauPqIj (1)");
-      global_dpd_->buf4_init(&tau2_AO, PSIF_CC_TMP0, 0, 5, 0, 5, 0, 0, "tauPqIj (2)");
-      global_dpd_->buf4_scm(&tau2_AO, 0.0);
-        
-      for(h=0; h < nirreps; h++) {
-	global_dpd_->buf4_mat_irrep_init(&tau1_AO, h);
-	global_dpd_->buf4_mat_irrep_rd(&tau1_AO, h);
-	global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
-      }
-        
-      iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-        
-      lastbuf = InBuf.lastbuf;
-        
-      counter += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-        
-      while(!lastbuf) {
-	iwl_buf_fetch(&InBuf);
-	lastbuf = InBuf.lastbuf;
-        
-	counter += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-      }
-        
-      iwl_buf_close(&InBuf, 1);
-        
-      if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <ab||cd> --> T2\n", counter);
-        
-      for(h=0; h < nirreps; h++) {
-	global_dpd_->buf4_mat_irrep_wrt(&tau2_AO, h);
-	global_dpd_->buf4_mat_irrep_close(&tau2_AO, h);
-	global_dpd_->buf4_mat_irrep_close(&tau1_AO, h);
-      }
-      global_dpd_->buf4_close(&tau1_AO);
-      global_dpd_->buf4_close(&tau2_AO);
 
-      /* Transpose tau2_AO for the half-backtransformation */
-      dpd_set_default(1);
-      global_dpd_->buf4_init(&tau2_AO, PSIF_CC_TMP0, 0, 5, 0, 5, 0, 0, "tauPqIj (2)");
-      global_dpd_->buf4_sort(&tau2_AO, PSIF_CC_TAMPS, rspq, 0, 5, "tauIjPq (2)");
-      global_dpd_->buf4_close(&tau2_AO);
+    global_dpd_->buf4_init(&tau1_AO, PSIF_CC_TMP0, 0, 5, 0, 5, 0, 0, "tauPqIj (1)");
+    global_dpd_->buf4_init(&tau2_AO, PSIF_CC_TMP0, 0, 5, 0, 5, 0, 0, "tauPqIj (2)");
+    global_dpd_->buf4_scm(&tau2_AO, 0.0);
 
-      global_dpd_->buf4_init(&tau2_AO, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjPq (2)");
-    
-      dpd_set_default(0);
-      global_dpd_->buf4_init(&t2, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "New tIjAb");
+    for(h=0; h < nirreps; h++) {
+      global_dpd_->buf4_mat_irrep_init(&tau1_AO, h);
+      global_dpd_->buf4_mat_irrep_rd(&tau1_AO, h);
+      global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
+    }
 
-      halftrans(&t2, 0, &tau2_AO, 1, C, C, nirreps, T2_cd_row_start, T2_pq_row_start, 
-		virtpi, virtpi, sopi, 1, 1.0, 1.0);
+    counter += AO_ladder(&tau1_AO, &tau2_AO);
 
-      global_dpd_->buf4_close(&t2);
-      global_dpd_->buf4_close(&tau2_AO);
+    if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <ab||cd> --> T2\n", counter);
 
+    for(h=0; h < nirreps; h++) {
+      global_dpd_->buf4_mat_irrep_wrt(&tau2_AO, h);
+      global_dpd_->buf4_mat_irrep_close(&tau2_AO, h);
+      global_dpd_->buf4_mat_irrep_close(&tau1_AO, h);
     }
-    else if(params.aobasis == "DIRECT") {
-      global_dpd_->file4_init(&T, PSIF_CC_TAMPS, 0, 0, 5, "tauIjAb");
-      global_dpd_->file4_cache_del(&T);
-      global_dpd_->file4_close(&T);
-
-      global_dpd_->file4_init(&T, PSIF_CC_TAMPS, 0, 0, 5, "New tIjAb");
-      global_dpd_->file4_cache_del(&T);
-      global_dpd_->file4_close(&T);
-
-      /* close the CC_TAMPS file for cints to use it */
-      psio_close(PSIF_CC_TAMPS, 1);
-        
-      system("cints --cc_bt2");
-
-      /* re-open CCC_TAMPS for remaining terms */
-      psio_open(PSIF_CC_TAMPS, PSIO_OPEN_OLD);
-    }
+    global_dpd_->buf4_close(&tau1_AO);
+    global_dpd_->buf4_close(&tau2_AO);
+
+    /* Transpose tau2_AO for the half-backtransformation */
+    dpd_set_default(1);
+    global_dpd_->buf4_init(&tau2_AO, PSIF_CC_TMP0, 0, 5, 0, 5, 0, 0, "tauPqIj (2)");
+    global_dpd_->buf4_sort(&tau2_AO, PSIF_CC_TAMPS, rspq, 0, 5, "tauIjPq (2)");
+    global_dpd_->buf4_close(&tau2_AO);
+
+    global_dpd_->buf4_init(&tau2_AO, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tauIjPq (2)");
+
+    dpd_set_default(0);
+    global_dpd_->buf4_init(&t2, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "New tIjAb");
+
+    halftrans(&t2, 0, &tau2_AO, 1, C, C, nirreps, T2_cd_row_start, T2_pq_row_start, 
+              virtpi, virtpi, sopi, 1, 1.0, 1.0);
+
+    global_dpd_->buf4_close(&t2);
+    global_dpd_->buf4_close(&tau2_AO);
 
   }
   else if(params.ref == 1) { /** ROHF **/
@@ -253,20 +247,7 @@ void BT2_AO(void)
       global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
     }
 
-    iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-
-    lastbuf = InBuf.lastbuf;
-
-    counterAA += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-
-    while(!lastbuf) {
-      iwl_buf_fetch(&InBuf);
-      lastbuf = InBuf.lastbuf;
-
-      counterAA += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-    }
-
-    iwl_buf_close(&InBuf, 1);
+    counterAA += AO_ladder(&tau1_AO, &tau2_AO);
 
     if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <AB||CD> --> T2\n", counterAA);
 
@@ -327,20 +308,7 @@ void BT2_AO(void)
       global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
     }
 
-    iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-
-    lastbuf = InBuf.lastbuf;
-
-    counterBB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-
-    while(!lastbuf) {
-      iwl_buf_fetch(&InBuf);
-      lastbuf = InBuf.lastbuf;
-
-      counterBB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-    }
-
-    iwl_buf_close(&InBuf, 1);
+    counterBB += AO_ladder(&tau1_AO, &tau2_AO);
 
     if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <ab||cd> --> T2\n", counterBB);
 
@@ -402,20 +370,7 @@ void BT2_AO(void)
       global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
     }
 
-    iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-
-    lastbuf = InBuf.lastbuf;
-
-    counterAB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-
-    while(!lastbuf) {
-      iwl_buf_fetch(&InBuf);
-      lastbuf = InBuf.lastbuf;
-
-      counterAB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-    }
-
-    iwl_buf_close(&InBuf, 1);
+    counterAB += AO_ladder(&tau1_AO, &tau2_AO);
 
     if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <Ab|Cd> --> T2\n", counterAB);
 
@@ -478,20 +433,7 @@ void BT2_AO(void)
       global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
     }
 
-    iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-
-    lastbuf = InBuf.lastbuf;
-
-    counterAA += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-
-    while(!lastbuf) {
-      iwl_buf_fetch(&InBuf);
-      lastbuf = InBuf.lastbuf;
-
-      counterAA += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-    }
-
-    iwl_buf_close(&InBuf, 1);
+    counterAA += AO_ladder(&tau1_AO, &tau2_AO);
 
     if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <AB||CD> --> T2\n", counterAA);
 
@@ -552,20 +494,7 @@ void BT2_AO(void)
       global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
     }
 
-    iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-
-    lastbuf = InBuf.lastbuf;
-
-    counterBB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-
-    while(!lastbuf) {
-      iwl_buf_fetch(&InBuf);
-      lastbuf = InBuf.lastbuf;
-
-      counterBB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-    }
-
-    iwl_buf_close(&InBuf, 1);
+    counterBB += AO_ladder(&tau1_AO, &tau2_AO);
 
     if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <ab||cd> --> T2\n", counterBB);
 
@@ -627,20 +556,7 @@ void BT2_AO(void)
       global_dpd_->buf4_mat_irrep_init(&tau2_AO, h);
     }
 
-    iwl_buf_init(&InBuf, PSIF_SO_TEI, tolerance, 1, 1);
-
-    lastbuf = InBuf.lastbuf;
-
-    counterAB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-
-    while(!lastbuf) {
-      iwl_buf_fetch(&InBuf);
-      lastbuf = InBuf.lastbuf;
-
-      counterAB += AO_contribute(&InBuf, &tau1_AO, &tau2_AO);
-    }
-
-    iwl_buf_close(&InBuf, 1);
+    counterAB += AO_ladder(&tau1_AO, &tau2_AO);
 
     if(params.print & 2) fprintf(outfile, "     *** Processed %d SO integrals for <Ab|Cd> --> T2\n", counterAB);
 
@@ -40,6 +40,7 @@ struct Params {
   int restart;
   long int memory;
   std::string aobasis;
+  double ints_tol;     /* Schwarz screening threshold for AO_BASIS = DIRECT */
   int cachelev;
   int cachetype;
   int ref;
@@ -61,6 +62,7 @@ struct Params {
   int just_energy; /* just compute energy from T amplitudes on disk and quit */
 	int just_residuals; /* just compute residuals from T amplitudes on disk and quit */
   std::string abcd;
+  int abcd_single;   /* B(+)/B(-) ladder in single precision */
   int t3_Ws_incore;
   int nthreads;
   int scs;
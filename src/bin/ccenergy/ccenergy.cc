@@ -228,7 +228,7 @@ PsiReturnType ccenergy(Options &options)
     spaces.push_back(moinfo.bvirtpi);
     spaces.push_back(moinfo.bvir_sym);
     delete[] dpd_list[0];
-    dpd_list[0] = new DPD(0, moinfo.nirreps, params.memory, 0, cachefiles,
+    dpd_list[0] = new DPD(0, moinfo.nirreps, params.memory, params.cachetype, cachefiles,
          cachelist, NULL, 4, spaces);
     dpd_set_default(0);
 
@@ -316,6 +316,8 @@ PsiReturnType ccenergy(Options &options)
   checkpoint();
   for(moinfo.iter=1; moinfo.iter <= params.maxiter; moinfo.iter++) {
 
+    global_dpd_->file4_cache_trace_next();
+
     sort_amps();
 
 #ifdef TIME_CCENERGY
@@ -438,6 +440,7 @@ PsiReturnType ccenergy(Options &options)
     update();
     checkpoint();
   }  // end loop over iterations
+  global_dpd_->file4_cache_trace_print(outfile);
   fprintf(outfile, "\n");
   if(!done) {
     fprintf(outfile, "\t ** Wave function not converged to %2.1e ** \n",
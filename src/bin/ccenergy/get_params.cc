@@ -101,17 +101,19 @@ void get_params(Options &options)
   params.memory = Process::environment.get_memory();
 
   params.aobasis = options.get_str("AO_BASIS");
+  params.ints_tol = options.get_double("INTS_TOLERANCE");
   params.cachelev = options.get_int("CACHELEVEL");
 
   params.cachetype = 1;
   cachetype = options.get_str("CACHETYPE");
   if(cachetype == "LOW") params.cachetype = 1;
   else if(cachetype == "LRU") params.cachetype = 0;
+  else if(cachetype == "TRACE") params.cachetype = 2;
   else
     throw PsiException("Error in input: invalid CACHETYPE", __FILE__, __LINE__);
 
 
- if(params.ref == 2) /* No LOW cacheing yet for UHF references */
+ if(params.ref == 2 && params.cachetype == 1) /* No LOW cacheing yet for UHF references */
     params.cachetype = 0;
 
   params.nthreads = Process::environment.get_n_threads();
@@ -122,6 +124,7 @@ void get_params(Options &options)
   params.t2_coupled = options.get_bool("T2_COUPLED");
   params.prop = options.get_str("PROPERTY");
   params.abcd = options.get_str("ABCD");
+  params.abcd_single = (options.get_str("ABCD_PRECISION") == "SINGLE");
   params.local = options.get_bool("LOCAL");
   local.cutoff = options.get_double("LOCAL_CUTOFF");
   local.method = options.get_str("LOCAL_METHOD");
@@ -196,10 +199,13 @@ void get_params(Options &options)
       params.restart ? "Yes" : "No");
   fprintf(outfile, "\tDIIS            =     %s\n", params.diis ? "Yes" : "No");
   fprintf(outfile, "\tAO Basis        =     %s\n", params.aobasis.c_str());
+  if(params.aobasis == "DIRECT")
+    fprintf(outfile, "\tInts Tolerance  =     %3.1e\n", params.ints_tol);
   fprintf(outfile, "\tABCD            =     %s\n", params.abcd.c_str());
+  fprintf(outfile, "\tABCD Precision  =     %s\n", params.abcd_single ? "SINGLE" : "DOUBLE");
   fprintf(outfile, "\tCache Level     =     %1d\n", params.cachelev);
-  fprintf(outfile, "\tCache Type      =    %4s\n",
-      params.cachetype ? "LOW" : "LRU");
+  fprintf(outfile, "\tCache Type      =    %5s\n",
+      params.cachetype == 2 ? "TRACE" : (params.cachetype ? "LOW" : "LRU"));
   fprintf(outfile, "\tPrint Level     =     %1d\n",  params.print);
   fprintf(outfile, "\tNum. of threads =     %d\n",  params.nthreads);
   fprintf(outfile, "\t# Amps to Print =     %1d\n",  params.num_amps);
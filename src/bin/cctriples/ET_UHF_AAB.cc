@@ -29,57 +29,46 @@
 #include <cmath>
 #include <libciomr/libciomr.h>
 #include <libqt/qt.h>
+#include <pthread.h>
 #include <libdpd/dpd.h>
 #include "MOInfo.h"
 #include "Params.h"
+#include "ijk_tasks.h"
 #define EXTERN
 #include "globals.h"
 
 namespace psi { namespace cctriples {
 
+struct ET_UHF_AAB_data {
+  dpdfile2 *T1A; dpdfile2 *T1B; dpdfile2 *fIJ; dpdfile2 *fij;
+  dpdfile2 *fAB; dpdfile2 *fab; dpdfile2 *fIA; dpdfile2 *fia;
+  dpdbuf4 *T2AB; dpdbuf4 *T2AA; dpdbuf4 *T2BA; dpdbuf4 *EAAints;
+  dpdbuf4 *EABints; dpdbuf4 *EBAints; dpdbuf4 *DAAints; dpdbuf4 *DABints;
+  dpdbuf4 FAAints, FABints, FBAints;
+  IJKQueue *queue; double ET;
+};
+
+void *ET_UHF_AAB_thread(void *thread_data);
+
 double ET_UHF_AAB(void)
 {
-  int cnt;
   int h, nirreps;
-  int Gi, Gj, Gk, Ga, Gb, Gc, Gd, Gl;
-  int Gji, Gij, Gjk, Gkj, Gik, Gki, Gijk;
-  int Gab, Gbc, Gac, Gcb, Gca;
-  int Gid, Gjd, Gkd;
-  int Gil, Gjl, Gkl;
-  int I, J, K, A, B, C;
-  int i, j, k, a, b, c;
-  int ij, ji, ik, ki, jk, kj;
-  int ab, ba, ac, ca, bc, cb;
-  int dc, ad, bd;
-  int lc, la, lb;
-  int id, jd, kd;
-  int il, jl, kl;
-  int *aoccpi, *avirtpi, *aocc_off, *avir_off;
-  int *boccpi, *bvirtpi, *bocc_off, *bvir_off;
-  double value_c, value_d, dijk, denom, ET_AAB;
-  double t_ia, t_ib, t_ja, t_jb, t_kc;
-  double f_ia, f_ib, f_ja, f_jb, f_kc;
-  double D_jkbc, D_jkac, D_ikbc, D_ikac, D_jiab;
-  double t_jkbc, t_jkac, t_ikbc, t_ikac, t_jiab;
-  int nrows, ncols, nlinks;
+  int nthreads, thread;
+  int *aoccpi, *aocc_off;
+  int *boccpi, *bocc_off;
+  double ET_AAB;
   dpdbuf4 T2AB, T2AA, T2BA;
-  dpdbuf4 FAAints, FABints, FBAints;
   dpdbuf4 EAAints, EABints, EBAints;
   dpdbuf4 DAAints, DABints;
   dpdfile2 T1A, T1B, fIJ, fij, fAB, fab, fIA, fia;
-  double ***WABc, ***WBcA, ***WAcB, ***WcAB, ***WcBA, ***VABc;
-  int nijk, mijk;
   FILE *ijkfile;
+  struct ET_UHF_AAB_data *thread_data_array;
 
   nirreps = moinfo.nirreps;
   aoccpi = moinfo.aoccpi; 
-  avirtpi = moinfo.avirtpi;
   aocc_off = moinfo.aocc_off;
-  avir_off = moinfo.avir_off;
   boccpi = moinfo.boccpi; 
-  bvirtpi = moinfo.bvirtpi;
   bocc_off = moinfo.bocc_off;
-  bvir_off = moinfo.bvir_off;
 
   global_dpd_->file2_init(&fIJ, PSIF_CC_OEI, 0, 0, 0, "fIJ");
   global_dpd_->file2_init(&fij, PSIF_CC_OEI, 0, 2, 2, "fij");
@@ -111,9 +100,6 @@ double ET_UHF_AAB(void)
   global_dpd_->buf4_init(&T2AB, PSIF_CC_TAMPS, 0, 22, 28, 22, 28, 0, "tIjAb");
   global_dpd_->buf4_init(&T2BA, PSIF_CC_TAMPS, 0, 23, 29, 23, 29, 0, "tiJaB");
 
-  global_dpd_->buf4_init(&FAAints, PSIF_CC_FINTS, 0, 20, 5, 20, 5, 1, "F <IA|BC>");
-  global_dpd_->buf4_init(&FABints, PSIF_CC_FINTS, 0, 24, 28, 24, 28, 0, "F <Ia|Bc>");
-  global_dpd_->buf4_init(&FBAints, PSIF_CC_FINTS, 0, 27, 29, 27, 29, 0, "F <iA|bC>");
 
   global_dpd_->buf4_init(&EAAints, PSIF_CC_EINTS, 0, 0, 20, 2, 20, 0, "E <IJ||KA> (I>J,KA)");
   global_dpd_->buf4_init(&EABints, PSIF_CC_EINTS, 0, 22, 24, 22, 24, 0, "E <Ij|Ka>");
@@ -148,31 +134,162 @@ double ET_UHF_AAB(void)
     global_dpd_->buf4_mat_irrep_rd(&DABints, h);
   }
 
-  /* Compute the number of IJK combinations in this spin case */
-  nijk = 0;
-  for(Gi=0; Gi < nirreps; Gi++)
-    for(Gj=0; Gj < nirreps; Gj++)
-      for(Gk=0; Gk < nirreps; Gk++)
-	for(i=0; i < aoccpi[Gi]; i++) {
-	  I = aocc_off[Gi] + i;
-	  for(j=0; j < aoccpi[Gj]; j++) {
-	    J = aocc_off[Gj] + j;
-	    for(k=0; k < boccpi[Gk]; k++) {
-	      K = bocc_off[Gk] + k;
-
-	      if(I > J) nijk++;
-	    }
-	  }
-	}
+  /* All IJK combinations of all irrep triples go into one queue, which
+     the threads draw from until it is empty */
+  IJKQueue queue(nirreps, aoccpi, aocc_off, aoccpi, aocc_off, boccpi, bocc_off, IJK_IJ_GT);
 
   ffile(&ijkfile,"ijk.dat",0);
   fprintf(ijkfile, "Spin Case: AAB\n");
-  fprintf(ijkfile, "Number of IJK combintions: %d\n", nijk);
+  fprintf(ijkfile, "Number of IJK combintions: %d\n", queue.size());
   fprintf(ijkfile, "\nCurrent IJK Combination:\n");
   fflush(ijkfile);
+  queue.set_progress(ijkfile);
+
+  /* each thread gets its own F buffers to read blocks into and its own
+     W and V intermediates - all else shared */
+  nthreads = params.nthreads;
+  thread_data_array = (struct ET_UHF_AAB_data *) malloc(nthreads*sizeof(struct ET_UHF_AAB_data));
+  for(thread=0; thread < nthreads; thread++) {
+    thread_data_array[thread].T1A = &T1A;
+    thread_data_array[thread].T1B = &T1B;
+    thread_data_array[thread].fIJ = &fIJ;
+    thread_data_array[thread].fij = &fij;
+    thread_data_array[thread].fAB = &fAB;
+    thread_data_array[thread].fab = &fab;
+    thread_data_array[thread].fIA = &fIA;
+    thread_data_array[thread].fia = &fia;
+    thread_data_array[thread].T2AB = &T2AB;
+    thread_data_array[thread].T2AA = &T2AA;
+    thread_data_array[thread].T2BA = &T2BA;
+    thread_data_array[thread].EAAints = &EAAints;
+    thread_data_array[thread].EABints = &EABints;
+    thread_data_array[thread].EBAints = &EBAints;
+    thread_data_array[thread].DAAints = &DAAints;
+    thread_data_array[thread].DABints = &DABints;
+    global_dpd_->buf4_init(&(thread_data_array[thread].FAAints), PSIF_CC_FINTS, 0, 20, 5, 20, 5, 1, "F <IA|BC>");
+    global_dpd_->buf4_init(&(thread_data_array[thread].FABints), PSIF_CC_FINTS, 0, 24, 28, 24, 28, 0, "F <Ia|Bc>");
+    global_dpd_->buf4_init(&(thread_data_array[thread].FBAints), PSIF_CC_FINTS, 0, 27, 29, 27, 29, 0, "F <iA|bC>");
+    thread_data_array[thread].queue = &queue;
+    thread_data_array[thread].ET = 0.0;
+  }
+
+  ijk_threads(nthreads, ET_UHF_AAB_thread, thread_data_array, sizeof(struct ET_UHF_AAB_data));
 
-  mijk = 0;
   ET_AAB = 0.0;
+  for(thread=0; thread < nthreads; thread++) {
+    ET_AAB += thread_data_array[thread].ET;
+    global_dpd_->buf4_close(&(thread_data_array[thread].FAAints));
+    global_dpd_->buf4_close(&(thread_data_array[thread].FABints));
+    global_dpd_->buf4_close(&(thread_data_array[thread].FBAints));
+  }
+
+  free(thread_data_array);
+
+  /*  fprintf(outfile, "cnt = %d\n", cnt); */
+  /*  fprintf(outfile, "ET_AAB = %20.14f\n", ET_AAB); */
+
+
+  fclose(ijkfile);
+
+  for(h=0; h < nirreps; h++) {
+    global_dpd_->buf4_mat_irrep_close(&T2AA, h);
+    global_dpd_->buf4_mat_irrep_close(&T2AB, h);
+    global_dpd_->buf4_mat_irrep_close(&T2BA, h);
+    global_dpd_->buf4_mat_irrep_close(&EAAints, h);
+    global_dpd_->buf4_mat_irrep_close(&EABints, h);
+    global_dpd_->buf4_mat_irrep_close(&EBAints, h);
+    global_dpd_->buf4_mat_irrep_close(&DAAints, h);
+    global_dpd_->buf4_mat_irrep_close(&DABints, h);
+  }
+
+  global_dpd_->buf4_close(&T2AA);
+  global_dpd_->buf4_close(&T2AB);
+  global_dpd_->buf4_close(&T2BA);
+  global_dpd_->buf4_close(&EAAints);
+  global_dpd_->buf4_close(&EABints);
+  global_dpd_->buf4_close(&EBAints);
+  global_dpd_->buf4_close(&DAAints);
+  global_dpd_->buf4_close(&DABints);
+
+  global_dpd_->file2_mat_close(&T1A);
+  global_dpd_->file2_close(&T1A);
+  global_dpd_->file2_mat_close(&T1B);
+  global_dpd_->file2_close(&T1B);
+
+  global_dpd_->file2_mat_close(&fIJ);
+  global_dpd_->file2_mat_close(&fij);
+  global_dpd_->file2_mat_close(&fAB);
+  global_dpd_->file2_mat_close(&fab);
+  global_dpd_->file2_mat_close(&fIA);
+  global_dpd_->file2_mat_close(&fia);
+  global_dpd_->file2_close(&fIJ);
+  global_dpd_->file2_close(&fij);
+  global_dpd_->file2_close(&fAB);
+  global_dpd_->file2_close(&fab);
+  global_dpd_->file2_close(&fIA);
+  global_dpd_->file2_close(&fia);
+
+  return ET_AAB;
+}
+
+void *ET_UHF_AAB_thread(void *thread_data_in)
+{
+  int nirreps;
+  int Gi, Gj, Gk, Ga, Gb, Gc, Gd, Gl;
+  int Gji, Gij, Gjk, Gkj, Gik, Gki, Gijk;
+  int Gab, Gbc, Gac, Gcb, Gca;
+  int Gid, Gjd, Gkd;
+  int Gil, Gjl, Gkl;
+  int I, J, K, A, B, C;
+  int i, j, k, a, b, c;
+  int ij, ji, ik, ki, jk, kj;
+  int ab, ba, ac, ca, bc, cb;
+  int dc, ad, bd;
+  int lc, la, lb;
+  int id, jd, kd;
+  int il, jl, kl;
+  int *aoccpi, *avirtpi, *aocc_off, *avir_off;
+  int *boccpi, *bvirtpi, *bocc_off, *bvir_off;
+  double value_c, value_d, dijk, denom, ET_AAB;
+  double t_ia, t_ib, t_ja, t_jb, t_kc;
+  double f_ia, f_ib, f_ja, f_jb, f_kc;
+  double D_jkbc, D_jkac, D_ikbc, D_ikac, D_jiab;
+  double t_jkbc, t_jkac, t_ikbc, t_ikac, t_jiab;
+  int nrows, ncols, nlinks;
+  double ***WABc, ***WBcA, ***WAcB, ***WcAB, ***WcBA, ***VABc;
+  struct ET_UHF_AAB_data *data;
+  IJKTask task;
+
+  data = (struct ET_UHF_AAB_data *) thread_data_in;
+  dpdfile2 &T1A = *(data->T1A);
+  dpdfile2 &T1B = *(data->T1B);
+  dpdfile2 &fIJ = *(data->fIJ);
+  dpdfile2 &fij = *(data->fij);
+  dpdfile2 &fAB = *(data->fAB);
+  dpdfile2 &fab = *(data->fab);
+  dpdfile2 &fIA = *(data->fIA);
+  dpdfile2 &fia = *(data->fia);
+  dpdbuf4 &T2AB = *(data->T2AB);
+  dpdbuf4 &T2AA = *(data->T2AA);
+  dpdbuf4 &T2BA = *(data->T2BA);
+  dpdbuf4 &EAAints = *(data->EAAints);
+  dpdbuf4 &EABints = *(data->EABints);
+  dpdbuf4 &EBAints = *(data->EBAints);
+  dpdbuf4 &DAAints = *(data->DAAints);
+  dpdbuf4 &DABints = *(data->DABints);
+  dpdbuf4 &FAAints = data->FAAints;
+  dpdbuf4 &FABints = data->FABints;
+  dpdbuf4 &FBAints = data->FBAints;
+
+  nirreps = moinfo.nirreps;
+  aoccpi = moinfo.aoccpi; 
+  avirtpi = moinfo.avirtpi;
+  aocc_off = moinfo.aocc_off;
+  avir_off = moinfo.avir_off;
+  boccpi = moinfo.boccpi; 
+  bvirtpi = moinfo.bvirtpi;
+  bocc_off = moinfo.bocc_off;
+  bvir_off = moinfo.bvir_off;
 
   WABc = (double ***) malloc(nirreps * sizeof(double **));
   WBcA = (double ***) malloc(nirreps * sizeof(double **));
@@ -181,601 +298,602 @@ double ET_UHF_AAB(void)
   WcBA = (double ***) malloc(nirreps * sizeof(double **));
   VABc = (double ***) malloc(nirreps * sizeof(double **));
 
-  for(Gi=0; Gi < nirreps; Gi++) {
-    for(Gj=0; Gj < nirreps; Gj++) {
-      for(Gk=0; Gk < nirreps; Gk++) {
+  ET_AAB = 0.0;
 
-	Gij = Gji = Gi ^ Gj;
-	Gjk = Gkj = Gj ^ Gk;
-	Gik = Gki = Gi ^ Gk;
+  while(data->queue->next(task)) {
 
-	Gijk = Gi ^ Gj ^ Gk;
+    Gi = task.Gi; Gj = task.Gj; Gk = task.Gk;
+    i = task.i; j = task.j; k = task.k;
 
-	for(i=0; i < aoccpi[Gi]; i++) {
-	  I = aocc_off[Gi] + i;
-	  for(j=0; j < aoccpi[Gj]; j++) {
-	    J = aocc_off[Gj] + j;
-	    for(k=0; k < boccpi[Gk]; k++) {
-	      K = bocc_off[Gk] + k;
+    I = aocc_off[Gi] + i;
+    J = aocc_off[Gj] + j;
+    K = bocc_off[Gk] + k;
 
-	      if(I > J) {
+    Gij = Gji = Gi ^ Gj;
+    Gjk = Gkj = Gj ^ Gk;
+    Gik = Gki = Gi ^ Gk;
 
-		mijk++;
-		fprintf(ijkfile, "%d\n", mijk);
-		fflush(ijkfile);
+    Gijk = Gi ^ Gj ^ Gk;
 
-		ij = EAAints.params->rowidx[I][J];
-		ji = EAAints.params->rowidx[J][I];
-		jk = EABints.params->rowidx[J][K];
-		kj = EBAints.params->rowidx[K][J];
-		ik = EABints.params->rowidx[I][K];
-		ki = EBAints.params->rowidx[K][I];
+    ij = EAAints.params->rowidx[I][J];
+    ji = EAAints.params->rowidx[J][I];
+    jk = EABints.params->rowidx[J][K];
+    kj = EBAints.params->rowidx[K][J];
+    ik = EABints.params->rowidx[I][K];
+    ki = EBAints.params->rowidx[K][I];
 
-		dijk = 0.0;
-		if(fIJ.params->rowtot[Gi])
-		  dijk += fIJ.matrix[Gi][i][i];
-		if(fIJ.params->rowtot[Gj])
-		  dijk += fIJ.matrix[Gj][j][j];
-		if(fij.params->rowtot[Gk])
-		  dijk += fij.matrix[Gk][k][k];
+    dijk = 0.0;
+    if(fIJ.params->rowtot[Gi])
+      dijk += fIJ.matrix[Gi][i][i];
+    if(fIJ.params->rowtot[Gj])
+      dijk += fIJ.matrix[Gj][j][j];
+    if(fij.params->rowtot[Gk])
+      dijk += fij.matrix[Gk][k][k];
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  WABc[Gab] = global_dpd_->dpd_block_matrix(FAAints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      WABc[Gab] = ijk_block_matrix(FAAints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
-		  /* +t_JkDc * F_IDAB */
-		  Gab = Gid = Gi ^ Gd;
-		  Gc = Gjk ^ Gd;
+    for(Gd=0; Gd < nirreps; Gd++) {
+      /* +t_JkDc * F_IDAB */
+      Gab = Gid = Gi ^ Gd;
+      Gc = Gjk ^ Gd;
 
-		  dc = T2AB.col_offset[Gjk][Gd];
-		  id = FAAints.row_offset[Gid][I];
+      dc = T2AB.col_offset[Gjk][Gd];
+      id = FAAints.row_offset[Gid][I];
 
-		  FAAints.matrix[Gid] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FAAints.params->coltot[Gid]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FAAints, Gid, id, avirtpi[Gd]);
+      FAAints.matrix[Gid] = ijk_block_matrix(avirtpi[Gd], FAAints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FAAints, Gid, id, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FAAints.params->coltot[Gid];
-		  ncols = bvirtpi[Gc];
-		  nlinks = avirtpi[Gd];
+      nrows = FAAints.params->coltot[Gid];
+      ncols = bvirtpi[Gc];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(FAAints.matrix[Gid][0][0]), nrows,
-			    &(T2AB.matrix[Gjk][jk][dc]), ncols, 1.0,
-			    &(WABc[Gab][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(FAAints.matrix[Gid][0][0]), nrows,
+		&(T2AB.matrix[Gjk][jk][dc]), ncols, 1.0,
+		&(WABc[Gab][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FAAints.matrix[Gid], avirtpi[Gd], FAAints.params->coltot[Gid]);
+      ijk_free_block(FAAints.matrix[Gid], avirtpi[Gd], FAAints.params->coltot[Gid]);
 
-		  /* -t_IkDc * F_JDAB */
-		  Gab = Gjd = Gj ^ Gd;
-		  Gc = Gik ^ Gd;
+      /* -t_IkDc * F_JDAB */
+      Gab = Gjd = Gj ^ Gd;
+      Gc = Gik ^ Gd;
 
-		  dc = T2AB.col_offset[Gik][Gd];
-		  jd = FAAints.row_offset[Gjd][J];
+      dc = T2AB.col_offset[Gik][Gd];
+      jd = FAAints.row_offset[Gjd][J];
 
-		  FAAints.matrix[Gjd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FAAints.params->coltot[Gjd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FAAints, Gjd, jd, avirtpi[Gd]);
+      FAAints.matrix[Gjd] = ijk_block_matrix(avirtpi[Gd], FAAints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FAAints, Gjd, jd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FAAints.params->coltot[Gjd];
-		  ncols = bvirtpi[Gc];
-		  nlinks = avirtpi[Gd];
+      nrows = FAAints.params->coltot[Gjd];
+      ncols = bvirtpi[Gc];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(FAAints.matrix[Gjd][0][0]), nrows,
-			    &(T2AB.matrix[Gik][ik][dc]), ncols, 1.0,
-			    &(WABc[Gab][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(FAAints.matrix[Gjd][0][0]), nrows,
+		&(T2AB.matrix[Gik][ik][dc]), ncols, 1.0,
+		&(WABc[Gab][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FAAints.matrix[Gjd], avirtpi[Gd], FAAints.params->coltot[Gjd]);
+      ijk_free_block(FAAints.matrix[Gjd], avirtpi[Gd], FAAints.params->coltot[Gjd]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
-		  /* -t_ILAB * E_JkLc */
-		  Gab = Gil = Gi ^ Gl;
-		  Gc = Gjk ^ Gl;
+    for(Gl=0; Gl < nirreps; Gl++) {
+      /* -t_ILAB * E_JkLc */
+      Gab = Gil = Gi ^ Gl;
+      Gc = Gjk ^ Gl;
 
-		  lc = EABints.col_offset[Gjk][Gl];
-		  il = T2AA.row_offset[Gil][I];
+      lc = EABints.col_offset[Gjk][Gl];
+      il = T2AA.row_offset[Gil][I];
 
-		  nrows = T2AA.params->coltot[Gil];
-		  ncols = bvirtpi[Gc];
-		  nlinks = aoccpi[Gl];
+      nrows = T2AA.params->coltot[Gil];
+      ncols = bvirtpi[Gc];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2AA.matrix[Gil][il][0]), nrows,
-			    &(EABints.matrix[Gjk][jk][lc]), ncols, 1.0,
-			    &(WABc[Gab][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2AA.matrix[Gil][il][0]), nrows,
+		&(EABints.matrix[Gjk][jk][lc]), ncols, 1.0,
+		&(WABc[Gab][0][0]), ncols);
 
 
-		  /* +t_JLAB * E_IkLc */
-		  Gab = Gjl = Gj ^ Gl;
-		  Gc = Gik ^ Gl;
+      /* +t_JLAB * E_IkLc */
+      Gab = Gjl = Gj ^ Gl;
+      Gc = Gik ^ Gl;
 
-		  lc = EABints.col_offset[Gik][Gl];
-		  jl = T2AA.row_offset[Gjl][J];
+      lc = EABints.col_offset[Gik][Gl];
+      jl = T2AA.row_offset[Gjl][J];
 
-		  nrows = T2AA.params->coltot[Gjl];
-		  ncols = bvirtpi[Gc];
-		  nlinks = aoccpi[Gl];
+      nrows = T2AA.params->coltot[Gjl];
+      ncols = bvirtpi[Gc];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2AA.matrix[Gjl][jl][0]), nrows,
-			    &(EABints.matrix[Gik][ik][lc]), ncols, 1.0,
-			    &(WABc[Gab][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2AA.matrix[Gjl][jl][0]), nrows,
+		&(EABints.matrix[Gik][ik][lc]), ncols, 1.0,
+		&(WABc[Gab][0][0]), ncols);
+    }
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  WBcA[Gab] = global_dpd_->dpd_block_matrix(FABints.params->coltot[Gab], avirtpi[Gc]);
-		}
+      WBcA[Gab] = ijk_block_matrix(FABints.params->coltot[Gab], avirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		  /* -t_JkAd * F_IdBc */
-		  Gbc = Gid = Gi ^ Gd;
-		  Ga = Gjk ^ Gd;
+      /* -t_JkAd * F_IdBc */
+      Gbc = Gid = Gi ^ Gd;
+      Ga = Gjk ^ Gd;
 
-		  ad = T2AB.col_offset[Gjk][Ga];
-		  id = FABints.row_offset[Gid][I];
+      ad = T2AB.col_offset[Gjk][Ga];
+      id = FABints.row_offset[Gid][I];
 
-		  FABints.matrix[Gid] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      FABints.matrix[Gid] = ijk_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FABints.params->coltot[Gid];
-		  ncols = avirtpi[Ga];
-		  nlinks = bvirtpi[Gd];
+      nrows = FABints.params->coltot[Gid];
+      ncols = avirtpi[Ga];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
-			    &(FABints.matrix[Gid][0][0]), nrows,
-			    &(T2AB.matrix[Gjk][jk][ad]), nlinks, 1.0,
-			    &(WBcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
+		&(FABints.matrix[Gid][0][0]), nrows,
+		&(T2AB.matrix[Gjk][jk][ad]), nlinks, 1.0,
+		&(WBcA[Gbc][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
+      ijk_free_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
 
 
-		  /* +t_IkAd * F_JdBc */
-		  Gbc = Gjd = Gj ^ Gd;
-		  Ga = Gik ^ Gd;
+      /* +t_IkAd * F_JdBc */
+      Gbc = Gjd = Gj ^ Gd;
+      Ga = Gik ^ Gd;
 
-		  ad = T2AB.col_offset[Gik][Ga];
-		  jd = FABints.row_offset[Gjd][J];
+      ad = T2AB.col_offset[Gik][Ga];
+      jd = FABints.row_offset[Gjd][J];
 
-		  FABints.matrix[Gjd] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gjd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gjd, jd, bvirtpi[Gd]);
+      FABints.matrix[Gjd] = ijk_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gjd, jd, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FABints.params->coltot[Gjd];
-		  ncols = avirtpi[Ga];
-		  nlinks = bvirtpi[Gd];
+      nrows = FABints.params->coltot[Gjd];
+      ncols = avirtpi[Ga];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			    &(FABints.matrix[Gjd][0][0]), nrows,
-			    &(T2AB.matrix[Gik][ik][ad]), nlinks, 1.0,
-			    &(WBcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+		&(FABints.matrix[Gjd][0][0]), nrows,
+		&(T2AB.matrix[Gik][ik][ad]), nlinks, 1.0,
+		&(WBcA[Gbc][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FABints.matrix[Gjd], bvirtpi[Gd], FABints.params->coltot[Gjd]);
-		}
+      ijk_free_block(FABints.matrix[Gjd], bvirtpi[Gd], FABints.params->coltot[Gjd]);
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		  /* +t_IlBc * E_kJlA */
-		  Gbc = Gil = Gi ^ Gl;
-		  Ga = Gkj ^ Gl;
+      /* +t_IlBc * E_kJlA */
+      Gbc = Gil = Gi ^ Gl;
+      Ga = Gkj ^ Gl;
 
-		  la = EBAints.col_offset[Gkj][Gl];
-		  il = T2AB.row_offset[Gil][I];
+      la = EBAints.col_offset[Gkj][Gl];
+      il = T2AB.row_offset[Gil][I];
 
-		  nrows = T2AB.params->coltot[Gil];
-		  ncols = avirtpi[Ga];
-		  nlinks = boccpi[Gl];
+      nrows = T2AB.params->coltot[Gil];
+      ncols = avirtpi[Ga];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2AB.matrix[Gil][il][0]), nrows,
-			    &(EBAints.matrix[Gkj][kj][la]), ncols, 1.0,
-			    &(WBcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2AB.matrix[Gil][il][0]), nrows,
+		&(EBAints.matrix[Gkj][kj][la]), ncols, 1.0,
+		&(WBcA[Gbc][0][0]), ncols);
 
 
-		  /* -t_JlBc * E_kIlA */
-		  Gbc = Gjl = Gj ^ Gl;
-		  Ga = Gki ^ Gl;
+      /* -t_JlBc * E_kIlA */
+      Gbc = Gjl = Gj ^ Gl;
+      Ga = Gki ^ Gl;
 
-		  la = EBAints.col_offset[Gki][Gl];
-		  jl = T2AB.row_offset[Gjl][J];
+      la = EBAints.col_offset[Gki][Gl];
+      jl = T2AB.row_offset[Gjl][J];
 
-		  nrows = T2AB.params->coltot[Gjl];
-		  ncols = avirtpi[Ga];
-		  nlinks = boccpi[Gl];
+      nrows = T2AB.params->coltot[Gjl];
+      ncols = avirtpi[Ga];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2AB.matrix[Gjl][jl][0]), nrows,
-			    &(EBAints.matrix[Gki][ki][la]), ncols, 1.0,
-			    &(WBcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2AB.matrix[Gjl][jl][0]), nrows,
+		&(EBAints.matrix[Gki][ki][la]), ncols, 1.0,
+		&(WBcA[Gbc][0][0]), ncols);
 
-		}
+    }
 
-        global_dpd_->sort_3d(WBcA, WABc, nirreps, Gijk, FABints.params->coltot, FABints.params->colidx,
-		       FABints.params->colorb, FABints.params->rsym, FABints.params->ssym,
-		       avir_off, bvir_off, avirtpi, avir_off, FAAints.params->colidx, cab, 1);
+global_dpd_->sort_3d(WBcA, WABc, nirreps, Gijk, FABints.params->coltot, FABints.params->colidx,
+	   FABints.params->colorb, FABints.params->rsym, FABints.params->ssym,
+	   avir_off, bvir_off, avirtpi, avir_off, FAAints.params->colidx, cab, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WBcA[Gab], FABints.params->coltot[Gab], avirtpi[Gc]);
+      ijk_free_block(WBcA[Gab], FABints.params->coltot[Gab], avirtpi[Gc]);
 
-		  WAcB[Gab] = global_dpd_->dpd_block_matrix(FABints.params->coltot[Gab], avirtpi[Gc]);
-		}
+      WAcB[Gab] = ijk_block_matrix(FABints.params->coltot[Gab], avirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		  /* +t_JkBd * F_IdAc */
-		  Gac = Gid = Gi ^ Gd;
-		  Gb = Gjk ^ Gd;
+      /* +t_JkBd * F_IdAc */
+      Gac = Gid = Gi ^ Gd;
+      Gb = Gjk ^ Gd;
 
-		  bd = T2AB.col_offset[Gjk][Gb];
-		  id = FABints.row_offset[Gid][I];
+      bd = T2AB.col_offset[Gjk][Gb];
+      id = FABints.row_offset[Gid][I];
 
-		  FABints.matrix[Gid] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      FABints.matrix[Gid] = ijk_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FABints.params->coltot[Gid];
-		  ncols = avirtpi[Gb];
-		  nlinks = bvirtpi[Gd];
+      nrows = FABints.params->coltot[Gid];
+      ncols = avirtpi[Gb];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			    &(FABints.matrix[Gid][0][0]), nrows,
-			    &(T2AB.matrix[Gjk][jk][bd]), nlinks, 1.0,
-			    &(WAcB[Gac][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+		&(FABints.matrix[Gid][0][0]), nrows,
+		&(T2AB.matrix[Gjk][jk][bd]), nlinks, 1.0,
+		&(WAcB[Gac][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
+      ijk_free_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
 
 
-		  /* -t_IkBd * F_JdAc */
-		  Gac = Gjd = Gj ^ Gd;
-		  Gb = Gik ^ Gd;
+      /* -t_IkBd * F_JdAc */
+      Gac = Gjd = Gj ^ Gd;
+      Gb = Gik ^ Gd;
 
-		  bd = T2AB.col_offset[Gik][Gb];
-		  jd = FABints.row_offset[Gjd][J];
+      bd = T2AB.col_offset[Gik][Gb];
+      jd = FABints.row_offset[Gjd][J];
 
-		  FABints.matrix[Gjd] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gjd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gjd, jd, bvirtpi[Gd]);
+      FABints.matrix[Gjd] = ijk_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gjd, jd, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FABints.params->coltot[Gjd];
-		  ncols = avirtpi[Gb];
-		  nlinks = bvirtpi[Gd];
+      nrows = FABints.params->coltot[Gjd];
+      ncols = avirtpi[Gb];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
-			    &(FABints.matrix[Gjd][0][0]), nrows,
-			    &(T2AB.matrix[Gik][ik][bd]), nlinks, 1.0,
-			    &(WAcB[Gac][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
+		&(FABints.matrix[Gjd][0][0]), nrows,
+		&(T2AB.matrix[Gik][ik][bd]), nlinks, 1.0,
+		&(WAcB[Gac][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FABints.matrix[Gjd], bvirtpi[Gd], FABints.params->coltot[Gjd]);
+      ijk_free_block(FABints.matrix[Gjd], bvirtpi[Gd], FABints.params->coltot[Gjd]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		  /* -t_IlAc * E_kJlB */
-		  Gac = Gil = Gi ^ Gl;
-		  Gb = Gkj ^ Gl;
+      /* -t_IlAc * E_kJlB */
+      Gac = Gil = Gi ^ Gl;
+      Gb = Gkj ^ Gl;
 
-		  lb = EBAints.col_offset[Gkj][Gl];
-		  il = T2AB.row_offset[Gil][I];
+      lb = EBAints.col_offset[Gkj][Gl];
+      il = T2AB.row_offset[Gil][I];
 
-		  nrows = T2AB.params->coltot[Gil];
-		  ncols = avirtpi[Gb];
-		  nlinks = boccpi[Gl];
+      nrows = T2AB.params->coltot[Gil];
+      ncols = avirtpi[Gb];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2AB.matrix[Gil][il][0]), nrows,
-			    &(EBAints.matrix[Gkj][kj][lb]), ncols, 1.0,
-			    &(WAcB[Gac][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2AB.matrix[Gil][il][0]), nrows,
+		&(EBAints.matrix[Gkj][kj][lb]), ncols, 1.0,
+		&(WAcB[Gac][0][0]), ncols);
 
 
-		  /* +t_JlAc * E_kIlB */
-		  Gac = Gjl = Gj ^ Gl;
-		  Gb = Gki ^ Gl;
+      /* +t_JlAc * E_kIlB */
+      Gac = Gjl = Gj ^ Gl;
+      Gb = Gki ^ Gl;
 
-		  lb = EBAints.col_offset[Gki][Gl];
-		  jl = T2AB.row_offset[Gjl][J];
+      lb = EBAints.col_offset[Gki][Gl];
+      jl = T2AB.row_offset[Gjl][J];
 
-		  nrows = T2AB.params->coltot[Gjl];
-		  ncols = avirtpi[Gb];
-		  nlinks = boccpi[Gl];
+      nrows = T2AB.params->coltot[Gjl];
+      ncols = avirtpi[Gb];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2AB.matrix[Gjl][jl][0]), nrows,
-			    &(EBAints.matrix[Gki][ki][lb]), ncols, 1.0,
-			    &(WAcB[Gac][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2AB.matrix[Gjl][jl][0]), nrows,
+		&(EBAints.matrix[Gki][ki][lb]), ncols, 1.0,
+		&(WAcB[Gac][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WAcB, WABc, nirreps, Gijk, FABints.params->coltot, FABints.params->colidx,
-		       FABints.params->colorb, FABints.params->rsym, FABints.params->ssym,
-		       avir_off, bvir_off, avirtpi, avir_off, FAAints.params->colidx, acb, 1);
+global_dpd_->sort_3d(WAcB, WABc, nirreps, Gijk, FABints.params->coltot, FABints.params->colidx,
+	   FABints.params->colorb, FABints.params->rsym, FABints.params->ssym,
+	   avir_off, bvir_off, avirtpi, avir_off, FAAints.params->colidx, acb, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WAcB[Gab], FABints.params->coltot[Gab], avirtpi[Gc]);
+      ijk_free_block(WAcB[Gab], FABints.params->coltot[Gab], avirtpi[Gc]);
 
-		  WcBA[Gab] = global_dpd_->dpd_block_matrix(FBAints.params->coltot[Gab], avirtpi[Gc]);
-		}
+      WcBA[Gab] = ijk_block_matrix(FBAints.params->coltot[Gab], avirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		  /* -t_JIAD * F_kDcB */
-		  Gcb = Gkd = Gk ^ Gd;
-		  Ga = Gji ^ Gd;
+      /* -t_JIAD * F_kDcB */
+      Gcb = Gkd = Gk ^ Gd;
+      Ga = Gji ^ Gd;
 
-		  ad = T2AA.col_offset[Gji][Ga];
-		  kd = FBAints.row_offset[Gkd][K];
+      ad = T2AA.col_offset[Gji][Ga];
+      kd = FBAints.row_offset[Gkd][K];
 
-		  FBAints.matrix[Gkd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      FBAints.matrix[Gkd] = ijk_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FBAints.params->coltot[Gkd];
-		  ncols = avirtpi[Ga];
-		  nlinks = avirtpi[Gd];
+      nrows = FBAints.params->coltot[Gkd];
+      ncols = avirtpi[Ga];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
-			    &(FBAints.matrix[Gkd][0][0]), nrows,
-			    &(T2AA.matrix[Gji][ji][ad]), nlinks, 1.0,
-			    &(WcBA[Gcb][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
+		&(FBAints.matrix[Gkd][0][0]), nrows,
+		&(T2AA.matrix[Gji][ji][ad]), nlinks, 1.0,
+		&(WcBA[Gcb][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
-		}
+      ijk_free_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		  /* -t_kLcB * E_JILA */
-		  Gcb = Gkl = Gk ^ Gl;
-		  Ga = Gji ^ Gl;
+      /* -t_kLcB * E_JILA */
+      Gcb = Gkl = Gk ^ Gl;
+      Ga = Gji ^ Gl;
 
-		  la = EAAints.col_offset[Gji][Gl];
-		  kl = T2BA.row_offset[Gkl][K];
+      la = EAAints.col_offset[Gji][Gl];
+      kl = T2BA.row_offset[Gkl][K];
 
-		  nrows = T2BA.params->coltot[Gkl];
-		  ncols = avirtpi[Ga];
-		  nlinks = aoccpi[Gl];
+      nrows = T2BA.params->coltot[Gkl];
+      ncols = avirtpi[Ga];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2BA.matrix[Gkl][kl][0]), nrows,
-			    &(EAAints.matrix[Gji][ji][la]), ncols, 1.0,
-			    &(WcBA[Gcb][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2BA.matrix[Gkl][kl][0]), nrows,
+		&(EAAints.matrix[Gji][ji][la]), ncols, 1.0,
+		&(WcBA[Gcb][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WcBA, WABc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
-		       FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
-		       bvir_off, avir_off, avirtpi, avir_off, FAAints.params->colidx, cba, 1);
+global_dpd_->sort_3d(WcBA, WABc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
+	   FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
+	   bvir_off, avir_off, avirtpi, avir_off, FAAints.params->colidx, cba, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WcBA[Gab], FBAints.params->coltot[Gab], avirtpi[Gc]);
+      ijk_free_block(WcBA[Gab], FBAints.params->coltot[Gab], avirtpi[Gc]);
 
-		  WcAB[Gab] = global_dpd_->dpd_block_matrix(FBAints.params->coltot[Gab], avirtpi[Gc]);
-		}
+      WcAB[Gab] = ijk_block_matrix(FBAints.params->coltot[Gab], avirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		  /* +t_JIBD * F_kDcA */
-		  Gca = Gkd = Gk ^ Gd;
-		  Gb = Gji ^ Gd;
+      /* +t_JIBD * F_kDcA */
+      Gca = Gkd = Gk ^ Gd;
+      Gb = Gji ^ Gd;
 
-		  bd = T2AA.col_offset[Gji][Gb];
-		  kd = FBAints.row_offset[Gkd][K];
+      bd = T2AA.col_offset[Gji][Gb];
+      kd = FBAints.row_offset[Gkd][K];
 
-		  FBAints.matrix[Gkd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      FBAints.matrix[Gkd] = ijk_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
- 		  nrows = FBAints.params->coltot[Gkd];
-		  ncols = avirtpi[Gb];
-		  nlinks = avirtpi[Gd];
+      nrows = FBAints.params->coltot[Gkd];
+      ncols = avirtpi[Gb];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			    &(FBAints.matrix[Gkd][0][0]), nrows,
-			    &(T2AA.matrix[Gji][ji][bd]), nlinks, 1.0,
-			    &(WcAB[Gca][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+		&(FBAints.matrix[Gkd][0][0]), nrows,
+		&(T2AA.matrix[Gji][ji][bd]), nlinks, 1.0,
+		&(WcAB[Gca][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
-		}
+      ijk_free_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		  /* t_kLcA * E_JILB */
-		  Gca = Gkl = Gk ^ Gl;
-		  Gb = Gji ^ Gl;
+      /* t_kLcA * E_JILB */
+      Gca = Gkl = Gk ^ Gl;
+      Gb = Gji ^ Gl;
 
-		  lb = EAAints.col_offset[Gji][Gl];
-		  kl = T2BA.row_offset[Gkl][K];
+      lb = EAAints.col_offset[Gji][Gl];
+      kl = T2BA.row_offset[Gkl][K];
 
-		  nrows = T2BA.params->coltot[Gkl];
-		  ncols = avirtpi[Gb];
-		  nlinks = aoccpi[Gl];
+      nrows = T2BA.params->coltot[Gkl];
+      ncols = avirtpi[Gb];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2BA.matrix[Gkl][kl][0]), nrows,
-			    &(EAAints.matrix[Gji][ji][lb]), ncols, 1.0,
-			    &(WcAB[Gca][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2BA.matrix[Gkl][kl][0]), nrows,
+		&(EAAints.matrix[Gji][ji][lb]), ncols, 1.0,
+		&(WcAB[Gca][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WcAB, WABc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
-		       FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
-		       bvir_off, avir_off, avirtpi, avir_off, FAAints.params->colidx, bca, 1);
+global_dpd_->sort_3d(WcAB, WABc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
+	   FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
+	   bvir_off, avir_off, avirtpi, avir_off, FAAints.params->colidx, bca, 1);
 
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WcAB[Gab], FBAints.params->coltot[Gab], avirtpi[Gc]);
+      ijk_free_block(WcAB[Gab], FBAints.params->coltot[Gab], avirtpi[Gc]);
 
-		  VABc[Gab] = global_dpd_->dpd_block_matrix(FAAints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      VABc[Gab] = ijk_block_matrix(FAAints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		/* Add disconnected triples and finish W and V arrays */
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    /* Add disconnected triples and finish W and V arrays */
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  for(ab=0; ab < FAAints.params->coltot[Gab]; ab++) {
-		    A = FAAints.params->colorb[Gab][ab][0];
-		    Ga = FAAints.params->rsym[A];
-		    a = A - avir_off[Ga];
-		    B = FAAints.params->colorb[Gab][ab][1];
-		    Gb = FAAints.params->ssym[B];
-		    b = B - avir_off[Gb];
+      for(ab=0; ab < FAAints.params->coltot[Gab]; ab++) {
+	A = FAAints.params->colorb[Gab][ab][0];
+	Ga = FAAints.params->rsym[A];
+	a = A - avir_off[Ga];
+	B = FAAints.params->colorb[Gab][ab][1];
+	Gb = FAAints.params->ssym[B];
+	b = B - avir_off[Gb];
 
-		    Gbc = Gb ^ Gc;
-		    Gac = Ga ^ Gc;
+	Gbc = Gb ^ Gc;
+	Gac = Ga ^ Gc;
 
-		    for(c=0; c < bvirtpi[Gc]; c++) {
-		      C = bvir_off[Gc] + c;
+	for(c=0; c < bvirtpi[Gc]; c++) {
+	  C = bvir_off[Gc] + c;
 
-		      bc = DABints.params->colidx[B][C];
-		      ac = DABints.params->colidx[A][C];
+	  bc = DABints.params->colidx[B][C];
+	  ac = DABints.params->colidx[A][C];
 
-		      /* +t_IA * D_JkBc + f_IA * t_JkBc */
-		      if(Gi == Ga && Gjk == Gbc) {
-			t_ia = D_jkbc = f_ia = t_jkbc = 0.0;
+	  /* +t_IA * D_JkBc + f_IA * t_JkBc */
+	  if(Gi == Ga && Gjk == Gbc) {
+	    t_ia = D_jkbc = f_ia = t_jkbc = 0.0;
 
-			if(T1A.params->rowtot[Gi] && T1A.params->coltot[Gi]) {
-			  t_ia = T1A.matrix[Gi][i][a];
-			  f_ia = fIA.matrix[Gi][i][a];
-			}
+	    if(T1A.params->rowtot[Gi] && T1A.params->coltot[Gi]) {
+	      t_ia = T1A.matrix[Gi][i][a];
+	      f_ia = fIA.matrix[Gi][i][a];
+	    }
 
-			if(DABints.params->rowtot[Gjk] && DABints.params->coltot[Gjk]) {
-			  D_jkbc = DABints.matrix[Gjk][jk][bc];
-			  t_jkbc = T2AB.matrix[Gjk][jk][bc];
-			}
+	    if(DABints.params->rowtot[Gjk] && DABints.params->coltot[Gjk]) {
+	      D_jkbc = DABints.matrix[Gjk][jk][bc];
+	      t_jkbc = T2AB.matrix[Gjk][jk][bc];
+	    }
 
-			VABc[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
-		      }
+	    VABc[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
+	  }
 
-		      /* -t_IB * D_JkAc - f_IB * t_JkAc */
-		      if(Gi == Gb && Gjk == Gac) {
-			t_ib = D_jkac = f_ib = t_jkac = 0.0;
+	  /* -t_IB * D_JkAc - f_IB * t_JkAc */
+	  if(Gi == Gb && Gjk == Gac) {
+	    t_ib = D_jkac = f_ib = t_jkac = 0.0;
 
-			if(T1A.params->rowtot[Gi] && T1A.params->coltot[Gi]) {
-			  t_ib = T1A.matrix[Gi][i][b];
-			  f_ib = fIA.matrix[Gi][i][b];
-			}
+	    if(T1A.params->rowtot[Gi] && T1A.params->coltot[Gi]) {
+	      t_ib = T1A.matrix[Gi][i][b];
+	      f_ib = fIA.matrix[Gi][i][b];
+	    }
 
-			if(DABints.params->rowtot[Gjk] && DABints.params->coltot[Gjk]) {
-			  D_jkac = DABints.matrix[Gjk][jk][ac];
-			  t_jkac = T2AB.matrix[Gjk][jk][ac];
-			}
+	    if(DABints.params->rowtot[Gjk] && DABints.params->coltot[Gjk]) {
+	      D_jkac = DABints.matrix[Gjk][jk][ac];
+	      t_jkac = T2AB.matrix[Gjk][jk][ac];
+	    }
 
-			VABc[Gab][ab][c] -= t_ib * D_jkac + f_ib * t_jkac;
-		      }
-
-		      /* -t_JA * D_IkBc - f_JA * t_IkBc */
-		      if(Gj == Ga && Gik == Gbc) {
-			t_ja = D_ikbc = f_ja = t_ikbc = 0.0;
-
-			if(T1A.params->rowtot[Gj] && T1A.params->coltot[Gj]) {
-			  t_ja = T1A.matrix[Gj][j][a];
-			  f_ja = fIA.matrix[Gj][j][a];
-			}
+	    VABc[Gab][ab][c] -= t_ib * D_jkac + f_ib * t_jkac;
+	  }
 
-			if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
-			  D_ikbc = DABints.matrix[Gik][ik][bc];
-			  t_ikbc = T2AB.matrix[Gik][ik][bc];
-			}
+	  /* -t_JA * D_IkBc - f_JA * t_IkBc */
+	  if(Gj == Ga && Gik == Gbc) {
+	    t_ja = D_ikbc = f_ja = t_ikbc = 0.0;
 
-			VABc[Gab][ab][c] -= t_ja * D_ikbc + f_ja * t_ikbc;
-		      }
+	    if(T1A.params->rowtot[Gj] && T1A.params->coltot[Gj]) {
+	      t_ja = T1A.matrix[Gj][j][a];
+	      f_ja = fIA.matrix[Gj][j][a];
+	    }
 
-		      /* +t_JB * D_IkAc + f_JB * t_IkAc */
-		      if(Gj == Gb && Gik == Gac) {
-			t_jb = D_ikac = f_jb = t_ikac = 0.0;
+	    if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
+	      D_ikbc = DABints.matrix[Gik][ik][bc];
+	      t_ikbc = T2AB.matrix[Gik][ik][bc];
+	    }
 
-			if(T1A.params->rowtot[Gj] && T1A.params->coltot[Gj]) {
-			  t_jb = T1A.matrix[Gj][j][b];
-			  f_jb = fIA.matrix[Gj][j][b];
-			}
-
-			if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
-			  D_ikac = DABints.matrix[Gik][ik][ac];
-			  t_ikac = T2AB.matrix[Gik][ik][ac];
-			}
+	    VABc[Gab][ab][c] -= t_ja * D_ikbc + f_ja * t_ikbc;
+	  }
 
-			VABc[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
-		      }
+	  /* +t_JB * D_IkAc + f_JB * t_IkAc */
+	  if(Gj == Gb && Gik == Gac) {
+	    t_jb = D_ikac = f_jb = t_ikac = 0.0;
 
-		      /* -t_kc * D_JIAB - f_kc * t_JIAB */
-		      if(Gk == Gc && Gji == Gab) {
-			t_kc = D_jiab = f_kc = t_jiab = 0.0;
-
-			if(T1B.params->rowtot[Gk] && T1B.params->coltot[Gk]) {
-			  t_kc = T1B.matrix[Gk][k][c];
-			  f_kc = fia.matrix[Gk][k][c];
-			}
-
-			if(DAAints.params->rowtot[Gji] && DAAints.params->coltot[Gji]) {
-			  D_jiab = DAAints.matrix[Gji][ji][ab];
-			  t_jiab = T2AA.matrix[Gji][ji][ab];
-			}
-
-			VABc[Gab][ab][c] -= t_kc * D_jiab + f_kc * t_jiab;
-		      }
-
-		      /* Sum V and W into V */
-		      VABc[Gab][ab][c] += WABc[Gab][ab][c];
-
-		      /* Build the rest of the denominator and divide it into W */
-		      denom = dijk;
-		      if(fAB.params->rowtot[Ga])
-			denom -= fAB.matrix[Ga][a][a];
-		      if(fAB.params->rowtot[Gb])
-			denom -= fAB.matrix[Gb][b][b];
-		      if(fab.params->rowtot[Gc])
-			denom -= fab.matrix[Gc][c][c];
-
-		      WABc[Gab][ab][c] /= denom;
-
-		    } /* c */
-		  } /* ab */
-		} /* Gab */
-
-		/* 1/2 Dot product of final V and W is the energy for this ijk triple */
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
-		  ET_AAB += dot_block(WABc[Gab], VABc[Gab], FAAints.params->coltot[Gab], bvirtpi[Gc], 0.5);
-		}
-
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
-		  global_dpd_->free_dpd_block(WABc[Gab], FAAints.params->coltot[Gab], bvirtpi[Gc]);
-		  global_dpd_->free_dpd_block(VABc[Gab], FAAints.params->coltot[Gab], bvirtpi[Gc]);
-		}
-
-	      } /* I >= J */
-
-	    } /* k */
-	  } /* j */
-	} /* i */
-
-      } /* Gk */
-    } /* Gj */
-  } /* Gi */
+	    if(T1A.params->rowtot[Gj] && T1A.params->coltot[Gj]) {
+	      t_jb = T1A.matrix[Gj][j][b];
+	      f_jb = fIA.matrix[Gj][j][b];
+	    }
 
-  /*  fprintf(outfile, "cnt = %d\n", cnt); */
-  /*  fprintf(outfile, "ET_AAB = %20.14f\n", ET_AAB); */
+	    if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
+	      D_ikac = DABints.matrix[Gik][ik][ac];
+	      t_ikac = T2AB.matrix[Gik][ik][ac];
+	    }
+
+	    VABc[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
+	  }
+
+	  /* -t_kc * D_JIAB - f_kc * t_JIAB */
+	  if(Gk == Gc && Gji == Gab) {
+	    t_kc = D_jiab = f_kc = t_jiab = 0.0;
+
+	    if(T1B.params->rowtot[Gk] && T1B.params->coltot[Gk]) {
+	      t_kc = T1B.matrix[Gk][k][c];
+	      f_kc = fia.matrix[Gk][k][c];
+	    }
+
+	    if(DAAints.params->rowtot[Gji] && DAAints.params->coltot[Gji]) {
+	      D_jiab = DAAints.matrix[Gji][ji][ab];
+	      t_jiab = T2AA.matrix[Gji][ji][ab];
+	    }
+
+	    VABc[Gab][ab][c] -= t_kc * D_jiab + f_kc * t_jiab;
+	  }
+
+	  /* Sum V and W into V */
+	  VABc[Gab][ab][c] += WABc[Gab][ab][c];
+
+	  /* Build the rest of the denominator and divide it into W */
+	  denom = dijk;
+	  if(fAB.params->rowtot[Ga])
+	    denom -= fAB.matrix[Ga][a][a];
+	  if(fAB.params->rowtot[Gb])
+	    denom -= fAB.matrix[Gb][b][b];
+	  if(fab.params->rowtot[Gc])
+	    denom -= fab.matrix[Gc][c][c];
+
+	  WABc[Gab][ab][c] /= denom;
+
+	} /* c */
+      } /* ab */
+    } /* Gab */
+
+    /* 1/2 Dot product of final V and W is the energy for this ijk triple */
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+      ET_AAB += dot_block(WABc[Gab], VABc[Gab], FAAints.params->coltot[Gab], bvirtpi[Gc], 0.5);
+    }
+
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+      ijk_free_block(WABc[Gab], FAAints.params->coltot[Gab], bvirtpi[Gc]);
+      ijk_free_block(VABc[Gab], FAAints.params->coltot[Gab], bvirtpi[Gc]);
+    }
+
+  } /* ijk */
+
+  data->ET = ET_AAB;
 
   free(WABc);
   free(WBcA);
@@ -784,50 +902,7 @@ double ET_UHF_AAB(void)
   free(WcBA);
   free(VABc);
 
-  fclose(ijkfile);
-
-  for(h=0; h < nirreps; h++) {
-    global_dpd_->buf4_mat_irrep_close(&T2AA, h);
-    global_dpd_->buf4_mat_irrep_close(&T2AB, h);
-    global_dpd_->buf4_mat_irrep_close(&T2BA, h);
-    global_dpd_->buf4_mat_irrep_close(&EAAints, h);
-    global_dpd_->buf4_mat_irrep_close(&EABints, h);
-    global_dpd_->buf4_mat_irrep_close(&EBAints, h);
-    global_dpd_->buf4_mat_irrep_close(&DAAints, h);
-    global_dpd_->buf4_mat_irrep_close(&DABints, h);
-  }
-
-  global_dpd_->buf4_close(&T2AA);
-  global_dpd_->buf4_close(&T2AB);
-  global_dpd_->buf4_close(&T2BA);
-  global_dpd_->buf4_close(&FAAints);
-  global_dpd_->buf4_close(&FABints);
-  global_dpd_->buf4_close(&FBAints);
-  global_dpd_->buf4_close(&EAAints);
-  global_dpd_->buf4_close(&EABints);
-  global_dpd_->buf4_close(&EBAints);
-  global_dpd_->buf4_close(&DAAints);
-  global_dpd_->buf4_close(&DABints);
-
-  global_dpd_->file2_mat_close(&T1A);
-  global_dpd_->file2_close(&T1A);
-  global_dpd_->file2_mat_close(&T1B);
-  global_dpd_->file2_close(&T1B);
-
-  global_dpd_->file2_mat_close(&fIJ);
-  global_dpd_->file2_mat_close(&fij);
-  global_dpd_->file2_mat_close(&fAB);
-  global_dpd_->file2_mat_close(&fab);
-  global_dpd_->file2_mat_close(&fIA);
-  global_dpd_->file2_mat_close(&fia);
-  global_dpd_->file2_close(&fIJ);
-  global_dpd_->file2_close(&fij);
-  global_dpd_->file2_close(&fAB);
-  global_dpd_->file2_close(&fab);
-  global_dpd_->file2_close(&fIA);
-  global_dpd_->file2_close(&fia);
-
-  return ET_AAB;
+  pthread_exit(NULL);
 }
 
 }} // namespace psi::CCTRIPLES
@@ -29,56 +29,45 @@
 #include <cmath>
 #include <libdpd/dpd.h>
 #include <libqt/qt.h>
+#include <pthread.h>
 #include "MOInfo.h"
 #include "Params.h"
+#include "ijk_tasks.h"
 #define EXTERN
 #include "globals.h"
 
 namespace psi { namespace cctriples {
 
+struct ET_UHF_ABB_data {
+  dpdfile2 *T1A; dpdfile2 *T1B; dpdfile2 *fIJ; dpdfile2 *fij;
+  dpdfile2 *fAB; dpdfile2 *fab; dpdfile2 *fIA; dpdfile2 *fia;
+  dpdbuf4 *T2AB; dpdbuf4 *T2BB; dpdbuf4 *T2BA; dpdbuf4 *EBBints;
+  dpdbuf4 *EABints; dpdbuf4 *EBAints; dpdbuf4 *DBBints; dpdbuf4 *DABints;
+  dpdbuf4 FBBints, FABints, FBAints;
+  IJKQueue *queue; double ET;
+};
+
+void *ET_UHF_ABB_thread(void *thread_data);
+
 double ET_UHF_ABB(void)
 {
-  int cnt;
   int h, nirreps;
-  int Gi, Gj, Gk, Ga, Gb, Gc, Gd, Gl;
-  int Gji, Gij, Gjk, Gkj, Gik, Gki, Gijk;
-  int Gab, Gbc, Gac, Gca, Gba;
-  int Gid, Gjd, Gkd;
-  int Gil, Gjl, Gkl;
-  int I, J, K, A, B, C;
-  int i, j, k, a, b, c;
-  int ij, ji, ik, ki, jk, kj;
-  int ab, ba, ac, ca, bc, cb;
-  int cd, bd, ad, db, dc;
-  int lc, lb, la;
-  int id, jd, kd;
-  int il, jl, kl;
-  int *aoccpi, *avirtpi, *aocc_off, *avir_off;
-  int *boccpi, *bvirtpi, *bocc_off, *bvir_off;
-  double value_c, value_d, dijk, denom, ET_ABB;
-  int nrows, ncols, nlinks;
-  double t_ia, t_jb, t_jc, t_kb, t_kc;
-  double f_ia, f_jb, f_jc, f_kb, f_kc;
-  double D_jkbc, D_ikac, D_ikab, D_ijac, D_ijab;
-  double t_jkbc, t_ikac, t_ikab, t_ijac, t_ijab;
+  int nthreads, thread;
+  int *aoccpi, *aocc_off;
+  int *boccpi, *bocc_off;
+  double ET_ABB;
   dpdbuf4 T2AB, T2BB, T2BA;
-  dpdbuf4 FBBints, FABints, FBAints;
   dpdbuf4 EBBints, EABints, EBAints;
   dpdbuf4 DBBints, DABints;
   dpdfile2 T1A, T1B, fIJ, fij, fAB, fab, fIA, fia;
-  double ***WAbc, ***VAbc, ***WAcb, ***WbAc, ***WcAb, ***WbcA;
-  int nijk, mijk;
   FILE *ijkfile;
+  struct ET_UHF_ABB_data *thread_data_array;
 
   nirreps = moinfo.nirreps;
   aoccpi = moinfo.aoccpi; 
-  avirtpi = moinfo.avirtpi;
   aocc_off = moinfo.aocc_off;
-  avir_off = moinfo.avir_off;
   boccpi = moinfo.boccpi; 
-  bvirtpi = moinfo.bvirtpi;
   bocc_off = moinfo.bocc_off;
-  bvir_off = moinfo.bvir_off;
 
   global_dpd_->file2_init(&fIJ, PSIF_CC_OEI, 0, 0, 0, "fIJ");
   global_dpd_->file2_init(&fij, PSIF_CC_OEI, 0, 2, 2, "fij");
@@ -110,9 +99,6 @@ double ET_UHF_ABB(void)
   global_dpd_->buf4_init(&T2AB, PSIF_CC_TAMPS, 0, 22, 28, 22, 28, 0, "tIjAb");
   global_dpd_->buf4_init(&T2BA, PSIF_CC_TAMPS, 0, 23, 29, 23, 29, 0, "tiJaB");
 
-  global_dpd_->buf4_init(&FBBints, PSIF_CC_FINTS, 0, 30, 15, 30, 15, 1, "F <ia|bc>");
-  global_dpd_->buf4_init(&FABints, PSIF_CC_FINTS, 0, 24, 28, 24, 28, 0, "F <Ia|Bc>");
-  global_dpd_->buf4_init(&FBAints, PSIF_CC_FINTS, 0, 27, 29, 27, 29, 0, "F <iA|bC>");
 
   global_dpd_->buf4_init(&EBBints, PSIF_CC_EINTS, 0, 10, 30, 12, 30, 0, "E <ij||ka> (i>j,ka)");
   global_dpd_->buf4_init(&EABints, PSIF_CC_EINTS, 0, 22, 24, 22, 24, 0, "E <Ij|Ka>");
@@ -147,31 +133,158 @@ double ET_UHF_ABB(void)
     global_dpd_->buf4_mat_irrep_rd(&DABints, h);
   }
 
-  /* Compute the number of IJK combinations in this spin case */
-  nijk = 0;
-  for(Gi=0; Gi < nirreps; Gi++)
-    for(Gj=0; Gj < nirreps; Gj++)
-      for(Gk=0; Gk < nirreps; Gk++)
-	for(i=0; i < aoccpi[Gi]; i++) {
-	  I = aocc_off[Gi] + i;
-	  for(j=0; j < boccpi[Gj]; j++) {
-	    J = bocc_off[Gj] + j;
-	    for(k=0; k < boccpi[Gk]; k++) {
-	      K = bocc_off[Gk] + k;
-
-	      if(J > K) nijk++;
-	    }
-	  }
-	}
+  /* All IJK combinations of all irrep triples go into one queue, which
+     the threads draw from until it is empty */
+  IJKQueue queue(nirreps, aoccpi, aocc_off, boccpi, bocc_off, boccpi, bocc_off, IJK_JK_GT);
 
   ffile(&ijkfile,"ijk.dat",0);
   fprintf(ijkfile, "Spin Case: ABB\n");
-  fprintf(ijkfile, "Number of IJK combintions: %d\n", nijk);
+  fprintf(ijkfile, "Number of IJK combintions: %d\n", queue.size());
   fprintf(ijkfile, "\nCurrent IJK Combination:\n");
   fflush(ijkfile);
+  queue.set_progress(ijkfile);
+
+  /* each thread gets its own F buffers to read blocks into and its own
+     W and V intermediates - all else shared */
+  nthreads = params.nthreads;
+  thread_data_array = (struct ET_UHF_ABB_data *) malloc(nthreads*sizeof(struct ET_UHF_ABB_data));
+  for(thread=0; thread < nthreads; thread++) {
+    thread_data_array[thread].T1A = &T1A;
+    thread_data_array[thread].T1B = &T1B;
+    thread_data_array[thread].fIJ = &fIJ;
+    thread_data_array[thread].fij = &fij;
+    thread_data_array[thread].fAB = &fAB;
+    thread_data_array[thread].fab = &fab;
+    thread_data_array[thread].fIA = &fIA;
+    thread_data_array[thread].fia = &fia;
+    thread_data_array[thread].T2AB = &T2AB;
+    thread_data_array[thread].T2BB = &T2BB;
+    thread_data_array[thread].T2BA = &T2BA;
+    thread_data_array[thread].EBBints = &EBBints;
+    thread_data_array[thread].EABints = &EABints;
+    thread_data_array[thread].EBAints = &EBAints;
+    thread_data_array[thread].DBBints = &DBBints;
+    thread_data_array[thread].DABints = &DABints;
+    global_dpd_->buf4_init(&(thread_data_array[thread].FBBints), PSIF_CC_FINTS, 0, 30, 15, 30, 15, 1, "F <ia|bc>");
+    global_dpd_->buf4_init(&(thread_data_array[thread].FABints), PSIF_CC_FINTS, 0, 24, 28, 24, 28, 0, "F <Ia|Bc>");
+    global_dpd_->buf4_init(&(thread_data_array[thread].FBAints), PSIF_CC_FINTS, 0, 27, 29, 27, 29, 0, "F <iA|bC>");
+    thread_data_array[thread].queue = &queue;
+    thread_data_array[thread].ET = 0.0;
+  }
+
+  ijk_threads(nthreads, ET_UHF_ABB_thread, thread_data_array, sizeof(struct ET_UHF_ABB_data));
 
-  mijk = 0;
   ET_ABB = 0.0;
+  for(thread=0; thread < nthreads; thread++) {
+    ET_ABB += thread_data_array[thread].ET;
+    global_dpd_->buf4_close(&(thread_data_array[thread].FBBints));
+    global_dpd_->buf4_close(&(thread_data_array[thread].FABints));
+    global_dpd_->buf4_close(&(thread_data_array[thread].FBAints));
+  }
+
+  free(thread_data_array);
+
+  fclose(ijkfile);
+
+  for(h=0; h < nirreps; h++) {
+    global_dpd_->buf4_mat_irrep_close(&T2BB, h);
+    global_dpd_->buf4_mat_irrep_close(&T2AB, h);
+    global_dpd_->buf4_mat_irrep_close(&T2BA, h);
+    global_dpd_->buf4_mat_irrep_close(&EBBints, h);
+    global_dpd_->buf4_mat_irrep_close(&EABints, h);
+    global_dpd_->buf4_mat_irrep_close(&EBAints, h);
+    global_dpd_->buf4_mat_irrep_close(&DBBints, h);
+    global_dpd_->buf4_mat_irrep_close(&DABints, h);
+  }
+
+  global_dpd_->buf4_close(&T2BB);
+  global_dpd_->buf4_close(&T2AB);
+  global_dpd_->buf4_close(&T2BA);
+  global_dpd_->buf4_close(&EBBints);
+  global_dpd_->buf4_close(&EABints);
+  global_dpd_->buf4_close(&EBAints);
+  global_dpd_->buf4_close(&DBBints);
+  global_dpd_->buf4_close(&DABints);
+
+  global_dpd_->file2_mat_close(&T1A);
+  global_dpd_->file2_close(&T1A);
+  global_dpd_->file2_mat_close(&T1B);
+  global_dpd_->file2_close(&T1B);
+
+  global_dpd_->file2_mat_close(&fIJ);
+  global_dpd_->file2_mat_close(&fij);
+  global_dpd_->file2_mat_close(&fAB);
+  global_dpd_->file2_mat_close(&fab);
+  global_dpd_->file2_mat_close(&fIA);
+  global_dpd_->file2_mat_close(&fia);
+  global_dpd_->file2_close(&fIJ);
+  global_dpd_->file2_close(&fij);
+  global_dpd_->file2_close(&fAB);
+  global_dpd_->file2_close(&fab);
+  global_dpd_->file2_close(&fIA);
+  global_dpd_->file2_close(&fia);
+
+  return ET_ABB;
+}
+
+void *ET_UHF_ABB_thread(void *thread_data_in)
+{
+  int nirreps;
+  int Gi, Gj, Gk, Ga, Gb, Gc, Gd, Gl;
+  int Gji, Gij, Gjk, Gkj, Gik, Gki, Gijk;
+  int Gab, Gbc, Gac, Gca, Gba;
+  int Gid, Gjd, Gkd;
+  int Gil, Gjl, Gkl;
+  int I, J, K, A, B, C;
+  int i, j, k, a, b, c;
+  int ij, ji, ik, ki, jk, kj;
+  int ab, ba, ac, ca, bc, cb;
+  int cd, bd, ad, db, dc;
+  int lc, lb, la;
+  int id, jd, kd;
+  int il, jl, kl;
+  int *aoccpi, *avirtpi, *aocc_off, *avir_off;
+  int *boccpi, *bvirtpi, *bocc_off, *bvir_off;
+  double value_c, value_d, dijk, denom, ET_ABB;
+  int nrows, ncols, nlinks;
+  double t_ia, t_jb, t_jc, t_kb, t_kc;
+  double f_ia, f_jb, f_jc, f_kb, f_kc;
+  double D_jkbc, D_ikac, D_ikab, D_ijac, D_ijab;
+  double t_jkbc, t_ikac, t_ikab, t_ijac, t_ijab;
+  double ***WAbc, ***VAbc, ***WAcb, ***WbAc, ***WcAb, ***WbcA;
+  struct ET_UHF_ABB_data *data;
+  IJKTask task;
+
+  data = (struct ET_UHF_ABB_data *) thread_data_in;
+  dpdfile2 &T1A = *(data->T1A);
+  dpdfile2 &T1B = *(data->T1B);
+  dpdfile2 &fIJ = *(data->fIJ);
+  dpdfile2 &fij = *(data->fij);
+  dpdfile2 &fAB = *(data->fAB);
+  dpdfile2 &fab = *(data->fab);
+  dpdfile2 &fIA = *(data->fIA);
+  dpdfile2 &fia = *(data->fia);
+  dpdbuf4 &T2AB = *(data->T2AB);
+  dpdbuf4 &T2BB = *(data->T2BB);
+  dpdbuf4 &T2BA = *(data->T2BA);
+  dpdbuf4 &EBBints = *(data->EBBints);
+  dpdbuf4 &EABints = *(data->EABints);
+  dpdbuf4 &EBAints = *(data->EBAints);
+  dpdbuf4 &DBBints = *(data->DBBints);
+  dpdbuf4 &DABints = *(data->DABints);
+  dpdbuf4 &FBBints = data->FBBints;
+  dpdbuf4 &FABints = data->FABints;
+  dpdbuf4 &FBAints = data->FBAints;
+
+  nirreps = moinfo.nirreps;
+  aoccpi = moinfo.aoccpi; 
+  avirtpi = moinfo.avirtpi;
+  aocc_off = moinfo.aocc_off;
+  avir_off = moinfo.avir_off;
+  boccpi = moinfo.boccpi; 
+  bvirtpi = moinfo.bvirtpi;
+  bocc_off = moinfo.bocc_off;
+  bvir_off = moinfo.bvir_off;
 
   WAbc = (double ***) malloc(nirreps * sizeof(double **));
   VAbc = (double ***) malloc(nirreps * sizeof(double **));
@@ -180,636 +293,597 @@ double ET_UHF_ABB(void)
   WcAb = (double ***) malloc(nirreps * sizeof(double **));
   WbAc = (double ***) malloc(nirreps * sizeof(double **));
 
-  for(Gi=0; Gi < nirreps; Gi++) {
-    for(Gj=0; Gj < nirreps; Gj++) {
-      for(Gk=0; Gk < nirreps; Gk++) {
+  ET_ABB = 0.0;
 
-	Gij = Gji = Gi ^ Gj;
-	Gjk = Gkj = Gj ^ Gk;
-	Gik = Gki = Gi ^ Gk;
+  while(data->queue->next(task)) {
 
-	Gijk = Gi ^ Gj ^ Gk;
+    Gi = task.Gi; Gj = task.Gj; Gk = task.Gk;
+    i = task.i; j = task.j; k = task.k;
 
-	for(i=0; i < aoccpi[Gi]; i++) {
-	  I = aocc_off[Gi] + i;
-	  for(j=0; j < boccpi[Gj]; j++) {
-	    J = bocc_off[Gj] + j;
-	    for(k=0; k < boccpi[Gk]; k++) {
-	      K = bocc_off[Gk] + k;
+    I = aocc_off[Gi] + i;
+    J = bocc_off[Gj] + j;
+    K = bocc_off[Gk] + k;
 
-	      if(J > K) {
+    Gij = Gji = Gi ^ Gj;
+    Gjk = Gkj = Gj ^ Gk;
+    Gik = Gki = Gi ^ Gk;
 
-		mijk++;
-		fprintf(ijkfile, "%d\n", mijk);
-		fflush(ijkfile);
+    Gijk = Gi ^ Gj ^ Gk;
 
-		ij = EABints.params->rowidx[I][J];
-		ji = EBAints.params->rowidx[J][I];
-		jk = EBBints.params->rowidx[J][K];
-		kj = EBBints.params->rowidx[K][J];
-		ik = EABints.params->rowidx[I][K];
-		ki = EBAints.params->rowidx[K][I];
+    ij = EABints.params->rowidx[I][J];
+    ji = EBAints.params->rowidx[J][I];
+    jk = EBBints.params->rowidx[J][K];
+    kj = EBBints.params->rowidx[K][J];
+    ik = EABints.params->rowidx[I][K];
+    ki = EBAints.params->rowidx[K][I];
 
-		dijk = 0.0;
-		if(fIJ.params->rowtot[Gi])
-		  dijk += fIJ.matrix[Gi][i][i];
-		if(fij.params->rowtot[Gj])
-		  dijk += fij.matrix[Gj][j][j];
-		if(fij.params->rowtot[Gk])
-		  dijk += fij.matrix[Gk][k][k];
+    dijk = 0.0;
+    if(fIJ.params->rowtot[Gi])
+      dijk += fIJ.matrix[Gi][i][i];
+    if(fij.params->rowtot[Gj])
+      dijk += fij.matrix[Gj][j][j];
+    if(fij.params->rowtot[Gk])
+      dijk += fij.matrix[Gk][k][k];
 
-		/* Begin connected triples */
+    /* Begin connected triples */
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  WAbc[Gab] = global_dpd_->dpd_block_matrix(FABints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      WAbc[Gab] = ijk_block_matrix(FABints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
-		  /* -t_jkcd * F_IdAb */
-		  Gab = Gid = Gi ^ Gd;
-		  Gc = Gjk ^ Gd;
+    for(Gd=0; Gd < nirreps; Gd++) {
+      /* -t_jkcd * F_IdAb */
+      Gab = Gid = Gi ^ Gd;
+      Gc = Gjk ^ Gd;
 
-		  cd = T2BB.col_offset[Gjk][Gc];
-		  id = FABints.row_offset[Gid][I];
+      cd = T2BB.col_offset[Gjk][Gc];
+      id = FABints.row_offset[Gid][I];
 
-		  FABints.matrix[Gid] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      FABints.matrix[Gid] = ijk_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FABints.params->coltot[Gid];
-		  ncols = bvirtpi[Gc];
-		  nlinks = bvirtpi[Gd];
+      nrows = FABints.params->coltot[Gid];
+      ncols = bvirtpi[Gc];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
-			    &(FABints.matrix[Gid][0][0]), nrows,
-			    &(T2BB.matrix[Gjk][jk][cd]), nlinks, 1.0,
-			    &(WAbc[Gab][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
+		&(FABints.matrix[Gid][0][0]), nrows,
+		&(T2BB.matrix[Gjk][jk][cd]), nlinks, 1.0,
+		&(WAbc[Gab][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
+      ijk_free_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
-		  /* -t_IlAb E_jklc */
-		  Gab = Gil = Gi ^ Gl;
-		  Gc = Gjk ^ Gl;
+    for(Gl=0; Gl < nirreps; Gl++) {
+      /* -t_IlAb E_jklc */
+      Gab = Gil = Gi ^ Gl;
+      Gc = Gjk ^ Gl;
 
-		  lc = EBBints.col_offset[Gjk][Gl];
-		  il = T2AB.row_offset[Gil][I];
+      lc = EBBints.col_offset[Gjk][Gl];
+      il = T2AB.row_offset[Gil][I];
 
-		  nrows = T2AB.params->coltot[Gil];
-		  ncols = bvirtpi[Gc];
-		  nlinks = boccpi[Gl];
+      nrows = T2AB.params->coltot[Gil];
+      ncols = bvirtpi[Gc];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2AB.matrix[Gil][il][0]), nrows,
-			    &(EBBints.matrix[Gjk][jk][lc]), ncols, 1.0,
-			    &(WAbc[Gab][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2AB.matrix[Gil][il][0]), nrows,
+		&(EBBints.matrix[Gjk][jk][lc]), ncols, 1.0,
+		&(WAbc[Gab][0][0]), ncols);
+    }
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  WAcb[Gab] = global_dpd_->dpd_block_matrix(FABints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      WAcb[Gab] = ijk_block_matrix(FABints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
-		  /* +t_jkbd * F_IdAc */
-		  Gac = Gid = Gi ^ Gd;
-		  Gb = Gjk ^ Gd;
+    for(Gd=0; Gd < nirreps; Gd++) {
+      /* +t_jkbd * F_IdAc */
+      Gac = Gid = Gi ^ Gd;
+      Gb = Gjk ^ Gd;
 
-		  bd = T2BB.col_offset[Gjk][Gb];
-		  id = FABints.row_offset[Gid][I];
+      bd = T2BB.col_offset[Gjk][Gb];
+      id = FABints.row_offset[Gid][I];
 
-		  FABints.matrix[Gid] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      FABints.matrix[Gid] = ijk_block_matrix(bvirtpi[Gd], FABints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FABints, Gid, id, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FABints.params->coltot[Gid];
-		  ncols = bvirtpi[Gb];
-		  nlinks = bvirtpi[Gd];
+      nrows = FABints.params->coltot[Gid];
+      ncols = bvirtpi[Gb];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			    &(FABints.matrix[Gid][0][0]), nrows,
-			    &(T2BB.matrix[Gjk][jk][bd]), nlinks, 1.0,
-			    &(WAcb[Gac][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+		&(FABints.matrix[Gid][0][0]), nrows,
+		&(T2BB.matrix[Gjk][jk][bd]), nlinks, 1.0,
+		&(WAcb[Gac][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
+      ijk_free_block(FABints.matrix[Gid], bvirtpi[Gd], FABints.params->coltot[Gid]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
-		  /* +t_IlAc E_jklb */
-		  Gac = Gil = Gi ^ Gl;
-		  Gb = Gjk ^ Gl;
+    for(Gl=0; Gl < nirreps; Gl++) {
+      /* +t_IlAc E_jklb */
+      Gac = Gil = Gi ^ Gl;
+      Gb = Gjk ^ Gl;
 
-		  lb = EBBints.col_offset[Gjk][Gl];
-		  il = T2AB.row_offset[Gil][I];
+      lb = EBBints.col_offset[Gjk][Gl];
+      il = T2AB.row_offset[Gil][I];
 
-		  nrows = T2AB.params->coltot[Gil];
-		  ncols = bvirtpi[Gb];
-		  nlinks = boccpi[Gl];
+      nrows = T2AB.params->coltot[Gil];
+      ncols = bvirtpi[Gb];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2AB.matrix[Gil][il][0]), nrows,
-			    &(EBBints.matrix[Gjk][jk][lb]), ncols, 1.0,
-			    &(WAcb[Gac][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2AB.matrix[Gil][il][0]), nrows,
+		&(EBBints.matrix[Gjk][jk][lb]), ncols, 1.0,
+		&(WAcb[Gac][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WAcb, WAbc, nirreps, Gijk, FABints.params->coltot, FABints.params->colidx,
-		       FABints.params->colorb, FABints.params->rsym, FABints.params->ssym,
-		       avir_off, bvir_off, bvirtpi, bvir_off, FABints.params->colidx, acb, 1);
+global_dpd_->sort_3d(WAcb, WAbc, nirreps, Gijk, FABints.params->coltot, FABints.params->colidx,
+	   FABints.params->colorb, FABints.params->rsym, FABints.params->ssym,
+	   avir_off, bvir_off, bvirtpi, bvir_off, FABints.params->colidx, acb, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WAcb[Gab], FABints.params->coltot[Gab], bvirtpi[Gc]);
+      ijk_free_block(WAcb[Gab], FABints.params->coltot[Gab], bvirtpi[Gc]);
 
-		  WbcA[Gab] = global_dpd_->dpd_block_matrix(FBBints.params->coltot[Gab], avirtpi[Gc]);
-		}
+      WbcA[Gab] = ijk_block_matrix(FBBints.params->coltot[Gab], avirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
-		  /* +t_IkAd * F_jdbc */
-		  Gbc = Gjd = Gj ^ Gd;
-		  Ga = Gik ^ Gd;
+    for(Gd=0; Gd < nirreps; Gd++) {
+      /* +t_IkAd * F_jdbc */
+      Gbc = Gjd = Gj ^ Gd;
+      Ga = Gik ^ Gd;
 
-		  ad = T2AB.col_offset[Gik][Ga];
-		  jd = FBBints.row_offset[Gjd][J];
+      ad = T2AB.col_offset[Gik][Ga];
+      jd = FBBints.row_offset[Gjd][J];
 
-		  FBBints.matrix[Gjd] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FBBints.params->coltot[Gjd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBBints, Gjd, jd, bvirtpi[Gd]);
+      FBBints.matrix[Gjd] = ijk_block_matrix(bvirtpi[Gd], FBBints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBBints, Gjd, jd, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FBBints.params->coltot[Gjd];
-		  ncols = avirtpi[Ga];
-		  nlinks = bvirtpi[Gd];
+      nrows = FBBints.params->coltot[Gjd];
+      ncols = avirtpi[Ga];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			    &(FBBints.matrix[Gjd][0][0]), nrows,
-			    &(T2AB.matrix[Gik][ik][ad]), nlinks, 1.0,
-			    &(WbcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+		&(FBBints.matrix[Gjd][0][0]), nrows,
+		&(T2AB.matrix[Gik][ik][ad]), nlinks, 1.0,
+		&(WbcA[Gbc][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBBints.matrix[Gjd], bvirtpi[Gd], FBBints.params->coltot[Gjd]);
+      ijk_free_block(FBBints.matrix[Gjd], bvirtpi[Gd], FBBints.params->coltot[Gjd]);
 
-		  /* -t_IjAd * F_kdbc */
-		  Gbc = Gkd = Gk ^ Gd;
-		  Ga = Gij ^ Gd;
+      /* -t_IjAd * F_kdbc */
+      Gbc = Gkd = Gk ^ Gd;
+      Ga = Gij ^ Gd;
 
-		  ad = T2AB.col_offset[Gij][Ga];
-		  kd = FBBints.row_offset[Gkd][K];
+      ad = T2AB.col_offset[Gij][Ga];
+      kd = FBBints.row_offset[Gkd][K];
 
-		  FBBints.matrix[Gkd] = global_dpd_->dpd_block_matrix(bvirtpi[Gd], FBBints.params->coltot[Gkd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBBints, Gkd, kd, bvirtpi[Gd]);
+      FBBints.matrix[Gkd] = ijk_block_matrix(bvirtpi[Gd], FBBints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBBints, Gkd, kd, bvirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FBBints.params->coltot[Gkd];
-		  ncols = avirtpi[Ga];
-		  nlinks = bvirtpi[Gd];
+      nrows = FBBints.params->coltot[Gkd];
+      ncols = avirtpi[Ga];
+      nlinks = bvirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
-			    &(FBBints.matrix[Gkd][0][0]), nrows,
-			    &(T2AB.matrix[Gij][ij][ad]), nlinks, 1.0,
-			    &(WbcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 't', nrows, ncols, nlinks, -1.0,
+		&(FBBints.matrix[Gkd][0][0]), nrows,
+		&(T2AB.matrix[Gij][ij][ad]), nlinks, 1.0,
+		&(WbcA[Gbc][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBBints.matrix[Gkd], bvirtpi[Gd], FBBints.params->coltot[Gkd]);
+      ijk_free_block(FBBints.matrix[Gkd], bvirtpi[Gd], FBBints.params->coltot[Gkd]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
-		  /* -t_jlbc E_kIlA */
-		  Gbc = Gjl = Gj ^ Gl;
-		  Ga = Gki ^ Gl;
+    for(Gl=0; Gl < nirreps; Gl++) {
+      /* -t_jlbc E_kIlA */
+      Gbc = Gjl = Gj ^ Gl;
+      Ga = Gki ^ Gl;
 
-		  la = EBAints.col_offset[Gki][Gl];
-		  jl = T2BB.row_offset[Gjl][J];
+      la = EBAints.col_offset[Gki][Gl];
+      jl = T2BB.row_offset[Gjl][J];
 
-		  nrows = T2BB.params->coltot[Gjl];
-		  ncols = avirtpi[Ga];
-		  nlinks = boccpi[Gl];
+      nrows = T2BB.params->coltot[Gjl];
+      ncols = avirtpi[Ga];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2BB.matrix[Gjl][jl][0]), nrows,
-			    &(EBAints.matrix[Gki][ki][la]), ncols, 1.0,
-			    &(WbcA[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2BB.matrix[Gjl][jl][0]), nrows,
+		&(EBAints.matrix[Gki][ki][la]), ncols, 1.0,
+		&(WbcA[Gbc][0][0]), ncols);
 
-		  /* +t_klbc E_jIlA */
-		  Gbc = Gkl = Gk ^ Gl;
-		  Ga = Gji ^ Gl;
+      /* +t_klbc E_jIlA */
+      Gbc = Gkl = Gk ^ Gl;
+      Ga = Gji ^ Gl;
 
-		  la = EBAints.col_offset[Gji][Gl];
-		  kl = T2BB.row_offset[Gkl][K];
+      la = EBAints.col_offset[Gji][Gl];
+      kl = T2BB.row_offset[Gkl][K];
 
-		  nrows = T2BB.params->coltot[Gkl];
-		  ncols = avirtpi[Ga];
-		  nlinks = boccpi[Gl];
+      nrows = T2BB.params->coltot[Gkl];
+      ncols = avirtpi[Ga];
+      nlinks = boccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2BB.matrix[Gkl][kl][0]), nrows,
-			    &(EBAints.matrix[Gji][ji][la]), ncols, 1.0,
-			    &(WbcA[Gbc][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2BB.matrix[Gkl][kl][0]), nrows,
+		&(EBAints.matrix[Gji][ji][la]), ncols, 1.0,
+		&(WbcA[Gbc][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WbcA, WAbc, nirreps, Gijk, FBBints.params->coltot, FBBints.params->colidx,
-		       FBBints.params->colorb, FBBints.params->rsym, FBBints.params->ssym,
-		       bvir_off, bvir_off, avirtpi, avir_off, FABints.params->colidx, cab, 1);
+global_dpd_->sort_3d(WbcA, WAbc, nirreps, Gijk, FBBints.params->coltot, FBBints.params->colidx,
+	   FBBints.params->colorb, FBBints.params->rsym, FBBints.params->ssym,
+	   bvir_off, bvir_off, avirtpi, avir_off, FABints.params->colidx, cab, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WbcA[Gab], FBBints.params->coltot[Gab], avirtpi[Gc]);
+      ijk_free_block(WbcA[Gab], FBBints.params->coltot[Gab], avirtpi[Gc]);
 
-		  WcAb[Gab] = global_dpd_->dpd_block_matrix(FBAints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      WcAb[Gab] = ijk_block_matrix(FBAints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
-		  /* -t_IkDb * F_jDcA */
-		  Gca = Gjd = Gj ^ Gd;
-		  Gb = Gik ^ Gd;
+    for(Gd=0; Gd < nirreps; Gd++) {
+      /* -t_IkDb * F_jDcA */
+      Gca = Gjd = Gj ^ Gd;
+      Gb = Gik ^ Gd;
 
-		  db = T2AB.col_offset[Gik][Gd];
-		  jd = FBAints.row_offset[Gjd][J];
+      db = T2AB.col_offset[Gik][Gd];
+      jd = FBAints.row_offset[Gjd][J];
 
-		  FBAints.matrix[Gjd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gjd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gjd, jd, avirtpi[Gd]);
+      FBAints.matrix[Gjd] = ijk_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gjd, jd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FBAints.params->coltot[Gjd];
-		  ncols = bvirtpi[Gb];
-		  nlinks = avirtpi[Gd];
+      nrows = FBAints.params->coltot[Gjd];
+      ncols = bvirtpi[Gb];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(FBAints.matrix[Gjd][0][0]), nrows,
-			    &(T2AB.matrix[Gik][ik][db]), ncols, 1.0,
-			    &(WcAb[Gca][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(FBAints.matrix[Gjd][0][0]), nrows,
+		&(T2AB.matrix[Gik][ik][db]), ncols, 1.0,
+		&(WcAb[Gca][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBAints.matrix[Gjd], avirtpi[Gd], FBAints.params->coltot[Gjd]);
+      ijk_free_block(FBAints.matrix[Gjd], avirtpi[Gd], FBAints.params->coltot[Gjd]);
 
-		  /* +t_IjDb * F_kDcA */
-		  Gca = Gkd = Gk ^ Gd;
-		  Gb = Gij ^ Gd;
+      /* +t_IjDb * F_kDcA */
+      Gca = Gkd = Gk ^ Gd;
+      Gb = Gij ^ Gd;
 
-		  db = T2AB.col_offset[Gij][Gd];
-		  kd = FBAints.row_offset[Gkd][K];
+      db = T2AB.col_offset[Gij][Gd];
+      kd = FBAints.row_offset[Gkd][K];
 
-		  FBAints.matrix[Gkd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      FBAints.matrix[Gkd] = ijk_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FBAints.params->coltot[Gkd];
-		  ncols = bvirtpi[Gb];
-		  nlinks = avirtpi[Gd];
+      nrows = FBAints.params->coltot[Gkd];
+      ncols = bvirtpi[Gb];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(FBAints.matrix[Gkd][0][0]), nrows,
-			    &(T2AB.matrix[Gij][ij][db]), ncols, 1.0,
-			    &(WcAb[Gca][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(FBAints.matrix[Gkd][0][0]), nrows,
+		&(T2AB.matrix[Gij][ij][db]), ncols, 1.0,
+		&(WcAb[Gca][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
+      ijk_free_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
-		  /* +t_jLcA E_IkLb */
-		  Gca = Gjl = Gj ^ Gl;
-		  Gb = Gik ^ Gl;
+    for(Gl=0; Gl < nirreps; Gl++) {
+      /* +t_jLcA E_IkLb */
+      Gca = Gjl = Gj ^ Gl;
+      Gb = Gik ^ Gl;
 
-		  lb = EABints.col_offset[Gik][Gl];
-		  jl = T2BA.row_offset[Gjl][J];
+      lb = EABints.col_offset[Gik][Gl];
+      jl = T2BA.row_offset[Gjl][J];
 
-		  nrows = T2BA.params->coltot[Gjl];
-		  ncols = bvirtpi[Gb];
-		  nlinks = aoccpi[Gl];
+      nrows = T2BA.params->coltot[Gjl];
+      ncols = bvirtpi[Gb];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2BA.matrix[Gjl][jl][0]), nrows,
-			    &(EABints.matrix[Gik][ik][lb]), ncols, 1.0,
-			    &(WcAb[Gca][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2BA.matrix[Gjl][jl][0]), nrows,
+		&(EABints.matrix[Gik][ik][lb]), ncols, 1.0,
+		&(WcAb[Gca][0][0]), ncols);
 
-		  /* -t_kLcA E_IjLb */
-		  Gca = Gkl = Gk ^ Gl;
-		  Gb = Gij ^ Gl;
+      /* -t_kLcA E_IjLb */
+      Gca = Gkl = Gk ^ Gl;
+      Gb = Gij ^ Gl;
 
-		  lb = EABints.col_offset[Gij][Gl];
-		  kl = T2BA.row_offset[Gkl][K];
+      lb = EABints.col_offset[Gij][Gl];
+      kl = T2BA.row_offset[Gkl][K];
 
-		  nrows = T2BA.params->coltot[Gkl];
-		  ncols = bvirtpi[Gb];
-		  nlinks = aoccpi[Gl];
+      nrows = T2BA.params->coltot[Gkl];
+      ncols = bvirtpi[Gb];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2BA.matrix[Gkl][kl][0]), nrows,
-			    &(EABints.matrix[Gij][ij][lb]), ncols, 1.0,
-			    &(WcAb[Gca][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2BA.matrix[Gkl][kl][0]), nrows,
+		&(EABints.matrix[Gij][ij][lb]), ncols, 1.0,
+		&(WcAb[Gca][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WcAb, WAbc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
-		       FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
-		       bvir_off, avir_off, bvirtpi, bvir_off, FABints.params->colidx, bca, 1);
+global_dpd_->sort_3d(WcAb, WAbc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
+	   FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
+	   bvir_off, avir_off, bvirtpi, bvir_off, FABints.params->colidx, bca, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WcAb[Gab], FBAints.params->coltot[Gab], bvirtpi[Gc]);
+      ijk_free_block(WcAb[Gab], FBAints.params->coltot[Gab], bvirtpi[Gc]);
 
-		  WbAc[Gab] = global_dpd_->dpd_block_matrix(FBAints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      WbAc[Gab] = ijk_block_matrix(FBAints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		for(Gd=0; Gd < nirreps; Gd++) {
-		  /* +t_IkDc * F_jDbA */
-		  Gba = Gjd = Gj ^ Gd;
-		  Gc = Gik ^ Gd;
+    for(Gd=0; Gd < nirreps; Gd++) {
+      /* +t_IkDc * F_jDbA */
+      Gba = Gjd = Gj ^ Gd;
+      Gc = Gik ^ Gd;
 
-		  dc = T2AB.col_offset[Gik][Gd];
-		  jd = FBAints.row_offset[Gjd][J];
+      dc = T2AB.col_offset[Gik][Gd];
+      jd = FBAints.row_offset[Gjd][J];
 
-		  FBAints.matrix[Gjd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gjd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gjd, jd, avirtpi[Gd]);
+      FBAints.matrix[Gjd] = ijk_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gjd, jd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FBAints.params->coltot[Gjd];
-		  ncols = bvirtpi[Gc];
-		  nlinks = avirtpi[Gd];
+      nrows = FBAints.params->coltot[Gjd];
+      ncols = bvirtpi[Gc];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(FBAints.matrix[Gjd][0][0]), nrows,
-			    &(T2AB.matrix[Gik][ik][dc]), ncols, 1.0,
-			    &(WbAc[Gba][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(FBAints.matrix[Gjd][0][0]), nrows,
+		&(T2AB.matrix[Gik][ik][dc]), ncols, 1.0,
+		&(WbAc[Gba][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBAints.matrix[Gjd], avirtpi[Gd], FBAints.params->coltot[Gjd]);
+      ijk_free_block(FBAints.matrix[Gjd], avirtpi[Gd], FBAints.params->coltot[Gjd]);
 
-		  /* -t_IjDc * F_kDbA */
-		  Gba = Gkd = Gk ^ Gd;
-		  Gc = Gij ^ Gd;
+      /* -t_IjDc * F_kDbA */
+      Gba = Gkd = Gk ^ Gd;
+      Gc = Gij ^ Gd;
 
-		  dc = T2AB.col_offset[Gij][Gd];
-		  kd = FBAints.row_offset[Gkd][K];
+      dc = T2AB.col_offset[Gij][Gd];
+      kd = FBAints.row_offset[Gkd][K];
 
-		  FBAints.matrix[Gkd] = global_dpd_->dpd_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
-		  global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      FBAints.matrix[Gkd] = ijk_block_matrix(avirtpi[Gd], FBAints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&FBAints, Gkd, kd, avirtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		  nrows = FBAints.params->coltot[Gkd];
-		  ncols = bvirtpi[Gc];
-		  nlinks = avirtpi[Gd];
+      nrows = FBAints.params->coltot[Gkd];
+      ncols = bvirtpi[Gc];
+      nlinks = avirtpi[Gd];
 
-		  if(nrows && ncols && nlinks) 
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(FBAints.matrix[Gkd][0][0]), nrows,
-			    &(T2AB.matrix[Gij][ij][dc]), ncols, 1.0,
-			    &(WbAc[Gba][0][0]), ncols);
+      if(nrows && ncols && nlinks) 
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(FBAints.matrix[Gkd][0][0]), nrows,
+		&(T2AB.matrix[Gij][ij][dc]), ncols, 1.0,
+		&(WbAc[Gba][0][0]), ncols);
 
-		  global_dpd_->free_dpd_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
+      ijk_free_block(FBAints.matrix[Gkd], avirtpi[Gd], FBAints.params->coltot[Gkd]);
 
-		}
+    }
 
-		for(Gl=0; Gl < nirreps; Gl++) {
-		  /* -t_jLbA * E_IkLc */
-		  Gba = Gjl = Gj ^ Gl;
-		  Gc = Gik ^ Gl;
+    for(Gl=0; Gl < nirreps; Gl++) {
+      /* -t_jLbA * E_IkLc */
+      Gba = Gjl = Gj ^ Gl;
+      Gc = Gik ^ Gl;
 
-		  lc = EABints.col_offset[Gik][Gl];
-		  jl = T2BA.row_offset[Gjl][J];
+      lc = EABints.col_offset[Gik][Gl];
+      jl = T2BA.row_offset[Gjl][J];
 
-		  nrows = T2BA.params->coltot[Gjl];
-		  ncols = bvirtpi[Gc];
-		  nlinks = aoccpi[Gl];
+      nrows = T2BA.params->coltot[Gjl];
+      ncols = bvirtpi[Gc];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			    &(T2BA.matrix[Gjl][jl][0]), nrows,
-			    &(EABints.matrix[Gik][ik][lc]), ncols, 1.0,
-			    &(WbAc[Gba][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+		&(T2BA.matrix[Gjl][jl][0]), nrows,
+		&(EABints.matrix[Gik][ik][lc]), ncols, 1.0,
+		&(WbAc[Gba][0][0]), ncols);
 
-		  /* +t_kLbA * E_IjLc */
-		  Gba = Gkl = Gk ^ Gl;
-		  Gc = Gij ^ Gl;
+      /* +t_kLbA * E_IjLc */
+      Gba = Gkl = Gk ^ Gl;
+      Gc = Gij ^ Gl;
 
-		  lc = EABints.col_offset[Gij][Gl];
-		  kl = T2BA.row_offset[Gkl][K];
+      lc = EABints.col_offset[Gij][Gl];
+      kl = T2BA.row_offset[Gkl][K];
 
-		  nrows = T2BA.params->coltot[Gkl];
-		  ncols = bvirtpi[Gc];
-		  nlinks = aoccpi[Gl];
+      nrows = T2BA.params->coltot[Gkl];
+      ncols = bvirtpi[Gc];
+      nlinks = aoccpi[Gl];
 
-		  if(nrows && ncols && nlinks)
-		    C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
-			    &(T2BA.matrix[Gkl][kl][0]), nrows,
-			    &(EABints.matrix[Gij][ij][lc]), ncols, 1.0,
-			    &(WbAc[Gba][0][0]), ncols);
-		}
+      if(nrows && ncols && nlinks)
+	C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0,
+		&(T2BA.matrix[Gkl][kl][0]), nrows,
+		&(EABints.matrix[Gij][ij][lc]), ncols, 1.0,
+		&(WbAc[Gba][0][0]), ncols);
+    }
 
-        global_dpd_->sort_3d(WbAc, WAbc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
-		       FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
-		       bvir_off, avir_off, bvirtpi, bvir_off, FABints.params->colidx, bac, 1);
+global_dpd_->sort_3d(WbAc, WAbc, nirreps, Gijk, FBAints.params->coltot, FBAints.params->colidx,
+	   FBAints.params->colorb, FBAints.params->rsym, FBAints.params->ssym,
+	   bvir_off, avir_off, bvirtpi, bvir_off, FABints.params->colidx, bac, 1);
 
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  global_dpd_->free_dpd_block(WbAc[Gab], FBAints.params->coltot[Gab], bvirtpi[Gc]);
-		}
+      ijk_free_block(WbAc[Gab], FBAints.params->coltot[Gab], bvirtpi[Gc]);
+    }
 
-		/* Add disconnected triples and finish W and V */
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
+    /* Add disconnected triples and finish W and V */
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-		  VAbc[Gab] = global_dpd_->dpd_block_matrix(FABints.params->coltot[Gab], bvirtpi[Gc]);
+      VAbc[Gab] = ijk_block_matrix(FABints.params->coltot[Gab], bvirtpi[Gc]);
 
-		  for(ab=0; ab < FABints.params->coltot[Gab]; ab++) {
-		    A = FABints.params->colorb[Gab][ab][0];
-		    Ga = FABints.params->rsym[A];
-		    a = A - avir_off[Ga];
-		    B = FABints.params->colorb[Gab][ab][1];
-		    Gb = FABints.params->ssym[B];
-		    b = B - bvir_off[Gb];
+      for(ab=0; ab < FABints.params->coltot[Gab]; ab++) {
+	A = FABints.params->colorb[Gab][ab][0];
+	Ga = FABints.params->rsym[A];
+	a = A - avir_off[Ga];
+	B = FABints.params->colorb[Gab][ab][1];
+	Gb = FABints.params->ssym[B];
+	b = B - bvir_off[Gb];
 
-		    Gbc = Gb ^ Gc;
-		    Gac = Ga ^ Gc;
-
-		    for(c=0; c < bvirtpi[Gc]; c++) {
-		      C = bvir_off[Gc] + c;
-
-		      bc = DBBints.params->colidx[B][C];
-		      ac = DABints.params->colidx[A][C];
-
-		      /* +t_IA * D_jkbc + f_IA * t_jkbc */
-		      if(Gi == Ga && Gjk == Gbc) {
-			t_ia = D_jkbc = f_ia = t_jkbc = 0.0;
+	Gbc = Gb ^ Gc;
+	Gac = Ga ^ Gc;
 
-			if(T1A.params->rowtot[Gi] && T1A.params->coltot[Gi]) {
-			  t_ia = T1A.matrix[Gi][i][a];
-			  f_ia = fIA.matrix[Gi][i][a];
-			}
-
-			if(DBBints.params->rowtot[Gjk] && DBBints.params->coltot[Gjk]) {
-			  D_jkbc = DBBints.matrix[Gjk][jk][bc];
-			  t_jkbc = T2BB.matrix[Gjk][jk][bc];
-			}
-
-			VAbc[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
-		      }
-
-		      /* +t_jb * D_IkAc + f_jb * t_IkAc */
-		      if(Gj == Gb && Gik == Gac) {
-			t_jb = D_ikac = f_jb = t_ikac = 0.0;
-
-			if(T1B.params->rowtot[Gj] && T1B.params->coltot[Gj]) {
-			  t_jb = T1B.matrix[Gj][j][b];
-			  f_jb = fia.matrix[Gj][j][b];
-			}
-
-			if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
-			  D_ikac = DABints.matrix[Gik][ik][ac];
-			  t_ikac = T2AB.matrix[Gik][ik][ac];
-			}
-
-			VAbc[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
-		      }
-
-		      /* -t_jc * D_IkAb - f_jc * t_IkAb */
-		      if(Gj == Gc && Gik == Gab) {
-			t_jc = D_ikab = f_jc = t_ikab = 0.0;
-
-			if(T1B.params->rowtot[Gj] && T1B.params->coltot[Gj]) {
-			  t_jc = T1B.matrix[Gj][j][c];
-			  f_jc = fia.matrix[Gj][j][c];
-			}
-
-			if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
-			  D_ikab = DABints.matrix[Gik][ik][ab];
-			  t_ikab = T2AB.matrix[Gik][ik][ab];
-			}
-
-			VAbc[Gab][ab][c] -= t_jc * D_ikab + f_jc * t_ikab;
-		      }
-
-		      /* -t_kb * D_IjAc - f_kb * t_IjAc */
-		      if(Gk == Gb && Gji == Gac) {
-			t_kb = D_ijac = f_kb = t_ijac = 0.0;
-
-			if(T1B.params->rowtot[Gk] && T1B.params->coltot[Gk]) {
-			  t_kb = T1B.matrix[Gk][k][b];
-			  f_kb = fia.matrix[Gk][k][b];
-			}
-
-			if(DABints.params->rowtot[Gji] && DABints.params->coltot[Gji]) {
-			  D_ijac = DABints.matrix[Gji][ij][ac];
-			  t_ijac = T2AB.matrix[Gji][ij][ac];
-			}
-
-			VAbc[Gab][ab][c] -= t_kb * D_ijac + f_kb * t_ijac;
-		      }
-
-		      /* +t_kc * D_IjAb + f_kc * t_IjAb */
-		      if(Gk == Gc && Gji == Gab) {
-			t_kc = D_ijab = f_kc = t_ijab = 0.0;
-
-			if(T1B.params->rowtot[Gk] && T1B.params->coltot[Gk]) {
-			  t_kc = T1B.matrix[Gk][k][c];
-			  f_kc = fia.matrix[Gk][k][c];
-			}
-
-			if(DABints.params->rowtot[Gji] && DABints.params->coltot[Gji]) {
-			  D_ijab = DABints.matrix[Gji][ij][ab];
-			  t_ijab = T2AB.matrix[Gji][ij][ab];
-			}
-
-			VAbc[Gab][ab][c] += t_kc * D_ijab + f_kc * t_ijab;
-		      }
-
-		      /* Sum V and W into V */
-		      VAbc[Gab][ab][c] += WAbc[Gab][ab][c];
-
-		      /* Build the rest of the denominator and divide it into W */
-		      denom = dijk;
-		      if(fAB.params->rowtot[Ga])
-			denom -= fAB.matrix[Ga][a][a];
-		      if(fab.params->rowtot[Gb])
-			denom -= fab.matrix[Gb][b][b];
-		      if(fab.params->rowtot[Gc])
-			denom -= fab.matrix[Gc][c][c];
-
-		      WAbc[Gab][ab][c] /= denom;
-
-		    } /* c */
-		  } /* ab */
-		} /* Gab */
-
-		/* 1/2 Dot product of final V and W is the energy for this ijk triple */
-		for(Gab=0; Gab < nirreps; Gab++) {
-		  Gc = Gab ^ Gijk;
-		  ET_ABB += dot_block(WAbc[Gab], VAbc[Gab], FABints.params->coltot[Gab], bvirtpi[Gc], 0.5);
-		  global_dpd_->free_dpd_block(WAbc[Gab], FABints.params->coltot[Gab], bvirtpi[Gc]);
-		  global_dpd_->free_dpd_block(VAbc[Gab], FABints.params->coltot[Gab], bvirtpi[Gc]);
-		}
-
-	      } /* J >= K */
-
-	    } /* k */
-	  } /* j */
-	} /* i */
-
-      } /* Gk */
-    } /* Gj */
-  } /* Gi */
+	for(c=0; c < bvirtpi[Gc]; c++) {
+	  C = bvir_off[Gc] + c;
 
-  free(WAbc);
-  free(VAbc);
-  free(WAcb);
-  free(WbcA);
-  free(WcAb);
-  free(WbAc);
+	  bc = DBBints.params->colidx[B][C];
+	  ac = DABints.params->colidx[A][C];
 
-  fclose(ijkfile);
+	  /* +t_IA * D_jkbc + f_IA * t_jkbc */
+	  if(Gi == Ga && Gjk == Gbc) {
+	    t_ia = D_jkbc = f_ia = t_jkbc = 0.0;
 
-  for(h=0; h < nirreps; h++) {
-    global_dpd_->buf4_mat_irrep_close(&T2BB, h);
-    global_dpd_->buf4_mat_irrep_close(&T2AB, h);
-    global_dpd_->buf4_mat_irrep_close(&T2BA, h);
-    global_dpd_->buf4_mat_irrep_close(&EBBints, h);
-    global_dpd_->buf4_mat_irrep_close(&EABints, h);
-    global_dpd_->buf4_mat_irrep_close(&EBAints, h);
-    global_dpd_->buf4_mat_irrep_close(&DBBints, h);
-    global_dpd_->buf4_mat_irrep_close(&DABints, h);
-  }
+	    if(T1A.params->rowtot[Gi] && T1A.params->coltot[Gi]) {
+	      t_ia = T1A.matrix[Gi][i][a];
+	      f_ia = fIA.matrix[Gi][i][a];
+	    }
 
-  global_dpd_->buf4_close(&T2BB);
-  global_dpd_->buf4_close(&T2AB);
-  global_dpd_->buf4_close(&T2BA);
-  global_dpd_->buf4_close(&FBBints);
-  global_dpd_->buf4_close(&FABints);
-  global_dpd_->buf4_close(&FBAints);
-  global_dpd_->buf4_close(&EBBints);
-  global_dpd_->buf4_close(&EABints);
-  global_dpd_->buf4_close(&EBAints);
-  global_dpd_->buf4_close(&DBBints);
-  global_dpd_->buf4_close(&DABints);
+	    if(DBBints.params->rowtot[Gjk] && DBBints.params->coltot[Gjk]) {
+	      D_jkbc = DBBints.matrix[Gjk][jk][bc];
+	      t_jkbc = T2BB.matrix[Gjk][jk][bc];
+	    }
 
-  global_dpd_->file2_mat_close(&T1A);
-  global_dpd_->file2_close(&T1A);
-  global_dpd_->file2_mat_close(&T1B);
-  global_dpd_->file2_close(&T1B);
+	    VAbc[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
+	  }
 
-  global_dpd_->file2_mat_close(&fIJ);
-  global_dpd_->file2_mat_close(&fij);
-  global_dpd_->file2_mat_close(&fAB);
-  global_dpd_->file2_mat_close(&fab);
-  global_dpd_->file2_mat_close(&fIA);
-  global_dpd_->file2_mat_close(&fia);
-  global_dpd_->file2_close(&fIJ);
-  global_dpd_->file2_close(&fij);
-  global_dpd_->file2_close(&fAB);
-  global_dpd_->file2_close(&fab);
-  global_dpd_->file2_close(&fIA);
-  global_dpd_->file2_close(&fia);
+	  /* +t_jb * D_IkAc + f_jb * t_IkAc */
+	  if(Gj == Gb && Gik == Gac) {
+	    t_jb = D_ikac = f_jb = t_ikac = 0.0;
 
-  return ET_ABB;
+	    if(T1B.params->rowtot[Gj] && T1B.params->coltot[Gj]) {
+	      t_jb = T1B.matrix[Gj][j][b];
+	      f_jb = fia.matrix[Gj][j][b];
+	    }
+
+	    if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
+	      D_ikac = DABints.matrix[Gik][ik][ac];
+	      t_ikac = T2AB.matrix[Gik][ik][ac];
+	    }
+
+	    VAbc[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
+	  }
+
+	  /* -t_jc * D_IkAb - f_jc * t_IkAb */
+	  if(Gj == Gc && Gik == Gab) {
+	    t_jc = D_ikab = f_jc = t_ikab = 0.0;
+
+	    if(T1B.params->rowtot[Gj] && T1B.params->coltot[Gj]) {
+	      t_jc = T1B.matrix[Gj][j][c];
+	      f_jc = fia.matrix[Gj][j][c];
+	    }
+
+	    if(DABints.params->rowtot[Gik] && DABints.params->coltot[Gik]) {
+	      D_ikab = DABints.matrix[Gik][ik][ab];
+	      t_ikab = T2AB.matrix[Gik][ik][ab];
+	    }
+
+	    VAbc[Gab][ab][c] -= t_jc * D_ikab + f_jc * t_ikab;
+	  }
+
+	  /* -t_kb * D_IjAc - f_kb * t_IjAc */
+	  if(Gk == Gb && Gji == Gac) {
+	    t_kb = D_ijac = f_kb = t_ijac = 0.0;
+
+	    if(T1B.params->rowtot[Gk] && T1B.params->coltot[Gk]) {
+	      t_kb = T1B.matrix[Gk][k][b];
+	      f_kb = fia.matrix[Gk][k][b];
+	    }
+
+	    if(DABints.params->rowtot[Gji] && DABints.params->coltot[Gji]) {
+	      D_ijac = DABints.matrix[Gji][ij][ac];
+	      t_ijac = T2AB.matrix[Gji][ij][ac];
+	    }
+
+	    VAbc[Gab][ab][c] -= t_kb * D_ijac + f_kb * t_ijac;
+	  }
+
+	  /* +t_kc * D_IjAb + f_kc * t_IjAb */
+	  if(Gk == Gc && Gji == Gab) {
+	    t_kc = D_ijab = f_kc = t_ijab = 0.0;
+
+	    if(T1B.params->rowtot[Gk] && T1B.params->coltot[Gk]) {
+	      t_kc = T1B.matrix[Gk][k][c];
+	      f_kc = fia.matrix[Gk][k][c];
+	    }
+
+	    if(DABints.params->rowtot[Gji] && DABints.params->coltot[Gji]) {
+	      D_ijab = DABints.matrix[Gji][ij][ab];
+	      t_ijab = T2AB.matrix[Gji][ij][ab];
+	    }
+
+	    VAbc[Gab][ab][c] += t_kc * D_ijab + f_kc * t_ijab;
+	  }
+
+	  /* Sum V and W into V */
+	  VAbc[Gab][ab][c] += WAbc[Gab][ab][c];
+
+	  /* Build the rest of the denominator and divide it into W */
+	  denom = dijk;
+	  if(fAB.params->rowtot[Ga])
+	    denom -= fAB.matrix[Ga][a][a];
+	  if(fab.params->rowtot[Gb])
+	    denom -= fab.matrix[Gb][b][b];
+	  if(fab.params->rowtot[Gc])
+	    denom -= fab.matrix[Gc][c][c];
+
+	  WAbc[Gab][ab][c] /= denom;
+
+	} /* c */
+      } /* ab */
+    } /* Gab */
+
+    /* 1/2 Dot product of final V and W is the energy for this ijk triple */
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+      ET_ABB += dot_block(WAbc[Gab], VAbc[Gab], FABints.params->coltot[Gab], bvirtpi[Gc], 0.5);
+      ijk_free_block(WAbc[Gab], FABints.params->coltot[Gab], bvirtpi[Gc]);
+      ijk_free_block(VAbc[Gab], FABints.params->coltot[Gab], bvirtpi[Gc]);
+    }
+
+  } /* ijk */
+
+  data->ET = ET_ABB;
+
+  free(WAbc);
+  free(VAbc);
+  free(WAcb);
+  free(WbAc);
+  free(WcAb);
+  free(WbcA);
+
+  pthread_exit(NULL);
 }
 
 }} // namespace psi::CCTRIPLES
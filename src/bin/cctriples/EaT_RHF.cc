@@ -34,38 +34,30 @@
 #include <psiconfig.h>
 #include "MOInfo.h"
 #include "Params.h"
+#include "ijk_tasks.h"
 #define EXTERN
 #include "globals.h"
 
-//MKL Header
-#ifdef HAVE_MKL
-#include <mkl.h>
-#endif
-
-
 namespace psi { namespace cctriples {
 
-pthread_mutex_t mut_at = PTHREAD_MUTEX_INITIALIZER;
-
 struct thread_data {
  dpdfile2 *fIJ; dpdfile2 *fAB; dpdfile2 *fIA; 
  dpdfile2 *L1; dpdbuf4 *L2; dpdbuf4 *T2;
  dpdbuf4 *Eints; dpdbuf4 *Dints; dpdbuf4 *Fints_local;
- double *ET_local; int Gi; int Gj; int Gk; int first_ijk; int last_ijk;
+ double *ET_local; IJKQueue *queue;
 };
 
 void *EaT_RHF_thread(void *thread_data);
 
 double EaT_RHF(void)
 {
-  int i,j,k,I,J,K,Gi,Gj,Gk, h, nirreps, cnt;
-  int nijk, nthreads, thread, *ijk_part, errcod;
+  int h, nirreps;
+  int nthreads, thread;
   int *occpi, *virtpi, *occ_off, *vir_off;
   double ET, *ET_array;
   dpdfile2 fIJ, fAB, fIA, L1;
   dpdbuf4 T2, L2, Eints, Dints, *Fints_array;
   FILE *ijkfile;
-  pthread_t  *p_thread;
   struct thread_data *thread_data_array;
 
   timer_on("ET_RHF");
@@ -77,12 +69,6 @@ double EaT_RHF(void)
 
   nthreads = params.nthreads;
   thread_data_array = (struct thread_data *) malloc(nthreads*sizeof(struct thread_data));
-  p_thread = (pthread_t *) malloc(nthreads*sizeof(pthread_t));
-
-#ifdef HAVE_MKL
-  int old_threads = mkl_get_max_threads();
-  mkl_set_num_threads(1);
-#endif
 
   global_dpd_->file2_init(&fIJ, PSIF_CC_OEI, 0, 0, 0, "fIJ");
   global_dpd_->file2_init(&fAB, PSIF_CC_OEI, 0, 1, 1, "fAB");
@@ -117,13 +103,19 @@ double EaT_RHF(void)
   }
   ffile(&ijkfile,"ijk.dat", 0);
 
+  /* All IJK combinations of all irrep triples go into one queue, which
+     the threads draw from until it is empty */
+  IJKQueue queue(nirreps, occpi, occ_off, occpi, occ_off, occpi, occ_off, IJK_ALL);
+  fprintf(ijkfile, "Total number of IJK combinations =: %d\n", queue.size());
+  fprintf(ijkfile, "Number of threads =: %d\n", nthreads);
+  fflush(ijkfile);
+
   /* each thread gets its own F buffer to assign memory and read blocks
      into and its own energy double - all else shared */
   Fints_array = (dpdbuf4 *) malloc(nthreads*sizeof(dpdbuf4));
   for (thread=0; thread<nthreads;++thread)
     global_dpd_->buf4_init(&(Fints_array[thread]), PSIF_CC_FINTS, 0, 10, 5, 10, 5, 0, "F <ia|bc>");
   ET_array = (double *) malloc(nthreads*sizeof(double));
-  ijk_part = new int [nthreads];
 
   for (thread=0;thread<nthreads;++thread) {
     thread_data_array[thread].fIJ = &fIJ;
@@ -136,94 +128,15 @@ double EaT_RHF(void)
     thread_data_array[thread].Dints = &Dints;
     thread_data_array[thread].Fints_local = &(Fints_array[thread]);
     thread_data_array[thread].ET_local = &(ET_array[thread]);
+    thread_data_array[thread].queue = &queue;
+    ET_array[thread] = 0.0;
   }
 
-  /* Compute total number of IJK combinations */
-  nijk = 0;
-  for(Gi=0; Gi < nirreps; Gi++)
-    for(Gj=0; Gj < nirreps; Gj++)
-      for(Gk=0; Gk < nirreps; Gk++)
-        for(i=0; i < occpi[Gi]; i++) {
-          I = occ_off[Gi] + i;
-          for(j=0; j < occpi[Gj]; j++) {
-            J = occ_off[Gj] + j;
-            for(k=0; k < occpi[Gk]; k++) {
-              K = occ_off[Gk] + k;
-              nijk++;
-            }
-          }
-        }
-  fprintf(ijkfile, "Total number of IJK combinations =: %d\n", nijk);
-  fflush(ijkfile);
+  ijk_threads(nthreads, EaT_RHF_thread, thread_data_array, sizeof(struct thread_data));
 
   ET = 0.0;
-  for(Gi=0; Gi < nirreps; Gi++) {
-    for(Gj=0; Gj < nirreps; Gj++) {
-      for(Gk=0; Gk < nirreps; Gk++) {
-
-        nijk = 0; // total number of ijk for these irreps
-        for(i=0; i < occpi[Gi]; i++) {
-          I = occ_off[Gi] + i;
-          for(j=0; j < occpi[Gj]; j++) {
-            J = occ_off[Gj] + j;
-            for(k=0; k < occpi[Gk]; k++) {
-              K = occ_off[Gk] + k;
-              nijk++;
-            }
-          }
-        }
-        fprintf(ijkfile, "Num. of IJK with (Gi,Gj,Gk)=(%d,%d,%d) =: %d\n", Gi, Gj, Gk, nijk);
-        fflush(ijkfile);
-        if (nijk == 0) continue;
-
-        for (thread=0; thread<nthreads;++thread) {
-          thread_data_array[thread].Gi = Gi;
-          thread_data_array[thread].Gj = Gj;
-          thread_data_array[thread].Gk = Gk;
-          ET_array[thread] = 0.0;
-          ijk_part[thread] = nijk / nthreads; // number of ijk for each thread
-          if (thread < (nijk % nthreads)) ++ijk_part[thread];
-        }
-
-        cnt = 0;
-        for (thread=0; thread<nthreads; ++thread) {
-          if (!ijk_part[thread]) continue;  // there are more threads than nijk
-          thread_data_array[thread].first_ijk = cnt;
-          cnt += ijk_part[thread];
-          thread_data_array[thread].last_ijk = cnt-1;
-        }
-
-        /* execute threads */
-        for (thread=0; thread<nthreads;++thread) {
-          if (!ijk_part[thread]) continue;
-          fprintf(ijkfile,"\tthread %d: first_ijk=%d,  last_ijk=%d\n", thread,
-            thread_data_array[thread].first_ijk, thread_data_array[thread].last_ijk);
-          fflush(ijkfile);
-        }
-
-        for (thread=0;thread<nthreads;++thread) {
-          if (!ijk_part[thread]) continue;
-          errcod = pthread_create(&(p_thread[thread]), NULL, EaT_RHF_thread,
-                   (void *) &thread_data_array[thread]);
-          if (errcod) {
-            throw PsiException("pthread_create in ET_RHF()",__FILE__,__LINE__);
-          }
-        }
-
-        for (thread=0; thread<nthreads;++thread) {
-          if (!ijk_part[thread]) continue;
-          errcod = pthread_join(p_thread[thread], NULL);
-          if (errcod) {
-            throw PsiException("pthread_join in ET_RHF() failed",__FILE__,__LINE__);
-          }
-        }
-
-        for (thread=0;thread<nthreads;++thread)
-          ET += ET_array[thread];
-
-      } /* Gk */
-    } /* Gj */
-  } /* Gi */
+  for (thread=0;thread<nthreads;++thread)
+    ET += ET_array[thread];
 
   ET /= 3.0;
 
@@ -255,24 +168,18 @@ double EaT_RHF(void)
 
   free(Fints_array);
   free(ET_array);
-  delete [] ijk_part;
 
   free(thread_data_array);
-  free(p_thread);
 
   timer_off("ET_RHF");
 
-#ifdef HAVE_MKL
-  mkl_set_num_threads(old_threads);
-#endif
-
   return ET;
 }
 
 
 void* EaT_RHF_thread(void* thread_data_in)
 {
-  int h, nirreps, cnt_ijk;
+  int h, nirreps;
   int Gp, p, nump;
   int nrows, ncols, nlinks;
   int Gijk, Gid, Gkd, Gjd, Gil, Gkl, Gjl;
@@ -292,7 +199,7 @@ void* EaT_RHF_thread(void* thread_data_in)
   double ***W0, ***W1, ***W2, ***W3, ***V;
   dpdbuf4 *L2, *T2, *Eints, *Dints, *Fints;
   dpdfile2 *fIJ, *fAB, *fIA, *L1;
-  int nijk, nthreads, first_ijk, last_ijk, thr_id;
+  IJKTask task;
   struct thread_data *data;
 
   nirreps = moinfo.nirreps;
@@ -311,11 +218,6 @@ void* EaT_RHF_thread(void* thread_data_in)
   Dints = data->Dints;
   Fints = data->Fints_local;
   ET_local  = data->ET_local; // pointer to where thread E goes
-  Gi        =  data->Gi;
-  Gj        =  data->Gj;
-  Gk        =  data->Gk;
-  first_ijk = data->first_ijk;
-  last_ijk  = data->last_ijk;
 
   W0 = (double ***) malloc(nirreps * sizeof(double **));
   W1 = (double ***) malloc(nirreps * sizeof(double **));
@@ -323,610 +225,606 @@ void* EaT_RHF_thread(void* thread_data_in)
   W3 = (double ***) malloc(nirreps * sizeof(double **));
   V = (double ***) malloc(nirreps * sizeof(double **));
 
-  Gkj = Gjk = Gk ^ Gj;
-  Gji = Gij = Gi ^ Gj;
-  Gik = Gki = Gi ^ Gk;
-  Gijk = Gi ^ Gj ^ Gk;
-
-  cnt_ijk = -1;
-  for(i=0; i < occpi[Gi]; i++) {
-    I = occ_off[Gi] + i;
-    for(j=0; j < occpi[Gj]; j++) {
-      J = occ_off[Gj] + j;
-      for(k=0; k < occpi[Gk]; k++) {
-        K = occ_off[Gk] + k;
-
-        ++cnt_ijk;
-        /* check to see if this ijk is for this thread */
-        if ( (cnt_ijk < first_ijk) || (cnt_ijk > last_ijk))
-           continue;
-
-        ij = T2->params->rowidx[I][J];
-        ji = T2->params->rowidx[J][I];
-        ik = T2->params->rowidx[I][K];
-        ki = T2->params->rowidx[K][I];
-        jk = T2->params->rowidx[J][K];
-        kj = T2->params->rowidx[K][J];
-
-        dijk = 0.0;
-        if(fIJ->params->rowtot[Gi])
-          dijk += fIJ->matrix[Gi][i][i];
-        if(fIJ->params->rowtot[Gj])
-          dijk += fIJ->matrix[Gj][j][j];
-        if(fIJ->params->rowtot[Gk])
-          dijk += fIJ->matrix[Gk][k][k];
-
-        /* Malloc space for the W intermediate */
-
-        // timer_on("malloc");
-        for(Gab=0; Gab < nirreps; Gab++) {
-          Gc = Gab ^ Gijk;
-
-          W0[Gab] = global_dpd_->dpd_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
-          W1[Gab] = global_dpd_->dpd_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
-          W2[Gab] = global_dpd_->dpd_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
-          W3[Gab] = global_dpd_->dpd_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
-        }
-        // timer_off("malloc");
-
-        // timer_on("N7 Terms");
-
-        /* +F_idab * t_kjcd */
-        for(Gd=0; Gd < nirreps; Gd++) {
-
-          Gab = Gid = Gi ^ Gd;
-          Gc = Gkj ^ Gd;
-
-          /* Set up F integrals */
-          Fints->matrix[Gid] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints->params->coltot[Gid]);
-          pthread_mutex_lock(&mut_at);
-          global_dpd_->buf4_mat_irrep_rd_block(Fints, Gid, Fints->row_offset[Gid][I], virtpi[Gd]);
-          pthread_mutex_unlock(&mut_at);
-
-          /* Set up T2 amplitudes */
-          cd = T2->col_offset[Gkj][Gc];
-
-          /* Set up multiplication parameters */
-          nrows = Fints->params->coltot[Gid];
-          ncols = virtpi[Gc];
-          nlinks = virtpi[Gd];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gid][0][0]), nrows,
-                    &(T2->matrix[Gkj][kj][cd]), nlinks, 0.0,
-                    &(W0[Gab][0][0]), ncols);
-
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gid][0][0]), nrows,
-                    &(L2->matrix[Gkj][kj][cd]), nlinks, 0.0,
-                    &(W2[Gab][0][0]), ncols);
-          }
-
-          global_dpd_->free_dpd_block(Fints->matrix[Gid], virtpi[Gd], Fints->params->coltot[Gid]);
-        }
-
-        /* -E_jklc * t_ilab */
-        for(Gl=0; Gl < nirreps; Gl++) {
-
-          Gab = Gil = Gi ^ Gl;
-          Gc = Gjk ^ Gl;
-
-          /* Set up E integrals */
-          lc = Eints->col_offset[Gjk][Gl];
-
-          /* Set up T2 amplitudes */
-          il = T2->row_offset[Gil][I];
-
-          /* Set up multiplication parameters */
-          nrows = T2->params->coltot[Gil];
-          ncols = virtpi[Gc];
-          nlinks = occpi[Gl];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(T2->matrix[Gil][il][0]), nrows,
-                    &(Eints->matrix[Gjk][jk][lc]), ncols, 1.0,
-                    &(W0[Gab][0][0]), ncols);
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(L2->matrix[Gil][il][0]), nrows,
-                    &(Eints->matrix[Gjk][jk][lc]), ncols, 1.0,
-                    &(W2[Gab][0][0]), ncols);
-          }
-        }
-
-        /* Sort W[ab][c] --> W[ac][b] */
-        global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
-        global_dpd_->sort_3d(W2, W3, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
-
-        /* +F_idac * t_jkbd */
-        for(Gd=0; Gd < nirreps; Gd++) {
-
-          Gac = Gid = Gi ^ Gd;
-          Gb = Gjk ^ Gd;
-
-          Fints->matrix[Gid] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints->params->coltot[Gid]);
-          pthread_mutex_lock(&mut_at);
-          global_dpd_->buf4_mat_irrep_rd_block(Fints, Gid, Fints->row_offset[Gid][I], virtpi[Gd]);
-          pthread_mutex_unlock(&mut_at);
-
-          bd = T2->col_offset[Gjk][Gb];
-
-          nrows = Fints->params->coltot[Gid];
-          ncols = virtpi[Gb];
-          nlinks = virtpi[Gd];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gid][0][0]), nrows,
-                    &(T2->matrix[Gjk][jk][bd]), nlinks, 1.0,
-                    &(W1[Gac][0][0]), ncols);
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gid][0][0]), nrows,
-                    &(L2->matrix[Gjk][jk][bd]), nlinks, 1.0,
-                    &(W3[Gac][0][0]), ncols);
-          }
-
-          global_dpd_->free_dpd_block(Fints->matrix[Gid], virtpi[Gd], Fints->params->coltot[Gid]);
-        }
-
-        /* -E_kjlb * t_ilac */
-        for(Gl=0; Gl < nirreps; Gl++) {
-
-          Gac = Gil = Gi ^ Gl;
-          Gb = Gkj ^ Gl;
-
-          lb = Eints->col_offset[Gkj][Gl];
-
-          il = T2->row_offset[Gil][I];
-
-          nrows = T2->params->coltot[Gil];
-          ncols = virtpi[Gb];
-          nlinks = occpi[Gl];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(T2->matrix[Gil][il][0]), nrows,
-                    &(Eints->matrix[Gkj][kj][lb]), ncols, 1.0,
-                    &(W1[Gac][0][0]), ncols);
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(L2->matrix[Gil][il][0]), nrows,
-                    &(Eints->matrix[Gkj][kj][lb]), ncols, 1.0,
-                    &(W3[Gac][0][0]), ncols);
-          }
-        }
-
-        /* Sort W[ac][b] --> W[ca][b] */
-        global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
-        global_dpd_->sort_3d(W3, W2, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
-
-        /* +F_kdca * t_jibd */
-        for(Gd=0; Gd < nirreps; Gd++) {
-
-          Gca = Gkd = Gk ^ Gd;
-          Gb = Gji ^ Gd;
-
-          Fints->matrix[Gkd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints->params->coltot[Gkd]);
-          pthread_mutex_lock(&mut_at);
-          global_dpd_->buf4_mat_irrep_rd_block(Fints, Gkd, Fints->row_offset[Gkd][K], virtpi[Gd]);
-          pthread_mutex_unlock(&mut_at);
-
-          bd = T2->col_offset[Gji][Gb];
-
-          nrows = Fints->params->coltot[Gkd];
-          ncols = virtpi[Gb];
-          nlinks = virtpi[Gd];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gkd][0][0]), nrows,
-                    &(T2->matrix[Gji][ji][bd]), nlinks, 1.0,
-                    &(W0[Gca][0][0]), ncols);
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gkd][0][0]), nrows,
-                    &(L2->matrix[Gji][ji][bd]), nlinks, 1.0,
-                    &(W2[Gca][0][0]), ncols);
-          }
+  while(data->queue->next(task)) {
 
-          global_dpd_->free_dpd_block(Fints->matrix[Gkd], virtpi[Gd], Fints->params->coltot[Gkd]);
-        }
+    Gi = task.Gi; Gj = task.Gj; Gk = task.Gk;
+    i = task.i; j = task.j; k = task.k;
 
-        /* -E_ijlb * t_klca */
-        for(Gl=0; Gl < nirreps; Gl++) {
+    I = occ_off[Gi] + i;
+    J = occ_off[Gj] + j;
+    K = occ_off[Gk] + k;
+
+    Gkj = Gjk = Gk ^ Gj;
+    Gji = Gij = Gi ^ Gj;
+    Gik = Gki = Gi ^ Gk;
+    Gijk = Gi ^ Gj ^ Gk;
+
+    ij = T2->params->rowidx[I][J];
+    ji = T2->params->rowidx[J][I];
+    ik = T2->params->rowidx[I][K];
+    ki = T2->params->rowidx[K][I];
+    jk = T2->params->rowidx[J][K];
+    kj = T2->params->rowidx[K][J];
+
+    dijk = 0.0;
+    if(fIJ->params->rowtot[Gi])
+      dijk += fIJ->matrix[Gi][i][i];
+    if(fIJ->params->rowtot[Gj])
+      dijk += fIJ->matrix[Gj][j][j];
+    if(fIJ->params->rowtot[Gk])
+      dijk += fIJ->matrix[Gk][k][k];
+
+    /* Malloc space for the W intermediate */
+
+    // timer_on("malloc");
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+
+      W0[Gab] = ijk_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
+      W1[Gab] = ijk_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
+      W2[Gab] = ijk_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
+      W3[Gab] = ijk_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
+    }
+    // timer_off("malloc");
+
+    // timer_on("N7 Terms");
+
+    /* +F_idab * t_kjcd */
+    for(Gd=0; Gd < nirreps; Gd++) {
+
+      Gab = Gid = Gi ^ Gd;
+      Gc = Gkj ^ Gd;
+
+      /* Set up F integrals */
+      Fints->matrix[Gid] = ijk_block_matrix(virtpi[Gd], Fints->params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(Fints, Gid, Fints->row_offset[Gid][I], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
+
+      /* Set up T2 amplitudes */
+      cd = T2->col_offset[Gkj][Gc];
+
+      /* Set up multiplication parameters */
+      nrows = Fints->params->coltot[Gid];
+      ncols = virtpi[Gc];
+      nlinks = virtpi[Gd];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gid][0][0]), nrows,
+                &(T2->matrix[Gkj][kj][cd]), nlinks, 0.0,
+                &(W0[Gab][0][0]), ncols);
+
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gid][0][0]), nrows,
+                &(L2->matrix[Gkj][kj][cd]), nlinks, 0.0,
+                &(W2[Gab][0][0]), ncols);
+      }
+
+      ijk_free_block(Fints->matrix[Gid], virtpi[Gd], Fints->params->coltot[Gid]);
+    }
+
+    /* -E_jklc * t_ilab */
+    for(Gl=0; Gl < nirreps; Gl++) {
+
+      Gab = Gil = Gi ^ Gl;
+      Gc = Gjk ^ Gl;
+
+      /* Set up E integrals */
+      lc = Eints->col_offset[Gjk][Gl];
+
+      /* Set up T2 amplitudes */
+      il = T2->row_offset[Gil][I];
+
+      /* Set up multiplication parameters */
+      nrows = T2->params->coltot[Gil];
+      ncols = virtpi[Gc];
+      nlinks = occpi[Gl];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2->matrix[Gil][il][0]), nrows,
+                &(Eints->matrix[Gjk][jk][lc]), ncols, 1.0,
+                &(W0[Gab][0][0]), ncols);
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(L2->matrix[Gil][il][0]), nrows,
+                &(Eints->matrix[Gjk][jk][lc]), ncols, 1.0,
+                &(W2[Gab][0][0]), ncols);
+      }
+    }
+
+    /* Sort W[ab][c] --> W[ac][b] */
+    global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
+    global_dpd_->sort_3d(W2, W3, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
+
+    /* +F_idac * t_jkbd */
+    for(Gd=0; Gd < nirreps; Gd++) {
+
+      Gac = Gid = Gi ^ Gd;
+      Gb = Gjk ^ Gd;
+
+      Fints->matrix[Gid] = ijk_block_matrix(virtpi[Gd], Fints->params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(Fints, Gid, Fints->row_offset[Gid][I], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
+
+      bd = T2->col_offset[Gjk][Gb];
+
+      nrows = Fints->params->coltot[Gid];
+      ncols = virtpi[Gb];
+      nlinks = virtpi[Gd];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gid][0][0]), nrows,
+                &(T2->matrix[Gjk][jk][bd]), nlinks, 1.0,
+                &(W1[Gac][0][0]), ncols);
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gid][0][0]), nrows,
+                &(L2->matrix[Gjk][jk][bd]), nlinks, 1.0,
+                &(W3[Gac][0][0]), ncols);
+      }
+
+      ijk_free_block(Fints->matrix[Gid], virtpi[Gd], Fints->params->coltot[Gid]);
+    }
+
+    /* -E_kjlb * t_ilac */
+    for(Gl=0; Gl < nirreps; Gl++) {
+
+      Gac = Gil = Gi ^ Gl;
+      Gb = Gkj ^ Gl;
+
+      lb = Eints->col_offset[Gkj][Gl];
+
+      il = T2->row_offset[Gil][I];
+
+      nrows = T2->params->coltot[Gil];
+      ncols = virtpi[Gb];
+      nlinks = occpi[Gl];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2->matrix[Gil][il][0]), nrows,
+                &(Eints->matrix[Gkj][kj][lb]), ncols, 1.0,
+                &(W1[Gac][0][0]), ncols);
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(L2->matrix[Gil][il][0]), nrows,
+                &(Eints->matrix[Gkj][kj][lb]), ncols, 1.0,
+                &(W3[Gac][0][0]), ncols);
+      }
+    }
+
+    /* Sort W[ac][b] --> W[ca][b] */
+    global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+    global_dpd_->sort_3d(W3, W2, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+
+    /* +F_kdca * t_jibd */
+    for(Gd=0; Gd < nirreps; Gd++) {
+
+      Gca = Gkd = Gk ^ Gd;
+      Gb = Gji ^ Gd;
+
+      Fints->matrix[Gkd] = ijk_block_matrix(virtpi[Gd], Fints->params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(Fints, Gkd, Fints->row_offset[Gkd][K], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
+
+      bd = T2->col_offset[Gji][Gb];
+
+      nrows = Fints->params->coltot[Gkd];
+      ncols = virtpi[Gb];
+      nlinks = virtpi[Gd];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gkd][0][0]), nrows,
+                &(T2->matrix[Gji][ji][bd]), nlinks, 1.0,
+                &(W0[Gca][0][0]), ncols);
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gkd][0][0]), nrows,
+                &(L2->matrix[Gji][ji][bd]), nlinks, 1.0,
+                &(W2[Gca][0][0]), ncols);
+      }
+
+      ijk_free_block(Fints->matrix[Gkd], virtpi[Gd], Fints->params->coltot[Gkd]);
+    }
+
+    /* -E_ijlb * t_klca */
+    for(Gl=0; Gl < nirreps; Gl++) {
+
+      Gca = Gkl = Gk ^ Gl;
+      Gb = Gij ^ Gl;
+
+      lb = Eints->col_offset[Gij][Gl];
+
+      kl = T2->row_offset[Gkl][K];
+
+      nrows = T2->params->coltot[Gkl];
+      ncols = virtpi[Gb];
+      nlinks = occpi[Gl];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2->matrix[Gkl][kl][0]), nrows,
+                &(Eints->matrix[Gij][ij][lb]), ncols, 1.0,
+                &(W0[Gca][0][0]), ncols);
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(L2->matrix[Gkl][kl][0]), nrows,
+                &(Eints->matrix[Gij][ij][lb]), ncols, 1.0,
+                &(W2[Gca][0][0]), ncols);
+      }
+    }
+
+    /* Sort W[ca][b] --> W[cb][a] */
+    global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
+    global_dpd_->sort_3d(W2, W3, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
+
+    /* +F_kdcb * t_ijad */
+    for(Gd=0; Gd < nirreps; Gd++) {
+
+      Gcb = Gkd = Gk ^ Gd;
+      Ga = Gij ^ Gd;
+
+      Fints->matrix[Gkd] = ijk_block_matrix(virtpi[Gd], Fints->params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(Fints, Gkd, Fints->row_offset[Gkd][K], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
+
+      ad = T2->col_offset[Gij][Ga];
+
+      nrows = Fints->params->coltot[Gkd];
+      ncols = virtpi[Ga];
+      nlinks = virtpi[Gd];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gkd][0][0]), nrows,
+                &(T2->matrix[Gij][ij][ad]), nlinks, 1.0,
+                &(W1[Gcb][0][0]), ncols);
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gkd][0][0]), nrows,
+                &(L2->matrix[Gij][ij][ad]), nlinks, 1.0,
+                &(W3[Gcb][0][0]), ncols);
+      }
+
+      ijk_free_block(Fints->matrix[Gkd], virtpi[Gd], Fints->params->coltot[Gkd]);
+    }
+
+    /* -E_jila * t_klcb */
+    for(Gl=0; Gl < nirreps; Gl++) {
+
+      Gcb = Gkl = Gk ^ Gl;
+      Ga = Gji ^ Gl;
+
+      la = Eints->col_offset[Gji][Gl];
+
+      kl = T2->row_offset[Gkl][K];
+
+      nrows = T2->params->coltot[Gkl];
+      ncols = virtpi[Ga];
+      nlinks = occpi[Gl];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2->matrix[Gkl][kl][0]), nrows,
+                &(Eints->matrix[Gji][ji][la]), ncols, 1.0,
+                &(W1[Gcb][0][0]), ncols);
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(L2->matrix[Gkl][kl][0]), nrows,
+                &(Eints->matrix[Gji][ji][la]), ncols, 1.0,
+                &(W3[Gcb][0][0]), ncols);
+       }
+    }
+
+    /* Sort W[cb][a] --> W[bc][a] */
+    global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+    global_dpd_->sort_3d(W3, W2, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+
+    /* +F_jdbc * t_ikad */
+    for(Gd=0; Gd < nirreps; Gd++) {
+
+      Gbc = Gjd = Gj ^ Gd;
+      Ga = Gik ^ Gd;
+
+      Fints->matrix[Gjd] = ijk_block_matrix(virtpi[Gd], Fints->params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(Fints, Gjd, Fints->row_offset[Gjd][J], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
+
+      ad = T2->col_offset[Gik][Ga];
+
+      nrows = Fints->params->coltot[Gjd];
+      ncols = virtpi[Ga];
+      nlinks = virtpi[Gd];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gjd][0][0]), nrows,
+                &(T2->matrix[Gik][ik][ad]), nlinks, 1.0,
+                &(W0[Gbc][0][0]), ncols);
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gjd][0][0]), nrows,
+                &(L2->matrix[Gik][ik][ad]), nlinks, 1.0,
+                &(W2[Gbc][0][0]), ncols);
+      }
+
+      ijk_free_block(Fints->matrix[Gjd], virtpi[Gd], Fints->params->coltot[Gjd]);
+    }
+
+    /* -E_kila * t_jlbc */
+    for(Gl=0; Gl < nirreps; Gl++) {
+
+      Gbc = Gjl = Gj ^ Gl;
+      Ga = Gki ^ Gl;
+
+      la = Eints->col_offset[Gki][Gl];
+
+      jl = T2->row_offset[Gjl][J];
+
+      nrows = T2->params->coltot[Gjl];
+      ncols = virtpi[Ga];
+      nlinks = occpi[Gl];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2->matrix[Gjl][jl][0]), nrows,
+                &(Eints->matrix[Gki][ki][la]), ncols, 1.0,
+                &(W0[Gbc][0][0]), ncols);
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(L2->matrix[Gjl][jl][0]), nrows,
+                &(Eints->matrix[Gki][ki][la]), ncols, 1.0,
+                &(W2[Gbc][0][0]), ncols);
+      }
+    }
+
+    /* Sort W[bc][a] --> W[ba][c] */
+    global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
+    global_dpd_->sort_3d(W2, W3, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
+
+    /* +F_jdba * t_kicd */
+    for(Gd=0; Gd < nirreps; Gd++) {
+
+      Gba = Gjd = Gj ^ Gd;
+      Gc = Gki ^ Gd;
+
+      Fints->matrix[Gjd] = ijk_block_matrix(virtpi[Gd], Fints->params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(Fints, Gjd, Fints->row_offset[Gjd][J], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
+
+      cd = T2->col_offset[Gki][Gc];
+
+      nrows = Fints->params->coltot[Gjd];
+      ncols = virtpi[Gc];
+      nlinks = virtpi[Gd];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gjd][0][0]), nrows,
+                &(T2->matrix[Gki][ki][cd]), nlinks, 1.0,
+                &(W1[Gba][0][0]), ncols);
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints->matrix[Gjd][0][0]), nrows,
+                &(L2->matrix[Gki][ki][cd]), nlinks, 1.0,
+                &(W3[Gba][0][0]), ncols);
+      }
+
+      ijk_free_block(Fints->matrix[Gjd], virtpi[Gd], Fints->params->coltot[Gjd]);
+    }
+
+    /* -E_iklc * t_jlba */
+    for(Gl=0; Gl < nirreps; Gl++) {
+
+      Gba = Gjl = Gj ^ Gl;
+      Gc = Gik ^ Gl;
+
+      lc = Eints->col_offset[Gik][Gl];
+
+      jl = T2->row_offset[Gjl][J];
+
+      nrows = T2->params->coltot[Gjl];
+      ncols = virtpi[Gc];
+      nlinks = occpi[Gl];
+
+      if(nrows && ncols && nlinks) {
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2->matrix[Gjl][jl][0]), nrows,
+                &(Eints->matrix[Gik][ik][lc]), ncols, 1.0,
+                &(W1[Gba][0][0]), ncols);
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(L2->matrix[Gjl][jl][0]), nrows,
+                &(Eints->matrix[Gik][ik][lc]), ncols, 1.0,
+                &(W3[Gba][0][0]), ncols);
+       }
+    }
+
+    /* Sort W[ba][c] --> W[ab][c] */
+    global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+    global_dpd_->sort_3d(W3, W2, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
+           Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
+           vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+
+    // timer_off("N7 Terms");
+
+    // timer_on("malloc");
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+      ijk_free_block(W1[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
+      ijk_free_block(W3[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
+
+      V[Gab] = ijk_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
+    }
+    // timer_off("malloc");
+
+    // timer_on("EST Terms");
+
+    /* Add EST terms to V */
+
+    for(Gab=0; Gab < nirreps; Gab++) {
+
+      Gc = Gab ^ Gijk;
+
+      for(ab=0; ab < Fints->params->coltot[Gab]; ab++) {
+
+        A = Fints->params->colorb[Gab][ab][0];
+        Ga = Fints->params->rsym[A];
+        a = A - vir_off[Ga];
+        B = Fints->params->colorb[Gab][ab][1];
+        Gb = Fints->params->ssym[B];
+        b = B - vir_off[Gb];
+
+        Gbc = Gb ^ Gc;
+        Gac = Ga ^ Gc;
 
-          Gca = Gkl = Gk ^ Gl;
-          Gb = Gij ^ Gl;
+        for(c=0; c < virtpi[Gc]; c++) {
+          C = vir_off[Gc] + c;
 
-          lb = Eints->col_offset[Gij][Gl];
+          bc = Dints->params->colidx[B][C];
+          ac = Dints->params->colidx[A][C];
 
-          kl = T2->row_offset[Gkl][K];
+          /* +t_ia * D_jkbc + f_ia * t_jkbc */
+          if(Gi == Ga && Gjk == Gbc) {
+            t_ia = D_jkbc = 0.0;
+
+            if(L1->params->rowtot[Gi] && L1->params->coltot[Gi]) {
+              t_ia = L1->matrix[Gi][i][a];
+              f_ia = fIA->matrix[Gi][i][a];
+            }
 
-          nrows = T2->params->coltot[Gkl];
-          ncols = virtpi[Gb];
-          nlinks = occpi[Gl];
+            if(Dints->params->rowtot[Gjk] && Dints->params->coltot[Gjk]) {
+              D_jkbc = Dints->matrix[Gjk][jk][bc];
+              t_jkbc = L2->matrix[Gjk][jk][bc];
+            }
 
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(T2->matrix[Gkl][kl][0]), nrows,
-                    &(Eints->matrix[Gij][ij][lb]), ncols, 1.0,
-                    &(W0[Gca][0][0]), ncols);
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(L2->matrix[Gkl][kl][0]), nrows,
-                    &(Eints->matrix[Gij][ij][lb]), ncols, 1.0,
-                    &(W2[Gca][0][0]), ncols);
-          }
-        }
+            V[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
 
-        /* Sort W[ca][b] --> W[cb][a] */
-        global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
-        global_dpd_->sort_3d(W2, W3, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
-
-        /* +F_kdcb * t_ijad */
-        for(Gd=0; Gd < nirreps; Gd++) {
-
-          Gcb = Gkd = Gk ^ Gd;
-          Ga = Gij ^ Gd;
-
-          Fints->matrix[Gkd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints->params->coltot[Gkd]);
-          pthread_mutex_lock(&mut_at);
-          global_dpd_->buf4_mat_irrep_rd_block(Fints, Gkd, Fints->row_offset[Gkd][K], virtpi[Gd]);
-          pthread_mutex_unlock(&mut_at);
-
-          ad = T2->col_offset[Gij][Ga];
-
-          nrows = Fints->params->coltot[Gkd];
-          ncols = virtpi[Ga];
-          nlinks = virtpi[Gd];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gkd][0][0]), nrows,
-                    &(T2->matrix[Gij][ij][ad]), nlinks, 1.0,
-                    &(W1[Gcb][0][0]), ncols);
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gkd][0][0]), nrows,
-                    &(L2->matrix[Gij][ij][ad]), nlinks, 1.0,
-                    &(W3[Gcb][0][0]), ncols);
           }
 
-          global_dpd_->free_dpd_block(Fints->matrix[Gkd], virtpi[Gd], Fints->params->coltot[Gkd]);
-        }
-
-        /* -E_jila * t_klcb */
-        for(Gl=0; Gl < nirreps; Gl++) {
-
-          Gcb = Gkl = Gk ^ Gl;
-          Ga = Gji ^ Gl;
-
-          la = Eints->col_offset[Gji][Gl];
-
-          kl = T2->row_offset[Gkl][K];
+          /* +t_jb * D_ikac */
+          if(Gj == Gb && Gik == Gac) {
+            t_jb = D_ikac = 0.0;
 
-          nrows = T2->params->coltot[Gkl];
-          ncols = virtpi[Ga];
-          nlinks = occpi[Gl];
+            if(L1->params->rowtot[Gj] && L1->params->coltot[Gj]) {
+              t_jb = L1->matrix[Gj][j][b];
+              f_jb = fIA->matrix[Gj][j][b];
+            }
 
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(T2->matrix[Gkl][kl][0]), nrows,
-                    &(Eints->matrix[Gji][ji][la]), ncols, 1.0,
-                    &(W1[Gcb][0][0]), ncols);
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(L2->matrix[Gkl][kl][0]), nrows,
-                    &(Eints->matrix[Gji][ji][la]), ncols, 1.0,
-                    &(W3[Gcb][0][0]), ncols);
-           }
-        }
+            if(Dints->params->rowtot[Gik] && Dints->params->coltot[Gik]) {
+              D_ikac = Dints->matrix[Gik][ik][ac];
+              t_ikac = L2->matrix[Gik][ik][ac];
+            }
 
-        /* Sort W[cb][a] --> W[bc][a] */
-        global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
-        global_dpd_->sort_3d(W3, W2, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
-
-        /* +F_jdbc * t_ikad */
-        for(Gd=0; Gd < nirreps; Gd++) {
-
-          Gbc = Gjd = Gj ^ Gd;
-          Ga = Gik ^ Gd;
-
-          Fints->matrix[Gjd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints->params->coltot[Gjd]);
-          pthread_mutex_lock(&mut_at);
-          global_dpd_->buf4_mat_irrep_rd_block(Fints, Gjd, Fints->row_offset[Gjd][J], virtpi[Gd]);
-          pthread_mutex_unlock(&mut_at);
-
-          ad = T2->col_offset[Gik][Ga];
-
-          nrows = Fints->params->coltot[Gjd];
-          ncols = virtpi[Ga];
-          nlinks = virtpi[Gd];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gjd][0][0]), nrows,
-                    &(T2->matrix[Gik][ik][ad]), nlinks, 1.0,
-                    &(W0[Gbc][0][0]), ncols);
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gjd][0][0]), nrows,
-                    &(L2->matrix[Gik][ik][ad]), nlinks, 1.0,
-                    &(W2[Gbc][0][0]), ncols);
+            V[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
           }
 
-          global_dpd_->free_dpd_block(Fints->matrix[Gjd], virtpi[Gd], Fints->params->coltot[Gjd]);
-        }
+          /* +t_kc * D_ijab */
+          if(Gk == Gc && Gij == Gab) {
+            t_kc = D_ijab = 0.0;
 
-        /* -E_kila * t_jlbc */
-        for(Gl=0; Gl < nirreps; Gl++) {
-
-          Gbc = Gjl = Gj ^ Gl;
-          Ga = Gki ^ Gl;
-
-          la = Eints->col_offset[Gki][Gl];
-
-          jl = T2->row_offset[Gjl][J];
-
-          nrows = T2->params->coltot[Gjl];
-          ncols = virtpi[Ga];
-          nlinks = occpi[Gl];
+            if(L1->params->rowtot[Gk] && L1->params->coltot[Gk]) {
+              t_kc = L1->matrix[Gk][k][c];
+              f_kc = fIA->matrix[Gk][k][c];
+            }
 
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(T2->matrix[Gjl][jl][0]), nrows,
-                    &(Eints->matrix[Gki][ki][la]), ncols, 1.0,
-                    &(W0[Gbc][0][0]), ncols);
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(L2->matrix[Gjl][jl][0]), nrows,
-                    &(Eints->matrix[Gki][ki][la]), ncols, 1.0,
-                    &(W2[Gbc][0][0]), ncols);
-          }
-        }
+            if(Dints->params->rowtot[Gij] && Dints->params->coltot[Gij]) {
+              D_ijab = Dints->matrix[Gij][ij][ab];
+              t_ijab = L2->matrix[Gij][ij][ab];
+            }
 
-        /* Sort W[bc][a] --> W[ba][c] */
-        global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
-        global_dpd_->sort_3d(W2, W3, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, acb, 0);
-
-        /* +F_jdba * t_kicd */
-        for(Gd=0; Gd < nirreps; Gd++) {
-
-          Gba = Gjd = Gj ^ Gd;
-          Gc = Gki ^ Gd;
-
-          Fints->matrix[Gjd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints->params->coltot[Gjd]);
-          pthread_mutex_lock(&mut_at);
-          global_dpd_->buf4_mat_irrep_rd_block(Fints, Gjd, Fints->row_offset[Gjd][J], virtpi[Gd]);
-          pthread_mutex_unlock(&mut_at);
-
-          cd = T2->col_offset[Gki][Gc];
-
-          nrows = Fints->params->coltot[Gjd];
-          ncols = virtpi[Gc];
-          nlinks = virtpi[Gd];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gjd][0][0]), nrows,
-                    &(T2->matrix[Gki][ki][cd]), nlinks, 1.0,
-                    &(W1[Gba][0][0]), ncols);
-            C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-                    &(Fints->matrix[Gjd][0][0]), nrows,
-                    &(L2->matrix[Gki][ki][cd]), nlinks, 1.0,
-                    &(W3[Gba][0][0]), ncols);
+            V[Gab][ab][c] += t_kc * D_ijab + f_kc * t_ijab;
           }
 
-          global_dpd_->free_dpd_block(Fints->matrix[Gjd], virtpi[Gd], Fints->params->coltot[Gjd]);
-        }
-
-        /* -E_iklc * t_jlba */
-        for(Gl=0; Gl < nirreps; Gl++) {
-
-          Gba = Gjl = Gj ^ Gl;
-          Gc = Gik ^ Gl;
-
-          lc = Eints->col_offset[Gik][Gl];
-
-          jl = T2->row_offset[Gjl][J];
-
-          nrows = T2->params->coltot[Gjl];
-          ncols = virtpi[Gc];
-          nlinks = occpi[Gl];
-
-          if(nrows && ncols && nlinks) {
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(T2->matrix[Gjl][jl][0]), nrows,
-                    &(Eints->matrix[Gik][ik][lc]), ncols, 1.0,
-                    &(W1[Gba][0][0]), ncols);
-            C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-                    &(L2->matrix[Gjl][jl][0]), nrows,
-                    &(Eints->matrix[Gik][ik][lc]), ncols, 1.0,
-                    &(W3[Gba][0][0]), ncols);
-           }
         }
+      }
+    }
 
-        /* Sort W[ba][c] --> W[ab][c] */
-        global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
-        global_dpd_->sort_3d(W3, W2, nirreps, Gijk, Fints->params->coltot, Fints->params->colidx,
-               Fints->params->colorb, Fints->params->rsym, Fints->params->ssym,
-               vir_off, vir_off, virtpi, vir_off, Fints->params->colidx, bac, 0);
+    // timer_off("EST Terms");
 
-        // timer_off("N7 Terms");
+    // timer_on("Energy");
+    for(Gab=0; Gab < nirreps; Gab++) {
 
-        // timer_on("malloc");
-        for(Gab=0; Gab < nirreps; Gab++) {
-          Gc = Gab ^ Gijk;
-          global_dpd_->free_dpd_block(W1[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
-          global_dpd_->free_dpd_block(W3[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
+      Gc = Gab ^ Gijk;
+      Gba = Gab;
 
-          V[Gab] = global_dpd_->dpd_block_matrix(Fints->params->coltot[Gab],virtpi[Gc]);
-        }
-        // timer_off("malloc");
-
-        // timer_on("EST Terms");
-
-        /* Add EST terms to V */
-
-        for(Gab=0; Gab < nirreps; Gab++) {
-
-          Gc = Gab ^ Gijk;
-
-          for(ab=0; ab < Fints->params->coltot[Gab]; ab++) {
-
-            A = Fints->params->colorb[Gab][ab][0];
-            Ga = Fints->params->rsym[A];
-            a = A - vir_off[Ga];
-            B = Fints->params->colorb[Gab][ab][1];
-            Gb = Fints->params->ssym[B];
-            b = B - vir_off[Gb];
-
-            Gbc = Gb ^ Gc;
-            Gac = Ga ^ Gc;
+      for(ab=0; ab < Fints->params->coltot[Gab]; ab++) {
 
-            for(c=0; c < virtpi[Gc]; c++) {
-              C = vir_off[Gc] + c;
+        A = Fints->params->colorb[Gab][ab][0];
+        Ga = Fints->params->rsym[A];
+        a = A - vir_off[Ga];
+        B = Fints->params->colorb[Gab][ab][1];
+        Gb = Fints->params->ssym[B];
+        b = B - vir_off[Gb];
 
-              bc = Dints->params->colidx[B][C];
-              ac = Dints->params->colidx[A][C];
+        Gac = Gca = Ga ^ Gc;
+        Gbc = Gcb = Gb ^ Gc;
 
-              /* +t_ia * D_jkbc + f_ia * t_jkbc */
-              if(Gi == Ga && Gjk == Gbc) {
-                t_ia = D_jkbc = 0.0;
+        ba = Dints->params->colidx[B][A];
 
-                if(L1->params->rowtot[Gi] && L1->params->coltot[Gi]) {
-                  t_ia = L1->matrix[Gi][i][a];
-                  f_ia = fIA->matrix[Gi][i][a];
-                }
+        for(c=0; c < virtpi[Gc]; c++) {
+          C = vir_off[Gc] + c;
 
-                if(Dints->params->rowtot[Gjk] && Dints->params->coltot[Gjk]) {
-                  D_jkbc = Dints->matrix[Gjk][jk][bc];
-                  t_jkbc = L2->matrix[Gjk][jk][bc];
-                }
+          ac = Dints->params->colidx[A][C];
+          ca = Dints->params->colidx[C][A];
+          bc = Dints->params->colidx[B][C];
+          cb = Dints->params->colidx[C][B];
 
-                V[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
+          denom = dijk;
+          if(fAB->params->rowtot[Ga])
+            denom -= fAB->matrix[Ga][a][a];
+          if(fAB->params->rowtot[Gb])
+            denom -= fAB->matrix[Gb][b][b];
+          if(fAB->params->rowtot[Gc])
+            denom -= fAB->matrix[Gc][c][c];
 
-              }
+          value1 = 4.0 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b];
+          value2 = W2[Gab][ab][c] + V[Gab][ab][c] - W2[Gcb][cb][a] - V[Gcb][cb][a];
 
-              /* +t_jb * D_ikac */
-              if(Gj == Gb && Gik == Gac) {
-                t_jb = D_ikac = 0.0;
+          *ET_local += (value1 * value2)/denom;
 
-                if(L1->params->rowtot[Gj] && L1->params->coltot[Gj]) {
-                  t_jb = L1->matrix[Gj][j][b];
-                  f_jb = fIA->matrix[Gj][j][b];
-                }
+        } // c
 
-                if(Dints->params->rowtot[Gik] && Dints->params->coltot[Gik]) {
-                  D_ikac = Dints->matrix[Gik][ik][ac];
-                  t_ikac = L2->matrix[Gik][ik][ac];
-                }
+      } // ab
 
-                V[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
-              }
-
-              /* +t_kc * D_ijab */
-              if(Gk == Gc && Gij == Gab) {
-                t_kc = D_ijab = 0.0;
-
-                if(L1->params->rowtot[Gk] && L1->params->coltot[Gk]) {
-                  t_kc = L1->matrix[Gk][k][c];
-                  f_kc = fIA->matrix[Gk][k][c];
-                }
-
-                if(Dints->params->rowtot[Gij] && Dints->params->coltot[Gij]) {
-                  D_ijab = Dints->matrix[Gij][ij][ab];
-                  t_ijab = L2->matrix[Gij][ij][ab];
-                }
-
-                V[Gab][ab][c] += t_kc * D_ijab + f_kc * t_ijab;
-              }
-
-            }
-          }
-        }
+    } // Gab
 
-        // timer_off("EST Terms");
+    // timer_off("Energy");
 
-        // timer_on("Energy");
-        for(Gab=0; Gab < nirreps; Gab++) {
+    /* Free the W and V intermediates */
+    // timer_on("malloc");
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
 
-          Gc = Gab ^ Gijk;
-          Gba = Gab;
+      ijk_free_block(W0[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
+      ijk_free_block(W2[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
+      ijk_free_block(V[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
+    }
+    // timer_off("malloc");
 
-          for(ab=0; ab < Fints->params->coltot[Gab]; ab++) {
-
-            A = Fints->params->colorb[Gab][ab][0];
-            Ga = Fints->params->rsym[A];
-            a = A - vir_off[Ga];
-            B = Fints->params->colorb[Gab][ab][1];
-            Gb = Fints->params->ssym[B];
-            b = B - vir_off[Gb];
-
-            Gac = Gca = Ga ^ Gc;
-            Gbc = Gcb = Gb ^ Gc;
-
-            ba = Dints->params->colidx[B][A];
-
-            for(c=0; c < virtpi[Gc]; c++) {
-              C = vir_off[Gc] + c;
-
-              ac = Dints->params->colidx[A][C];
-              ca = Dints->params->colidx[C][A];
-              bc = Dints->params->colidx[B][C];
-              cb = Dints->params->colidx[C][B];
-
-              denom = dijk;
-              if(fAB->params->rowtot[Ga])
-                denom -= fAB->matrix[Ga][a][a];
-              if(fAB->params->rowtot[Gb])
-                denom -= fAB->matrix[Gb][b][b];
-              if(fAB->params->rowtot[Gc])
-                denom -= fAB->matrix[Gc][c][c];
-
-              value1 = 4.0 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b];
-              value2 = W2[Gab][ab][c] + V[Gab][ab][c] - W2[Gcb][cb][a] - V[Gcb][cb][a];
-
-              *ET_local += (value1 * value2)/denom;
-
-            } // c
-
-          } // ab
-
-        } // Gab
-
-        // timer_off("Energy");
-
-        /* Free the W and V intermediates */
-        // timer_on("malloc");
-        for(Gab=0; Gab < nirreps; Gab++) {
-          Gc = Gab ^ Gijk;
-
-          global_dpd_->free_dpd_block(W0[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
-          global_dpd_->free_dpd_block(W2[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
-          global_dpd_->free_dpd_block(V[Gab],Fints->params->coltot[Gab],virtpi[Gc]);
-        }
-        // timer_off("malloc");
+  } /* ijk */
 
-      } /* k */
-    } /* j */
-  } /* i */
+  free(W0); free(W1); free(W2); free(W3); free(V);
 
   pthread_exit(NULL);
 }
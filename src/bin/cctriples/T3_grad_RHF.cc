@@ -25,51 +25,47 @@
     \brief Computes T3-dependent terms needed in cclambda and
     ccdensity for (T) contributions to the CCSD(T) energy gradient.
 */
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
 #include <libciomr/libciomr.h>
 #include <libdpd/dpd.h>
 #include <libqt/qt.h>
+#include <pthread.h>
 #include "MOInfo.h"
 #include "Params.h"
+#include "ijk_tasks.h"
 #define EXTERN
 #include "globals.h"
 
 namespace psi { namespace cctriples {
 
+struct T3_grad_RHF_data {
+  dpdfile2 *fIJ; dpdfile2 *fAB; dpdfile2 *fIA; dpdfile2 *T1; dpdfile2 *S1;
+  dpdbuf4 *T2; dpdbuf4 *Eints; dpdbuf4 *Dints; dpdbuf4 *S2;
+  dpdbuf4 Fints;
+  IJKQueue *queue; double ET;
+};
+
+/* S1 and S2 are accumulated by all threads */
+static pthread_mutex_t T3_grad_RHF_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void *T3_grad_RHF_thread(void *thread_data);
+
     void T3_grad_RHF(void)
     {
       int h, nirreps;
-      int I, J, K, A, B, C, D, L;
-      int i, j, k, a, b, c, d, l;
-      int ij, ji, ik, ki, jk, kj;
-      int ab, ba, ac, ca, bc, cb;
-      int il, jl, kl;
-      int ad, bd, cd;
-      int la, lb, lc;
-      int Gi, Gj, Gk, Ga, Gb, Gc, Gd, Gl;
-      int Gij, Gji, Gik, Gki, Gjk, Gkj, Gijk;
-      int Gid, Gjd, Gkd, Gil, Gjl, Gkl;
-      int Gab, Gba, Gac, Gca, Gbc, Gcb;
-      int nrows, ncols, nlinks;
-      int *occpi, *virtpi, *occ_off, *vir_off;
-      double t_ia, t_jb, t_kc, D_jkbc, D_ikac, D_ijab;
-      double f_ia, f_jb, f_kc, t_jkbc, t_ikac, t_ijab;
-      double dijk, denom;
-      double ***W0, ***W1, ***M, ***V;
-      dpdbuf4 T2, Fints, Eints, Dints, S2, F2ints;
+      int nthreads, thread;
+      int *occpi, *occ_off;
+      dpdbuf4 T2, Eints, Dints, S2, F2ints;
       dpdfile2 fIJ, fAB, fIA, T1, S1;
-      int nijk, mijk;
       FILE *ijkfile;
-      double value, value1, value2, ET=0.0;
-      int id;
-      double **Z;
+      double ET;
+      struct T3_grad_RHF_data *thread_data_array;
 
       nirreps = moinfo.nirreps;
-      occpi = moinfo.occpi; virtpi = moinfo.virtpi;
+      occpi = moinfo.occpi;
       occ_off = moinfo.occ_off;
-      vir_off = moinfo.vir_off;
 
       global_dpd_->file2_init(&fIJ, PSIF_CC_OEI, 0, 0, 0, "fIJ");
       global_dpd_->file2_init(&fAB, PSIF_CC_OEI, 0, 1, 1, "fAB");
@@ -90,7 +86,6 @@ namespace psi { namespace cctriples {
 
       global_dpd_->buf4_init(&T2, PSIF_CC_TAMPS, 0, 0, 5, 0, 5, 0, "tIjAb");
       global_dpd_->buf4_init(&S2, PSIF_CC_MISC, 0, 0, 5, 0, 5, 0, "SIjAb");
-      global_dpd_->buf4_init(&Fints, PSIF_CC_FINTS, 0, 10, 5, 10, 5, 0, "F <ia|bc>");
       global_dpd_->buf4_init(&F2ints, PSIF_CC_FINTS, 0, 10, 5, 10, 5, 0, "F <ia|bc>");
       global_dpd_->buf4_init(&Eints, PSIF_CC_EINTS, 0, 0, 10, 0, 10, 0, "E <ij|ka>");
       global_dpd_->buf4_init(&Dints, PSIF_CC_DINTS, 0, 0, 5, 0, 5, 0, "D <ij|ab>");
@@ -110,687 +105,778 @@ namespace psi { namespace cctriples {
 	global_dpd_->buf4_mat_irrep_rd(&Dints, h);
       }
 
-      /* Compute the number of IJK combinations */
-      /* For now, we need all combinations for gradients */
-      nijk = 0;
-      for(Gi=0; Gi < nirreps; Gi++)
-	for(Gj=0; Gj < nirreps; Gj++)
-	  for(Gk=0; Gk < nirreps; Gk++)
-	    for(i=0; i < occpi[Gi]; i++) {
-	      I = occ_off[Gi] + i;
-	      for(j=0; j < occpi[Gj]; j++) {
-		J = occ_off[Gj] + j;
-		for(k=0; k < occpi[Gk]; k++) {
-		  K = occ_off[Gk] + k;
-
-		  nijk++;
-		}
-	      }
-	    }
+      /* For now, we need all IJK combinations for gradients.  They all
+         go into one queue, which the threads draw from until it is empty */
+      IJKQueue queue(nirreps, occpi, occ_off, occpi, occ_off, occpi, occ_off, IJK_ALL);
 
       ffile(&ijkfile,"ijk.dat", 0);
-      fprintf(ijkfile, "Number of IJK combintions: %d\n", nijk);
-      fprintf(ijkfile, "\nCurrent IJK Combination: ");
-
-      W0 = (double ***) malloc(nirreps * sizeof(double **));
-      W1 = (double ***) malloc(nirreps * sizeof(double **));
-      M = (double ***) malloc(nirreps * sizeof(double **));
-      V = (double ***) malloc(nirreps * sizeof(double **));
-
-      mijk = 0;
-      for(Gi=0; Gi < nirreps; Gi++) {
-	for(Gj=0; Gj < nirreps; Gj++) {
-	  for(Gk=0; Gk < nirreps; Gk++) {
-
-	    Gkj = Gjk = Gk ^ Gj;
-	    Gji = Gij = Gi ^ Gj;
-	    Gik = Gki = Gi ^ Gk;
-
-	    Gijk = Gi ^ Gj ^ Gk;
-
-	    for(i=0; i < occpi[Gi]; i++) {
-	      I = occ_off[Gi] + i;
-	      for(j=0; j < occpi[Gj]; j++) {
-		J = occ_off[Gj] + j;
-		for(k=0; k < occpi[Gk]; k++) {
-		  K = occ_off[Gk] + k;
-
-		  mijk++;
-		  fprintf(ijkfile, "%d\n", mijk);
-		  fflush(ijkfile);
-
-		  ij = T2.params->rowidx[I][J];
-		  ji = T2.params->rowidx[J][I];
-		  ik = T2.params->rowidx[I][K];
-		  ki = T2.params->rowidx[K][I];
-		  jk = T2.params->rowidx[J][K];
-		  kj = T2.params->rowidx[K][J];
-
-		  dijk = 0.0;
-		  if(fIJ.params->rowtot[Gi])
-		    dijk += fIJ.matrix[Gi][i][i];
-		  if(fIJ.params->rowtot[Gj])
-		    dijk += fIJ.matrix[Gj][j][j];
-		  if(fIJ.params->rowtot[Gk])
-		    dijk += fIJ.matrix[Gk][k][k];
-
-		  /* Malloc space for the W intermediate */
-		  timer_on("malloc");
-		  for(Gab=0; Gab < nirreps; Gab++) {
-		    Gc = Gab ^ Gijk;
+      fprintf(ijkfile, "Number of IJK combintions: %d\n", queue.size());
+      fprintf(ijkfile, "\nCurrent IJK Combination:\n");
+      fflush(ijkfile);
+      queue.set_progress(ijkfile);
+
+      /* each thread gets its own F buffer to read blocks into and its own
+         W, V and M intermediates - S1 and S2 are shared */
+      nthreads = params.nthreads;
+      thread_data_array = (struct T3_grad_RHF_data *) malloc(nthreads*sizeof(struct T3_grad_RHF_data));
+      for(thread=0; thread < nthreads; thread++) {
+	thread_data_array[thread].fIJ = &fIJ;
+	thread_data_array[thread].fAB = &fAB;
+	thread_data_array[thread].fIA = &fIA;
+	thread_data_array[thread].T1 = &T1;
+	thread_data_array[thread].S1 = &S1;
+	thread_data_array[thread].T2 = &T2;
+	thread_data_array[thread].Eints = &Eints;
+	thread_data_array[thread].Dints = &Dints;
+	thread_data_array[thread].S2 = &S2;
+	global_dpd_->buf4_init(&(thread_data_array[thread].Fints), PSIF_CC_FINTS, 0, 10, 5, 10, 5, 0, "F <ia|bc>");
+	thread_data_array[thread].queue = &queue;
+	thread_data_array[thread].ET = 0.0;
+      }
+
+      ijk_threads(nthreads, T3_grad_RHF_thread, thread_data_array, sizeof(struct T3_grad_RHF_data));
+
+      ET = 0.0;
+      for(thread=0; thread < nthreads; thread++) {
+	ET += thread_data_array[thread].ET;
+	global_dpd_->buf4_close(&(thread_data_array[thread].Fints));
+      }
+
+      free(thread_data_array);
+
+      fprintf(outfile, "\tE(T) = %20.14f\n", ET);
+
+      fclose(ijkfile);
+
+      for(h=0; h < nirreps; h++) {
+	global_dpd_->buf4_mat_irrep_wrt(&S2, h);
+	global_dpd_->buf4_mat_irrep_close(&S2, h);
+	global_dpd_->buf4_mat_irrep_close(&T2, h);
+	global_dpd_->buf4_mat_irrep_close(&Eints, h);
+	global_dpd_->buf4_mat_irrep_close(&F2ints, h);
+	global_dpd_->buf4_mat_irrep_close(&Dints, h);
+      }
+      global_dpd_->buf4_print(&S2, outfile, 1);
+      global_dpd_->buf4_close(&S2);
+      global_dpd_->buf4_close(&T2);
+      global_dpd_->buf4_close(&Eints);
+      global_dpd_->buf4_close(&Dints);
+      global_dpd_->buf4_close(&F2ints);
+
+      global_dpd_->file2_mat_wrt(&S1);
+      global_dpd_->file2_mat_close(&S1);
+      global_dpd_->file2_print(&S1, outfile);
+      global_dpd_->file2_close(&S1);
+
+      global_dpd_->file2_mat_close(&T1);
+      global_dpd_->file2_close(&T1);
+
+      global_dpd_->file2_mat_close(&fIJ);
+      global_dpd_->file2_mat_close(&fAB);
+      global_dpd_->file2_mat_close(&fIA);
+      global_dpd_->file2_close(&fIJ);
+      global_dpd_->file2_close(&fAB);
+      global_dpd_->file2_close(&fIA);
+    }
+
+void *T3_grad_RHF_thread(void *thread_data_in)
+{
+  int nirreps, nvirt;
+  int I, J, K, A, B, C;
+  int i, j, k, a, b, c;
+  int ij, ji, ik, ki, jk, kj;
+  int ab, ba, ac, ca, bc, cb;
+  int il, jl, kl;
+  int ad, bd, cd;
+  int la, lb, lc;
+  int Gi, Gj, Gk, Ga, Gb, Gc, Gd, Gl;
+  int Gij, Gji, Gik, Gki, Gjk, Gkj, Gijk;
+  int Gid, Gjd, Gkd, Gil, Gjl, Gkl;
+  int Gab, Gba, Gac, Gca, Gbc, Gcb;
+  int nrows, ncols, nlinks;
+  int *occpi, *virtpi, *occ_off, *vir_off;
+  double t_ia, t_jb, t_kc, D_jkbc, D_ikac, D_ijab;
+  double f_ia, f_jb, f_kc, t_jkbc, t_ikac, t_ijab;
+  double dijk, denom;
+  double ***W0, ***W1, ***M, ***V;
+  double value, value1, value2, ET;
+  double *s1, *S2kj, **Z;
+  int id;
+  struct T3_grad_RHF_data *data;
+  IJKTask task;
+
+  data = (struct T3_grad_RHF_data *) thread_data_in;
+  dpdfile2 &fIJ = *(data->fIJ);
+  dpdfile2 &fAB = *(data->fAB);
+  dpdfile2 &fIA = *(data->fIA);
+  dpdfile2 &T1 = *(data->T1);
+  dpdfile2 &S1 = *(data->S1);
+  dpdbuf4 &T2 = *(data->T2);
+  dpdbuf4 &Eints = *(data->Eints);
+  dpdbuf4 &Dints = *(data->Dints);
+  dpdbuf4 &S2 = *(data->S2);
+  dpdbuf4 &Fints = data->Fints;
+
+  nirreps = moinfo.nirreps;
+  occpi = moinfo.occpi; virtpi = moinfo.virtpi;
+  occ_off = moinfo.occ_off;
+  vir_off = moinfo.vir_off;
+
+  W0 = (double ***) malloc(nirreps * sizeof(double **));
+  W1 = (double ***) malloc(nirreps * sizeof(double **));
+  M = (double ***) malloc(nirreps * sizeof(double **));
+  V = (double ***) malloc(nirreps * sizeof(double **));
+
+  /* this thread's S1 contributions for the current i */
+  nvirt = 0;
+  for(Ga=0; Ga < nirreps; Ga++)
+    if(virtpi[Ga] > nvirt) nvirt = virtpi[Ga];
+  s1 = init_array(nvirt);
+
+  ET = 0.0;
+
+  while(data->queue->next(task)) {
+
+    Gi = task.Gi; Gj = task.Gj; Gk = task.Gk;
+    i = task.i; j = task.j; k = task.k;
+
+    I = occ_off[Gi] + i;
+    J = occ_off[Gj] + j;
+    K = occ_off[Gk] + k;
+
+    Gkj = Gjk = Gk ^ Gj;
+    Gji = Gij = Gi ^ Gj;
+    Gik = Gki = Gi ^ Gk;
+
+    Gijk = Gi ^ Gj ^ Gk;
+
+    ij = T2.params->rowidx[I][J];
+    ji = T2.params->rowidx[J][I];
+    ik = T2.params->rowidx[I][K];
+    ki = T2.params->rowidx[K][I];
+    jk = T2.params->rowidx[J][K];
+    kj = T2.params->rowidx[K][J];
+
+    dijk = 0.0;
+    if(fIJ.params->rowtot[Gi])
+      dijk += fIJ.matrix[Gi][i][i];
+    if(fIJ.params->rowtot[Gj])
+      dijk += fIJ.matrix[Gj][j][j];
+    if(fIJ.params->rowtot[Gk])
+      dijk += fIJ.matrix[Gk][k][k];
+
+    /* Malloc space for the W intermediate */
+    // timer_on("malloc");
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+
+      W0[Gab] = ijk_block_matrix(Fints.params->coltot[Gab],virtpi[Gc]);
+      W1[Gab] = ijk_block_matrix(Fints.params->coltot[Gab],virtpi[Gc]);
+      V[Gab] = ijk_block_matrix(Fints.params->coltot[Gab],virtpi[Gc]);
+      M[Gab] = ijk_block_matrix(Fints.params->coltot[Gab], virtpi[Gc]);
+    }
+    // timer_off("malloc");
+
+    /**** Build T3(c) for curent i,j,k;  Result stored in W0 ****/
 
-		    W0[Gab] = global_dpd_->dpd_block_matrix(Fints.params->coltot[Gab],virtpi[Gc]);
-		    W1[Gab] = global_dpd_->dpd_block_matrix(Fints.params->coltot[Gab],virtpi[Gc]);
-		    V[Gab] = global_dpd_->dpd_block_matrix(Fints.params->coltot[Gab],virtpi[Gc]);
-		    M[Gab] = global_dpd_->dpd_block_matrix(Fints.params->coltot[Gab], virtpi[Gc]);
-		  }
-		  timer_off("malloc");
+    // timer_on("N7 Terms");
 
-		  /**** Build T3(c) for curent i,j,k;  Result stored in W0 ****/
+    /* +F_idab * t_kjcd */
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		  timer_on("N7 Terms");
-
-		  /* +F_idab * t_kjcd */
-		  for(Gd=0; Gd < nirreps; Gd++) {
-
-		    Gab = Gid = Gi ^ Gd;
-		    Gc = Gkj ^ Gd;
+      Gab = Gid = Gi ^ Gd;
+      Gc = Gkj ^ Gd;
 
-		    /* Set up F integrals */
-		    Fints.matrix[Gid] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gid]);
-		    global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gid, Fints.row_offset[Gid][I], virtpi[Gd]);
+      /* Set up F integrals */
+      Fints.matrix[Gid] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gid, Fints.row_offset[Gid][I], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		    /* Set up T2 amplitudes */
-		    cd = T2.col_offset[Gkj][Gc];
+      /* Set up T2 amplitudes */
+      cd = T2.col_offset[Gkj][Gc];
 
-		    /* Set up multiplication parameters */
-		    nrows = Fints.params->coltot[Gid];
-		    ncols = virtpi[Gc];
-		    nlinks = virtpi[Gd];
+      /* Set up multiplication parameters */
+      nrows = Fints.params->coltot[Gid];
+      ncols = virtpi[Gc];
+      nlinks = virtpi[Gd];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			      &(Fints.matrix[Gid][0][0]), nrows, 
-			      &(T2.matrix[Gkj][kj][cd]), nlinks, 0.0,
-			      &(W0[Gab][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints.matrix[Gid][0][0]), nrows, 
+                &(T2.matrix[Gkj][kj][cd]), nlinks, 0.0,
+                &(W0[Gab][0][0]), ncols);
 
-		    global_dpd_->free_dpd_block(Fints.matrix[Gid], virtpi[Gd], Fints.params->coltot[Gid]);
-		  }
+      ijk_free_block(Fints.matrix[Gid], virtpi[Gd], Fints.params->coltot[Gid]);
+    }
 
-		  /* -E_jklc * t_ilab */
-		  for(Gl=0; Gl < nirreps; Gl++) {
+    /* -E_jklc * t_ilab */
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		    Gab = Gil = Gi ^ Gl;
-		    Gc = Gjk ^ Gl;
+      Gab = Gil = Gi ^ Gl;
+      Gc = Gjk ^ Gl;
 
-		    /* Set up E integrals */
-		    lc = Eints.col_offset[Gjk][Gl];
+      /* Set up E integrals */
+      lc = Eints.col_offset[Gjk][Gl];
 
-		    /* Set up T2 amplitudes */
-		    il = T2.row_offset[Gil][I];
+      /* Set up T2 amplitudes */
+      il = T2.row_offset[Gil][I];
 
-		    /* Set up multiplication parameters */
-		    nrows = T2.params->coltot[Gil];
-		    ncols = virtpi[Gc];
-		    nlinks = occpi[Gl];
+      /* Set up multiplication parameters */
+      nrows = T2.params->coltot[Gil];
+      ncols = virtpi[Gc];
+      nlinks = occpi[Gl];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			      &(T2.matrix[Gil][il][0]), nrows,
-			      &(Eints.matrix[Gjk][jk][lc]), ncols, 1.0,
-			      &(W0[Gab][0][0]), ncols);
-		  }
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2.matrix[Gil][il][0]), nrows,
+                &(Eints.matrix[Gjk][jk][lc]), ncols, 1.0,
+                &(W0[Gab][0][0]), ncols);
+    }
 
-		  /* Sort W[ab][c] --> W[ac][b] */
-          global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
-			      Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
-			      vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, acb, 0);
+    /* Sort W[ab][c] --> W[ac][b] */
+    global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
+                     Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
+                     vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, acb, 0);
 
-		  /* +F_idac * t_jkbd */
-		  for(Gd=0; Gd < nirreps; Gd++) {
+    /* +F_idac * t_jkbd */
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		    Gac = Gid = Gi ^ Gd;
-		    Gb = Gjk ^ Gd;
+      Gac = Gid = Gi ^ Gd;
+      Gb = Gjk ^ Gd;
 
-		    Fints.matrix[Gid] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gid]);
-		    global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gid, Fints.row_offset[Gid][I], virtpi[Gd]);
+      Fints.matrix[Gid] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gid]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gid, Fints.row_offset[Gid][I], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		    bd = T2.col_offset[Gjk][Gb];
+      bd = T2.col_offset[Gjk][Gb];
 
-		    nrows = Fints.params->coltot[Gid];
-		    ncols = virtpi[Gb];
-		    nlinks = virtpi[Gd];
+      nrows = Fints.params->coltot[Gid];
+      ncols = virtpi[Gb];
+      nlinks = virtpi[Gd];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			      &(Fints.matrix[Gid][0][0]), nrows, 
-			      &(T2.matrix[Gjk][jk][bd]), nlinks, 1.0,
-			      &(W1[Gac][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints.matrix[Gid][0][0]), nrows, 
+                &(T2.matrix[Gjk][jk][bd]), nlinks, 1.0,
+                &(W1[Gac][0][0]), ncols);
 
-		    global_dpd_->free_dpd_block(Fints.matrix[Gid], virtpi[Gd], Fints.params->coltot[Gid]);
-		  }
+      ijk_free_block(Fints.matrix[Gid], virtpi[Gd], Fints.params->coltot[Gid]);
+    }
 
-		  /* -E_kjlb * t_ilac */
-		  for(Gl=0; Gl < nirreps; Gl++) {
+    /* -E_kjlb * t_ilac */
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		    Gac = Gil = Gi ^ Gl;
-		    Gb = Gkj ^ Gl;
+      Gac = Gil = Gi ^ Gl;
+      Gb = Gkj ^ Gl;
 
-		    lb = Eints.col_offset[Gkj][Gl];
+      lb = Eints.col_offset[Gkj][Gl];
 
-		    il = T2.row_offset[Gil][I];
+      il = T2.row_offset[Gil][I];
 
-		    nrows = T2.params->coltot[Gil];
-		    ncols = virtpi[Gb];
-		    nlinks = occpi[Gl];
+      nrows = T2.params->coltot[Gil];
+      ncols = virtpi[Gb];
+      nlinks = occpi[Gl];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			      &(T2.matrix[Gil][il][0]), nrows,
-			      &(Eints.matrix[Gkj][kj][lb]), ncols, 1.0,
-			      &(W1[Gac][0][0]), ncols);
-		  }
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2.matrix[Gil][il][0]), nrows,
+                &(Eints.matrix[Gkj][kj][lb]), ncols, 1.0,
+                &(W1[Gac][0][0]), ncols);
+    }
 
-		  /* Sort W[ac][b] --> W[ca][b] */
-          global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
-			      Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
-			      vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, bac, 0);
+    /* Sort W[ac][b] --> W[ca][b] */
+    global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
+                     Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
+                     vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, bac, 0);
 
-		  /* +F_kdca * t_jibd */
-		  for(Gd=0; Gd < nirreps; Gd++) {
+    /* +F_kdca * t_jibd */
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		    Gca = Gkd = Gk ^ Gd;
-		    Gb = Gji ^ Gd;
+      Gca = Gkd = Gk ^ Gd;
+      Gb = Gji ^ Gd;
 
-		    Fints.matrix[Gkd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gkd]);
-		    global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gkd, Fints.row_offset[Gkd][K], virtpi[Gd]);
+      Fints.matrix[Gkd] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gkd, Fints.row_offset[Gkd][K], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		    bd = T2.col_offset[Gji][Gb];
+      bd = T2.col_offset[Gji][Gb];
 
-		    nrows = Fints.params->coltot[Gkd];
-		    ncols = virtpi[Gb];
-		    nlinks = virtpi[Gd];
+      nrows = Fints.params->coltot[Gkd];
+      ncols = virtpi[Gb];
+      nlinks = virtpi[Gd];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			      &(Fints.matrix[Gkd][0][0]), nrows, 
-			      &(T2.matrix[Gji][ji][bd]), nlinks, 1.0,
-			      &(W0[Gca][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints.matrix[Gkd][0][0]), nrows, 
+                &(T2.matrix[Gji][ji][bd]), nlinks, 1.0,
+                &(W0[Gca][0][0]), ncols);
 
-		    global_dpd_->free_dpd_block(Fints.matrix[Gkd], virtpi[Gd], Fints.params->coltot[Gkd]);
-		  }
+      ijk_free_block(Fints.matrix[Gkd], virtpi[Gd], Fints.params->coltot[Gkd]);
+    }
 
-		  /* -E_ijlb * t_klca */
-		  for(Gl=0; Gl < nirreps; Gl++) {
+    /* -E_ijlb * t_klca */
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		    Gca = Gkl = Gk ^ Gl;
-		    Gb = Gij ^ Gl;
+      Gca = Gkl = Gk ^ Gl;
+      Gb = Gij ^ Gl;
 
-		    lb = Eints.col_offset[Gij][Gl];
+      lb = Eints.col_offset[Gij][Gl];
 
-		    kl = T2.row_offset[Gkl][K];
+      kl = T2.row_offset[Gkl][K];
 
-		    nrows = T2.params->coltot[Gkl];
-		    ncols = virtpi[Gb];
-		    nlinks = occpi[Gl];
+      nrows = T2.params->coltot[Gkl];
+      ncols = virtpi[Gb];
+      nlinks = occpi[Gl];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			      &(T2.matrix[Gkl][kl][0]), nrows,
-			      &(Eints.matrix[Gij][ij][lb]), ncols, 1.0,
-			      &(W0[Gca][0][0]), ncols);
-		  }
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2.matrix[Gkl][kl][0]), nrows,
+                &(Eints.matrix[Gij][ij][lb]), ncols, 1.0,
+                &(W0[Gca][0][0]), ncols);
+    }
 
-		  /* Sort W[ca][b] --> W[cb][a] */
-          global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
-			      Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
-			      vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, acb, 0);
+    /* Sort W[ca][b] --> W[cb][a] */
+    global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
+                     Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
+                     vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, acb, 0);
 
-		  /* +F_kdcb * t_ijad */
-		  for(Gd=0; Gd < nirreps; Gd++) {
+    /* +F_kdcb * t_ijad */
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		    Gcb = Gkd = Gk ^ Gd;
-		    Ga = Gij ^ Gd;
+      Gcb = Gkd = Gk ^ Gd;
+      Ga = Gij ^ Gd;
 
-		    Fints.matrix[Gkd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gkd]);
-		    global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gkd, Fints.row_offset[Gkd][K], virtpi[Gd]);
+      Fints.matrix[Gkd] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gkd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gkd, Fints.row_offset[Gkd][K], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		    ad = T2.col_offset[Gij][Ga];
+      ad = T2.col_offset[Gij][Ga];
 
-		    nrows = Fints.params->coltot[Gkd];
-		    ncols = virtpi[Ga];
-		    nlinks = virtpi[Gd];
+      nrows = Fints.params->coltot[Gkd];
+      ncols = virtpi[Ga];
+      nlinks = virtpi[Gd];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			      &(Fints.matrix[Gkd][0][0]), nrows, 
-			      &(T2.matrix[Gij][ij][ad]), nlinks, 1.0,
-			      &(W1[Gcb][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints.matrix[Gkd][0][0]), nrows, 
+                &(T2.matrix[Gij][ij][ad]), nlinks, 1.0,
+                &(W1[Gcb][0][0]), ncols);
 
-		    global_dpd_->free_dpd_block(Fints.matrix[Gkd], virtpi[Gd], Fints.params->coltot[Gkd]);
-		  }
+      ijk_free_block(Fints.matrix[Gkd], virtpi[Gd], Fints.params->coltot[Gkd]);
+    }
 
-		  /* -E_jila * t_klcb */
-		  for(Gl=0; Gl < nirreps; Gl++) {
+    /* -E_jila * t_klcb */
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		    Gcb = Gkl = Gk ^ Gl;
-		    Ga = Gji ^ Gl;
+      Gcb = Gkl = Gk ^ Gl;
+      Ga = Gji ^ Gl;
 
-		    la = Eints.col_offset[Gji][Gl];
+      la = Eints.col_offset[Gji][Gl];
 
-		    kl = T2.row_offset[Gkl][K];
+      kl = T2.row_offset[Gkl][K];
 
-		    nrows = T2.params->coltot[Gkl];
-		    ncols = virtpi[Ga];
-		    nlinks = occpi[Gl];
+      nrows = T2.params->coltot[Gkl];
+      ncols = virtpi[Ga];
+      nlinks = occpi[Gl];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			      &(T2.matrix[Gkl][kl][0]), nrows,
-			      &(Eints.matrix[Gji][ji][la]), ncols, 1.0,
-			      &(W1[Gcb][0][0]), ncols);
-		  }
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2.matrix[Gkl][kl][0]), nrows,
+                &(Eints.matrix[Gji][ji][la]), ncols, 1.0,
+                &(W1[Gcb][0][0]), ncols);
+    }
 
-		  /* Sort W[cb][a] --> W[bc][a] */
-          global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
-			      Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
-			      vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, bac, 0);
+    /* Sort W[cb][a] --> W[bc][a] */
+    global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
+                     Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
+                     vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, bac, 0);
 
-		  /* +F_jdbc * t_ikad */
-		  for(Gd=0; Gd < nirreps; Gd++) {
+    /* +F_jdbc * t_ikad */
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		    Gbc = Gjd = Gj ^ Gd;
-		    Ga = Gik ^ Gd;
+      Gbc = Gjd = Gj ^ Gd;
+      Ga = Gik ^ Gd;
 
-		    Fints.matrix[Gjd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gjd]);
-		    global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gjd, Fints.row_offset[Gjd][J], virtpi[Gd]);
+      Fints.matrix[Gjd] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gjd, Fints.row_offset[Gjd][J], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		    ad = T2.col_offset[Gik][Ga];
+      ad = T2.col_offset[Gik][Ga];
 
-		    nrows = Fints.params->coltot[Gjd];
-		    ncols = virtpi[Ga];
-		    nlinks = virtpi[Gd];
+      nrows = Fints.params->coltot[Gjd];
+      ncols = virtpi[Ga];
+      nlinks = virtpi[Gd];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			      &(Fints.matrix[Gjd][0][0]), nrows, 
-			      &(T2.matrix[Gik][ik][ad]), nlinks, 1.0,
-			      &(W0[Gbc][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints.matrix[Gjd][0][0]), nrows, 
+                &(T2.matrix[Gik][ik][ad]), nlinks, 1.0,
+                &(W0[Gbc][0][0]), ncols);
 
-		    global_dpd_->free_dpd_block(Fints.matrix[Gjd], virtpi[Gd], Fints.params->coltot[Gjd]);
-		  }
+      ijk_free_block(Fints.matrix[Gjd], virtpi[Gd], Fints.params->coltot[Gjd]);
+    }
 
-		  /* -E_kila * t_jlbc */
-		  for(Gl=0; Gl < nirreps; Gl++) {
+    /* -E_kila * t_jlbc */
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		    Gbc = Gjl = Gj ^ Gl;
-		    Ga = Gki ^ Gl;
+      Gbc = Gjl = Gj ^ Gl;
+      Ga = Gki ^ Gl;
 
-		    la = Eints.col_offset[Gki][Gl];
+      la = Eints.col_offset[Gki][Gl];
 
-		    jl = T2.row_offset[Gjl][J];
+      jl = T2.row_offset[Gjl][J];
 
-		    nrows = T2.params->coltot[Gjl];
-		    ncols = virtpi[Ga];
-		    nlinks = occpi[Gl];
+      nrows = T2.params->coltot[Gjl];
+      ncols = virtpi[Ga];
+      nlinks = occpi[Gl];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			      &(T2.matrix[Gjl][jl][0]), nrows,
-			      &(Eints.matrix[Gki][ki][la]), ncols, 1.0,
-			      &(W0[Gbc][0][0]), ncols);
-		  }
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2.matrix[Gjl][jl][0]), nrows,
+                &(Eints.matrix[Gki][ki][la]), ncols, 1.0,
+                &(W0[Gbc][0][0]), ncols);
+    }
 
-		  /* Sort W[bc][a] --> W[ba][c] */
-          global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
-			      Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
-			      vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, acb, 0);
+    /* Sort W[bc][a] --> W[ba][c] */
+    global_dpd_->sort_3d(W0, W1, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
+                     Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
+                     vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, acb, 0);
 
-		  /* +F_jdba * t_kicd */
-		  for(Gd=0; Gd < nirreps; Gd++) {
+    /* +F_jdba * t_kicd */
+    for(Gd=0; Gd < nirreps; Gd++) {
 
-		    Gba = Gjd = Gj ^ Gd;
-		    Gc = Gki ^ Gd;
+      Gba = Gjd = Gj ^ Gd;
+      Gc = Gki ^ Gd;
 
-		    Fints.matrix[Gjd] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gjd]);
-		    global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gjd, Fints.row_offset[Gjd][J], virtpi[Gd]);
+      Fints.matrix[Gjd] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gjd]);
+      pthread_mutex_lock(&ijk_io_mutex);
+      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gjd, Fints.row_offset[Gjd][J], virtpi[Gd]);
+      pthread_mutex_unlock(&ijk_io_mutex);
 
-		    cd = T2.col_offset[Gki][Gc];
+      cd = T2.col_offset[Gki][Gc];
 
-		    nrows = Fints.params->coltot[Gjd];
-		    ncols = virtpi[Gc];
-		    nlinks = virtpi[Gd];
+      nrows = Fints.params->coltot[Gjd];
+      ncols = virtpi[Gc];
+      nlinks = virtpi[Gd];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
-			      &(Fints.matrix[Gjd][0][0]), nrows, 
-			      &(T2.matrix[Gki][ki][cd]), nlinks, 1.0,
-			      &(W1[Gba][0][0]), ncols);
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0,
+                &(Fints.matrix[Gjd][0][0]), nrows, 
+                &(T2.matrix[Gki][ki][cd]), nlinks, 1.0,
+                &(W1[Gba][0][0]), ncols);
 
-		    global_dpd_->free_dpd_block(Fints.matrix[Gjd], virtpi[Gd], Fints.params->coltot[Gjd]);
-		  }
+      ijk_free_block(Fints.matrix[Gjd], virtpi[Gd], Fints.params->coltot[Gjd]);
+    }
 
-		  /* -E_iklc * t_jlba */
-		  for(Gl=0; Gl < nirreps; Gl++) {
+    /* -E_iklc * t_jlba */
+    for(Gl=0; Gl < nirreps; Gl++) {
 
-		    Gba = Gjl = Gj ^ Gl;
-		    Gc = Gik ^ Gl;
+      Gba = Gjl = Gj ^ Gl;
+      Gc = Gik ^ Gl;
 
-		    lc = Eints.col_offset[Gik][Gl];
+      lc = Eints.col_offset[Gik][Gl];
 
-		    jl = T2.row_offset[Gjl][J];
+      jl = T2.row_offset[Gjl][J];
 
-		    nrows = T2.params->coltot[Gjl];
-		    ncols = virtpi[Gc];
-		    nlinks = occpi[Gl];
+      nrows = T2.params->coltot[Gjl];
+      ncols = virtpi[Gc];
+      nlinks = occpi[Gl];
 
-		    if(nrows && ncols && nlinks)
-		      C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
-			      &(T2.matrix[Gjl][jl][0]), nrows,
-			      &(Eints.matrix[Gik][ik][lc]), ncols, 1.0,
-			      &(W1[Gba][0][0]), ncols);
-		  }
+      if(nrows && ncols && nlinks)
+        C_DGEMM('t', 'n', nrows, ncols, nlinks, -1.0,
+                &(T2.matrix[Gjl][jl][0]), nrows,
+                &(Eints.matrix[Gik][ik][lc]), ncols, 1.0,
+                &(W1[Gba][0][0]), ncols);
+    }
 
-		  /* Sort W[ba][c] --> W[ab][c] */
-          global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
-			      Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
-			      vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, bac, 0);
+    /* Sort W[ba][c] --> W[ab][c] */
+    global_dpd_->sort_3d(W1, W0, nirreps, Gijk, Fints.params->coltot, Fints.params->colidx,
+                     Fints.params->colorb, Fints.params->rsym, Fints.params->ssym, 
+                     vir_off, vir_off, virtpi, vir_off, Fints.params->colidx, bac, 0);
 
-		  timer_off("N7 Terms");
+    // timer_off("N7 Terms");
 
-		  /**** T3(c) complete ****/
+    /**** T3(c) complete ****/
 
 
-		  /**** Build T3(d) for current i,j,k; Result stored in V ****/
+    /**** Build T3(d) for current i,j,k; Result stored in V ****/
 
-		  timer_on("T3(d) Terms");
+    // timer_on("T3(d) Terms");
 
-		  for(Gab=0; Gab < nirreps; Gab++) {
+    for(Gab=0; Gab < nirreps; Gab++) {
 
-		    Gc = Gab ^ Gijk;
+      Gc = Gab ^ Gijk;
 
-		    for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
+      for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
 
-		      A = Fints.params->colorb[Gab][ab][0];
-		      Ga = Fints.params->rsym[A];
-		      a = A - vir_off[Ga];
-		      B = Fints.params->colorb[Gab][ab][1];
-		      Gb = Fints.params->ssym[B];
-		      b = B - vir_off[Gb];
+        A = Fints.params->colorb[Gab][ab][0];
+        Ga = Fints.params->rsym[A];
+        a = A - vir_off[Ga];
+        B = Fints.params->colorb[Gab][ab][1];
+        Gb = Fints.params->ssym[B];
+        b = B - vir_off[Gb];
 
-		      Gbc = Gb ^ Gc;
-		      Gac = Ga ^ Gc;
+        Gbc = Gb ^ Gc;
+        Gac = Ga ^ Gc;
 
-		      for(c=0; c < virtpi[Gc]; c++) {
-			C = vir_off[Gc] + c;
+        for(c=0; c < virtpi[Gc]; c++) {
+          C = vir_off[Gc] + c;
 
-			bc = Dints.params->colidx[B][C];
-			ac = Dints.params->colidx[A][C];
+          bc = Dints.params->colidx[B][C];
+          ac = Dints.params->colidx[A][C];
 
-			/* +t_ia * D_jkbc + f_ia * t_jkbc */
-			if(Gi == Ga && Gjk == Gbc) {
-			  t_ia = D_jkbc = 0.0;
+          /* +t_ia * D_jkbc + f_ia * t_jkbc */
+          if(Gi == Ga && Gjk == Gbc) {
+            t_ia = D_jkbc = 0.0;
 
-			  if(T1.params->rowtot[Gi] && T1.params->coltot[Gi]) {
-			    t_ia = T1.matrix[Gi][i][a];
-			    f_ia = fIA.matrix[Gi][i][a];
-			  }
+            if(T1.params->rowtot[Gi] && T1.params->coltot[Gi]) {
+              t_ia = T1.matrix[Gi][i][a];
+              f_ia = fIA.matrix[Gi][i][a];
+            }
 
-			  if(Dints.params->rowtot[Gjk] && Dints.params->coltot[Gjk]) {
-			    D_jkbc = Dints.matrix[Gjk][jk][bc];
-			    t_jkbc = T2.matrix[Gjk][jk][bc];
-			  }
+            if(Dints.params->rowtot[Gjk] && Dints.params->coltot[Gjk]) {
+              D_jkbc = Dints.matrix[Gjk][jk][bc];
+              t_jkbc = T2.matrix[Gjk][jk][bc];
+            }
 
-			  V[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
+            V[Gab][ab][c] += t_ia * D_jkbc + f_ia * t_jkbc;
 
-			}
+          }
 
-			/* +t_jb * D_ikac */
-			if(Gj == Gb && Gik == Gac) {
-			  t_jb = D_ikac = 0.0;
+          /* +t_jb * D_ikac */
+          if(Gj == Gb && Gik == Gac) {
+            t_jb = D_ikac = 0.0;
 
-			  if(T1.params->rowtot[Gj] && T1.params->coltot[Gj]) {
-			    t_jb = T1.matrix[Gj][j][b];
-			    f_jb = fIA.matrix[Gj][j][b];
-			  }
+            if(T1.params->rowtot[Gj] && T1.params->coltot[Gj]) {
+              t_jb = T1.matrix[Gj][j][b];
+              f_jb = fIA.matrix[Gj][j][b];
+            }
 
-			  if(Dints.params->rowtot[Gik] && Dints.params->coltot[Gik]) {
-			    D_ikac = Dints.matrix[Gik][ik][ac];
-			    t_ikac = T2.matrix[Gik][ik][ac];
-			  }
+            if(Dints.params->rowtot[Gik] && Dints.params->coltot[Gik]) {
+              D_ikac = Dints.matrix[Gik][ik][ac];
+              t_ikac = T2.matrix[Gik][ik][ac];
+            }
 
-			  V[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
-			}
+            V[Gab][ab][c] += t_jb * D_ikac + f_jb * t_ikac;
+          }
 
-			/* +t_kc * D_ijab */
-			if(Gk == Gc && Gij == Gab) {
-			  t_kc = D_ijab = 0.0;
+          /* +t_kc * D_ijab */
+          if(Gk == Gc && Gij == Gab) {
+            t_kc = D_ijab = 0.0;
 
-			  if(T1.params->rowtot[Gk] && T1.params->coltot[Gk]) {
-			    t_kc = T1.matrix[Gk][k][c];
-			    f_kc = fIA.matrix[Gk][k][c];
-			  }
+            if(T1.params->rowtot[Gk] && T1.params->coltot[Gk]) {
+              t_kc = T1.matrix[Gk][k][c];
+              f_kc = fIA.matrix[Gk][k][c];
+            }
 
-			  if(Dints.params->rowtot[Gij] && Dints.params->coltot[Gij]) {
-			    D_ijab = Dints.matrix[Gij][ij][ab];
-			    t_ijab = T2.matrix[Gij][ij][ab];
-			  }
+            if(Dints.params->rowtot[Gij] && Dints.params->coltot[Gij]) {
+              D_ijab = Dints.matrix[Gij][ij][ab];
+              t_ijab = T2.matrix[Gij][ij][ab];
+            }
 
-			  V[Gab][ab][c] += t_kc * D_ijab + f_kc * t_ijab;
-			}
+            V[Gab][ab][c] += t_kc * D_ijab + f_kc * t_ijab;
+          }
 
-		      } /* c */
-		    } /* ab */
-		  } /* Gab */
+        } /* c */
+      } /* ab */
+    } /* Gab */
 
-		  timer_off("T3(d) Terms");
+    // timer_off("T3(d) Terms");
 
-		  /**** T3(d) complete ****/
+    /**** T3(d) complete ****/
 
-		  /**** Compute (T) Energy as a Test ****/
-		  for(Gab=0; Gab < nirreps; Gab++) {
-		    Gc = Gab ^ Gijk; Gba = Gab;
-		    for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
-		      A = Fints.params->colorb[Gab][ab][0];
-		      Ga = Fints.params->rsym[A];
-		      a = A - vir_off[Ga];
-		      B = Fints.params->colorb[Gab][ab][1];
-		      Gb = Fints.params->ssym[B];
-		      b = B - vir_off[Gb];
-
-		      Gac = Gca = Ga ^ Gc;  Gbc = Gcb = Gb ^ Gc;
-
-		      ba = Dints.params->colidx[B][A];
-
-		      for(c=0; c < virtpi[Gc]; c++) {
-			C = vir_off[Gc] + c;
-
-			ac = Dints.params->colidx[A][C];
-			ca = Dints.params->colidx[C][A];
-			bc = Dints.params->colidx[B][C];
-			cb = Dints.params->colidx[C][B];
-
-			denom = dijk;
-			if(fAB.params->rowtot[Ga])
-			  denom -= fAB.matrix[Ga][a][a];
-			if(fAB.params->rowtot[Gb])
-			  denom -= fAB.matrix[Gb][b][b];
-			if(fAB.params->rowtot[Gc])
-			  denom -= fAB.matrix[Gc][c][c];
-
-			value1 = W0[Gab][ab][c] + V[Gab][ab][c] - W0[Gcb][cb][a] - V[Gcb][cb][a];
-			value2 = 4 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b];
-
-			ET += value1 * value2 / (3.0 * denom);
-
-		      } /* c */
-		    } /* ab */
-		  } /* Gab */
-
-		  /**** (T) Energy Contribution Complete ****/
-
-		  /**** Compute S1 needed for lambda equations ****/
-		  for(Gab=0; Gab < nirreps; Gab++) {
-		    Gc = Gab ^ Gijk; Gba = Gab;
-		    for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
-		      A = Fints.params->colorb[Gab][ab][0];
-		      Ga = Fints.params->rsym[A];
-		      a = A - vir_off[Ga];
-		      B = Fints.params->colorb[Gab][ab][1];
-		      Gb = Fints.params->ssym[B];
-		      b = B - vir_off[Gb];
-
-		      Gac = Gca = Ga ^ Gc;  Gbc = Gcb = Gb ^ Gc;
-
-		      ba = Dints.params->colidx[B][A];
-
-		      if(Gi == Ga && S1.params->rowtot[Gi] && S1.params->coltot[Gi]) {
-			for(c=0; c < virtpi[Gc]; c++) {
-			  C = vir_off[Gc] + c;
-
-			  ac = Dints.params->colidx[A][C];
-			  ca = Dints.params->colidx[C][A];
-			  bc = Dints.params->colidx[B][C];
-			  cb = Dints.params->colidx[C][B];
-
-			  denom = dijk;
-			  if(fAB.params->rowtot[Ga])
-			    denom -= fAB.matrix[Ga][a][a];
-			  if(fAB.params->rowtot[Gb])
-			    denom -= fAB.matrix[Gb][b][b];
-			  if(fAB.params->rowtot[Gc])
-			    denom -= fAB.matrix[Gc][c][c];
-
-			  /* TJ Lee's expression */
-			  value = (4 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b]
-				   -3 * W0[Gcb][cb][a] - 2 * W0[Gac][ac][b] - W0[Gba][ba][c])/denom;
-
-			  S1.matrix[Gi][i][a] += 0.5 * Dints.matrix[Gjk][jk][bc] * value;
-
-			} /* c */
-		      } /* Gi == Ga && S1 rows and S1 cols */
-		    } /* ab */
-		  } /* Gab */
-
-		  /**** S1 contributions complete ****/
-
-		  /* Build M3 array */
-
-		  for(Gab=0; Gab < nirreps; Gab++) {
-		    Gc = Gab ^ Gijk; Gba = Gab;
-		    for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
-		      A = Fints.params->colorb[Gab][ab][0];
-		      Ga = Fints.params->rsym[A];
-		      a = A - vir_off[Ga];
-		      B = Fints.params->colorb[Gab][ab][1];
-		      Gb = Fints.params->ssym[B];
-		      b = B - vir_off[Gb];
-		      Gac = Gca = Ga ^ Gc;
-		      Gbc = Gcb = Gb ^ Gc;
-		      ba = Dints.params->colidx[B][A];
-		      for(c=0; c < virtpi[Gc]; c++) {
-			C = vir_off[Gc] + c;
-			ac = Dints.params->colidx[A][C];
-			ca = Dints.params->colidx[C][A];
-			bc = Dints.params->colidx[B][C];
-			cb = Dints.params->colidx[C][B];
-			denom = dijk;
-			if(fAB.params->rowtot[Ga]) denom -= fAB.matrix[Ga][a][a];
-			if(fAB.params->rowtot[Gb]) denom -= fAB.matrix[Gb][b][b];
-			if(fAB.params->rowtot[Gc]) denom -= fAB.matrix[Gc][c][c];
-
-			/* TJ Lee Expression */
-// 			M[Gab][ab][c] = 6 * (8 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b]
-// 					     - 4 * W0[Gcb][cb][a] - 4 * W0[Gac][ac][b] - 4 * W0[Gba][ba][c]
-// 					     + 4 * V[Gab][ab][c] + V[Gbc][bc][a] + V[Gca][ca][b]
-// 					     - 2 * V[Gcb][cb][a] - 2 * V[Gac][ac][b] - 2 * V[Gba][ba][c])/denom;
-
-                        /* GE Scuseria Expression */
-			M[Gab][ab][c] = (4 * (2 * W0[Gab][ab][c] + V[Gab][ab][c]) + (2 * W0[Gbc][bc][a] + V[Gbc][bc][a])
-					 + (2 * W0[Gca][ca][b] + V[Gca][ca][b]) - 2 * (2 * W0[Gcb][cb][a] + V[Gcb][cb][a])
-					 - (2 * W0[Gac][ac][b] + V[Gac][ac][b]) - 2 * (2 * W0[Gba][ba][c] + V[Gba][ba][c]))/denom;
-		      }
-		    }
-		  }
-
-		  /**** Compute S2 needed for lambda equations ****/
-		  /* S_kjcd --> t_ijkabc <id|ab> */
-		  for(Gd=0; Gd < nirreps; Gd++) {
-		    Gid = Gab = Gi ^ Gd;
-		    Gc = Gkj ^ Gd;
-
-		    nrows = virtpi[Gc];
-		    ncols = virtpi[Gd];
-		    nlinks = Fints.params->coltot[Gid];
-
-		    if(nrows && ncols && nlinks) {
-		      id = Fints.row_offset[Gid][I];
-		      Fints.matrix[Gid] = global_dpd_->dpd_block_matrix(virtpi[Gd], Fints.params->coltot[Gid]);
-		      global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gid, id, virtpi[Gd]);
-		      cd = S2.col_offset[Gkj][Gc];
-
-		      C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0, M[Gab][0], nrows, 
-			      Fints.matrix[Gid][0], nlinks, 1.0, &(S2.matrix[Gkj][kj][cd]), ncols);
-
-		      global_dpd_->free_dpd_block(Fints.matrix[Gid], virtpi[Gd], Fints.params->coltot[Gid]);
-		    }
-		  } /* Gd */
-
-		  timer_on("malloc");
-		  for(Gab=0; Gab < nirreps; Gab++) {
-		    Gc = Gab ^ Gijk;
-		    global_dpd_->free_dpd_block(W0[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
-		    global_dpd_->free_dpd_block(W1[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
-		    global_dpd_->free_dpd_block(V[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
-		    global_dpd_->free_dpd_block(M[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
-		  }
-		  timer_off("malloc");
-
-		} /* k */
-	      } /* j */
-	    } /* i */
-
-	  } /* Gk */
-	} /* Gj */
-      } /* Gi */
+    /**** Compute (T) Energy as a Test ****/
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk; Gba = Gab;
+      for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
+        A = Fints.params->colorb[Gab][ab][0];
+        Ga = Fints.params->rsym[A];
+        a = A - vir_off[Ga];
+        B = Fints.params->colorb[Gab][ab][1];
+        Gb = Fints.params->ssym[B];
+        b = B - vir_off[Gb];
 
-      fprintf(outfile, "\tE(T) = %20.14f\n", ET);
+        Gac = Gca = Ga ^ Gc;  Gbc = Gcb = Gb ^ Gc;
 
-      free(W0); free(W1); free(V); free(M);
+        ba = Dints.params->colidx[B][A];
 
-      fclose(ijkfile);
+        for(c=0; c < virtpi[Gc]; c++) {
+          C = vir_off[Gc] + c;
 
-      for(h=0; h < nirreps; h++) {
-	global_dpd_->buf4_mat_irrep_wrt(&S2, h);
-	global_dpd_->buf4_mat_irrep_close(&S2, h);
-	global_dpd_->buf4_mat_irrep_close(&T2, h);
-	global_dpd_->buf4_mat_irrep_close(&Eints, h);
-	global_dpd_->buf4_mat_irrep_close(&F2ints, h);
-	global_dpd_->buf4_mat_irrep_close(&Dints, h);
+          ac = Dints.params->colidx[A][C];
+          ca = Dints.params->colidx[C][A];
+          bc = Dints.params->colidx[B][C];
+          cb = Dints.params->colidx[C][B];
+
+          denom = dijk;
+          if(fAB.params->rowtot[Ga])
+            denom -= fAB.matrix[Ga][a][a];
+          if(fAB.params->rowtot[Gb])
+            denom -= fAB.matrix[Gb][b][b];
+          if(fAB.params->rowtot[Gc])
+            denom -= fAB.matrix[Gc][c][c];
+
+          value1 = W0[Gab][ab][c] + V[Gab][ab][c] - W0[Gcb][cb][a] - V[Gcb][cb][a];
+          value2 = 4 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b];
+
+          ET += value1 * value2 / (3.0 * denom);
+
+        } /* c */
+      } /* ab */
+    } /* Gab */
+
+    /**** (T) Energy Contribution Complete ****/
+
+    /**** Compute S1 needed for lambda equations ****/
+    for(a=0; a < virtpi[Gi]; a++) s1[a] = 0.0;
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk; Gba = Gab;
+      for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
+        A = Fints.params->colorb[Gab][ab][0];
+        Ga = Fints.params->rsym[A];
+        a = A - vir_off[Ga];
+        B = Fints.params->colorb[Gab][ab][1];
+        Gb = Fints.params->ssym[B];
+        b = B - vir_off[Gb];
+
+        Gac = Gca = Ga ^ Gc;  Gbc = Gcb = Gb ^ Gc;
+
+        ba = Dints.params->colidx[B][A];
+
+        if(Gi == Ga && S1.params->rowtot[Gi] && S1.params->coltot[Gi]) {
+          for(c=0; c < virtpi[Gc]; c++) {
+            C = vir_off[Gc] + c;
+
+            ac = Dints.params->colidx[A][C];
+            ca = Dints.params->colidx[C][A];
+            bc = Dints.params->colidx[B][C];
+            cb = Dints.params->colidx[C][B];
+
+            denom = dijk;
+            if(fAB.params->rowtot[Ga])
+              denom -= fAB.matrix[Ga][a][a];
+            if(fAB.params->rowtot[Gb])
+              denom -= fAB.matrix[Gb][b][b];
+            if(fAB.params->rowtot[Gc])
+              denom -= fAB.matrix[Gc][c][c];
+
+            /* TJ Lee's expression */
+            value = (4 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b]
+                     -3 * W0[Gcb][cb][a] - 2 * W0[Gac][ac][b] - W0[Gba][ba][c])/denom;
+
+            s1[a] += 0.5 * Dints.matrix[Gjk][jk][bc] * value;
+
+          } /* c */
+        } /* Gi == Ga && S1 rows and S1 cols */
+      } /* ab */
+    } /* Gab */
+
+    /* S1 is shared by all threads */
+    if(S1.params->rowtot[Gi] && S1.params->coltot[Gi]) {
+      pthread_mutex_lock(&T3_grad_RHF_mutex);
+      for(a=0; a < virtpi[Gi]; a++)
+        S1.matrix[Gi][i][a] += s1[a];
+      pthread_mutex_unlock(&T3_grad_RHF_mutex);
+    }
+
+    /**** S1 contributions complete ****/
+
+    /* Build M3 array */
+
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk; Gba = Gab;
+      for(ab=0; ab < Fints.params->coltot[Gab]; ab++) {
+        A = Fints.params->colorb[Gab][ab][0];
+        Ga = Fints.params->rsym[A];
+        a = A - vir_off[Ga];
+        B = Fints.params->colorb[Gab][ab][1];
+        Gb = Fints.params->ssym[B];
+        b = B - vir_off[Gb];
+        Gac = Gca = Ga ^ Gc;
+        Gbc = Gcb = Gb ^ Gc;
+        ba = Dints.params->colidx[B][A];
+        for(c=0; c < virtpi[Gc]; c++) {
+          C = vir_off[Gc] + c;
+          ac = Dints.params->colidx[A][C];
+          ca = Dints.params->colidx[C][A];
+          bc = Dints.params->colidx[B][C];
+          cb = Dints.params->colidx[C][B];
+          denom = dijk;
+          if(fAB.params->rowtot[Ga]) denom -= fAB.matrix[Ga][a][a];
+          if(fAB.params->rowtot[Gb]) denom -= fAB.matrix[Gb][b][b];
+          if(fAB.params->rowtot[Gc]) denom -= fAB.matrix[Gc][c][c];
+
+          /* TJ Lee Expression */
+//                      M[Gab][ab][c] = 6 * (8 * W0[Gab][ab][c] + W0[Gbc][bc][a] + W0[Gca][ca][b]
+//                                           - 4 * W0[Gcb][cb][a] - 4 * W0[Gac][ac][b] - 4 * W0[Gba][ba][c]
+//                                           + 4 * V[Gab][ab][c] + V[Gbc][bc][a] + V[Gca][ca][b]
+//                                           - 2 * V[Gcb][cb][a] - 2 * V[Gac][ac][b] - 2 * V[Gba][ba][c])/denom;
+
+          /* GE Scuseria Expression */
+          M[Gab][ab][c] = (4 * (2 * W0[Gab][ab][c] + V[Gab][ab][c]) + (2 * W0[Gbc][bc][a] + V[Gbc][bc][a])
+                           + (2 * W0[Gca][ca][b] + V[Gca][ca][b]) - 2 * (2 * W0[Gcb][cb][a] + V[Gcb][cb][a])
+                           - (2 * W0[Gac][ac][b] + V[Gac][ac][b]) - 2 * (2 * W0[Gba][ba][c] + V[Gba][ba][c]))/denom;
+        }
       }
-      global_dpd_->buf4_print(&S2, outfile, 1);
-      global_dpd_->buf4_close(&S2);
-      global_dpd_->buf4_close(&T2);
-      global_dpd_->buf4_close(&Eints);
-      global_dpd_->buf4_close(&Dints);
-      global_dpd_->buf4_close(&F2ints);
-      global_dpd_->buf4_close(&Fints);
+    }
 
-      global_dpd_->file2_mat_wrt(&S1);
-      global_dpd_->file2_mat_close(&S1);
-      global_dpd_->file2_print(&S1, outfile);
-      global_dpd_->file2_close(&S1);
+    /**** Compute S2 needed for lambda equations ****/
+    /* S_kjcd --> t_ijkabc <id|ab> */
+    for(Gd=0; Gd < nirreps; Gd++) {
+      Gid = Gab = Gi ^ Gd;
+      Gc = Gkj ^ Gd;
+
+      nrows = virtpi[Gc];
+      ncols = virtpi[Gd];
+      nlinks = Fints.params->coltot[Gid];
+
+      if(nrows && ncols && nlinks) {
+        id = Fints.row_offset[Gid][I];
+        Fints.matrix[Gid] = ijk_block_matrix(virtpi[Gd], Fints.params->coltot[Gid]);
+        pthread_mutex_lock(&ijk_io_mutex);
+        global_dpd_->buf4_mat_irrep_rd_block(&Fints, Gid, id, virtpi[Gd]);
+        pthread_mutex_unlock(&ijk_io_mutex);
+        cd = S2.col_offset[Gkj][Gc];
+
+        /* S2 is shared by all threads, so the product goes to Z first */
+        Z = ijk_block_matrix(nrows, ncols);
+        C_DGEMM('t', 't', nrows, ncols, nlinks, 1.0, M[Gab][0], nrows,
+                Fints.matrix[Gid][0], nlinks, 0.0, Z[0], ncols);
+
+        pthread_mutex_lock(&T3_grad_RHF_mutex);
+        S2kj = &(S2.matrix[Gkj][kj][cd]);
+        for(cd=0; cd < nrows*ncols; cd++)
+          S2kj[cd] += Z[0][cd];
+        pthread_mutex_unlock(&T3_grad_RHF_mutex);
+        ijk_free_block(Z, nrows, ncols);
+
+        ijk_free_block(Fints.matrix[Gid], virtpi[Gd], Fints.params->coltot[Gid]);
+      }
+    } /* Gd */
+
+    // timer_on("malloc");
+    for(Gab=0; Gab < nirreps; Gab++) {
+      Gc = Gab ^ Gijk;
+      ijk_free_block(W0[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
+      ijk_free_block(W1[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
+      ijk_free_block(V[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
+      ijk_free_block(M[Gab],Fints.params->coltot[Gab],virtpi[Gc]);
+    }
+    // timer_off("malloc");
 
-      global_dpd_->file2_mat_close(&T1);
-      global_dpd_->file2_close(&T1);
+  } /* ijk */
 
-      global_dpd_->file2_mat_close(&fIJ);
-      global_dpd_->file2_mat_close(&fAB);
-      global_dpd_->file2_mat_close(&fIA);
-      global_dpd_->file2_close(&fIJ);
-      global_dpd_->file2_close(&fAB);
-      global_dpd_->file2_close(&fIA);
-    }
+  free(W0); free(W1); free(V); free(M);
+  free(s1);
+
+  data->ET = ET;
 
+  return NULL;
+}
 
   }}
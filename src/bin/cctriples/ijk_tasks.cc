@@ -0,0 +1,174 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+/*! \file
+    \ingroup CCTRIPLES
+    \brief Work list and thread driver shared by the threaded (T) kernels
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <exception.h>
+#include <psiconfig.h>
+#include <libdpd/dpd.h>
+#include "ijk_tasks.h"
+
+//MKL Header
+#ifdef HAVE_MKL
+#include <mkl.h>
+#endif
+
+namespace psi { namespace cctriples {
+
+pthread_mutex_t ijk_io_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+IJKQueue::IJKQueue(int nirreps, int *occpi_i, int *occ_off_i, int *occpi_j, int *occ_off_j,
+                   int *occpi_k, int *occ_off_k, IJKRestriction restriction)
+  : nirreps_(nirreps), occpi_i_(occpi_i), occ_off_i_(occ_off_i), occpi_j_(occpi_j),
+    occ_off_j_(occ_off_j), occpi_k_(occpi_k), occ_off_k_(occ_off_k), restriction_(restriction),
+    G_(0), n_(-1), count_(0), size_(0), progress_(NULL)
+{
+  IJKTask task;
+
+  pthread_mutex_init(&lock_, NULL);
+
+  /* One pass to count the triples, then rewind */
+  while(advance(task)) size_++;
+  G_ = 0;
+  n_ = -1;
+}
+
+IJKQueue::~IJKQueue()
+{
+  pthread_mutex_destroy(&lock_);
+}
+
+/* Moves the cursor to the next triple allowed by the restriction */
+bool IJKQueue::advance(IJKTask &task)
+{
+  int Gi, Gj, Gk, ni, nj, nk, I, J, K;
+  bool keep;
+
+  while(G_ < nirreps_*nirreps_*nirreps_) {
+    Gi = G_ / (nirreps_*nirreps_);
+    Gj = (G_ / nirreps_) % nirreps_;
+    Gk = G_ % nirreps_;
+    ni = occpi_i_[Gi]; nj = occpi_j_[Gj]; nk = occpi_k_[Gk];
+
+    if(++n_ >= (long int) ni*nj*nk) {
+      G_++;
+      n_ = -1;
+      continue;
+    }
+
+    task.Gi = Gi; task.Gj = Gj; task.Gk = Gk;
+    task.i = (int) (n_ / ((long int) nj*nk));
+    task.j = (int) ((n_ / nk) % nj);
+    task.k = (int) (n_ % nk);
+    I = occ_off_i_[Gi] + task.i;
+    J = occ_off_j_[Gj] + task.j;
+    K = occ_off_k_[Gk] + task.k;
+
+    switch(restriction_) {
+    case IJK_ALL:   keep = true; break;
+    case IJK_GE:    keep = (I >= J && J >= K); break;
+    case IJK_GT:    keep = (I > J && J > K); break;
+    case IJK_IJ_GT: keep = (I > J); break;
+    case IJK_JK_GT: keep = (J > K); break;
+    default:
+      throw PsiException("IJKQueue: unknown ijk restriction", __FILE__, __LINE__);
+    }
+    if(keep) return true;
+  }
+
+  return false;
+}
+
+bool IJKQueue::next(IJKTask &task)
+{
+  bool found;
+
+  pthread_mutex_lock(&lock_);
+  found = advance(task);
+  if(found) {
+    count_++;
+    if(progress_ != NULL) {
+      fprintf(progress_, "%d\n", count_);
+      fflush(progress_);
+    }
+  }
+  pthread_mutex_unlock(&lock_);
+
+  return found;
+}
+
+double **ijk_block_matrix(size_t n, size_t m)
+{
+  double **A;
+
+  pthread_mutex_lock(&ijk_io_mutex);
+  A = global_dpd_->dpd_block_matrix(n, m);
+  pthread_mutex_unlock(&ijk_io_mutex);
+
+  return A;
+}
+
+void ijk_free_block(double **array, size_t n, size_t m)
+{
+  pthread_mutex_lock(&ijk_io_mutex);
+  global_dpd_->free_dpd_block(array, n, m);
+  pthread_mutex_unlock(&ijk_io_mutex);
+}
+
+void ijk_threads(int nthreads, void *(*thread)(void *), void *data, size_t size)
+{
+  int t, errcod;
+  pthread_t *p_thread;
+
+#ifdef HAVE_MKL
+  int old_threads = mkl_get_max_threads();
+  mkl_set_num_threads(1);
+#endif
+
+  p_thread = (pthread_t *) malloc(nthreads*sizeof(pthread_t));
+
+  for(t=0; t < nthreads; t++) {
+    errcod = pthread_create(&(p_thread[t]), NULL, thread, (void *) ((char *) data + t*size));
+    if(errcod) {
+      throw PsiException("pthread_create in ijk_threads() failed",__FILE__,__LINE__);
+    }
+  }
+
+  for(t=0; t < nthreads; t++) {
+    errcod = pthread_join(p_thread[t], NULL);
+    if(errcod) {
+      throw PsiException("pthread_join in ijk_threads() failed",__FILE__,__LINE__);
+    }
+  }
+
+  free(p_thread);
+
+#ifdef HAVE_MKL
+  mkl_set_num_threads(old_threads);
+#endif
+}
+
+}} // namespace psi::cctriples
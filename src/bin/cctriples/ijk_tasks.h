@@ -0,0 +1,101 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+/*! \file
+    \ingroup CCTRIPLES
+    \brief Work list and thread driver shared by the threaded (T) kernels
+*/
+#ifndef _psi_src_bin_cctriples_ijk_tasks_h
+#define _psi_src_bin_cctriples_ijk_tasks_h
+
+#include <cstdio>
+#include <pthread.h>
+
+namespace psi { namespace cctriples {
+
+/* One occupied triple of the (T) ijk loop: irreps and irrep-relative indices */
+struct IJKTask {
+  int Gi, Gj, Gk;
+  int i, j, k;
+};
+
+/* Index restriction of the ijk loop of each kernel */
+enum IJKRestriction {
+  IJK_ALL,     /* every ijk (EaT_RHF) */
+  IJK_GE,      /* I >= J >= K (ET_RHF) */
+  IJK_GT,      /* I > J > K (AAA and BBB) */
+  IJK_IJ_GT,   /* I > J (AAB) */
+  IJK_JK_GT    /* J > K (ABB) */
+};
+
+/*
+** IJKQueue: the ijk triples of all irrep triples, handed out in the
+** order of the serial loops.  Worker threads take the next triple when
+** they finish one, so no thread idles at the end of an irrep triple
+** while the others finish theirs.  The triples are generated as they
+** are handed out, so the queue takes no memory beyond its cursor.
+*/
+class IJKQueue {
+  int nirreps_;
+  int *occpi_i_, *occ_off_i_, *occpi_j_, *occ_off_j_, *occpi_k_, *occ_off_k_;
+  IJKRestriction restriction_;
+  /* Cursor: irrep triple Gi*nirreps^2 + Gj*nirreps + Gk and position
+     i*nj*nk + j*nk + k within it */
+  int G_;
+  long int n_;
+  int count_;
+  int size_;
+  pthread_mutex_t lock_;
+  FILE *progress_;
+
+  bool advance(IJKTask &task);
+
+public:
+  IJKQueue(int nirreps, int *occpi_i, int *occ_off_i, int *occpi_j, int *occ_off_j,
+           int *occpi_k, int *occ_off_k, IJKRestriction restriction);
+  ~IJKQueue();
+
+  int size() const { return size_; }
+
+  /* Log the running task count to this file as triples are handed out */
+  void set_progress(FILE *progress) { progress_ = progress; }
+
+  /* Copies the next triple into task; false once the list is exhausted */
+  bool next(IJKTask &task);
+};
+
+/* libdpd is not thread-safe, so the workers hold this around block reads */
+extern pthread_mutex_t ijk_io_mutex;
+
+/* dpd_block_matrix() and free_dpd_block() under ijk_io_mutex: both update
+   the DPD memory count and may evict cache entries */
+double **ijk_block_matrix(size_t n, size_t m);
+void ijk_free_block(double **array, size_t n, size_t m);
+
+/* Runs thread() on nthreads pthreads, the t-th getting the t-th element
+   of the array data (elements of size bytes), and joins them.  MKL is
+   held to a single thread while the workers run. */
+void ijk_threads(int nthreads, void *(*thread)(void *), void *data, size_t size);
+
+}} // namespace psi::cctriples
+
+#endif // _psi_src_bin_cctriples_ijk_tasks_h
@@ -31,9 +31,23 @@
 
 namespace psi{ namespace dcft{
 
+/* Adds value times row row1 of tau1_AO to row row2 of tau2_AO in irrep h,
+ * restricted to the columns col0[h] ... col0[h]+ncol[h]-1 if col0 is given */
+static inline void
+tau_daxpy(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int h, int row1, int row2,
+        double value, const int *col0, const int *ncol)
+{
+    int c0 = col0 ? col0[h] : 0;
+    int nc = col0 ? ncol[h] : tau1_AO->params->coltot[h];
+    if(nc)
+        C_DAXPY(nc, value, &(tau1_AO->matrix[h][row1][c0]), 1,
+                &(tau2_AO->matrix[h][row2][c0]), 1);
+}
+
 void
 DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
-        int r, int s, double value, dpdfile2 *s1, dpdfile2 *s1b, dpdfile2 *s2)
+        int r, int s, double value, dpdfile2 *s1, dpdfile2 *s1b, dpdfile2 *s2,
+        const int *col0, const int *ncol)
 {
     int Gp, Gq, Gr, Gs, Gpr, Grp, Gps, Gsp, Gsq, Gqs, Gqr, Grq, Gpq, Gqp, Grs, Gsr;
     int prel, qrel, rrel, srel;
@@ -71,9 +85,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
     sq = tau1_AO->params->rowidx[s][q];
 
     /* ####(pq|rs)#### */
-    if(tau1_AO->params->coltot[Gpr])
-        C_DAXPY(tau1_AO->params->coltot[Gpr], value, tau1_AO->matrix[Gpr][qs], 1,
-                tau2_AO->matrix[Gpr][pr], 1);
+    tau_daxpy(tau1_AO, tau2_AO, Gpr, qs, pr, value, col0, ncol);
     if(s1 && Gp==Gq && Gr==Gs){
         s2->matrix[Gp][prel][qrel] += value * s1->matrix[Gr][rrel][srel];
         s2->matrix[Gp][prel][qrel] += value * s1b->matrix[Gr][rrel][srel];
@@ -85,9 +97,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
     if(p!=q && r!=s && pq != rs){
 
         /* ####(pq|sr)#### */
-        if(tau1_AO->params->coltot[Gps])
-            C_DAXPY(tau1_AO->params->coltot[Gps], value, tau1_AO->matrix[Gps][qr], 1,
-                    tau2_AO->matrix[Gps][ps], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gps, qr, ps, value, col0, ncol);
         if(s1 && Gp == Gq && Gs == Gr){
             s2->matrix[Gp][prel][qrel] += value * s1->matrix[Gs][srel][rrel];
             s2->matrix[Gp][prel][qrel] += value * s1b->matrix[Gs][srel][rrel];
@@ -96,9 +106,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gp][prel][rrel] -= value * s1->matrix[Gs][srel][qrel];
 
         /* ####(qp|rs)#### */
-        if(tau1_AO->params->coltot[Gqr])
-            C_DAXPY(tau1_AO->params->coltot[Gqr], value, tau1_AO->matrix[Gqr][ps], 1,
-                    tau2_AO->matrix[Gqr][qr], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gqr, ps, qr, value, col0, ncol);
         if(s1 && Gq==Gp && Gr==Gs){
             s2->matrix[Gq][qrel][prel] += value * s1->matrix[Gr][rrel][srel];
             s2->matrix[Gq][qrel][prel] += value * s1b->matrix[Gr][rrel][srel];
@@ -107,9 +115,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gq][qrel][srel] -= value * s1->matrix[Gr][rrel][prel];
 
         /* ####(qp|sr)#### */
-        if(tau1_AO->params->coltot[Gqs])
-            C_DAXPY(tau1_AO->params->coltot[Gqs], value, tau1_AO->matrix[Gqs][pr], 1,
-                    tau2_AO->matrix[Gqs][qs], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gqs, pr, qs, value, col0, ncol);
         if(s1 && Gq==Gp && Gs==Gr){
             s2->matrix[Gq][qrel][prel] += value * s1->matrix[Gs][srel][rrel];
             s2->matrix[Gq][qrel][prel] += value * s1b->matrix[Gs][srel][rrel];
@@ -118,9 +124,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gq][qrel][rrel] -= value * s1->matrix[Gs][srel][prel];
 
         /* ####(rs|pq)#### */
-        if(tau1_AO->params->coltot[Grp])
-            C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-                    tau2_AO->matrix[Grp][rp], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Grp, sq, rp, value, col0, ncol);
         if(s1 && Gr==Gs && Gp==Gq){
             s2->matrix[Gr][rrel][srel] += value * s1->matrix[Gp][prel][qrel];
             s2->matrix[Gr][rrel][srel] += value * s1b->matrix[Gp][prel][qrel];
@@ -129,9 +133,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gr][rrel][qrel] -= value * s1->matrix[Gp][prel][srel];
 
         /* ####(sr|pq)#### */
-        if(tau1_AO->params->coltot[Gsp])
-            C_DAXPY(tau1_AO->params->coltot[Gsp], value, tau1_AO->matrix[Gsp][rq], 1,
-                    tau2_AO->matrix[Gsp][sp], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gsp, rq, sp, value, col0, ncol);
         if(s1 && Gs==Gr && Gp==Gq){
             s2->matrix[Gs][srel][rrel] += value * s1->matrix[Gp][prel][qrel];
             s2->matrix[Gs][srel][rrel] += value * s1b->matrix[Gp][prel][qrel];
@@ -140,9 +142,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gs][srel][qrel] -= value * s1->matrix[Gp][prel][rrel];
 
         /* ####(rs|qp)#### */
-        if(tau1_AO->params->coltot[Grq])
-            C_DAXPY(tau1_AO->params->coltot[Grq], value, tau1_AO->matrix[Grq][sp], 1,
-                    tau2_AO->matrix[Grq][rq], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Grq, sp, rq, value, col0, ncol);
         if(s1 && Gr==Gs && Gq==Gp){
             s2->matrix[Gr][rrel][srel] += value * s1->matrix[Gq][qrel][prel];
             s2->matrix[Gr][rrel][srel] += value * s1b->matrix[Gq][qrel][prel];
@@ -151,9 +151,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gr][rrel][prel] -= value * s1->matrix[Gq][qrel][srel];
 
         /* ####(sr|qp)#### */
-        if(tau1_AO->params->coltot[Gsq])
-            C_DAXPY(tau1_AO->params->coltot[Gsq], value, tau1_AO->matrix[Gsq][rp], 1,
-                    tau2_AO->matrix[Gsq][sq],1 );
+        tau_daxpy(tau1_AO, tau2_AO, Gsq, rp, sq, value, col0, ncol);
         if(s1 && Gs==Gr && Gq==Gp){
             s2->matrix[Gs][srel][rrel] += value * s1->matrix[Gq][qrel][prel];
             s2->matrix[Gs][srel][rrel] += value * s1b->matrix[Gq][qrel][prel];
@@ -165,9 +163,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
     else if(p!=q && r!=s && pq==rs) {
 
         /* (pq|sr) */
-        if(tau1_AO->params->coltot[Gps])
-            C_DAXPY(tau1_AO->params->coltot[Gps], value, tau1_AO->matrix[Gps][qr], 1,
-                    tau2_AO->matrix[Gps][ps], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gps, qr, ps, value, col0, ncol);
         if(s1 && Gp==Gq && Gs==Gr){
             s2->matrix[Gp][prel][qrel] += value * s1->matrix[Gs][srel][rrel];
             s2->matrix[Gp][prel][qrel] += value * s1b->matrix[Gs][srel][rrel];
@@ -176,9 +172,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gp][prel][rrel] -= value * s1->matrix[Gs][srel][qrel];
 
         /* (qp|rs) */
-        if(tau1_AO->params->coltot[Gqr])
-            C_DAXPY(tau1_AO->params->coltot[Gqr], value, tau1_AO->matrix[Gqr][ps], 1,
-                    tau2_AO->matrix[Gqr][qr], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gqr, ps, qr, value, col0, ncol);
         if(s1 && Gq==Gp && Gr==Gs){
             s2->matrix[Gq][qrel][prel] += value * s1->matrix[Gr][rrel][srel];
             s2->matrix[Gq][qrel][prel] += value * s1b->matrix[Gr][rrel][srel];
@@ -187,9 +181,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gq][qrel][srel] -= value * s1->matrix[Gr][rrel][prel];
 
         /* (qp|sr) */
-        if(tau1_AO->params->coltot[Gqs])
-            C_DAXPY(tau1_AO->params->coltot[Gqs], value, tau1_AO->matrix[Gqs][pr], 1,
-                    tau2_AO->matrix[Gqs][qs], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gqs, pr, qs, value, col0, ncol);
         if(s1 && Gq==Gp && Gs==Gr){
             s2->matrix[Gq][qrel][prel] += value * s1->matrix[Gs][srel][rrel];
             s2->matrix[Gq][qrel][prel] += value * s1b->matrix[Gs][srel][rrel];
@@ -200,9 +192,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
     else if(p!=q && r==s) {
 
         /* (qp|rs) */
-        if(tau1_AO->params->coltot[Gqr])
-            C_DAXPY(tau1_AO->params->coltot[Gqr], value, tau1_AO->matrix[Gqr][ps], 1,
-                    tau2_AO->matrix[Gqr][qr], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gqr, ps, qr, value, col0, ncol);
         if(s1 && Gq==Gp && Gr==Gs){
             s2->matrix[Gq][qrel][prel] += value * s1->matrix[Gr][rrel][srel];
             s2->matrix[Gq][qrel][prel] += value * s1b->matrix[Gr][rrel][srel];
@@ -211,9 +201,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gq][qrel][srel] -= value * s1->matrix[Gr][rrel][prel];
 
         /* (rs|pq) */
-        if(tau1_AO->params->coltot[Grp])
-            C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-                    tau2_AO->matrix[Grp][rp], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Grp, sq, rp, value, col0, ncol);
         if(s1 && Gr==Gs && Gp==Gq){
             s2->matrix[Gr][rrel][srel] += value * s1->matrix[Gp][prel][qrel];
             s2->matrix[Gr][rrel][srel] += value * s1b->matrix[Gp][prel][qrel];
@@ -222,9 +210,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gr][rrel][qrel] -= value * s1->matrix[Gp][prel][srel];
 
         /* (rs|qp) */
-        if(tau1_AO->params->coltot[Grq])
-            C_DAXPY(tau1_AO->params->coltot[Grq], value, tau1_AO->matrix[Grq][sp], 1,
-                    tau2_AO->matrix[Grq][rq], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Grq, sp, rq, value, col0, ncol);
         if(s1 && Gr==Gs && Gq==Gp){
             s2->matrix[Gr][rrel][srel] += value * s1->matrix[Gq][qrel][prel];
             s2->matrix[Gr][rrel][srel] += value * s1b->matrix[Gq][qrel][prel];
@@ -236,9 +222,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
     else if(p==q && r!=s) {
 
         /* (pq|sr) */
-        if(tau1_AO->params->coltot[Gps])
-            C_DAXPY(tau1_AO->params->coltot[Gps], value, tau1_AO->matrix[Gps][qr], 1,
-                    tau2_AO->matrix[Gps][ps], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gps, qr, ps, value, col0, ncol);
         if(s1 && Gp==Gq && Gs==Gr){
             s2->matrix[Gp][prel][qrel] += value * s1->matrix[Gs][srel][rrel];
             s2->matrix[Gp][prel][qrel] += value * s1b->matrix[Gs][srel][rrel];
@@ -247,9 +231,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gp][prel][rrel] -= value * s1->matrix[Gs][srel][qrel];
 
         /* (rs|pq) */
-        if(tau1_AO->params->coltot[Grp])
-            C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-                    tau2_AO->matrix[Grp][rp], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Grp, sq, rp, value, col0, ncol);
         if(s1 && Gr==Gs && Gp==Gq){
             s2->matrix[Gr][rrel][srel] += value * s1->matrix[Gp][prel][qrel];
             s2->matrix[Gr][rrel][srel] += value * s1b->matrix[Gp][prel][qrel];
@@ -258,9 +240,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
             s2->matrix[Gr][rrel][qrel] -= value * s1->matrix[Gp][prel][srel];
 
         /* (sr|pq) */
-        if(tau1_AO->params->coltot[Gsp])
-            C_DAXPY(tau1_AO->params->coltot[Gsp], value, tau1_AO->matrix[Gsp][rq], 1,
-                    tau2_AO->matrix[Gsp][sp], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Gsp, rq, sp, value, col0, ncol);
         if(s1 && Gs==Gr && Gp==Gq){
             s2->matrix[Gs][srel][rrel] += value * s1->matrix[Gp][prel][qrel];
             s2->matrix[Gs][srel][rrel] += value * s1b->matrix[Gp][prel][qrel];
@@ -273,9 +253,7 @@ DCFTSolver::AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
     else if(p==q && r==s && pq != rs) {
 
         /* (rs|pq) */
-        if(tau1_AO->params->coltot[Grp])
-            C_DAXPY(tau1_AO->params->coltot[Grp], value, tau1_AO->matrix[Grp][sq], 1,
-                    tau2_AO->matrix[Grp][rp], 1);
+        tau_daxpy(tau1_AO, tau2_AO, Grp, sq, rp, value, col0, ncol);
         if(s1 && Gr==Gs && Gp==Gq){
             s2->matrix[Gr][rrel][srel] += value * s1->matrix[Gp][prel][qrel];
             s2->matrix[Gr][rrel][srel] += value * s1b->matrix[Gp][prel][qrel];
@@ -0,0 +1,125 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <libciomr/libciomr.h>
+#include <libdpd/dpd.h>
+#include <libmints/mints.h>
+#include <libmints/sointegral_direct.h>
+#include <psi4-dec.h>
+#include "dcft.h"
+
+namespace psi{ namespace dcft{
+
+/**
+ * The integral-direct counterpart of the AO_contribute() loop over PSIF_SO_TEI,
+ * used for AO_BASIS = DIRECT.  The SO integrals are recomputed shell quartet
+ * by shell quartet, skipping quartets whose Schwarz bound is below
+ * INTS_TOLERANCE.
+ *
+ * The quartets are processed in batches sized to the free DPD memory, in a
+ * buffer charged to the DPD pool.  Each slice of the occupied-pair columns of
+ * the tau2 buffers is updated with all integrals of a batch by one thread, so
+ * no two threads update the same element.  The GTau terms (s_aa_2 and s_bb_2),
+ * if requested, are accumulated with the first slice only.
+ *
+ * The tau1 and tau2 buffers must be in core for all irreps.  Returns the
+ * number of SO integrals processed.
+ */
+long int
+DCFTSolver::AO_contribute_direct(dpdbuf4 *tau1_AO_aa, dpdbuf4 *tau2_AO_aa, dpdbuf4 *tau1_AO_bb,
+        dpdbuf4 *tau2_AO_bb, dpdbuf4 *tau1_AO_ab, dpdbuf4 *tau2_AO_ab,
+        dpdfile2 *s_aa_1, dpdfile2 *s_bb_1, dpdfile2 *s_aa_2, dpdfile2 *s_bb_2)
+{
+    dcft_timer_on("DCFTSolver::AO_contribute_direct");
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = Process::environment.get_n_threads();
+#endif
+    if(nthreads < 1) nthreads = 1;
+    long int count = 0;
+    int nbatch = 0;
+
+    DirectSOIntegrals ints(integral_, nthreads, int_tolerance_);
+
+    // Each slice is a contiguous range of the columns of every irrep
+    int **col0_aa = init_int_matrix(nthreads, nirrep_);
+    int **ncol_aa = init_int_matrix(nthreads, nirrep_);
+    int **col0_bb = init_int_matrix(nthreads, nirrep_);
+    int **ncol_bb = init_int_matrix(nthreads, nirrep_);
+    int **col0_ab = init_int_matrix(nthreads, nirrep_);
+    int **ncol_ab = init_int_matrix(nthreads, nirrep_);
+    DirectSOIntegrals::split_columns(nirrep_, tau2_AO_aa->params->coltot, nthreads, col0_aa, ncol_aa);
+    DirectSOIntegrals::split_columns(nirrep_, tau2_AO_bb->params->coltot, nthreads, col0_bb, ncol_bb);
+    DirectSOIntegrals::split_columns(nirrep_, tau2_AO_ab->params->coltot, nthreads, col0_ab, ncol_ab);
+
+    // Four labels and a value per integral
+    long int size = dpd_memfree() / 5;
+    if(size > ints.max_total_size()) size = ints.max_total_size();
+    if(size < ints.max_quartet_size()) size = ints.max_quartet_size();
+    double **buf = global_dpd_->dpd_block_matrix(5, size);
+
+    for(ints.first(); !ints.is_done(); ){
+        long int nints = ints.compute_next(buf, size);
+
+        // Every slice is done exactly once, however many threads we get
+        #pragma omp parallel for schedule(static) num_threads(nthreads)
+        for(int t = 0; t < nthreads; ++t){
+            dpdfile2 *sa1 = (t == 0) ? s_aa_1 : NULL;
+            dpdfile2 *sb1 = (t == 0) ? s_bb_1 : NULL;
+            for(long int n = 0; n < nints; ++n){
+                int p = (int) buf[0][n], q = (int) buf[1][n], r = (int) buf[2][n], s = (int) buf[3][n];
+                double value = buf[4][n];
+                AO_contribute(tau1_AO_aa, tau2_AO_aa, p, q, r, s, value, sa1, sb1, s_aa_2,
+                              col0_aa[t], ncol_aa[t]);
+                AO_contribute(tau1_AO_bb, tau2_AO_bb, p, q, r, s, value, sb1, sa1, s_bb_2,
+                              col0_bb[t], ncol_bb[t]);
+                AO_contribute(tau1_AO_ab, tau2_AO_ab, p, q, r, s, value, NULL, NULL, NULL,
+                              col0_ab[t], ncol_ab[t]);
+            }
+        }
+
+        count += nints;
+        ++nbatch;
+    }
+
+    if(print_ > 1){
+        fprintf(outfile, "\t%ld of %ld SO shell quartets survive Schwarz screening, %d batches\n",
+                ints.nquartet(), ints.ntotal(), nbatch);
+    }
+
+    global_dpd_->free_dpd_block(buf, 5, size);
+    free_int_matrix(col0_aa);
+    free_int_matrix(ncol_aa);
+    free_int_matrix(col0_bb);
+    free_int_matrix(ncol_bb);
+    free_int_matrix(col0_ab);
+    free_int_matrix(ncol_ab);
+
+    dcft_timer_off("DCFTSolver::AO_contribute_direct");
+
+    return count;
+}
+
+}} // End namespaces
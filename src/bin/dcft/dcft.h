@@ -75,7 +75,12 @@ protected:
                         bool backwards, double alpha, double beta);
     void file2_transform(dpdfile2 *A, dpdfile2 *B, SharedMatrix C, bool backwards);
     void AO_contribute(dpdbuf4 *tau1_AO, dpdbuf4 *tau2_AO, int p, int q,
-                       int r, int s, double value, dpdfile2* = NULL, dpdfile2* = NULL, dpdfile2* = NULL);
+                       int r, int s, double value, dpdfile2* = NULL, dpdfile2* = NULL, dpdfile2* = NULL,
+                       const int *col0 = NULL, const int *ncol = NULL);
+    long int AO_contribute_direct(dpdbuf4 *tau1_AO_aa, dpdbuf4 *tau2_AO_aa, dpdbuf4 *tau1_AO_bb,
+                                  dpdbuf4 *tau2_AO_bb, dpdbuf4 *tau1_AO_ab, dpdbuf4 *tau2_AO_ab,
+                                  dpdfile2 *s_aa_1 = NULL, dpdfile2 *s_bb_1 = NULL,
+                                  dpdfile2 *s_aa_2 = NULL, dpdfile2 *s_bb_2 = NULL);
     void compute_tau_squared();
     void compute_energy_tau_squared();
     //void AO_contribute(dpdfile2 *tau1_AO, dpdfile2 *tau2_AO, int p, int q,
@@ -56,9 +56,9 @@ DCFTSolver::compute_energy()
     // Things that are not implemented yet...
     if (options_.get_str("DERTYPE") == "FIRST" && options_.get_str("DCFT_FUNCTIONAL") == "DC-12") throw FeatureNotImplemented("DC-12 functional", "Analytic gradients", __FILE__, __LINE__);
     if (options_.get_str("DERTYPE") == "FIRST" && options_.get_str("DCFT_FUNCTIONAL") == "CEPA0") throw FeatureNotImplemented("CEPA0", "Analytic gradients", __FILE__, __LINE__);
-    if (options_.get_str("DERTYPE") == "FIRST" && options_.get_str("AO_BASIS") == "DISK") throw FeatureNotImplemented("DC-06 with AO_BASIS = DISK", "Analytic gradients", __FILE__, __LINE__);
+    if (options_.get_str("DERTYPE") == "FIRST" && options_.get_str("AO_BASIS") != "NONE") throw FeatureNotImplemented("DC-06 with AO_BASIS = DISK or DIRECT", "Analytic gradients", __FILE__, __LINE__);
     if (options_.get_str("ALGORITHM") == "SIMULTANEOUS" && options_.get_str("DCFT_FUNCTIONAL") == "CEPA0") throw FeatureNotImplemented("CEPA0", "ALGORITHM = SIMULTANEOUS", __FILE__, __LINE__);
-    if (options_.get_str("AO_BASIS") == "DISK" && options_.get_str("DCFT_FUNCTIONAL") == "CEPA0") throw FeatureNotImplemented("CEPA0", "AO_BASIS = DISK", __FILE__, __LINE__);
+    if (options_.get_str("AO_BASIS") != "NONE" && options_.get_str("DCFT_FUNCTIONAL") == "CEPA0") throw FeatureNotImplemented("CEPA0", "AO_BASIS = DISK or DIRECT", __FILE__, __LINE__);
     if (options_.get_str("ALGORITHM") == "QC" && options_.get_str("DCFT_FUNCTIONAL") == "CEPA0") throw FeatureNotImplemented("CEPA0", "ALGORITHM = QC", __FILE__, __LINE__);
     if (options_.get_str("ALGORITHM") == "QC" && options_.get_str("DERTYPE") == "FIRST") throw FeatureNotImplemented("QC-DC-06", "Analytic gradients", __FILE__, __LINE__);
 
@@ -178,7 +178,7 @@ DCFTSolver::run_twostep_dcft()
                         if (options_.get_str("DCFT_FUNCTIONAL") == "DC-12") {
                             refine_tau();
                         }
-                        if (options_.get_str("AO_BASIS") == "DISK") {
+                        if (options_.get_str("AO_BASIS") != "NONE") {
                             // Transform new Tau to the SO basis
                             transform_tau();
                             // Build SO basis tensors for the <VV||VV>, <vv||vv>, and <Vv|Vv> terms in the G intermediate
@@ -192,7 +192,7 @@ DCFTSolver::run_twostep_dcft()
                         update_fock();
                     }
                     else {
-                        if (options_.get_str("AO_BASIS") == "DISK") {
+                        if (options_.get_str("AO_BASIS") != "NONE") {
                             // Build SO basis tensors for the <VV||VV>, <vv||vv>, and <Vv|Vv> terms in the G intermediate
                             build_tensors();
                         }
@@ -533,14 +533,19 @@ namespace psi{ namespace dcft{
     int Gc, Gd;
     int pqArr, qpArr, rsArr, srArr, qrArr, rqArr;
     int qsArr, sqArr, psArr, spArr, prArr, rpArr;
-    int offset, labelIndex, p, q, r, s, h, counter;
+    int offset, labelIndex, p, q, r, s, h;
+    long int counter;
     int **pq_row_start, **CD_row_start, **Cd_row_start, **cd_row_start;
     dpdbuf4 tau_temp, lambda;
     dpdbuf4 tau1_AO_aa, tau2_AO_aa;
     dpdbuf4 tau1_AO_ab, tau2_AO_ab;
     dpdbuf4 tau1_AO_bb, tau2_AO_bb;
 
-    bool buildTensors = (options_.get_str("AO_BASIS") == "DISK");
+    // With AO_BASIS = DIRECT the tensors are built from integrals computed on the fly
+    // after the integral file has been processed, so only the Fock build reads it.
+    // The Fock build itself is not direct: PSIF_SO_TEI is still required.
+    bool buildTensors = (options_.get_str("AO_BASIS") == "DISK" || options_.get_str("AO_BASIS") == "DIRECT");
+    bool directTensors = (options_.get_str("AO_BASIS") == "DIRECT");
 
     if(buildTensors){
 
@@ -681,7 +686,7 @@ namespace psi{ namespace dcft{
             r = (int) lblptr[labelIndex++];
             s = (int) lblptr[labelIndex++];
             value = (double) valptr[index];
-            if(buildTensors){
+            if(buildTensors && !directTensors){
                 AO_contribute(&tau1_AO_aa, &tau2_AO_aa, p, q, r, s, value);
                 AO_contribute(&tau1_AO_bb, &tau2_AO_bb, p, q, r, s, value);
                 AO_contribute(&tau1_AO_ab, &tau2_AO_ab, p, q, r, s, value);
@@ -951,8 +956,12 @@ namespace psi{ namespace dcft{
     iwl->set_keep_flag(1);
     delete iwl;
     if(buildTensors){
+        if(directTensors){
+            counter = AO_contribute_direct(&tau1_AO_aa, &tau2_AO_aa, &tau1_AO_bb, &tau2_AO_bb,
+                                           &tau1_AO_ab, &tau2_AO_ab);
+        }
         if(print_ > 1){
-            fprintf(outfile, "Processed %d SO integrals each for AA, BB, and AB\n", counter);
+            fprintf(outfile, "Processed %ld SO integrals each for AA, BB, and AB\n", counter);
         }
         for(int h = 0; h < nirrep_; ++h){
             global_dpd_->buf4_mat_irrep_wrt(&tau2_AO_aa, h);
@@ -1162,14 +1171,10 @@ namespace psi{ namespace dcft{
   {
       dcft_timer_on("DCFTSolver::build_tensors");
 
-      IWL *iwl = new IWL(psio_.get(), PSIF_SO_TEI, int_tolerance_, 1, 1);
-
-      Label *lblptr = iwl->labels();
-      Value *valptr = iwl->values();
-
       double value;
       int Gc, Gd;
-      int offset, labelIndex, p, q, r, s, h, counter;
+      int offset, labelIndex, p, q, r, s, h;
+    long int counter;
       int **pq_row_start, **CD_row_start, **Cd_row_start, **cd_row_start;
       dpdbuf4 tau_temp, lambda;
       dpdbuf4 tau1_AO_aa, tau2_AO_aa;
@@ -1339,28 +1344,40 @@ namespace psi{ namespace dcft{
 
       }
 
-      bool lastBuffer;
-      do{
-          lastBuffer = iwl->last_buffer();
-          for(int index = 0; index < iwl->buffer_count(); ++index){
-              labelIndex = 4*index;
-              p = abs((int) lblptr[labelIndex++]);
-              q = (int) lblptr[labelIndex++];
-              r = (int) lblptr[labelIndex++];
-              s = (int) lblptr[labelIndex++];
-              value = (double) valptr[index];
-              AO_contribute(&tau1_AO_aa, &tau2_AO_aa, p, q, r, s, value, &s_aa_1, &s_bb_1, &s_aa_2);
-              AO_contribute(&tau1_AO_bb, &tau2_AO_bb, p, q, r, s, value, &s_bb_1, &s_aa_1, &s_bb_2);
-              AO_contribute(&tau1_AO_ab, &tau2_AO_ab, p, q, r, s, value);
-              ++counter;
-
-          } /* end loop through current buffer */
-          if(!lastBuffer) iwl->fetch();
-      }while(!lastBuffer);
-      iwl->set_keep_flag(1);
-      delete iwl;
+      if(options_.get_str("AO_BASIS") == "DIRECT"){
+          // Compute the SO integrals on the fly instead of reading them from disk
+          counter = AO_contribute_direct(&tau1_AO_aa, &tau2_AO_aa, &tau1_AO_bb, &tau2_AO_bb,
+                                         &tau1_AO_ab, &tau2_AO_ab, &s_aa_1, &s_bb_1, &s_aa_2, &s_bb_2);
+      }
+      else{
+          IWL *iwl = new IWL(psio_.get(), PSIF_SO_TEI, int_tolerance_, 1, 1);
+
+          Label *lblptr = iwl->labels();
+          Value *valptr = iwl->values();
+
+          bool lastBuffer;
+          do{
+              lastBuffer = iwl->last_buffer();
+              for(int index = 0; index < iwl->buffer_count(); ++index){
+                  labelIndex = 4*index;
+                  p = abs((int) lblptr[labelIndex++]);
+                  q = (int) lblptr[labelIndex++];
+                  r = (int) lblptr[labelIndex++];
+                  s = (int) lblptr[labelIndex++];
+                  value = (double) valptr[index];
+                  AO_contribute(&tau1_AO_aa, &tau2_AO_aa, p, q, r, s, value, &s_aa_1, &s_bb_1, &s_aa_2);
+                  AO_contribute(&tau1_AO_bb, &tau2_AO_bb, p, q, r, s, value, &s_bb_1, &s_aa_1, &s_bb_2);
+                  AO_contribute(&tau1_AO_ab, &tau2_AO_ab, p, q, r, s, value);
+                  ++counter;
+
+              } /* end loop through current buffer */
+              if(!lastBuffer) iwl->fetch();
+          }while(!lastBuffer);
+          iwl->set_keep_flag(1);
+          delete iwl;
+      }
       if(print_ > 1){
-          fprintf(outfile, "Processed %d SO integrals each for AA, BB, and AB\n", counter);
+          fprintf(outfile, "Processed %ld SO integrals each for AA, BB, and AB\n", counter);
       }
       for(int h = 0; h < nirrep_; ++h){
           global_dpd_->buf4_mat_irrep_wrt(&tau2_AO_aa, h);
@@ -55,13 +55,11 @@ DCFTSolver::half_transform(dpdbuf4 *SO, dpdbuf4 *MO, SharedMatrix& C1, SharedMat
 {
     dcft_timer_on("DCFTSolver::half_transform");
 
-    int Gc, Gd, cd, pq, ij;
+    int Gc, Gd, cd, pq;
 
     //Matrix SO_mat(_nIrreps, _soPI, _soPI);
     //Matrix MO_mat(_nIrreps, mospi_right, mospi_left);
 
-    double **X;
-
         for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(SO, h);
         global_dpd_->buf4_mat_irrep_init(MO, h);
@@ -85,37 +83,49 @@ DCFTSolver::half_transform(dpdbuf4 *SO, dpdbuf4 *MO, SharedMatrix& C1, SharedMat
 
             if(mospi_left[Gc] && mospi_right[Gd] && nsopi_[Gc] && nsopi_[Gd]) {
 
+                // The rows are independent, so each thread transforms its own
+                // rows with a private scratch matrix
                 if(backwards) {
-                    X = block_matrix(mospi_left[Gc], nsopi_[Gd]);
+                    #pragma omp parallel
+                    {
+                        double **X = block_matrix(mospi_left[Gc], nsopi_[Gd]);
+
+                        #pragma omp for
+                        for(int ij = 0; ij < MO->params->rowtot[h]; ij++) {
 
-                    for(ij = 0; ij < MO->params->rowtot[h]; ij++) {
+                            C_DGEMM('n','t', mospi_left[Gc], nsopi_[Gd], mospi_right[Gd], 1.0,
+                                    &(MO->matrix[h][ij][cd]), mospi_right[Gd], &(pC2[0][0]),
+                                    mospi_right[Gd], 0.0, &(X[0][0]), nsopi_[Gd]);
 
-                        C_DGEMM('n','t', mospi_left[Gc], nsopi_[Gd], mospi_right[Gd], 1.0,
-                                &(MO->matrix[h][ij][cd]), mospi_right[Gd], &(pC2[0][0]),
-                                mospi_right[Gd], 0.0, &(X[0][0]), nsopi_[Gd]);
+                            C_DGEMM('n','n', nsopi_[Gc], nsopi_[Gd], mospi_left[Gc], alpha,
+                                    &(pC1[0][0]), mospi_left[Gc], &(X[0][0]), nsopi_[Gd],
+                                    beta, &(SO->matrix[h][ij][pq]), nsopi_[Gd]);
+                        }
 
-                        C_DGEMM('n','n', nsopi_[Gc], nsopi_[Gd], mospi_left[Gc], alpha,
-                                &(pC1[0][0]), mospi_left[Gc], &(X[0][0]), nsopi_[Gd],
-                                beta, &(SO->matrix[h][ij][pq]), nsopi_[Gd]);
+                        free_block(X);
                     }
                 }
                 else {
-                    X = block_matrix(nsopi_[Gc],mospi_right[Gd]);
+                    #pragma omp parallel
+                    {
+                        double **X = block_matrix(nsopi_[Gc],mospi_right[Gd]);
 
-                    for(ij=0; ij < MO->params->rowtot[h]; ij++) {
+                        #pragma omp for
+                        for(int ij = 0; ij < MO->params->rowtot[h]; ij++) {
 
-                        C_DGEMM('n','n', nsopi_[Gc], mospi_right[Gd], nsopi_[Gd], 1.0,
-                                &(SO->matrix[h][ij][pq]), nsopi_[Gd], &(pC2[0][0]), mospi_right[Gd],
-                                0.0, &(X[0][0]), mospi_right[Gd]);
+                            C_DGEMM('n','n', nsopi_[Gc], mospi_right[Gd], nsopi_[Gd], 1.0,
+                                    &(SO->matrix[h][ij][pq]), nsopi_[Gd], &(pC2[0][0]), mospi_right[Gd],
+                                    0.0, &(X[0][0]), mospi_right[Gd]);
 
-                        C_DGEMM('t','n', mospi_left[Gc], mospi_right[Gd], nsopi_[Gc], alpha,
-                                &(pC1[0][0]), mospi_left[Gc], &(X[0][0]), mospi_right[Gd],
-                                beta, &(MO->matrix[h][ij][cd]), mospi_right[Gd]);
+                            C_DGEMM('t','n', mospi_left[Gc], mospi_right[Gd], nsopi_[Gc], alpha,
+                                    &(pC1[0][0]), mospi_left[Gc], &(X[0][0]), mospi_right[Gd],
+                                    beta, &(MO->matrix[h][ij][cd]), mospi_right[Gd]);
 
+                        }
+
+                        free_block(X);
                     }
                 }
-
-                free_block(X);
             }
         }
 
@@ -46,9 +46,12 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <libciomr/libciomr.h>
 #include <libqt/qt.h>
 #include <libpsio/psio.h>
+#include <libpsio/psio.hpp>
+#include <libpsio/aiohandler.h>
 #include "structs.h"
 #include "globals.h"
 #include "ci_tol.h"
@@ -56,6 +59,10 @@
 
 namespace psi { namespace detci {
 
+/* the CIvect with an outstanding prefetch and the handler doing it */
+static CIvect *prefetch_owner = NULL;
+static boost::shared_ptr<AIOHandler> prefetch_aio;
+
 extern void calc_hd_block(struct stringwr *alplist,
    struct stringwr *betlist,
    double **H0, double *oei, double *tei, double efzc,
@@ -199,6 +206,16 @@ CIvect::CIvect() // Default constructor
    cur_unit = 0;
    cur_size = 0;
    first_unit = 0;
+   float_storage = 0;
+   double_first = 0;
+   fbuffer = NULL;
+   prefetch_state = 0;
+   prefetch_vect = -1;
+   prefetch_buf = -1;
+   prefetch_unit = 0;
+   prefetch_float = 0;
+   prefetch_buffer = NULL;
+   prefetch_fbuffer = NULL;
 }
 
 
@@ -246,6 +263,16 @@ CIvect::CIvect(BIGINT vl, int nb, int incor, int ms0, int *iac,
    units_used = 0;
    cur_unit = 0;
    cur_size = 0;
+   float_storage = 0;
+   double_first = 0;
+   fbuffer = NULL;
+   prefetch_state = 0;
+   prefetch_vect = -1;
+   prefetch_buf = -1;
+   prefetch_unit = 0;
+   prefetch_float = 0;
+   prefetch_buffer = NULL;
+   prefetch_fbuffer = NULL;
 
    set(vl, nb, incor, ms0, iac, ibc, ias, ibs, offs, nac, nbc,
          nirr, cdpirr, mxv, nu, funit, fablk, lablk, dc);
@@ -530,6 +557,14 @@ CIvect::~CIvect()
 {
    int i;
 
+   if (prefetch_state) {
+      prefetch_finish();
+      prefetch_owner = NULL;
+      }
+   if (prefetch_buffer != NULL) free(prefetch_buffer);
+   if (prefetch_fbuffer != NULL) free(prefetch_fbuffer);
+   if (fbuffer != NULL) free(fbuffer);
+
    if (num_blocks) {
       if (buf_locked) free(buffer);
       for (i=0; i<num_blocks; i++) {
@@ -1750,6 +1785,8 @@ void CIvect::close_io_files(int keep)
 {
    int i;
 
+   prefetch_finish();
+
    for (i=0; i<nunits; i++) {
      // rclose(units[i], keep ? 3 : 4); // old way
      psio_close(units[i], keep); // new way
@@ -1771,9 +1808,7 @@ void CIvect::close_io_files(int keep)
 */
 int CIvect::read(int ivect, int ibuf)
 {
-   int unit, buf, k, i;
-   unsigned long int size;
-   int blk;
+   int unit, isfloat;
    char key[20];
 
    detci_time.read_before_time = wall_time_new();
@@ -1790,17 +1825,18 @@ int CIvect::read(int ivect, int ibuf)
       }
 
    if (icore == 1) ibuf = 0;
-   buf = ivect * buf_per_vect + ibuf;
 
-   size = buf_size[ibuf] * (unsigned long int) sizeof(double);
+   prefetch_finish();
 
-   /* translate buffer number in case we renumbered after collapse * */
-   buf += new_first_buf;
-   if (buf >= buf_total) buf -= buf_total;
-   sprintf(key, "buffer %d", buf);
-   unit = file_number[buf];
-
-   psio_read_entry((ULI) unit, key, (char *) buffer, size);
+   if (prefetch_state && prefetch_vect == ivect && prefetch_buf == ibuf) {
+      memcpy((void *) buffer, (void *) prefetch_buffer,
+         buf_size[ibuf] * sizeof(double));
+      }
+   else {
+      unit = buf_key(ivect, ibuf, key, &isfloat);
+      read_buffer(unit, key, buffer, buf_size[ibuf], isfloat);
+      }
+   prefetch_state = 0;
 
    cur_vect = ivect;
    cur_buf = ibuf;
@@ -1826,9 +1862,7 @@ int CIvect::read(int ivect, int ibuf)
 */
 int CIvect::write(int ivect, int ibuf)
 {
-   int unit, buf, i;
-   unsigned long int size;
-   int blk;
+   int unit, isfloat;
    char key[20];
 
    detci_time.write_before_time = wall_time_new();
@@ -1846,16 +1880,14 @@ int CIvect::write(int ivect, int ibuf)
       }
 
    if (icore == 1) ibuf = 0;
-   buf = ivect * buf_per_vect + ibuf;
-   size = buf_size[ibuf] * (unsigned long int) sizeof(double);
 
-   /* translate buffer number in case we renumbered after collapse * */
-   buf += new_first_buf;
-   if (buf >= buf_total) buf -= buf_total;
-   sprintf(key, "buffer %d", buf);
-   unit = file_number[buf];
+   /* a prefetched copy of this buffer would be stale now */
+   prefetch_finish();
+   if (prefetch_state && prefetch_vect == ivect && prefetch_buf == ibuf)
+      prefetch_state = 0;
 
-   psio_write_entry((ULI) unit, key, (char *) buffer, size);
+   unit = buf_key(ivect, ibuf, key, &isfloat);
+   write_buffer(unit, key, buffer, buf_size[ibuf], isfloat);
 
    if (ivect >= nvect) nvect = ivect + 1;
    cur_vect = ivect;
@@ -1869,6 +1901,281 @@ int CIvect::write(int ivect, int ibuf)
 }
 
 
+/*
+** CIvect::buf_key(): Find the file unit and PSIO key of a buffer
+**
+** With float storage, the vectors from double_first on are kept in
+** double precision in entries of their own ("current %d", numbered from
+** double_first).  All other vectors live in the ring of "buffer %d"
+** entries, in the precision given by float_storage.
+**
+** Parameters:
+**    ivect   = vector number
+**    ibuf    = buffer number
+**    key     = the key is written here (at least 20 chars)
+**    isfloat = set to 1 if the buffer is stored as floats, else 0
+**
+** Returns: the file unit
+*/
+int CIvect::buf_key(int ivect, int ibuf, char *key, int *isfloat)
+{
+   int buf;
+
+   if (float_storage && ivect >= double_first) {
+      buf = (ivect - double_first) * buf_per_vect + ibuf;
+      sprintf(key, "current %d", buf);
+      *isfloat = 0;
+      return(units[buf % nunits]);
+      }
+
+   buf = ivect * buf_per_vect + ibuf;
+
+   /* translate buffer number in case we renumbered after collapse * */
+   buf += new_first_buf;
+   if (buf >= buf_total) buf -= buf_total;
+   sprintf(key, "buffer %d", buf);
+   *isfloat = float_storage;
+
+   return(file_number[buf]);
+}
+
+
+/*
+** CIvect::read_buffer(): Read n doubles into a from a buffer on disk,
+** converting from single precision if isfloat is set.
+*/
+void CIvect::read_buffer(int unit, const char *key, double *a,
+   unsigned long n, int isfloat)
+{
+   unsigned long i;
+
+   if (!isfloat) {
+      psio_read_entry((ULI) unit, (char *) key, (char *) a,
+         n * (unsigned long int) sizeof(double));
+      return;
+      }
+
+   if (fbuffer == NULL) fbuffer = (float *) malloc(buffer_size * sizeof(float));
+   psio_read_entry((ULI) unit, (char *) key, (char *) fbuffer,
+      n * (unsigned long int) sizeof(float));
+   for (i=0; i<n; i++) a[i] = (double) fbuffer[i];
+}
+
+
+/*
+** CIvect::write_buffer(): Write n doubles from a to a buffer on disk,
+** rounding to single precision if isfloat is set.
+*/
+void CIvect::write_buffer(int unit, const char *key, double *a,
+   unsigned long n, int isfloat)
+{
+   unsigned long i;
+
+   if (!isfloat) {
+      psio_write_entry((ULI) unit, (char *) key, (char *) a,
+         n * (unsigned long int) sizeof(double));
+      return;
+      }
+
+   if (fbuffer == NULL) fbuffer = (float *) malloc(buffer_size * sizeof(float));
+   for (i=0; i<n; i++) fbuffer[i] = (float) a[i];
+   psio_write_entry((ULI) unit, (char *) key, (char *) fbuffer,
+      n * (unsigned long int) sizeof(float));
+}
+
+
+/*
+** CIvect::prefetch(): Start reading a buffer of the CI vector into a
+** private copy in the background, so that a following read() of the
+** same buffer only has to copy it.  Used by the out-of-core sigma
+** routines to overlap I/O with the sigma work on the current buffer.
+**
+** Only one prefetch can be outstanding at a time, for all CIvects.
+** Every CIvect function that touches the disk waits for it first, since
+** libpsio is not thread-safe; anything else that does I/O must call
+** CIvect::prefetch_finish() before doing so.  The prefetched copy is
+** not updated by writes through another CIvect pointing to the same
+** files.
+**
+** Parameters:
+**    ivect  = vector number
+**    ibuf   = buffer number
+*/
+void CIvect::prefetch(int ivect, int ibuf)
+{
+   if (nunits < 1 || !Parameters.civec_prefetch) return;
+   if (icore == 1) ibuf = 0;
+
+   prefetch_finish();
+   if (prefetch_owner != NULL) prefetch_owner->prefetch_state = 0;
+   prefetch_owner = NULL;
+
+   if (prefetch_buffer == NULL) prefetch_buffer = buf_malloc();
+   prefetch_vect = ivect;
+   prefetch_buf = ibuf;
+   prefetch_unit = buf_key(ivect, ibuf, prefetch_key, &prefetch_float);
+   if (psio_tocscan((ULI) prefetch_unit, prefetch_key) == NULL) return;
+
+   if (!prefetch_aio) prefetch_aio = boost::shared_ptr<AIOHandler>(
+      new AIOHandler(_default_psio_lib_));
+
+   if (prefetch_float) {
+      if (prefetch_fbuffer == NULL)
+         prefetch_fbuffer = (float *) malloc(buffer_size * sizeof(float));
+      prefetch_aio->read_entry((ULI) prefetch_unit, prefetch_key,
+         (char *) prefetch_fbuffer,
+         buf_size[ibuf] * (unsigned long int) sizeof(float));
+      }
+   else {
+      prefetch_aio->read_entry((ULI) prefetch_unit, prefetch_key,
+         (char *) prefetch_buffer,
+         buf_size[ibuf] * (unsigned long int) sizeof(double));
+      }
+
+   prefetch_state = 1;
+   prefetch_owner = this;
+}
+
+
+/*
+** CIvect::prefetch_finish(): Wait for an outstanding prefetch, if any.
+** The prefetched data stay with the CIvect that asked for them.
+*/
+void CIvect::prefetch_finish(void)
+{
+   CIvect *vec = prefetch_owner;
+   unsigned long i, n;
+
+   if (vec == NULL || vec->prefetch_state != 1) return;
+
+   prefetch_aio->synchronize();
+
+   if (vec->prefetch_float) {
+      n = vec->buf_size[vec->prefetch_buf];
+      for (i=0; i<n; i++)
+         vec->prefetch_buffer[i] = (double) vec->prefetch_fbuffer[i];
+      }
+   vec->prefetch_state = 2;
+}
+
+
+/*
+** CIvect::set_float_storage(): Keep the old vectors of this CIvect on
+** disk in single precision.  Halves their disk space and I/O, at the
+** cost of rounding every element to about 7 significant digits.  The
+** vectors from double_first on stay double (see demote()), and the
+** in-core buffer is always double precision.
+**
+** Every CIvect that points to the same files must be set the same way
+** (see copy_storage()).
+*/
+void CIvect::set_float_storage(int f)
+{
+   float_storage = f;
+}
+
+
+/*
+** CIvect::get_float_storage(): Returns 1 if the old vectors of this
+** CIvect are kept in single precision, else 0.
+*/
+int CIvect::get_float_storage(void)
+{
+   return(float_storage);
+}
+
+
+/*
+** CIvect::set_double_first(): Set the first vector kept in double
+** precision, without moving any data.  Only valid if the vectors whose
+** storage changes hold no data yet, or for a CIvect that points to the
+** same files as one that was just demote()d.
+*/
+void CIvect::set_double_first(int first)
+{
+   double_first = first;
+}
+
+
+/*
+** CIvect::copy_storage(): Take the storage layout of src, which points
+** to the same files as this CIvect.
+*/
+void CIvect::copy_storage(CIvect &src)
+{
+   float_storage = src.float_storage;
+   double_first = src.double_first;
+}
+
+
+/*
+** CIvect::demote(): Move the double precision window up to vector
+** first.  Vectors double_first...first-1 become old vectors of the
+** subspace and are rounded to single precision on disk, a piece at a
+** time so that no extra vector-sized buffer is needed.  If first is
+** below double_first nothing is converted, so the vectors from first on
+** must not hold data yet.  The new window is written to the first unit
+** for restarts.
+**
+** Parameters:
+**    first  = the first vector to keep in double precision
+*/
+void CIvect::demote(int first)
+{
+   int ivect, ibuf, last, slot, buf, unit, funit;
+   char key[20], fkey[20];
+   unsigned long i, j, n, size, chunk;
+   double *dchunk;
+   float *fchunk;
+   psio_address dadd, fadd;
+
+   if (!float_storage || nunits < 1) {
+      double_first = first;
+      return;
+      }
+
+   prefetch_finish();
+   prefetch_state = 0;
+
+   last = (first < nvect) ? first : nvect;
+   if (last > double_first) {
+      chunk = (buffer_size < 65536) ? buffer_size : 65536;
+      dchunk = (double *) malloc(chunk * sizeof(double));
+      fchunk = (float *) malloc(chunk * sizeof(float));
+      for (ivect=double_first; ivect<last; ivect++) {
+         for (ibuf=0; ibuf<buf_per_vect; ibuf++) {
+            slot = (ivect - double_first) * buf_per_vect + ibuf;
+            sprintf(key, "current %d", slot);
+            unit = units[slot % nunits];
+            if (psio_tocscan((ULI) unit, key) == NULL) continue;
+            buf = ivect * buf_per_vect + ibuf + new_first_buf;
+            if (buf >= buf_total) buf -= buf_total;
+            sprintf(fkey, "buffer %d", buf);
+            funit = file_number[buf];
+            size = buf_size[ibuf];
+            dadd = PSIO_ZERO;
+            fadd = PSIO_ZERO;
+            for (i=0; i<size; i+=n) {
+               n = (size - i < chunk) ? size - i : chunk;
+               psio_read((ULI) unit, key, (char *) dchunk,
+                  n * (unsigned long int) sizeof(double), dadd, &dadd);
+               for (j=0; j<n; j++) fchunk[j] = (float) dchunk[j];
+               psio_write((ULI) funit, fkey, (char *) fchunk,
+                  n * (unsigned long int) sizeof(float), fadd, &fadd);
+               }
+            }
+         }
+      free(dchunk);
+      free(fchunk);
+      }
+
+   double_first = first;
+   psio_write_entry((ULI) first_unit, "Double First", (char *) &double_first,
+      sizeof(int));
+   write_toc();
+}
+
+
 /*
 ** CIvect::schmidt_add()
 **
@@ -3843,6 +4150,8 @@ void CIvect::write_new_first_buf(void)
 {
   int unit;
 
+  prefetch_finish();
+
   unit = first_unit;
   psio_write_entry((ULI) unit, "New First Buffer", (char *) &new_first_buf,
     sizeof(int));
@@ -3861,6 +4170,8 @@ int CIvect::read_new_first_buf(void)
   int unit;
   int nfb;
 
+  prefetch_finish();
+
   unit = first_unit;
   if (psio_tocscan((ULI) unit, "New First Buffer") == NULL) return(-1);
   psio_read_entry((ULI) unit, "New First Buffer", (char *) &nfb,
@@ -3891,6 +4202,8 @@ int CIvect::read_num_vecs(void)
   int unit;
   int nv;
 
+  prefetch_finish();
+
   unit = first_unit;
   if (psio_tocscan((ULI) unit, "Num Vectors") == NULL) return(-1);
   psio_read_entry((ULI) unit, "Num Vectors", (char *) &nv, sizeof(int));
@@ -3900,19 +4213,52 @@ int CIvect::read_num_vecs(void)
 
 /*
 ** Write the number of valid vectors in this object.  That will be stored
-** in the first unit.
+** in the first unit, with the storage layout (see read_storage()).
 */
 void CIvect::write_num_vecs(int nv)
 {
-  int unit;
+  int unit, esize;
+
+  prefetch_finish();
 
   unit = first_unit;
   psio_write_entry((ULI) unit, "Num Vectors", (char *) &nv, sizeof(int));
+  esize = float_storage ? (int) sizeof(float) : (int) sizeof(double);
+  psio_write_entry((ULI) unit, "Vector Precision", (char *) &esize,
+    sizeof(int));
+  psio_write_entry((ULI) unit, "Double First", (char *) &double_first,
+    sizeof(int));
   write_toc();
   //civect_psio_debug();
 }
 
 
+/*
+** Read the storage layout written by write_num_vecs() from the first
+** unit: the size in bytes of the elements of the old vectors and the
+** first vector kept in double precision.  On a restart the layout of the
+** files wins over CI_VECTOR_PRECISION.  Nothing changes if the layout is
+** not stored in the file yet.
+*/
+void CIvect::read_storage(void)
+{
+  int unit;
+  int esize;
+
+  prefetch_finish();
+
+  unit = first_unit;
+  if (psio_tocscan((ULI) unit, "Vector Precision") == NULL) return;
+  psio_read_entry((ULI) unit, "Vector Precision", (char *) &esize,
+    sizeof(int));
+  float_storage = (esize == (int) sizeof(float));
+  double_first = maxvect;
+  if (psio_tocscan((ULI) unit, "Double First") != NULL)
+    psio_read_entry((ULI) unit, "Double First", (char *) &double_first,
+      sizeof(int));
+}
+
+
 /*
 ** Write the libpsio table of contents to disk in case we crash before
 ** we're done.  The TOC is written to the end of the file.  If we aren't
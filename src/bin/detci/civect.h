@@ -92,6 +92,23 @@ class CIvect {
       int cur_unit;              /* current unit file */
       int cur_size;              /* current size of buffer */
       int first_unit;            /* first file unit number (if > 1) */ 
+      int float_storage;         /* 1 if old vectors are stored as floats */
+      int double_first;          /* vectors from here on are kept double  */
+      float *fbuffer;            /* conversion space for float storage    */
+      int prefetch_state;        /* 0 = none, 1 = reading, 2 = read done  */
+      int prefetch_vect;         /* vector number being prefetched        */
+      int prefetch_buf;          /* buffer number being prefetched        */
+      int prefetch_unit;         /* file unit of the prefetched buffer    */
+      int prefetch_float;        /* 1 if the prefetched buffer is floats  */
+      char prefetch_key[20];     /* PSIO key of the prefetched buffer     */
+      double *prefetch_buffer;   /* space the prefetched buffer goes to   */
+      float *prefetch_fbuffer;   /* prefetch space for float storage      */
+
+      int buf_key(int ivect, int ibuf, char *key, int *isfloat);
+      void read_buffer(int unit, const char *key, double *a,
+         unsigned long n, int isfloat);
+      void write_buffer(int unit, const char *key, double *a,
+         unsigned long n, int isfloat);
       
    public:
       CIvect();
@@ -141,6 +158,13 @@ class CIvect {
       void close_io_files(int keep);
       int read(int ivect, int ibuf);
       int write(int ivect, int ibuf);
+      void prefetch(int ivect, int ibuf);
+      static void prefetch_finish(void);
+      void set_float_storage(int f);
+      int get_float_storage(void);
+      void set_double_first(int first);
+      void copy_storage(CIvect &src);
+      void demote(int first);
       int schmidt_add(CIvect &c, int L);
       int schmidt_add2(CIvect &c, int first_vec, int last_vec, int source_vec,
           int target_vec, double *dotval, double *nrm, double *ovlpmax);
@@ -197,6 +221,7 @@ class CIvect {
       void set_new_first_buf(int nfb);
       int read_num_vecs(void);
       void write_num_vecs(int nv);
+      void read_storage(void);
       void write_toc(void);
       void civect_psio_debug(void);
       void pt_correction(struct stringwr **alplist, struct stringwr
@@ -58,6 +58,10 @@ void opdm_block(struct stringwr **alplist, struct stringwr **betlist,
 		int Jb_list, int Jnas, int Jnbs, int Ia_list, int Ib_list, 
 		int Inas, int Inbs);
 void opdm_ke(double **onepdm);
+int pdm_fused_fits(int nvect, unsigned long accum);
+void opdm_fused(struct stringwr **alplist, struct stringwr **betlist,
+                int nroots, const double *CI, int CI_inc, const double *CJ,
+                double ***onepdm_a, double ***onepdm_b);
 // void get_mo_dipmom_ints(double **mux_mo, double **muy_mo, double **muz_mo);
 // void get_dipmom_nuc(double *mu_x_n, double *mu_y_n, double *mu_z_n);
 
@@ -94,6 +98,9 @@ void opdm(struct stringwr **alplist, struct stringwr **betlist,
   // double **mux_mo, **muy_mo, **muz_mo;
   // double mu_x, mu_y, mu_z, mu_tot;
   double mux_n, muy_n, muz_n; /* nuclear parts of dipole moments */
+  int fused, nfused, first_Jroot, r;
+  unsigned long det;
+  double *CI_fused, *CJ_fused, ***fused_a, ***fused_b;
 
   if (!transdens) Iroot = 0;
   if (transdens) 
@@ -248,6 +255,40 @@ void opdm(struct stringwr **alplist, struct stringwr **betlist,
   } 
   */
 
+  /* with whole vectors in core, get the densities of all roots in one
+     pass over the string replacements, roots interleaved */
+  first_Jroot = Jroot;
+  nfused = Parameters.num_roots - first_Jroot;
+  fused = nfused > 0 && pdm_fused_fits(nfused + (transdens ? 1 : 0),
+                                       2 * (unsigned long) populated_orbs * populated_orbs * nfused);
+  if (fused) {
+    CJ_fused = (double *) malloc(Jvec.vectlen * nfused * sizeof(double));
+    for (r=0; r<nfused; r++) {
+      Jvec.read(first_Jroot+r, 0);
+      for (det=0; det<Jvec.vectlen; det++)
+        CJ_fused[det*nfused+r] = Jvec.buffer[det];
+    }
+    if (transdens) {
+      CI_fused = init_array(Ivec.vectlen);
+      Ivec.read(Iroot, 0);
+      for (det=0; det<Ivec.vectlen; det++) CI_fused[det] = Ivec.buffer[det];
+    }
+    else CI_fused = CJ_fused;
+
+    fused_a = (double ***) malloc(nfused * sizeof(double **));
+    fused_b = (double ***) malloc(nfused * sizeof(double **));
+    for (r=0; r<nfused; r++) {
+      fused_a[r] = block_matrix(populated_orbs, populated_orbs);
+      fused_b[r] = block_matrix(populated_orbs, populated_orbs);
+    }
+
+    opdm_fused(alplist, betlist, nfused, CI_fused, transdens ? 0 : 1,
+               CJ_fused, fused_a, fused_b);
+
+    if (CI_fused != CJ_fused) free(CI_fused);
+    free(CJ_fused);
+  }
+
   for (; Jroot<Parameters.num_roots; Jroot++) {
    
     zero_mat(onepdm_a, populated_orbs, populated_orbs); 
@@ -260,7 +301,17 @@ void opdm(struct stringwr **alplist, struct stringwr **betlist,
       }
     }
 
-    if (Parameters.icore == 0) {
+    if (fused) {
+      r = Jroot - first_Jroot;
+      for (i=0; i<populated_orbs; i++) {
+        for (j=0; j<populated_orbs; j++) {
+          onepdm_a[i][j] += fused_a[r][i][j];
+          onepdm_b[i][j] += fused_b[r][i][j];
+        }
+      }
+    } /* end fused */
+
+    else if (Parameters.icore == 0) {
  
       for (Ibuf=0; Ibuf<Ivec.buf_per_vect; Ibuf++) {
         Ivec.read(Iroot, Ibuf);
@@ -724,6 +775,15 @@ void opdm(struct stringwr **alplist, struct stringwr **betlist,
     if (!transdens) Iroot++;
   } /* end loop over num_roots Jroot */  
 
+  if (fused) {
+    for (r=0; r<nfused; r++) {
+      free_block(fused_a[r]);
+      free_block(fused_b[r]);
+    }
+    free(fused_a);
+    free(fused_b);
+  }
+
   if (writeflag) {
     sprintf(opdm_key,"Num MO-basis %s", transdens ? "TDM" : "OPDM");
     i = Parameters.num_roots; /* num max index, not the number for TDM
@@ -599,6 +599,9 @@ void get_parameters(Options &options)
   }
   if (Parameters.nthreads < 1) Parameters.nthreads = 1;
 
+  Parameters.civec_float = (options.get_str("CI_VECTOR_PRECISION") == "SINGLE");
+  Parameters.civec_prefetch = options.get_bool("CI_VECTOR_PREFETCH");
+
   Parameters.export_ci_vector = options["VECS_WRITE"].to_integer();
 
   Parameters.num_export = 0;
@@ -1034,8 +1037,10 @@ void print_parameters(void)
            Parameters.zaptn ? "yes":"no", Parameters.wigner ? "yes":"no");
    fprintf(outfile, "   PERT Z        =   %1.4f    FOLLOW ROOT  =   %6d\n",
            Parameters.perturbation_parameter, Parameters.root);
-   fprintf(outfile, "   NUM THREADS   =   %6d\n",
-           Parameters.nthreads);
+   fprintf(outfile, "   NUM THREADS   =   %6d      CIVEC PREC   =   %6s\n",
+           Parameters.nthreads, Parameters.civec_float ? "single":"double");
+   fprintf(outfile, "   CIVEC PREFETCH=   %6s\n",
+           Parameters.civec_prefetch ? "yes":"no");
    fprintf(outfile, "   VECS WRITE    =   %6s      NUM VECS WRITE =   %6d\n",
            Parameters.export_ci_vector ? "yes":"no", Parameters.num_export);
    fprintf(outfile, "   FILTER GUESS  =   %6s      SF RESTRICT  =   %6s\n",
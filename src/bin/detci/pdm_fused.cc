@@ -0,0 +1,583 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+/*! \file
+    \ingroup DETCI
+    \brief Multi-root, threaded OPDM and TPDM builds for in-core CI vectors
+*/
+
+/*
+** PDM_FUSED.CC
+**
+** When all the CI vectors fit in core (icore=1), the densities of all
+** roots are built in a single pass over the string replacement lists.
+** The roots are stored interleaved, C[det*nroots + root], so each
+** replacement loads the coefficients of every root from one cache line
+** and the root loop is innermost.
+**
+** The string loops of each pair of CI blocks are split into ranges
+** of strings and handed to the thread pool.  Each running task adds
+** into one of Parameters.nthreads private accumulators, which are
+** summed once all tasks are done.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <libciomr/libciomr.h>
+#include <libqt/qt.h>
+#include <psi4-dec.h>
+#include "structs.h"
+#define EXTERN
+#include "globals.h"
+#include <pthread.h>
+#include "tpool.h"
+
+namespace psi { namespace detci {
+
+#define INDEX(i,j) ((i>j) ? (ioff[(i)]+(j)) : (ioff[(j)]+(i)))
+#define TPDMINDEX2(i,j,n) ((i)*(n) + (j))
+
+/* the string loop of a block pair that a task runs */
+#define PDM_PART_BETA  0   /* Ia fixed, beta replacements */
+#define PDM_PART_ALPHA 1   /* Ib fixed, alpha replacements */
+#define PDM_PART_AB    2   /* alpha-beta replacements (TPDM only) */
+
+struct pdm_fused_s {
+  struct stringwr **alplist;
+  struct stringwr **betlist;
+  int tpdm;                 /* 1 for the TPDM, 0 for the OPDM */
+  int nroots;               /* number of interleaved roots */
+  const double *CJ;         /* ket coefficients, interleaved */
+  const double *CI;         /* bra coefficients */
+  int CI_inc;               /* 1 if CI is interleaved, 0 if one root */
+  const double *weights;    /* per-root weights (TPDM only) */
+  int norb;                 /* OPDM: populated orbitals; TPDM: CI orbitals */
+  unsigned long slot_size;  /* doubles per accumulator */
+  double **slots;           /* one accumulator per thread */
+  int *slot_free;           /* stack of unused accumulators */
+  int nfree;
+  pthread_mutex_t slot_mutex;
+};
+
+struct pdm_task_s {
+  struct pdm_fused_s *pdm;
+  int Iblock, Jblock;
+  int part;
+  int first, last;          /* range of the outer string index */
+};
+
+void pdm_fused_thread(void *arg);
+void opdm_fused_task(struct pdm_task_s *task, double *acc);
+void tpdm_fused_task(struct pdm_task_s *task, double *acc);
+
+
+/*
+** pdm_fused_fits(): Returns 1 if the fused density builds can be used:
+** the vectors are in core, and nvect interleaved vector copies plus
+** a per-thread accumulator of accum doubles fit in half the memory
+** given to Psi.
+*/
+int pdm_fused_fits(int nvect, unsigned long accum)
+{
+  double need;
+
+  if (Parameters.icore != 1 || nvect < 1) return 0;
+
+  need = (double) nvect * (double) CIblks.vectlen * sizeof(double);
+  need += (double) Parameters.nthreads * (double) accum * sizeof(double);
+
+  return (need <= 0.5 * (double) Process::environment.get_memory());
+}
+
+
+/*
+** pdm_fused_run(): Splits the contributing block pairs into tasks,
+** runs them, and sums the per-thread accumulators into the first one.
+*/
+static void pdm_fused_run(struct pdm_fused_s *pdm)
+{
+  int Iblock, Jblock, Iac, Ibc, Inas, Inbs, Jac, Jbc, Jnas, Jnbs;
+  int part, n, first, chunk, ntask, nslots, s, t;
+  unsigned long k;
+  struct pdm_task_s *tasks;
+  int nparts, parts[3], lens[3];
+
+  nslots = (Parameters.nthreads > 1) ? Parameters.nthreads : 1;
+  pdm->slots = (double **) malloc(nslots * sizeof(double *));
+  pdm->slot_free = (int *) malloc(nslots * sizeof(int));
+  for (s=0; s<nslots; s++) {
+    pdm->slots[s] = init_array(pdm->slot_size);
+    pdm->slot_free[s] = s;
+  }
+  pdm->nfree = nslots;
+  pthread_mutex_init(&(pdm->slot_mutex), NULL);
+
+  /* count the tasks first, then fill them in */
+  tasks = NULL;
+  for (int pass=0; pass<2; pass++) {
+    ntask = 0;
+    for (Iblock=0; Iblock<CIblks.num_blocks; Iblock++) {
+      Iac = CIblks.Ia_code[Iblock];
+      Ibc = CIblks.Ib_code[Iblock];
+      Inas = CIblks.Ia_size[Iblock];
+      Inbs = CIblks.Ib_size[Iblock];
+      if (Inas==0 || Inbs==0) continue;
+      for (Jblock=0; Jblock<CIblks.num_blocks; Jblock++) {
+        Jac = CIblks.Ia_code[Jblock];
+        Jbc = CIblks.Ib_code[Jblock];
+        Jnas = CIblks.Ia_size[Jblock];
+        Jnbs = CIblks.Ib_size[Jblock];
+        if (Jnas==0 || Jnbs==0) continue;
+        if (!s1_contrib[Iblock][Jblock] && !s2_contrib[Iblock][Jblock] &&
+            !(pdm->tpdm && s3_contrib[Iblock][Jblock])) continue;
+
+        nparts = 0;
+        if (Iac == Jac) { parts[nparts] = PDM_PART_BETA; lens[nparts++] = Inas; }
+        if (Ibc == Jbc) { parts[nparts] = PDM_PART_ALPHA; lens[nparts++] = Inbs; }
+        if (pdm->tpdm) { parts[nparts] = PDM_PART_AB; lens[nparts++] = Jnas; }
+
+        for (part=0; part<nparts; part++) {
+          n = lens[part];
+          chunk = (Parameters.nthreads > 1) ? tpool_chunk(thread_pool, n) : n;
+          for (first=0; first<n; first+=chunk) {
+            if (pass) {
+              tasks[ntask].pdm = pdm;
+              tasks[ntask].Iblock = Iblock;
+              tasks[ntask].Jblock = Jblock;
+              tasks[ntask].part = parts[part];
+              tasks[ntask].first = first;
+              tasks[ntask].last = (first+chunk < n) ? first+chunk : n;
+            }
+            ntask++;
+          }
+        }
+      } /* end loop over Jblock */
+    } /* end loop over Iblock */
+    if (!pass && ntask)
+      tasks = (struct pdm_task_s *) malloc(ntask * sizeof(struct pdm_task_s));
+  }
+
+  if (Parameters.nthreads > 1) {
+    tpool_queue_open(thread_pool);
+    for (t=0; t<ntask; t++)
+      tpool_add_work(thread_pool, pdm_fused_thread, (void *) &(tasks[t]));
+    tpool_queue_close(thread_pool, 1);
+  }
+  else {
+    for (t=0; t<ntask; t++)
+      pdm_fused_thread((void *) &(tasks[t]));
+  }
+
+  for (s=1; s<nslots; s++) {
+    for (k=0; k<pdm->slot_size; k++) pdm->slots[0][k] += pdm->slots[s][k];
+    free(pdm->slots[s]);
+  }
+
+  pthread_mutex_destroy(&(pdm->slot_mutex));
+  free(pdm->slot_free);
+  if (tasks != NULL) free(tasks);
+}
+
+
+void pdm_fused_thread(void *arg)
+{
+  struct pdm_task_s *task;
+  struct pdm_fused_s *pdm;
+  int slot;
+
+  task = (struct pdm_task_s *) arg;
+  pdm = task->pdm;
+
+  /* no more tasks run at once than there are accumulators */
+  pthread_mutex_lock(&(pdm->slot_mutex));
+  slot = pdm->slot_free[--pdm->nfree];
+  pthread_mutex_unlock(&(pdm->slot_mutex));
+
+  if (pdm->tpdm) tpdm_fused_task(task, pdm->slots[slot]);
+  else opdm_fused_task(task, pdm->slots[slot]);
+
+  pthread_mutex_lock(&(pdm->slot_mutex));
+  pdm->slot_free[pdm->nfree++] = slot;
+  pthread_mutex_unlock(&(pdm->slot_mutex));
+}
+
+
+/*
+** opdm_fused(): Alpha and beta one-particle (transition) densities of
+** nroots root pairs in one pass.  CJ holds the ket roots interleaved.
+** If CI_inc is 1, CI holds the bra roots interleaved the same way;
+** if it is 0, CI is a single bra root shared by all pairs.
+**
+** onepdm_a[r] and onepdm_b[r] (populated_orbs x populated_orbs) get
+** the densities of pair r added to them.
+*/
+void opdm_fused(struct stringwr **alplist, struct stringwr **betlist,
+                int nroots, const double *CI, int CI_inc, const double *CJ,
+                double ***onepdm_a, double ***onepdm_b)
+{
+  struct pdm_fused_s pdm;
+  int r, i, j, norb;
+  unsigned long ij;
+  double *acc_a, *acc_b;
+
+  norb = CalcInfo.num_ci_orbs + CalcInfo.num_fzc_orbs;
+
+  pdm.alplist = alplist;
+  pdm.betlist = betlist;
+  pdm.tpdm = 0;
+  pdm.nroots = nroots;
+  pdm.CJ = CJ;
+  pdm.CI = CI;
+  pdm.CI_inc = CI_inc;
+  pdm.weights = NULL;
+  pdm.norb = norb;
+  pdm.slot_size = 2 * (unsigned long) norb * norb * nroots;
+
+  pdm_fused_run(&pdm);
+
+  acc_a = pdm.slots[0];
+  acc_b = pdm.slots[0] + pdm.slot_size/2;
+  for (i=0,ij=0; i<norb; i++) {
+    for (j=0; j<norb; j++,ij++) {
+      for (r=0; r<nroots; r++) {
+        onepdm_a[r][i][j] += acc_a[ij*nroots+r];
+        onepdm_b[r][i][j] += acc_b[ij*nroots+r];
+      }
+    }
+  }
+
+  free(pdm.slots[0]);
+  free(pdm.slots);
+}
+
+
+/*
+** tpdm_fused(): State-averaged two-particle density of nroots roots
+** in one pass.  C holds the roots interleaved and weights their
+** weights.  The aa, bb and ab densities are added to twopdm_aa,
+** twopdm_bb and twopdm_ab, laid out as in tpdm_block().
+*/
+void tpdm_fused(struct stringwr **alplist, struct stringwr **betlist,
+                int nroots, const double *C, const double *weights,
+                double *twopdm_aa, double *twopdm_bb, double *twopdm_ab)
+{
+  struct pdm_fused_s pdm;
+  unsigned long k, ntri, ntri2;
+  double *acc;
+
+  ntri = (unsigned long) CalcInfo.num_ci_orbs * CalcInfo.num_ci_orbs;
+  ntri2 = (ntri * (ntri + 1)) / 2;
+
+  pdm.alplist = alplist;
+  pdm.betlist = betlist;
+  pdm.tpdm = 1;
+  pdm.nroots = nroots;
+  pdm.CJ = C;
+  pdm.CI = C;
+  pdm.CI_inc = 1;
+  pdm.weights = weights;
+  pdm.norb = CalcInfo.num_ci_orbs;
+  pdm.slot_size = 2 * ntri2 + ntri * ntri;
+
+  pdm_fused_run(&pdm);
+
+  acc = pdm.slots[0];
+  for (k=0; k<ntri2; k++) twopdm_aa[k] += acc[k];
+  for (k=0; k<ntri2; k++) twopdm_bb[k] += acc[ntri2+k];
+  for (k=0; k<ntri*ntri; k++) twopdm_ab[k] += acc[2*ntri2+k];
+
+  free(pdm.slots[0]);
+  free(pdm.slots);
+}
+
+
+void opdm_fused_task(struct pdm_task_s *task, double *acc)
+{
+  struct pdm_fused_s *pdm = task->pdm;
+  const int nroots = pdm->nroots, CI_inc = pdm->CI_inc;
+  const int CIstride = CI_inc ? nroots : 1;
+  int Ia_list, Ib_list, Ja_list, Jb_list, Inbs, Jnas, Jnbs;
+  int Ia_idx, Ib_idx, Ja_idx, Jb_idx, Ja_ex, Jb_ex, Jbcnt, Jacnt;
+  int i, j, r, oij, nfzc, norb, nci, *Jboij, *Jaoij;
+  struct stringwr *Jb, *Ja;
+  signed char *Jbsgn, *Jasgn;
+  unsigned int *Jbridx, *Jaridx;
+  unsigned long Ioff, Joff;
+  const double *C1, *C2;
+  double sgn, *acc_a, *acc_b, *D;
+
+  nfzc = CalcInfo.num_fzc_orbs;
+  nci = CalcInfo.num_ci_orbs;
+  norb = pdm->norb;
+  acc_a = acc;
+  acc_b = acc + (unsigned long) norb * norb * nroots;
+
+  Ia_list = CIblks.Ia_code[task->Iblock];
+  Ib_list = CIblks.Ib_code[task->Iblock];
+  Inbs = CIblks.Ib_size[task->Iblock];
+  Ioff = CIblks.offset[task->Iblock];
+  Ja_list = CIblks.Ia_code[task->Jblock];
+  Jb_list = CIblks.Ib_code[task->Jblock];
+  Jnas = CIblks.Ia_size[task->Jblock];
+  Jnbs = CIblks.Ib_size[task->Jblock];
+  Joff = CIblks.offset[task->Jblock];
+
+  if (task->part == PDM_PART_BETA) {
+    for (Ia_idx=task->first; Ia_idx<task->last; Ia_idx++) {
+      for (Jb=pdm->betlist[Jb_list], Jb_idx=0; Jb_idx<Jnbs; Jb_idx++, Jb++) {
+        C1 = pdm->CJ + (Joff + (unsigned long) Ia_idx*Jnbs + Jb_idx) * nroots;
+
+        /* loop over excitations E^b_{ij} from |B(J_b)> */
+        Jbcnt = Jb->cnt[Ib_list];
+        Jbridx = Jb->ridx[Ib_list];
+        Jbsgn = Jb->sgn[Ib_list];
+        Jboij = Jb->oij[Ib_list];
+        for (Jb_ex=0; Jb_ex < Jbcnt; Jb_ex++) {
+          oij = *Jboij++;
+          Ib_idx = *Jbridx++;
+          sgn = (double) *Jbsgn++;
+          C2 = pdm->CI + (Ioff + (unsigned long) Ia_idx*Inbs + Ib_idx) * CIstride;
+          i = oij/nci + nfzc;
+          j = oij%nci + nfzc;
+          D = acc_b + ((unsigned long) i*norb + j) * nroots;
+          for (r=0; r<nroots; r++) D[r] += sgn * C1[r] * C2[r*CI_inc];
+        }
+      }
+    }
+  }
+
+  else if (task->part == PDM_PART_ALPHA) {
+    for (Ib_idx=task->first; Ib_idx<task->last; Ib_idx++) {
+      for (Ja=pdm->alplist[Ja_list], Ja_idx=0; Ja_idx<Jnas; Ja_idx++, Ja++) {
+        C1 = pdm->CJ + (Joff + (unsigned long) Ja_idx*Jnbs + Ib_idx) * nroots;
+
+        /* loop over excitations */
+        Jacnt = Ja->cnt[Ia_list];
+        Jaridx = Ja->ridx[Ia_list];
+        Jasgn = Ja->sgn[Ia_list];
+        Jaoij = Ja->oij[Ia_list];
+        for (Ja_ex=0; Ja_ex < Jacnt; Ja_ex++) {
+          oij = *Jaoij++;
+          Ia_idx = *Jaridx++;
+          sgn = (double) *Jasgn++;
+          C2 = pdm->CI + (Ioff + (unsigned long) Ia_idx*Inbs + Ib_idx) * CIstride;
+          i = oij/nci + nfzc;
+          j = oij%nci + nfzc;
+          D = acc_a + ((unsigned long) i*norb + j) * nroots;
+          for (r=0; r<nroots; r++) D[r] += sgn * C1[r] * C2[r*CI_inc];
+        }
+      }
+    }
+  }
+}
+
+
+/* sum over roots of w_r * C1_r * C2_r */
+static inline double pdm_wdot(int nroots, const double *w, const double *C1,
+                              const double *C2)
+{
+  double tval = 0.0;
+  for (int r=0; r<nroots; r++) tval += w[r] * C1[r] * C2[r];
+  return tval;
+}
+
+
+void tpdm_fused_task(struct pdm_task_s *task, double *acc)
+{
+  struct pdm_fused_s *pdm = task->pdm;
+  const int nroots = pdm->nroots, nbf = pdm->norb, nbf2 = nbf * nbf;
+  const double *w = pdm->weights;
+  int Ia_list, Ib_list, Ja_list, Jb_list, Inbs, Jnas, Jnbs;
+  int Ia_idx, Ib_idx, Ja_idx, Jb_idx, Ja_ex, Jb_ex, Jbcnt, Jacnt;
+  int Kbcnt, Kacnt, Kb_ex, Ka_ex, Kb_list, Ka_list, Kb_idx, Ka_idx;
+  struct stringwr *Jb, *Ja, *Kb, *Ka;
+  signed char *Jbsgn, *Jasgn, *Kbsgn, *Kasgn;
+  unsigned int *Jbridx, *Jaridx, *Kbridx, *Karidx;
+  int i, j, l, ij, kl, ijkl, oij, okl, *Jboij, *Jaoij, *Kboij, *Kaoij;
+  unsigned long Ioff, Joff, ntri2;
+  const double *C1, *C2;
+  double Ib_sgn, Ia_sgn, Kb_sgn, Ka_sgn, tval;
+  double *twopdm_aa, *twopdm_bb, *twopdm_ab;
+
+  ntri2 = ((unsigned long) nbf2 * (nbf2 + 1)) / 2;
+  twopdm_aa = acc;
+  twopdm_bb = acc + ntri2;
+  twopdm_ab = acc + 2 * ntri2;
+
+  Ia_list = CIblks.Ia_code[task->Iblock];
+  Ib_list = CIblks.Ib_code[task->Iblock];
+  Inbs = CIblks.Ib_size[task->Iblock];
+  Ioff = CIblks.offset[task->Iblock];
+  Ja_list = CIblks.Ia_code[task->Jblock];
+  Jb_list = CIblks.Ib_code[task->Jblock];
+  Jnas = CIblks.Ia_size[task->Jblock];
+  Jnbs = CIblks.Ib_size[task->Jblock];
+  Joff = CIblks.offset[task->Jblock];
+
+  if (task->part == PDM_PART_BETA) {
+    for (Ia_idx=task->first; Ia_idx<task->last; Ia_idx++) {
+      for (Jb=pdm->betlist[Jb_list], Jb_idx=0; Jb_idx<Jnbs; Jb_idx++, Jb++) {
+        C1 = pdm->CJ + (Joff + (unsigned long) Ia_idx*Jnbs + Jb_idx) * nroots;
+
+        /* loop over excitations E^b_{kl} from |B(J_b)> */
+        for (Kb_list=0; Kb_list < CIblks.num_bet_codes; Kb_list++) {
+          Jbcnt = Jb->cnt[Kb_list];
+          Jbridx = Jb->ridx[Kb_list];
+          Jbsgn = Jb->sgn[Kb_list];
+          Jboij = Jb->oij[Kb_list];
+          for (Jb_ex=0; Jb_ex < Jbcnt; Jb_ex++) {
+            okl = *Jboij++;
+            Kb_idx = *Jbridx++;
+            Kb_sgn = (double) *Jbsgn++;
+
+            Kb = pdm->betlist[Kb_list] + Kb_idx;
+            if (Kb_list == Ib_list) {
+              C2 = pdm->CI + (Ioff + (unsigned long) Ia_idx*Inbs + Kb_idx) * nroots;
+              tval = Kb_sgn * pdm_wdot(nroots, w, C1, C2);
+              i = okl / nbf;
+              l = okl % nbf;
+              for (j=0; j<nbf && j<=i; j++) {
+                ij = i * nbf + j;
+                kl = j * nbf + l;
+                if (ij >= kl) {
+                  ijkl = INDEX(ij,kl);
+                  twopdm_bb[ijkl] -= tval;
+                }
+              }
+            }
+
+            /* loop over excitations E^b_{ij} from |B(K_b)> */
+            Kbcnt = Kb->cnt[Ib_list];
+            Kbridx = Kb->ridx[Ib_list];
+            Kbsgn = Kb->sgn[Ib_list];
+            Kboij = Kb->oij[Ib_list];
+            for (Kb_ex=0; Kb_ex<Kbcnt; Kb_ex++) {
+              Ib_idx = *Kbridx++;
+              Ib_sgn = (double) *Kbsgn++;
+              oij = *Kboij++;
+              if (oij >= okl) {
+                C2 = pdm->CI + (Ioff + (unsigned long) Ia_idx*Inbs + Ib_idx) * nroots;
+                ijkl = INDEX(oij,okl);
+                twopdm_bb[ijkl] += Ib_sgn * Kb_sgn * pdm_wdot(nroots, w, C1, C2);
+              }
+            }
+
+          } /* end loop over Jb_ex */
+        } /* end loop over Kb_list */
+      } /* end loop over Jb_idx */
+    } /* end loop over Ia_idx */
+  }
+
+  else if (task->part == PDM_PART_ALPHA) {
+    for (Ib_idx=task->first; Ib_idx<task->last; Ib_idx++) {
+      for (Ja=pdm->alplist[Ja_list], Ja_idx=0; Ja_idx<Jnas; Ja_idx++, Ja++) {
+        C1 = pdm->CJ + (Joff + (unsigned long) Ja_idx*Jnbs + Ib_idx) * nroots;
+
+        /* loop over excitations E^a_{kl} from |A(J_a)> */
+        for (Ka_list=0; Ka_list < CIblks.num_alp_codes; Ka_list++) {
+          Jacnt = Ja->cnt[Ka_list];
+          Jaridx = Ja->ridx[Ka_list];
+          Jasgn = Ja->sgn[Ka_list];
+          Jaoij = Ja->oij[Ka_list];
+          for (Ja_ex=0; Ja_ex < Jacnt; Ja_ex++) {
+            okl = *Jaoij++;
+            Ka_idx = *Jaridx++;
+            Ka_sgn = (double) *Jasgn++;
+
+            Ka = pdm->alplist[Ka_list] + Ka_idx;
+            if (Ka_list == Ia_list) {
+              C2 = pdm->CI + (Ioff + (unsigned long) Ka_idx*Inbs + Ib_idx) * nroots;
+              tval = Ka_sgn * pdm_wdot(nroots, w, C1, C2);
+              i = okl / nbf;
+              l = okl % nbf;
+              for (j=0; j<nbf && j<=i; j++) {
+                ij = i * nbf + j;
+                kl = j * nbf + l;
+                if (ij >= kl) {
+                  ijkl = INDEX(ij,kl);
+                  twopdm_aa[ijkl] -= tval;
+                }
+              }
+            }
+
+            /* loop over excitations E^a_{ij} from |A(K_a)> */
+            Kacnt = Ka->cnt[Ia_list];
+            Karidx = Ka->ridx[Ia_list];
+            Kasgn = Ka->sgn[Ia_list];
+            Kaoij = Ka->oij[Ia_list];
+            for (Ka_ex=0; Ka_ex<Kacnt; Ka_ex++) {
+              Ia_idx = *Karidx++;
+              Ia_sgn = (double) *Kasgn++;
+              oij = *Kaoij++;
+              if (oij >= okl) {
+                C2 = pdm->CI + (Ioff + (unsigned long) Ia_idx*Inbs + Ib_idx) * nroots;
+                ijkl = INDEX(oij,okl);
+                twopdm_aa[ijkl] += Ia_sgn * Ka_sgn * pdm_wdot(nroots, w, C1, C2);
+              }
+            }
+
+          } /* end loop over Ja_ex */
+        } /* end loop over Ka_list */
+      } /* end loop over Ja_idx */
+    } /* end loop over Ib_idx */
+  }
+
+  else if (task->part == PDM_PART_AB) {
+    for (Ja_idx=task->first; Ja_idx<task->last; Ja_idx++) {
+      Ja = pdm->alplist[Ja_list] + Ja_idx;
+
+      /* loop over excitations E^a_{kl} from |A(I_a)> */
+      Jacnt = Ja->cnt[Ia_list];
+      Jaridx = Ja->ridx[Ia_list];
+      Jasgn = Ja->sgn[Ia_list];
+      Jaoij = Ja->oij[Ia_list];
+      for (Ja_ex=0; Ja_ex < Jacnt; Ja_ex++) {
+        okl = *Jaoij++;
+        Ia_idx = *Jaridx++;
+        Ia_sgn = (double) *Jasgn++;
+
+        /* loop over Jb */
+        for (Jb=pdm->betlist[Jb_list], Jb_idx=0; Jb_idx<Jnbs; Jb_idx++, Jb++) {
+          C1 = pdm->CJ + (Joff + (unsigned long) Ja_idx*Jnbs + Jb_idx) * nroots;
+
+          /* loop over excitations E^b_{ij} from |B(J_b)> */
+          Jbcnt = Jb->cnt[Ib_list];
+          Jbridx = Jb->ridx[Ib_list];
+          Jbsgn = Jb->sgn[Ib_list];
+          Jboij = Jb->oij[Ib_list];
+          for (Jb_ex=0; Jb_ex < Jbcnt; Jb_ex++) {
+            oij = *Jboij++;
+            Ib_idx = *Jbridx++;
+            Ib_sgn = (double) *Jbsgn++;
+            C2 = pdm->CI + (Ioff + (unsigned long) Ia_idx*Inbs + Ib_idx) * nroots;
+            ijkl = TPDMINDEX2(oij, okl, nbf2);
+            twopdm_ab[ijkl] += Ib_sgn * Ia_sgn * pdm_wdot(nroots, w, C1, C2);
+          }
+        } /* end loop over Jb */
+      } /* end loop over Ja_ex */
+    } /* end loop over Ja_idx */
+  }
+}
+
+}} // namespace psi::detci
+
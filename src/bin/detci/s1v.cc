@@ -185,7 +185,7 @@ void s1_block_vfci_thread(struct stringwr **alplist, struct stringwr **betlist,
       int nlists, int nas, int nbs, int Ib_list, int Jb_list, 
       int Jb_list_nbs)
 {
-  struct stringwr *Ib, *Kb;
+  struct stringwr *Kb;
   unsigned int Ia_idx, Ib_idx, Kb_idx, Jb_idx;
   unsigned int Ibcnt, Kbcnt, Kb_list, Ib_ex, Kb_ex;
   unsigned int *Ibridx, *Kbridx;
@@ -195,11 +195,14 @@ void s1_block_vfci_thread(struct stringwr **alplist, struct stringwr **betlist,
   double Kb_sgn, Jb_sgn;
   double tval;
   struct pthreads_s1vfci **thread_info;
-  int i;
+  int i, chunk, ntask;
    
+  chunk = tpool_chunk(thread_pool, nbs);
+  ntask = (nbs + chunk - 1) / chunk;
+
   thread_info = (struct pthreads_s1vfci **)
-                malloc(sizeof(struct pthreads_s1vfci *) * nbs);
-  for (i=0; i<nbs; i++) {
+                malloc(sizeof(struct pthreads_s1vfci *) * ntask);
+  for (i=0; i<ntask; i++) {
       thread_info[i] = (struct pthreads_s1vfci *)
                        malloc(sizeof(struct pthreads_s1vfci));
     }
@@ -209,30 +212,32 @@ void s1_block_vfci_thread(struct stringwr **alplist, struct stringwr **betlist,
 
   detci_time.s1_mt_before_time = wall_time_new();
 
-  /* loop over I_b */
-  for (Ib=betlist[Ib_list], Ib_idx=0; Ib_idx < nbs; Ib_idx++, Ib++) {
-      thread_info[Ib_idx]->alplist=alplist;
-      thread_info[Ib_idx]->betlist=betlist;
-      thread_info[Ib_idx]->C=C;
-      thread_info[Ib_idx]->S=S;
-      thread_info[Ib_idx]->oei=oei;
-      thread_info[Ib_idx]->tei=tei;
-      thread_info[Ib_idx]->nlists=nlists;
-      thread_info[Ib_idx]->nas=nas;
-      thread_info[Ib_idx]->nbs=nbs;
-      thread_info[Ib_idx]->Ib_list=Ib_list;
-      thread_info[Ib_idx]->Jb_list=Jb_list;
-      thread_info[Ib_idx]->Jb_list_nbs=Jb_list_nbs;
-      thread_info[Ib_idx]->Ib=Ib;
-      thread_info[Ib_idx]->Ib_idx=Ib_idx;
-      tpool_add_work(thread_pool, s1_block_vfci_pthread, (void *) thread_info[Ib_idx]);
+  /* one work item per range of I_b strings; the item owns those columns of S */
+  for (i=0, Ib_idx=0; i < ntask; i++, Ib_idx += chunk) {
+      thread_info[i]->alplist=alplist;
+      thread_info[i]->betlist=betlist;
+      thread_info[i]->C=C;
+      thread_info[i]->S=S;
+      thread_info[i]->oei=oei;
+      thread_info[i]->tei=tei;
+      thread_info[i]->nlists=nlists;
+      thread_info[i]->nas=nas;
+      thread_info[i]->nbs=nbs;
+      thread_info[i]->Ib_list=Ib_list;
+      thread_info[i]->Jb_list=Jb_list;
+      thread_info[i]->Jb_list_nbs=Jb_list_nbs;
+      thread_info[i]->Ib=betlist[Ib_list] + Ib_idx;
+      thread_info[i]->Ib_idx=Ib_idx;
+      thread_info[i]->Ib_end=(Ib_idx + chunk < nbs) ? Ib_idx + chunk : nbs;
+      tpool_add_work(thread_pool, s1_block_vfci_pthread, (void *) thread_info[i]);
     } /* end loop over Ib */
   tpool_queue_close(thread_pool, 1);
 
   detci_time.s1_mt_after_time = wall_time_new();
   detci_time.s1_mt_total_time += detci_time.s1_mt_after_time - detci_time.s1_mt_before_time;
 
-  for (i=0; i<nbs; i++) free(thread_info[i]);
+  for (i=0; i<ntask; i++) free(thread_info[i]);
+  free(thread_info);
 
    
 }
@@ -269,6 +274,7 @@ void s1_block_vfci_pthread(void *threadarg)
   double tval;
   double *oei, *tei, **C, **S, *F;
   struct pthreads_s1vfci *thread_info;
+  unsigned int Ib_end;
   int nlists, nas, nbs, Ib_list, Jb_list, Jb_list_nbs;
    
   thread_info = (struct pthreads_s1vfci *) threadarg;
@@ -286,66 +292,70 @@ void s1_block_vfci_pthread(void *threadarg)
   Jb_list_nbs = thread_info->Jb_list_nbs;
   Ib = thread_info->Ib;
   Ib_idx = thread_info->Ib_idx;
+  Ib_end = thread_info->Ib_end;
   
   nirreps = CalcInfo.nirreps;
   F = init_array(Jb_list_nbs);
-  zero_arr(F, Jb_list_nbs);
-
-  /* loop over excitations E^b_{kl} from |B(I_b)> */
-  for (Kb_list=0; Kb_list < nlists; Kb_list++) {
-      Ibcnt = Ib->cnt[Kb_list];
-      Ibridx = Ib->ridx[Kb_list];
-      Ibsgn = Ib->sgn[Kb_list];
-      Ibij = Ib->ij[Kb_list];
-      for (Ib_ex=0; Ib_ex < Ibcnt; Ib_ex++) {
-          kl = *Ibij++;
-          Kb_idx = *Ibridx++;
-          Kb_sgn = (double) *Ibsgn++;
-
-          /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
-          Kb = betlist[Kb_list] + Kb_idx;
-          if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[kl];
-
-          /* loop over excitations E^b_{ij} from |B(K_b)> */
-          /* Jb_list pre-determined because of C blocking */
-          Kbcnt = Kb->cnt[Jb_list];
-          Kbridx = Kb->ridx[Jb_list];
-          Kbsgn = Kb->sgn[Jb_list];
-          Kbij = Kb->ij[Jb_list];
-          for (Kb_ex=0; Kb_ex < Kbcnt; Kb_ex++) {
-              Jb_idx = *Kbridx++;
-              Jb_sgn = (double) *Kbsgn++;
-              ij = *Kbij++;
-              ijkl = INDEX(ij,kl);
-              F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl] ;
-            }
-        } /* end loop over Ib excitations */
-    } /* end loop over Kb_list */
+
+  for (; Ib_idx < Ib_end; Ib_idx++, Ib++) {
+    zero_arr(F, Jb_list_nbs);
+
+    /* loop over excitations E^b_{kl} from |B(I_b)> */
+    for (Kb_list=0; Kb_list < nlists; Kb_list++) {
+        Ibcnt = Ib->cnt[Kb_list];
+        Ibridx = Ib->ridx[Kb_list];
+        Ibsgn = Ib->sgn[Kb_list];
+        Ibij = Ib->ij[Kb_list];
+        for (Ib_ex=0; Ib_ex < Ibcnt; Ib_ex++) {
+            kl = *Ibij++;
+            Kb_idx = *Ibridx++;
+            Kb_sgn = (double) *Ibsgn++;
+
+            /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
+            Kb = betlist[Kb_list] + Kb_idx;
+            if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[kl];
+
+            /* loop over excitations E^b_{ij} from |B(K_b)> */
+            /* Jb_list pre-determined because of C blocking */
+            Kbcnt = Kb->cnt[Jb_list];
+            Kbridx = Kb->ridx[Jb_list];
+            Kbsgn = Kb->sgn[Jb_list];
+            Kbij = Kb->ij[Jb_list];
+            for (Kb_ex=0; Kb_ex < Kbcnt; Kb_ex++) {
+                Jb_idx = *Kbridx++;
+                Jb_sgn = (double) *Kbsgn++;
+                ij = *Kbij++;
+                ijkl = INDEX(ij,kl);
+                F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl] ;
+              }
+          } /* end loop over Ib excitations */
+      } /* end loop over Kb_list */
 
       
-  /*
-    for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
-    tval = 0.0;
-    for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-    tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
-    }
-    S[Ia_idx][Ib_idx] += tval;
-    }
-  */
+    /*
+      for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
+      tval = 0.0;
+      for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+      tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
+      }
+      S[Ia_idx][Ib_idx] += tval;
+      }
+    */
 
-  /* need to improve mem access pattern here! Above vers may be better! */
-  /* min op cnt may also be better */
-  for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-      if ((tval=F[Jb_idx]) == 0.0) continue;
+    /* need to improve mem access pattern here! Above vers may be better! */
+    /* min op cnt may also be better */
+    for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+        if ((tval=F[Jb_idx]) == 0.0) continue;
 
 #ifdef USE_BLAS
-      C_DAXPY(nas,tval,(C[0]+Jb_idx),Jb_list_nbs,(S[0]+Ib_idx),nbs);
+        C_DAXPY(nas,tval,(C[0]+Jb_idx),Jb_list_nbs,(S[0]+Ib_idx),nbs);
 #else
-      for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
-          S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
-        }
+        for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
+            S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
+          }
 #endif
-    }
+      }
+    } /* end loop over Ib */
   free(F);
 
 }
@@ -487,14 +497,16 @@ void s1_block_vras_thread(struct stringwr **alplist, struct stringwr **betlist,
       int nlists, int nas, int nbs, int Ib_list, int Jb_list, 
       int Jb_list_nbs)
 {
-  struct stringwr *Ib;
   unsigned int Ib_idx;
   struct pthreads_s1vfci **thread_info;
-  int i;
+  int i, chunk, ntask;
+
+  chunk = tpool_chunk(thread_pool, nbs);
+  ntask = (nbs + chunk - 1) / chunk;
 
   thread_info = (struct pthreads_s1vfci **)
-                malloc(sizeof(struct pthreads_s1vfci *) * nbs);
-  for (i=0; i<nbs; i++) {
+                malloc(sizeof(struct pthreads_s1vfci *) * ntask);
+  for (i=0; i<ntask; i++) {
       thread_info[i] = (struct pthreads_s1vfci *)
                        malloc(sizeof(struct pthreads_s1vfci));
     }
@@ -502,30 +514,32 @@ void s1_block_vras_thread(struct stringwr **alplist, struct stringwr **betlist,
   tpool_queue_open(thread_pool);
   
   detci_time.s1_mt_before_time = wall_time_new();
-  /* loop over I_b */
-  for (Ib=betlist[Ib_list], Ib_idx=0; Ib_idx < nbs; Ib_idx++, Ib++) {
-      thread_info[Ib_idx]->alplist=alplist;
-      thread_info[Ib_idx]->betlist=betlist;
-      thread_info[Ib_idx]->C=C;
-      thread_info[Ib_idx]->S=S;
-      thread_info[Ib_idx]->oei=oei;
-      thread_info[Ib_idx]->tei=tei;
-      thread_info[Ib_idx]->nlists=nlists;
-      thread_info[Ib_idx]->nas=nas;
-      thread_info[Ib_idx]->nbs=nbs;
-      thread_info[Ib_idx]->Ib_list=Ib_list;
-      thread_info[Ib_idx]->Jb_list=Jb_list;
-      thread_info[Ib_idx]->Jb_list_nbs=Jb_list_nbs;
-      thread_info[Ib_idx]->Ib=Ib;
-      thread_info[Ib_idx]->Ib_idx=Ib_idx;
-      tpool_add_work(thread_pool, s1_block_vras_pthread, (void *) thread_info[Ib_idx]);
+  /* one work item per range of I_b strings; the item owns those columns of S */
+  for (i=0, Ib_idx=0; i < ntask; i++, Ib_idx += chunk) {
+      thread_info[i]->alplist=alplist;
+      thread_info[i]->betlist=betlist;
+      thread_info[i]->C=C;
+      thread_info[i]->S=S;
+      thread_info[i]->oei=oei;
+      thread_info[i]->tei=tei;
+      thread_info[i]->nlists=nlists;
+      thread_info[i]->nas=nas;
+      thread_info[i]->nbs=nbs;
+      thread_info[i]->Ib_list=Ib_list;
+      thread_info[i]->Jb_list=Jb_list;
+      thread_info[i]->Jb_list_nbs=Jb_list_nbs;
+      thread_info[i]->Ib=betlist[Ib_list] + Ib_idx;
+      thread_info[i]->Ib_idx=Ib_idx;
+      thread_info[i]->Ib_end=(Ib_idx + chunk < nbs) ? Ib_idx + chunk : nbs;
+      tpool_add_work(thread_pool, s1_block_vras_pthread, (void *) thread_info[i]);
     } /* end loop over Ib */
   tpool_queue_close(thread_pool, 1);
 
   detci_time.s1_mt_after_time = wall_time_new();
   detci_time.s1_mt_total_time += detci_time.s1_mt_after_time - detci_time.s1_mt_before_time;
 
-  for (i=0; i<nbs; i++) free(thread_info[i]);
+  for (i=0; i<ntask; i++) free(thread_info[i]);
+  free(thread_info);
 
 }
 
@@ -562,6 +576,7 @@ void s1_block_vras_pthread(void *threadarg)
   double tval;
   double *oei, *tei, **C, **S, *F;
   struct pthreads_s1vfci *thread_info;
+  unsigned int Ib_end;
   int nlists, nas, nbs, Ib_list, Jb_list, Jb_list_nbs;
   
   thread_info = (struct pthreads_s1vfci *) threadarg;
@@ -579,74 +594,78 @@ void s1_block_vras_pthread(void *threadarg)
   Jb_list_nbs = thread_info->Jb_list_nbs;
   Ib = thread_info->Ib;
   Ib_idx = thread_info->Ib_idx;
+  Ib_end = thread_info->Ib_end;
 
   nirreps = CalcInfo.nirreps;
   F = init_array(Jb_list_nbs);
-  zero_arr(F, Jb_list_nbs);
-
-  /* loop over excitations E^b_{kl} from |B(I_b)> */
-  for (Kb_list=0; Kb_list < nlists; Kb_list++) {
-      Ibcnt = Ib->cnt[Kb_list];
-      Ibridx = Ib->ridx[Kb_list];
-      Ibsgn = Ib->sgn[Kb_list];
-      Ibij = Ib->ij[Kb_list];
-      Iboij = Ib->oij[Kb_list];
-      for (Ib_ex=0; Ib_ex < Ibcnt; Ib_ex++) {
-          kl = *Ibij++;
-          okl = *Iboij++;
-          Kb_idx = *Ibridx++;
-          Kb_sgn = (double) *Ibsgn++;
-
-          /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
-          Kb = betlist[Kb_list] + Kb_idx;
-          /* note okl on next line, not kl */
-          if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[okl];
-
-          /* loop over excitations E^b_{ij} from |B(K_b)> */
-          /* Jb_list pre-determined because of C blocking */
-          Kbcnt = Kb->cnt[Jb_list];
-          Kbridx = Kb->ridx[Jb_list];
-          Kbsgn = Kb->sgn[Jb_list];
-          Kbij = Kb->ij[Jb_list];
-          Kboij = Kb->oij[Jb_list];
-          for (Kb_ex=0; Kb_ex < Kbcnt; Kb_ex++) {
-              Jb_idx = *Kbridx++;
-              Jb_sgn = (double) *Kbsgn++;
-              ij = *Kbij++;
-              oij = *Kboij++;
-              ijkl = INDEX(ij,kl);
-              if (oij > okl) 
-                  F[Jb_idx] += Kb_sgn * Jb_sgn * tei[ijkl] ;
-              else if (oij == okl) 
-                  F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl] ;
-            }
-        } /* end loop over Ib excitations */
-    } /* end loop over Kb_list */
+
+  for (; Ib_idx < Ib_end; Ib_idx++, Ib++) {
+    zero_arr(F, Jb_list_nbs);
+
+    /* loop over excitations E^b_{kl} from |B(I_b)> */
+    for (Kb_list=0; Kb_list < nlists; Kb_list++) {
+        Ibcnt = Ib->cnt[Kb_list];
+        Ibridx = Ib->ridx[Kb_list];
+        Ibsgn = Ib->sgn[Kb_list];
+        Ibij = Ib->ij[Kb_list];
+        Iboij = Ib->oij[Kb_list];
+        for (Ib_ex=0; Ib_ex < Ibcnt; Ib_ex++) {
+            kl = *Ibij++;
+            okl = *Iboij++;
+            Kb_idx = *Ibridx++;
+            Kb_sgn = (double) *Ibsgn++;
+
+            /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
+            Kb = betlist[Kb_list] + Kb_idx;
+            /* note okl on next line, not kl */
+            if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[okl];
+
+            /* loop over excitations E^b_{ij} from |B(K_b)> */
+            /* Jb_list pre-determined because of C blocking */
+            Kbcnt = Kb->cnt[Jb_list];
+            Kbridx = Kb->ridx[Jb_list];
+            Kbsgn = Kb->sgn[Jb_list];
+            Kbij = Kb->ij[Jb_list];
+            Kboij = Kb->oij[Jb_list];
+            for (Kb_ex=0; Kb_ex < Kbcnt; Kb_ex++) {
+                Jb_idx = *Kbridx++;
+                Jb_sgn = (double) *Kbsgn++;
+                ij = *Kbij++;
+                oij = *Kboij++;
+                ijkl = INDEX(ij,kl);
+                if (oij > okl) 
+                    F[Jb_idx] += Kb_sgn * Jb_sgn * tei[ijkl] ;
+                else if (oij == okl) 
+                    F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl] ;
+              }
+          } /* end loop over Ib excitations */
+      } /* end loop over Kb_list */
 
       
-  /* 
-     for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
-     tval = 0.0;
-     for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-     tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
-     }
-     S[Ia_idx][Ib_idx] += tval;
-     }
-  */
-
-  /* need to improve mem access pattern here! Above vers may be better!  */
-  /* min op cnt may also be better */
-  for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-      if ((tval=F[Jb_idx]) == 0.0) continue;
+    /* 
+       for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
+       tval = 0.0;
+       for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+       tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
+       }
+       S[Ia_idx][Ib_idx] += tval;
+       }
+    */
+
+    /* need to improve mem access pattern here! Above vers may be better!  */
+    /* min op cnt may also be better */
+    for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+        if ((tval=F[Jb_idx]) == 0.0) continue;
 
 #ifdef USE_BLAS
-      C_DAXPY(nas,tval, (C[0]+Jb_idx), Jb_list_nbs, (S[0]+Ib_idx), nbs);
+        C_DAXPY(nas,tval, (C[0]+Jb_idx), Jb_list_nbs, (S[0]+Ib_idx), nbs);
 #else
-      for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
-          S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
-        }
+        for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
+            S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
+          }
 #endif
-    }
+      }
+    } /* end loop over Ib */
   free(F);
 }
 
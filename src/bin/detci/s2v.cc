@@ -161,7 +161,7 @@ void s2_block_vfci_thread(struct stringwr **alplist, struct stringwr **betlist,
       int nlists, int nas, int nbs, int Ia_list, int Ja_list, 
       int Ja_list_nas)
 {
-  struct stringwr *Ia, *Ka;
+  struct stringwr *Ka;
   unsigned int Ia_idx, Ib_idx, Ka_idx, Ja_idx;
   unsigned int Iacnt, Kacnt, Ka_list, Ia_ex, Ka_ex;
   unsigned int *Iaridx, *Karidx;
@@ -172,11 +172,14 @@ void s2_block_vfci_thread(struct stringwr **alplist, struct stringwr **betlist,
   double tval;
   double *Sptr, *Cptr;
   struct pthreads_s2vfci **thread_info;
-  int i;
+  int i, chunk, ntask;
    
+  chunk = tpool_chunk(thread_pool, nas);
+  ntask = (nas + chunk - 1) / chunk;
+
   thread_info = (struct pthreads_s2vfci **)
-                malloc(sizeof(struct pthreads_s2vfci *) * nas);
-  for (i=0; i<nas; i++) {
+                malloc(sizeof(struct pthreads_s2vfci *) * ntask);
+  for (i=0; i<ntask; i++) {
       thread_info[i] = (struct pthreads_s2vfci *)
                        malloc(sizeof(struct pthreads_s2vfci));
     }
@@ -184,30 +187,32 @@ void s2_block_vfci_thread(struct stringwr **alplist, struct stringwr **betlist,
   tpool_queue_open(thread_pool);
 
   detci_time.s2_mt_before_time = wall_time_new();
-  /* loop over I_a */
-  for (Ia=alplist[Ia_list], Ia_idx=0; Ia_idx < nas; Ia_idx++, Ia++) {
-      thread_info[Ia_idx]->alplist=alplist;
-      thread_info[Ia_idx]->betlist=betlist;
-      thread_info[Ia_idx]->C=C;
-      thread_info[Ia_idx]->S=S;
-      thread_info[Ia_idx]->oei=oei;
-      thread_info[Ia_idx]->tei=tei;
-      thread_info[Ia_idx]->nlists=nlists;
-      thread_info[Ia_idx]->nas=nas;
-      thread_info[Ia_idx]->nbs=nbs;
-      thread_info[Ia_idx]->Ia_list=Ia_list;
-      thread_info[Ia_idx]->Ja_list=Ja_list;
-      thread_info[Ia_idx]->Ja_list_nas=Ja_list_nas;
-      thread_info[Ia_idx]->Ia=Ia;
-      thread_info[Ia_idx]->Ia_idx=Ia_idx;
-      tpool_add_work(thread_pool, s2_block_vfci_pthread, (void *) thread_info[Ia_idx]);
+  /* one work item per range of I_a strings; the item owns those rows of S */
+  for (i=0, Ia_idx=0; i < ntask; i++, Ia_idx += chunk) {
+      thread_info[i]->alplist=alplist;
+      thread_info[i]->betlist=betlist;
+      thread_info[i]->C=C;
+      thread_info[i]->S=S;
+      thread_info[i]->oei=oei;
+      thread_info[i]->tei=tei;
+      thread_info[i]->nlists=nlists;
+      thread_info[i]->nas=nas;
+      thread_info[i]->nbs=nbs;
+      thread_info[i]->Ia_list=Ia_list;
+      thread_info[i]->Ja_list=Ja_list;
+      thread_info[i]->Ja_list_nas=Ja_list_nas;
+      thread_info[i]->Ia=alplist[Ia_list] + Ia_idx;
+      thread_info[i]->Ia_idx=Ia_idx;
+      thread_info[i]->Ia_end=(Ia_idx + chunk < nas) ? Ia_idx + chunk : nas;
+      tpool_add_work(thread_pool, s2_block_vfci_pthread, (void *) thread_info[i]);
     } /* end loop over Ia */
   tpool_queue_close(thread_pool, 1);
 
   detci_time.s2_mt_after_time = wall_time_new();
   detci_time.s2_mt_total_time += detci_time.s2_mt_after_time - detci_time.s2_mt_before_time;
 
-  for (i=0; i<nas; i++) free(thread_info[i]);
+  for (i=0; i<ntask; i++) free(thread_info[i]);
+  free(thread_info);
 }
 
 
@@ -238,6 +243,7 @@ void s2_block_vfci_pthread(void *threadarg)
   double *Sptr, *Cptr, *oei, *tei;
   double *F, **C, **S;
   struct pthreads_s2vfci *thread_info;
+  unsigned int Ia_end;
   int nlists, nas, nbs, Ia_list, Ja_list, Ja_list_nas;
   
   thread_info = (struct pthreads_s2vfci *) threadarg;
@@ -255,65 +261,69 @@ void s2_block_vfci_pthread(void *threadarg)
   Ja_list_nas = thread_info->Ja_list_nas;
   Ia = thread_info->Ia;
   Ia_idx = thread_info->Ia_idx;
+  Ia_end = thread_info->Ia_end;
 
   F = init_array(Ja_list_nas);
-  Sptr = S[Ia_idx];
-  zero_arr(F, Ja_list_nas);
-
-  /* loop over excitations E^a_{kl} from |A(I_a)> */
-  for (Ka_list=0; Ka_list < nlists; Ka_list++) {
-      Iacnt = Ia->cnt[Ka_list];
-      Iaridx = Ia->ridx[Ka_list];
-      Iasgn = Ia->sgn[Ka_list];
-      Iaij = Ia->ij[Ka_list];
-      for (Ia_ex=0; Ia_ex < Iacnt; Ia_ex++) {
-          kl = *Iaij++;
-          Ka_idx = *Iaridx++;
-          Ka_sgn = (double) *Iasgn++;
-
-          /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
-          Ka = alplist[Ka_list] + Ka_idx;
-          if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[kl];
-
-          /* loop over excitations E^a_{ij} from |A(K_a)> */
-          /* Ja_list pre-determined because of C blocking */
-          Kacnt = Ka->cnt[Ja_list];
-          Karidx = Ka->ridx[Ja_list];
-          Kasgn = Ka->sgn[Ja_list];
-          Kaij = Ka->ij[Ja_list];
-          for (Ka_ex=0; Ka_ex < Kacnt; Ka_ex++) {
-              Ja_idx = *Karidx++;
-              Ja_sgn = (double) *Kasgn++;
-              ij = *Kaij++;
-              ijkl = INDEX(ij,kl);
-              F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl] ;
-            }
-        } /* end loop over Ia excitations */
-    } /* end loop over Ka_list */
+
+  for (; Ia_idx < Ia_end; Ia_idx++, Ia++) {
+    Sptr = S[Ia_idx];
+    zero_arr(F, Ja_list_nas);
+
+    /* loop over excitations E^a_{kl} from |A(I_a)> */
+    for (Ka_list=0; Ka_list < nlists; Ka_list++) {
+        Iacnt = Ia->cnt[Ka_list];
+        Iaridx = Ia->ridx[Ka_list];
+        Iasgn = Ia->sgn[Ka_list];
+        Iaij = Ia->ij[Ka_list];
+        for (Ia_ex=0; Ia_ex < Iacnt; Ia_ex++) {
+            kl = *Iaij++;
+            Ka_idx = *Iaridx++;
+            Ka_sgn = (double) *Iasgn++;
+
+            /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
+            Ka = alplist[Ka_list] + Ka_idx;
+            if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[kl];
+
+            /* loop over excitations E^a_{ij} from |A(K_a)> */
+            /* Ja_list pre-determined because of C blocking */
+            Kacnt = Ka->cnt[Ja_list];
+            Karidx = Ka->ridx[Ja_list];
+            Kasgn = Ka->sgn[Ja_list];
+            Kaij = Ka->ij[Ja_list];
+            for (Ka_ex=0; Ka_ex < Kacnt; Ka_ex++) {
+                Ja_idx = *Karidx++;
+                Ja_sgn = (double) *Kasgn++;
+                ij = *Kaij++;
+                ijkl = INDEX(ij,kl);
+                F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl] ;
+              }
+          } /* end loop over Ia excitations */
+      } /* end loop over Ka_list */
 
       
-  /*
-    for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
-    tval = 0.0;
-    for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
-    tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
-    }
-    S[Ia_idx][Ib_idx] += tval;
-    }
-  */
+    /*
+      for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
+      tval = 0.0;
+      for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
+      tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
+      }
+      S[Ia_idx][Ib_idx] += tval;
+      }
+    */
 
-  for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
-      if ((tval=F[Ja_idx]) == 0.0) continue;
-      Cptr = C[Ja_idx];
+    for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
+        if ((tval=F[Ja_idx]) == 0.0) continue;
+        Cptr = C[Ja_idx];
 
 #ifdef USE_BLAS
-      C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
+        C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
 #else   
-      for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
-          Sptr[Ib_idx] += tval * Cptr[Ib_idx];
-        }
+        for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
+            Sptr[Ib_idx] += tval * Cptr[Ib_idx];
+          }
 #endif
-    }
+      }
+    } /* end loop over Ia */
   free(F);
 }
 
@@ -450,14 +460,16 @@ void s2_block_vras_thread(struct stringwr **alplist, struct stringwr **betlist,
       int nlists, int nas, int nbs, int Ia_list, int Ja_list, 
       int Ja_list_nas)
 {
-  struct stringwr *Ia;
   unsigned int Ia_idx;
   struct pthreads_s2vfci **thread_info;
-  int i;
+  int i, chunk, ntask;
+
+  chunk = tpool_chunk(thread_pool, nas);
+  ntask = (nas + chunk - 1) / chunk;
 
   thread_info = (struct pthreads_s2vfci **)
-                malloc(sizeof(struct pthreads_s2vfci *) * nas);
-  for (i=0; i<nas; i++) {
+                malloc(sizeof(struct pthreads_s2vfci *) * ntask);
+  for (i=0; i<ntask; i++) {
       thread_info[i] = (struct pthreads_s2vfci *)
                        malloc(sizeof(struct pthreads_s2vfci));
     }
@@ -466,23 +478,24 @@ void s2_block_vras_thread(struct stringwr **alplist, struct stringwr **betlist,
   detci_time.s2_mt_before_time = wall_time_new();
 
  
-  /* loop over I_a */
-  for (Ia=alplist[Ia_list], Ia_idx=0; Ia_idx < nas; Ia_idx++, Ia++) {
-      thread_info[Ia_idx]->alplist=alplist;
-      thread_info[Ia_idx]->betlist=betlist;
-      thread_info[Ia_idx]->C=C;
-      thread_info[Ia_idx]->S=S;
-      thread_info[Ia_idx]->oei=oei;
-      thread_info[Ia_idx]->tei=tei;
-      thread_info[Ia_idx]->nlists=nlists;
-      thread_info[Ia_idx]->nas=nas;
-      thread_info[Ia_idx]->nbs=nbs;
-      thread_info[Ia_idx]->Ia_list=Ia_list;
-      thread_info[Ia_idx]->Ja_list=Ja_list;
-      thread_info[Ia_idx]->Ja_list_nas=Ja_list_nas;
-      thread_info[Ia_idx]->Ia=Ia;
-      thread_info[Ia_idx]->Ia_idx=Ia_idx;
-      tpool_add_work(thread_pool, s2_block_vras_pthread, (void *) thread_info[Ia_idx]);
+  /* one work item per range of I_a strings; the item owns those rows of S */
+  for (i=0, Ia_idx=0; i < ntask; i++, Ia_idx += chunk) {
+      thread_info[i]->alplist=alplist;
+      thread_info[i]->betlist=betlist;
+      thread_info[i]->C=C;
+      thread_info[i]->S=S;
+      thread_info[i]->oei=oei;
+      thread_info[i]->tei=tei;
+      thread_info[i]->nlists=nlists;
+      thread_info[i]->nas=nas;
+      thread_info[i]->nbs=nbs;
+      thread_info[i]->Ia_list=Ia_list;
+      thread_info[i]->Ja_list=Ja_list;
+      thread_info[i]->Ja_list_nas=Ja_list_nas;
+      thread_info[i]->Ia=alplist[Ia_list] + Ia_idx;
+      thread_info[i]->Ia_idx=Ia_idx;
+      thread_info[i]->Ia_end=(Ia_idx + chunk < nas) ? Ia_idx + chunk : nas;
+      tpool_add_work(thread_pool, s2_block_vras_pthread, (void *) thread_info[i]);
     } /* end loop over Ia */
 
   tpool_queue_close(thread_pool, 1);
@@ -490,7 +503,8 @@ void s2_block_vras_thread(struct stringwr **alplist, struct stringwr **betlist,
   detci_time.s2_mt_total_time += detci_time.s2_mt_after_time - detci_time.s2_mt_before_time;
 
 
-  for (i=0; i<nas; i++) free(thread_info[i]);
+  for (i=0; i<ntask; i++) free(thread_info[i]);
+  free(thread_info);
    
 }
 
@@ -527,6 +541,7 @@ void s2_block_vras_pthread(void *threadarg)
   double tval;
   double *Sptr, *Cptr, *oei, *tei, **C, **S, *F;
   struct pthreads_s2vfci *thread_info;
+  unsigned int Ia_end;
   int nlists, nas, nbs, Ia_list, Ja_list, Ja_list_nas;
 
   thread_info = (struct pthreads_s2vfci *) threadarg;
@@ -544,73 +559,76 @@ void s2_block_vras_pthread(void *threadarg)
   Ja_list_nas = thread_info->Ja_list_nas;
   Ia = thread_info->Ia;
   Ia_idx = thread_info->Ia_idx;
+  Ia_end = thread_info->Ia_end;
 
   F = init_array(Ja_list_nas);
-  Sptr = S[Ia_idx];
-  zero_arr(F, Ja_list_nas);
-
   nirreps = CalcInfo.nirreps;
 
-  /* loop over excitations E^a_{kl} from |A(I_a)> */
-  for (Ka_list=0; Ka_list < nlists; Ka_list++) {
-      Iacnt = Ia->cnt[Ka_list];
-      Iaridx = Ia->ridx[Ka_list];
-      Iasgn = Ia->sgn[Ka_list];
-      Iaij = Ia->ij[Ka_list];
-      Iaoij = Ia->oij[Ka_list];
-      for (Ia_ex=0; Ia_ex < Iacnt; Ia_ex++) {
-          kl = *Iaij++;
-          okl = *Iaoij++;
-          Ka_idx = *Iaridx++;
-          Ka_sgn = (double) *Iasgn++;
-
-          /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
-          Ka = alplist[Ka_list] + Ka_idx;
-          /* note okl on next line, not kl */
-          if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[okl];
-
-          /* loop over excitations E^a_{ij} from |A(K_a)> */
-          /* Ja_list pre-determined because of C blocking */
-          Kacnt = Ka->cnt[Ja_list];
-          Karidx = Ka->ridx[Ja_list];
-          Kasgn = Ka->sgn[Ja_list];
-          Kaij = Ka->ij[Ja_list];
-          Kaoij = Ka->oij[Ja_list];
-          for (Ka_ex=0; Ka_ex < Kacnt; Ka_ex++) {
-              Ja_idx = *Karidx++;
-              Ja_sgn = (double) *Kasgn++;
-              ij = *Kaij++;
-              oij = *Kaoij++;
-              ijkl = INDEX(ij,kl);
-              if (oij > okl) 
-                  F[Ja_idx] += Ka_sgn * Ja_sgn * tei[ijkl] ;
-              else if (oij == okl) 
-                  F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl] ;
-            }
-        } /* end loop over Ia excitations */
-    } /* end loop over Ka_list */
+  for (; Ia_idx < Ia_end; Ia_idx++, Ia++) {
+    Sptr = S[Ia_idx];
+    zero_arr(F, Ja_list_nas);
+
+    /* loop over excitations E^a_{kl} from |A(I_a)> */
+    for (Ka_list=0; Ka_list < nlists; Ka_list++) {
+        Iacnt = Ia->cnt[Ka_list];
+        Iaridx = Ia->ridx[Ka_list];
+        Iasgn = Ia->sgn[Ka_list];
+        Iaij = Ia->ij[Ka_list];
+        Iaoij = Ia->oij[Ka_list];
+        for (Ia_ex=0; Ia_ex < Iacnt; Ia_ex++) {
+            kl = *Iaij++;
+            okl = *Iaoij++;
+            Ka_idx = *Iaridx++;
+            Ka_sgn = (double) *Iasgn++;
+
+            /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
+            Ka = alplist[Ka_list] + Ka_idx;
+            /* note okl on next line, not kl */
+            if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[okl];
+
+            /* loop over excitations E^a_{ij} from |A(K_a)> */
+            /* Ja_list pre-determined because of C blocking */
+            Kacnt = Ka->cnt[Ja_list];
+            Karidx = Ka->ridx[Ja_list];
+            Kasgn = Ka->sgn[Ja_list];
+            Kaij = Ka->ij[Ja_list];
+            Kaoij = Ka->oij[Ja_list];
+            for (Ka_ex=0; Ka_ex < Kacnt; Ka_ex++) {
+                Ja_idx = *Karidx++;
+                Ja_sgn = (double) *Kasgn++;
+                ij = *Kaij++;
+                oij = *Kaoij++;
+                ijkl = INDEX(ij,kl);
+                if (oij > okl) 
+                    F[Ja_idx] += Ka_sgn * Ja_sgn * tei[ijkl] ;
+                else if (oij == okl) 
+                    F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl] ;
+              }
+          } /* end loop over Ia excitations */
+      } /* end loop over Ka_list */
       
-  /*
-    for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
-    tval = 0.0;
-    for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
-    tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
-    }
-    S[Ia_idx][Ib_idx] += tval;
-    }
-  */
+    /*
+      for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
+      tval = 0.0;
+      for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
+      tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
+      }
+      S[Ia_idx][Ib_idx] += tval;
+      }
+    */
 
-  for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
-      if ((tval=F[Ja_idx]) == 0.0) continue;
-      Cptr = C[Ja_idx];
+    for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
+        if ((tval=F[Ja_idx]) == 0.0) continue;
+        Cptr = C[Ja_idx];
 #ifdef USE_BLAS
-      C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
+        C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
 #else
-      for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
-          Sptr[Ib_idx] += tval * Cptr[Ib_idx];
-        }
+        for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
+            Sptr[Ib_idx] += tval * Cptr[Ib_idx];
+          }
 #endif
-    }
+      }
+    } /* end loop over Ia */
   free(F);
 }
 
@@ -36,12 +36,6 @@
 
 namespace psi { namespace detci {
 
-/* Global variables necessary for pthreads */
-pthread_mutex_t inc_Ia_mutex;
-struct stringwr *Ia_global;
-int Ia_idx_global;
-
-
 int form_ilist(struct stringwr *alplist, int Ja_list, int nas, int kl,
    int *L, int *R, double *Sgn);
 int form_ilist_rotf(int *Cnt, int **Ridx, signed char **Sn, int **Ij,
@@ -76,18 +70,18 @@ void s3_block_vdiag(struct stringwr *alplist, struct stringwr *betlist,
   signed char *Iasgn;
   double *Tptr;
   struct pthreads_s3diag **thread_info;
-  int npthreads, rc, status;
-  pthread_t *thread;
-   
-  npthreads = Parameters.nthreads-1;  /* subtract out the main thread */
+  int chunk, ntask;
 
-  thread = (pthread_t *) malloc(sizeof(pthread_t)*Parameters.nthreads);
+  /* each work item is a range of Ia strings and owns those rows of S */
+  chunk = (Parameters.nthreads > 1) ? tpool_chunk(thread_pool, nas) : nas;
+  if (chunk < 1) chunk = 1;
+  ntask = (nas + chunk - 1) / chunk;
 
   thread_info = (struct pthreads_s3diag **)
-                malloc(sizeof(struct pthreads_s3diag *) * nas);
+                malloc(sizeof(struct pthreads_s3diag *) * ntask);
 
-  for (i=0; i<nas; i++) {
-      thread_info[i] = (struct pthreads_s3diag *)
+  for (t=0; t<ntask; t++) {
+      thread_info[t] = (struct pthreads_s3diag *)
                        malloc(sizeof(struct pthreads_s3diag));
     }
   
@@ -121,18 +115,19 @@ void s3_block_vdiag(struct stringwr *alplist, struct stringwr *betlist,
           if (Parameters.nthreads > 1) {
               detci_time.s3_mt_before_time = wall_time_new();
               tpool_queue_open(thread_pool);
-              for (Ia=alplist, Ia_idx=0; Ia_idx<nas; Ia_idx++, Ia++) {
-                  thread_info[Ia_idx]->nas = nas;
-                  thread_info[Ia_idx]->jlen = jlen;
-                  thread_info[Ia_idx]->ij = ij;
-                  thread_info[Ia_idx]->Cprime = Cprime;    
-                  thread_info[Ia_idx]->Ja_list = Ja_list;
-                  thread_info[Ia_idx]->Tptr = Tptr;
-                  thread_info[Ia_idx]->S = S;
-                  thread_info[Ia_idx]->R = R;
-                  thread_info[Ia_idx]->Ia_local = Ia;
-                  thread_info[Ia_idx]->Ia_idx_local = Ia_idx;
-                  tpool_add_work(thread_pool , s3_block_vdiag_pthread, (void *) thread_info[Ia_idx]); 
+              for (t=0, Ia_idx=0; t<ntask; t++, Ia_idx += chunk) {
+                  thread_info[t]->nas = nas;
+                  thread_info[t]->jlen = jlen;
+                  thread_info[t]->ij = ij;
+                  thread_info[t]->Cprime = Cprime;    
+                  thread_info[t]->Ja_list = Ja_list;
+                  thread_info[t]->Tptr = Tptr;
+                  thread_info[t]->S = S;
+                  thread_info[t]->R = R;
+                  thread_info[t]->Ia_local = alplist + Ia_idx;
+                  thread_info[t]->Ia_idx_local = Ia_idx;
+                  thread_info[t]->Ia_idx_end = (Ia_idx + chunk < nas) ? Ia_idx + chunk : nas;
+                  tpool_add_work(thread_pool , s3_block_vdiag_pthread, (void *) thread_info[t]); 
                 }
               tpool_queue_close(thread_pool, 1);
               detci_time.s3_mt_after_time = wall_time_new();
@@ -187,8 +182,8 @@ void s3_block_vdiag(struct stringwr *alplist, struct stringwr *betlist,
         } /* end loop over j */
     } /* end loop over i */
 
-  for (i=0; i<nas; i++) free(thread_info[i]);
-  free(thread);
+  for (t=0; t<ntask; t++) free(thread_info[t]);
+  free(thread_info);
   
 }              
 
@@ -210,7 +205,7 @@ void s3_block_vdiag_pthread(void *threadarg)
   struct stringwr *Ia_local;
   unsigned int Ia_ex;
   int I, J, RJ, kl;
-  double tval, VS, *CprimeI0, *CI0;
+  double tval, VS, *CprimeI0;
   int Jacnt, *Iaij;
   unsigned int *Iaridx;
   signed char *Iasgn;
@@ -218,9 +213,7 @@ void s3_block_vdiag_pthread(void *threadarg)
 
   int nas, jlen, ij, Ja_list;
   double **S, **Cprime, *Tptr, *V;
-  int *R, Ia_idx_local;
-  int loop_var = 0;
-  int thread_id;
+  int *R, Ia_idx_local, Ia_idx_end;
   
   thread_info_i = (struct pthreads_s3diag *) threadarg;
   nas = thread_info_i->nas;
@@ -232,48 +225,46 @@ void s3_block_vdiag_pthread(void *threadarg)
   Tptr = thread_info_i->Tptr;
   R = thread_info_i->R;
   Ia_idx_local = thread_info_i->Ia_idx_local;
+  Ia_idx_end = thread_info_i->Ia_idx_end;
   Ia_local = thread_info_i->Ia_local;
   
   V = init_array(jlen);
-  /* loop over excitations E^a_{kl} from |A(I_a)> */
-  Jacnt = Ia_local->cnt[Ja_list];
-  Iaridx = Ia_local->ridx[Ja_list];
-  Iasgn = Ia_local->sgn[Ja_list];
-  Iaij = Ia_local->ij[Ja_list];
 
-/*
-  fprintf(outfile,"Ia_local = %x\t Ia_idx_local = %d\n", Ia_local, Ia_idx_local);
-  fflush(outfile);
-  
-  fprintf(outfile,"Jacnt = %d\n", Jacnt);
-*/
-      
-  zero_arr(V, jlen);
+  for (; Ia_idx_local < Ia_idx_end; Ia_idx_local++, Ia_local++) {
+
+      /* loop over excitations E^a_{kl} from |A(I_a)> */
+      Jacnt = Ia_local->cnt[Ja_list];
+      Iaridx = Ia_local->ridx[Ja_list];
+      Iasgn = Ia_local->sgn[Ja_list];
+      Iaij = Ia_local->ij[Ja_list];
+
+      zero_arr(V, jlen);
          
-  for (Ia_ex=0; Ia_ex < Jacnt && (kl = *Iaij++)<=ij; Ia_ex++) {
-      I = *Iaridx++;
-      tval = *Iasgn++;
-      if (ij == kl) tval *= 0.5;
-      VS = Tptr[kl] * tval;
-      CprimeI0 = Cprime[I];
+      for (Ia_ex=0; Ia_ex < Jacnt && (kl = *Iaij++)<=ij; Ia_ex++) {
+          I = *Iaridx++;
+          tval = *Iasgn++;
+          if (ij == kl) tval *= 0.5;
+          VS = Tptr[kl] * tval;
+          CprimeI0 = Cprime[I];
            
 #ifdef USE_BLAS
-      C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
+          C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
 #else
+          for (J=0; J<jlen; J++) {
+              V[J] += VS * CprimeI0[J];
+            }
+#endif
+        }
+
+      /* scatter */
       for (J=0; J<jlen; J++) {
-          V[J] += VS * CprimeI0[J];
+          RJ = R[J];
+          S[Ia_idx_local][RJ] += V[J];
         }
-#endif
-    }
 
-  /* scatter */
-  for (J=0; J<jlen; J++) {
-      RJ = R[J];
-      S[Ia_idx_local][RJ] += V[J];
-    }
+    } /* end loop over Ia */
 
   free(V);
-  /* return 0; */
   
 }              
 
@@ -299,17 +290,20 @@ void s3_block_v(struct stringwr *alplist, struct stringwr *betlist,
    signed char *Iasgn;
    double *Tptr;
    struct pthreads_s3diag **thread_info;
-   int t, npthreads, rc, status;
-   pthread_t *thread;
+   int t, chunk, ntask;
    
    norbs = CalcInfo.num_ci_orbs;
    orbsym = CalcInfo.orbsym + CalcInfo.num_fzc_orbs;
 
-   thread = (pthread_t *) malloc(sizeof(pthread_t)*Parameters.nthreads);
+   /* each work item is a range of Ia strings and owns those rows of S */
+   chunk = (Parameters.nthreads > 1) ? tpool_chunk(thread_pool, nas) : nas;
+   if (chunk < 1) chunk = 1;
+   ntask = (nas + chunk - 1) / chunk;
+
    thread_info = (struct pthreads_s3diag **)
-                  malloc(sizeof(struct pthreads_s3diag *) * nas);
-   for (i=0; i<nas; i++) {
-       thread_info[i] = (struct pthreads_s3diag *)
+                  malloc(sizeof(struct pthreads_s3diag *) * ntask);
+   for (t=0; t<ntask; t++) {
+       thread_info[t] = (struct pthreads_s3diag *)
                         malloc(sizeof(struct pthreads_s3diag));
      }
    
@@ -339,18 +333,19 @@ void s3_block_v(struct stringwr *alplist, struct stringwr *betlist,
        if (Parameters.nthreads > 1) {
            detci_time.s3_mt_before_time = wall_time_new();
            tpool_queue_open(thread_pool);
-           for (Ia=alplist, Ia_idx=0; Ia_idx<nas; Ia_idx++, Ia++) {
-               thread_info[Ia_idx]->nas = nas;
-               thread_info[Ia_idx]->jlen = jlen;
-               thread_info[Ia_idx]->ij = ij;
-               thread_info[Ia_idx]->Cprime = Cprime;    
-               thread_info[Ia_idx]->Ja_list = Ja_list;
-               thread_info[Ia_idx]->Tptr = tei;
-               thread_info[Ia_idx]->S = S;
-               thread_info[Ia_idx]->R = R;
-               thread_info[Ia_idx]->Ia_local = Ia;
-               thread_info[Ia_idx]->Ia_idx_local = Ia_idx;
-               tpool_add_work(thread_pool, s3_block_v_pthread, (void *) thread_info[Ia_idx]);
+           for (t=0, Ia_idx=0; t<ntask; t++, Ia_idx += chunk) {
+               thread_info[t]->nas = nas;
+               thread_info[t]->jlen = jlen;
+               thread_info[t]->ij = ij;
+               thread_info[t]->Cprime = Cprime;    
+               thread_info[t]->Ja_list = Ja_list;
+               thread_info[t]->Tptr = tei;
+               thread_info[t]->S = S;
+               thread_info[t]->R = R;
+               thread_info[t]->Ia_local = alplist + Ia_idx;
+               thread_info[t]->Ia_idx_local = Ia_idx;
+               thread_info[t]->Ia_idx_end = (Ia_idx + chunk < nas) ? Ia_idx + chunk : nas;
+               tpool_add_work(thread_pool, s3_block_v_pthread, (void *) thread_info[t]);
              }
            tpool_queue_close(thread_pool, 1);
            detci_time.s3_mt_after_time = wall_time_new();
@@ -398,8 +393,8 @@ void s3_block_v(struct stringwr *alplist, struct stringwr *betlist,
        
      } /* end loop over j */
    } /* end loop over i */
-  for (i=0; i<nas; i++) free(thread_info[i]);
-  free(thread);
+  for (t=0; t<ntask; t++) free(thread_info[t]);
+  free(thread_info);
    
 }
 
@@ -418,18 +413,15 @@ void s3_block_v_pthread(void *threadarg)
   struct stringwr *Ia_local;
   unsigned int Ia_ex;
   int I, J, RJ, kl, ijkl;
-  double tval, VS, *CprimeI0, *CI0;
+  double tval, VS, *CprimeI0;
   int Jacnt, *Iaij;
   unsigned int *Iaridx;
   signed char *Iasgn;
   struct pthreads_s3diag *thread_info_i;
 
   int nas, jlen, ij, Ja_list;
-  double **S, **Cprime, *tei, *V, *Tptr;
-  int *R, Ia_idx_local;
-  int loop_var = 0;
-  int work_units = 0;
-  int thread_id;
+  double **S, **Cprime, *tei, *V;
+  int *R, Ia_idx_local, Ia_idx_end;
 
   thread_info_i = (struct pthreads_s3diag *) threadarg;
   nas = thread_info_i->nas;
@@ -440,47 +432,48 @@ void s3_block_v_pthread(void *threadarg)
   Cprime = thread_info_i->Cprime;
   tei = thread_info_i->Tptr;
   R = thread_info_i->R;
-  thread_id = thread_info_i->thread_id;
   Ia_idx_local = thread_info_i->Ia_idx_local;
+  Ia_idx_end = thread_info_i->Ia_idx_end;
   Ia_local = thread_info_i->Ia_local;
   
   V = init_array(jlen);
 
-  /* loop over excitations E^a_{kl} from |A(I_a)> */
-  Jacnt = Ia_local->cnt[Ja_list];
-  Iaridx = Ia_local->ridx[Ja_list];
-  Iasgn = Ia_local->sgn[Ja_list];
-  Iaij = Ia_local->ij[Ja_list];
+  for (; Ia_idx_local < Ia_idx_end; Ia_idx_local++, Ia_local++) {
+
+      /* loop over excitations E^a_{kl} from |A(I_a)> */
+      Jacnt = Ia_local->cnt[Ja_list];
+      Iaridx = Ia_local->ridx[Ja_list];
+      Iasgn = Ia_local->sgn[Ja_list];
+      Iaij = Ia_local->ij[Ja_list];
 
-  work_units++;
-      
-  zero_arr(V, jlen);
+      zero_arr(V, jlen);
          
-  for (Ia_ex=0; Ia_ex < Jacnt; Ia_ex++) {
-      kl = *Iaij++;
-      I = *Iaridx++;
-      tval = *Iasgn++;
-      ijkl = INDEX(ij,kl);
-      VS = tval * tei[ijkl];
-      CprimeI0 = Cprime[I];
+      for (Ia_ex=0; Ia_ex < Jacnt; Ia_ex++) {
+          kl = *Iaij++;
+          I = *Iaridx++;
+          tval = *Iasgn++;
+          ijkl = INDEX(ij,kl);
+          VS = tval * tei[ijkl];
+          CprimeI0 = Cprime[I];
 
 #ifdef USE_BLAS
-      C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
+          C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
 #else
+          for (J=0; J<jlen; J++) {
+              V[J] += VS * CprimeI0[J];
+            }
+#endif
+        }
+
+      /* scatter */
       for (J=0; J<jlen; J++) {
-          V[J] += VS * CprimeI0[J];
+          RJ = R[J];
+          S[Ia_idx_local][RJ] += V[J];
         }
-#endif
-    }
 
-  /* scatter */
-  for (J=0; J<jlen; J++) {
-      RJ = R[J];
-      S[Ia_idx_local][RJ] += V[J];
-    }
+    } /* end loop over Ia */
 
   free(V);
-  /* return 0; */
   
 }
 
@@ -91,6 +91,7 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
    double *x, *y, tmpx, tmpy;
    double lse_tolerance, *renorm_c, *E_est, ovlpmax=0.0;
    double cknorm, tvalmatt=0.0, tmp; /* Add by CDS for debugging purposes */
+   double eshift = 0.0;
    int errcod;
    std::string str;
 
@@ -154,6 +155,17 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
         CIblks.first_iablk, CIblks.last_iablk, CIblks.decode);
      }
 
+   /* the old subspace vectors may be kept in single precision, while
+      the newest b and sigma vectors stay double until the next ones are
+      appended (see CIvect::demote()); with nodfile the final vectors live
+      in the C file, so they must stay double */
+   if (Parameters.civec_float && !Parameters.nodfile) {
+     Cvec.set_float_storage(1);
+     Cvec2.set_float_storage(1);
+     Sigma.set_float_storage(1);
+     Sigma2.set_float_storage(1);
+     }
+
    /* open the files: some of these CIvectors are logical vectors that
       point to the same files ... don't need to repeat the file opens
       for those
@@ -281,6 +293,12 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
 
       fprintf(outfile, "\nAttempting Restart with %d vectors\n", L);
 
+      /* the files keep the precision they were written in */
+      Cvec.read_storage();
+      Cvec2.copy_storage(Cvec);
+      Sigma.read_storage();
+      Sigma2.copy_storage(Sigma);
+
    /* open detci.dat and write file_offset and file_number array out to
       detci.dat */
 
@@ -599,6 +617,15 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
      Dvec2.restart_reord_fp(maxnvect-1);
      }
 
+   /* With the old vectors in single precision, the sigma vectors are
+      stored for H - eshift, eshift being the electronic SCF energy.
+      sigma ~ E b would otherwise lose |E| * 1e-7 or so to rounding, which
+      is well above the usual convergence thresholds; the shifted sigmas
+      are of the order of the correlation energy.  G and lambda are then
+      shifted as well, and eshift is added back wherever lambda is used
+      as an energy. */
+   if (Sigma.get_float_storage()) eshift = CalcInfo.escf - enuc - efzc;
+
    /* begin iteration */
    while (!converged && iter <= maxiter) {
 
@@ -609,6 +636,13 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
         iter2 > 0 ? Lvec[iter2-1] : 999);
       #endif
 
+      /* the new sigmas are written in double precision, and only rounded
+         by the next demote(), after they have been shifted */
+      if (Sigma.get_float_storage()) {
+        Sigma.set_double_first(Llast);
+        Sigma2.copy_storage(Sigma);
+        }
+
       /* form contributions to the G matrix */
       Cvec.buf_lock(buffer1);
       Sigma.buf_lock(buffer2);
@@ -631,6 +665,8 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
            Sigma.read(i,0);
            }
 
+         if (eshift != 0.0) Sigma.civ_xpeay(-eshift, Cvec, i, i);
+
          if (print_lvl > 3) { /* and this as well */
             fprintf(outfile, "H * b[%d] = \n", i);
             Sigma.print(outfile);
@@ -756,7 +792,8 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
 
        for (i=0; i<L; i++) {
          fprintf(outfile, "\nGuess energy #%d = %15.9lf\n", i,
-           -1.0 * sqrt(sigma_overlap[i][i]) + CalcInfo.enuc + CalcInfo.efzc);
+           -1.0 * sqrt(sigma_overlap[i][i]) + CalcInfo.enuc + CalcInfo.efzc
+           + eshift);
          }
 
        /* diagonalize sigma_overlap to see what that does
@@ -777,7 +814,7 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
        sq_rsp(L, L, M[0], m_lambda[0][0], 1, m_alpha[0][0], 1.0E-14);
        for (i=0; i<L; i++) {
          m_lambda[0][0][i] = -1.0 * sqrt(m_lambda[0][0][i]) +
-           CalcInfo.enuc + CalcInfo.efzc;
+           CalcInfo.enuc + CalcInfo.efzc + eshift;
        }
        fprintf(outfile, "\n Guess energy from H^2 = %15.9lf\n",
          m_lambda[0][0][L]);
@@ -793,6 +830,14 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
            Parameters.collapse_size + 1] + nroots * Parameters.collapse_size
            > maxnvect) && iter != maxiter) {
 
+         /* everything written during the collapse is an old vector */
+         Cvec.demote(L);
+         Sigma.demote(L);
+         Cvec.set_double_first(maxnvect);
+         Cvec2.set_double_first(maxnvect);
+         Sigma.set_double_first(maxnvect);
+         Sigma2.set_double_first(maxnvect);
+
          Cvec.set_nvect(maxnvect);
          Cvec2.set_nvect(maxnvect);
          Sigma.set_nvect(maxnvect);
@@ -935,6 +980,11 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
     Sigma.write_num_vecs(L3);
         L = L2;
         Llast = L;
+        /* the collapsed sigmas are combinations of rounded vectors, and the
+           Schmidt step can blow that error up by the inverse of the norm
+           of the difference of two nearly equal vectors; with single
+           precision storage recompute them before G is formed again */
+        if (Sigma.get_float_storage()) Llast = 0;
         iter2 = 0;  Lvec[0] = L;
         #ifdef DEBUG
         fprintf(outfile, "L = %d, L2 = %d, L3 = %d\n",L, L2, L3);
@@ -958,8 +1008,11 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
           Dvec2.restart_reord_fp(maxnvect-1);
           }
 
-        /* Schmidt-Orthogonalize again to ensure numerical stability */
-        if (ovlpmax > S_MAX) {
+        /* Schmidt-Orthogonalize again to ensure numerical stability.
+           With single precision storage the collapsed vectors are only
+           normalized to about 1E-8, and the first pass divides that error
+           by the norm of a small difference vector, so always redo it */
+        if (ovlpmax > S_MAX || Cvec.get_float_storage()) {
            Cvec.buf_lock(buffer1);
            Cvec2.buf_lock(buffer2);
            L2 = L3 = 1;
@@ -1054,16 +1107,17 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
           Cvec.buf_unlock();
           for (i=0; i<nroots; i++) {
              olsen_iter_xy(Dvec,Sigma,Hd,&tmpx,&tmpy,buffer1,buffer2,
-               lambda[iter2][i]+efzc,i,L,alpha[iter2], alplist, betlist);
+               lambda[iter2][i]+efzc+eshift,i,L,alpha[iter2], alplist,
+               betlist);
              x[i] = tmpx;
              y[i] = tmpy;
              /* fprintf(outfile,"x[%d] = %lf    y[%d] = %lf\n",i,x[i],i,y[i]);
                E_est[i] += efzc; */
-             errcod = H0block_calc(lambda[iter2][i]);
+             errcod = H0block_calc(lambda[iter2][i]+eshift);
              if (!errcod)
                fprintf(outfile,"Determinant of H0block is too small.\n");
              if (Parameters.precon>=PRECON_GEN_DAVIDSON)
-               H0block_xy(&x[i],&y[i],lambda[iter2][i]);
+               H0block_xy(&x[i],&y[i],lambda[iter2][i]+eshift);
         /*
              fprintf(outfile,
                      "Modified x[%d] = %lf y[%d] = %lf\n",i,x[i],i,y[i]);
@@ -1095,7 +1149,7 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
             converged = 0;
             }
          fprintf(outfile, "Iter %2d  Root %2d = %13.9lf",
-            iter, i+1, (lambda[iter2][i] + enuc + efzc));
+            iter, i+1, (lambda[iter2][i] + enuc + efzc + eshift));
          fprintf(outfile, "   Delta_E %10.3E   Delta_C %10.3E %c\n",
             lambda[iter2][i] - lastroot[i], dvecnorm[i],
             root_converged[i] ? 'c' : ' ');
@@ -1114,7 +1168,7 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
          Dvec.buf_lock(buffer2);
          //if (Parameters.nodfile) Dvec.reset_detfile(CI_VEC);
          for (i=0; i<nroots; i++) {
-            evals[i] = lambda[iter2][i];
+            evals[i] = lambda[iter2][i] + eshift;
             tval = alpha[iter2][0][i];
             Dvec.civ_xeay(tval, Cvec, i, 0);
 
@@ -1176,19 +1230,27 @@ void sem_iter(CIvect &Hd, struct stringwr **alplist, struct stringwr
 
       /* form the correction vector and normalize */
 
+      /* the b and sigma vectors so far become old vectors; the new b
+         vectors and their sigmas are kept double */
+      Cvec.demote(L);
+      Cvec2.copy_storage(Cvec);
+      Sigma.demote(L);
+      Sigma2.copy_storage(Sigma);
+
       Dvec.buf_lock(buffer1);
       for (k=0; k<nroots; k++) {
          if (root_converged[k]) continue;
          Hd.buf_lock(buffer2);
          if (Parameters.precon == PRECON_EVANGELISTI)
-           tval = Dvec.dcalc_evangelisti(k, L, lambda[iter2][k]+efzc, Hd, Cvec,
-                buffer1, buffer2, Parameters.precon, L, alplist,
+           tval = Dvec.dcalc_evangelisti(k, L, lambda[iter2][k]+efzc+eshift,
+                Hd, Cvec, buffer1, buffer2, Parameters.precon, L, alplist,
                 betlist, alpha[iter2]);
-         else tval = Dvec.dcalc2(k, lambda[iter2][k]+efzc, Hd,
+         else tval = Dvec.dcalc2(k, lambda[iter2][k]+efzc+eshift, Hd,
                 Parameters.precon, alplist, betlist);
          if (Parameters.precon >= PRECON_GEN_DAVIDSON && (iter >= 1)) {
            if (Parameters.h0block_coupling && (iter >= 2))
-             H0block_coupling_calc(lambda[iter2][k]+efzc, alplist, betlist);
+             H0block_coupling_calc(lambda[iter2][k]+efzc+eshift, alplist,
+               betlist);
            Dvec.h0block_buf_precon(&tval, k);
            }
          if (tval < 1.0E-13 && print_lvl > 0) {
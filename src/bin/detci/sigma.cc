@@ -633,6 +633,7 @@ void sigma_c(struct stringwr **alplist, struct stringwr **betlist,
       S.zero();
       for (cbuf=0; cbuf<C.buf_per_vect; cbuf++) {
          C.read(C.cur_vect, cbuf); /* go ahead and assume it will contrib */
+         if (cbuf+1 < C.buf_per_vect) C.prefetch(C.cur_vect, cbuf+1);
          cairr = C.buf2blk[cbuf];
          cbirr = cairr ^ CalcInfo.ref_sym;
 
@@ -494,6 +494,10 @@ struct params {
                               command line or the DETCASMAN driver? */
    double special_conv;    /* special convergence value */
    int nthreads;           /* number of threads to use in sigma routines */
+   int civec_float;        /* 1 if Davidson subspace vectors are stored
+                              on disk in single precision */
+   int civec_prefetch;     /* 1 if out-of-core sigma reads the next C
+                              buffer while working on the current one */
    int export_ci_vector;   /* 1 if export the CI vector with string info,
                               useful for BODC */
    int num_export;         /* number of vectors to export */
@@ -609,6 +613,7 @@ struct pthreads_s3diag {
     int thread_id;            /* thread id number */
     struct stringwr *Ia_local; /* ptr to string replacement struct */
     int Ia_idx_local;         /* index of c block string */
+    int Ia_idx_end;           /* one past the last string of this task */
 };
 
 struct pthreads_s2vfci {
@@ -626,6 +631,7 @@ struct pthreads_s2vfci {
     int Ja_list_nas;
     struct stringwr *Ia;
     unsigned int Ia_idx;
+    unsigned int Ia_end;      /* one past the last string of this task */
 };
 
 struct pthreads_s1vfci {
@@ -643,6 +649,7 @@ struct pthreads_s1vfci {
     int Jb_list_nbs;
     struct stringwr *Ib;
     unsigned int Ib_idx;
+    unsigned int Ib_end;      /* one past the last string of this task */
 };    
 
 struct detci_timings {
@@ -51,6 +51,10 @@ void tpdm_block(struct stringwr **alplist, struct stringwr **betlist,
 		double *twopdm_aa, double *twopdm_bb, double *twopdm_ab, double **CJ, double **CI, int Ja_list, 
 		int Jb_list, int Jnas, int Jnbs, int Ia_list, int Ib_list, 
 		int Inas, int Inbs, double weight);
+int pdm_fused_fits(int nvect, unsigned long accum);
+void tpdm_fused(struct stringwr **alplist, struct stringwr **betlist,
+                int nroots, const double *C, const double *weights,
+                double *twopdm_aa, double *twopdm_bb, double *twopdm_ab);
 
 
 void tpdm(struct stringwr **alplist, struct stringwr **betlist, 
@@ -81,6 +85,9 @@ void tpdm(struct stringwr **alplist, struct stringwr **betlist,
    char opdm_key[80];
    int root_idx;   /* what root we're on */
    double weight;  /* the weight of that root */
+   int nfused;
+   unsigned long det;
+   double *C_fused, *weights_fused;
 
    nfzc = CalcInfo.num_fzc_orbs;
    populated_orbs = CalcInfo.nmo - CalcInfo.num_fzv_orbs;
@@ -243,6 +250,28 @@ void tpdm(struct stringwr **alplist, struct stringwr **betlist,
      } /* end loop over roots */
    } /* end icore==0 */
 
+   else if (Parameters.icore==1 &&
+            pdm_fused_fits(Parameters.average_num, 2 * (unsigned long) ntri2 +
+                           (unsigned long) ntri * ntri)) {
+     /* all roots in one pass over the string replacements */
+     nfused = Parameters.average_num;
+     C_fused = (double *) malloc(Ivec.vectlen * nfused * sizeof(double));
+     weights_fused = init_array(nfused);
+     for (root_idx=0; root_idx<nfused; root_idx++) {
+       Iroot = Parameters.average_states[root_idx];
+       weights_fused[root_idx] = Parameters.average_weights[root_idx];
+       Ivec.read(Iroot, 0);
+       for (det=0; det<Ivec.vectlen; det++)
+         C_fused[det*nfused+root_idx] = Ivec.buffer[det];
+     }
+
+     tpdm_fused(alplist, betlist, nfused, C_fused, weights_fused,
+                twopdm_aa, twopdm_bb, twopdm_ab);
+
+     free(C_fused);
+     free(weights_fused);
+   } /* end fused icore==1 */
+
    else if (Parameters.icore==1) { /* whole vectors in-core */
 
      for (root_idx=0; root_idx<Parameters.average_num; root_idx++)  {
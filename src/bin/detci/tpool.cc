@@ -300,7 +300,7 @@ void tpool_queue_close(tpool_t tpool, int finish)
   tpool->queue_closed = 1;
   
   if (finish) {
-      if (tpool->cur_queue_size !=0 || tpool->threads_awake != 0) {
+      while (tpool->cur_queue_size !=0 || tpool->threads_awake != 0) {
           if ((rtn = pthread_cond_wait(&(tpool->all_work_done), &(tpool->queue_lock))) !=0){
               str = "pthread_cond_wait ";
               str += boost::lexical_cast<std::string>( rtn) ;
@@ -314,6 +314,23 @@ void tpool_queue_close(tpool_t tpool, int finish)
   
 }
   
+/*
+** tpool_chunk(): Number of consecutive strings to hand out per work item
+** when n strings are split over the pool.  Each thread gets about
+** TPOOL_CHUNKS_PER_THREAD items, so threads that finish early take
+** items the slower ones have not reached yet.
+*/
+int tpool_chunk(tpool_t tpool, int n)
+{
+  int nchunk;
+
+  nchunk = TPOOL_CHUNKS_PER_THREAD * tpool->num_threads;
+  if (nchunk < 1) nchunk = 1;
+  if (n < nchunk) return 1;
+
+  return (n + nchunk - 1) / nchunk;
+}
+
 void *tpool_thread(void *arg)
 {
   std::string str;
@@ -97,6 +97,10 @@ void tpool_queue_open(tpool_t tpool);
 
 void tpool_queue_close(tpool_t tpool, int finish);
 
+#define TPOOL_CHUNKS_PER_THREAD 4
+
+int tpool_chunk(tpool_t tpool, int n);
+
 }} // namespace psi::detci
 
 #endif // header guard
@@ -30,6 +30,7 @@
 #include <libqt/qt.h>
 #include <libpsio/psio.hpp>
 #include <libpsio/psio.h>
+#include <libpsio/aiohandler.h>
 #include <psi4-dec.h>
 #include <physconst.h>
 #include <psifiles.h>
@@ -45,6 +46,51 @@ using namespace std;
 namespace psi {
 namespace dfmp2 {
 
+namespace {
+
+/* A strided block of a disk entry: nrow pieces of len doubles, piece r
+   at offset start + r * stride doubles, packed back to back in buf */
+struct DiskBlock {
+    const char* label;
+    double* buf;
+    ULI nrow;
+    ULI len;
+    ULI stride;
+    ULI start;
+    psio_address end;
+};
+
+/* Queue the read of a block on aio.  The data is in buf after
+   aio->synchronize(); until then the caller must not touch psio. */
+void aio_read_block(boost::shared_ptr<AIOHandler> aio, unsigned int file, DiskBlock& block)
+{
+    if (block.nrow == 1L || block.stride == block.len) {
+        aio->read(file, block.label, (char*) block.buf, sizeof(double) * block.nrow * block.len,
+                  psio_get_address(PSIO_ZERO, sizeof(double) * block.start), &block.end);
+        return;
+    }
+    for (ULI r = 0L; r < block.nrow; r++) {
+        aio->read(file, block.label, (char*) &block.buf[r * block.len], sizeof(double) * block.len,
+                  psio_get_address(PSIO_ZERO, sizeof(double) * (block.start + r * block.stride)), &block.end);
+    }
+}
+
+/* Queue the write of a block on aio, done after aio->synchronize() */
+void aio_write_block(boost::shared_ptr<AIOHandler> aio, unsigned int file, DiskBlock& block)
+{
+    if (block.nrow == 1L || block.stride == block.len) {
+        aio->write(file, block.label, (char*) block.buf, sizeof(double) * block.nrow * block.len,
+                   psio_get_address(PSIO_ZERO, sizeof(double) * block.start), &block.end);
+        return;
+    }
+    for (ULI r = 0L; r < block.nrow; r++) {
+        aio->write(file, block.label, (char*) &block.buf[r * block.len], sizeof(double) * block.len,
+                   psio_get_address(PSIO_ZERO, sizeof(double) * (block.start + r * block.stride)), &block.end);
+    }
+}
+
+}
+
 
 void DFMP2::compute_opdm_and_nos(const SharedMatrix Dnosym, SharedMatrix Dso, SharedMatrix Cno, SharedVector occ)
 {
@@ -173,6 +219,7 @@ void DFMP2::common_init()
 
     sss_ = options_.get_double("MP2_SS_SCALE");
     oss_ = options_.get_double("MP2_OS_SCALE");
+    laplace_ = false;
 
     boost::shared_ptr<BasisSetParser> parser(new Gaussian94BasisSetParser());
     ribasis_ = BasisSet::construct(parser, molecule_, "DF_BASIS_MP2");
@@ -407,13 +454,13 @@ SharedMatrix DFMP2::form_inverse_metric()
 }
 void DFMP2::apply_fitting(SharedMatrix Jm12, unsigned int file, ULI naux, ULI nia)
 {
-    // Memory constraints
+    // Memory constraints: two Aia and two Qia blocks for double buffering
     ULI Jmem = naux * naux;
     ULI doubles = (ULI) (options_.get_double("DFMP2_MEM_FACTOR") * (memory_ / 8L));
     if (doubles < 2L * Jmem) {
         throw PSIEXCEPTION("DFMP2: More memory required for tractable disk transpose");
     }
-    ULI rem = (doubles - Jmem) / 2L;
+    ULI rem = (doubles - Jmem) / 4L;
     ULI max_nia = (rem / naux);
     max_nia = (max_nia > nia ? nia : max_nia);
     max_nia = (max_nia < 1L ? 1L : max_nia);
@@ -429,45 +476,77 @@ void DFMP2::apply_fitting(SharedMatrix Jm12, unsigned int file, ULI naux, ULI ni
         }
     }
     //block_status(ia_starts, __FILE__,__LINE__);
+    int nblock = ia_starts.size() - 1;
 
-    // Tensor blocks
-    SharedMatrix Aia(new Matrix("Aia", naux, max_nia));
-    SharedMatrix Qia(new Matrix("Qia", max_nia, naux));
-    double** Aiap = Aia->pointer();
-    double** Qiap = Qia->pointer();
+    // Tensor blocks, packed as naux x ncols and ncols x naux
+    double* Aiap[2];
+    double* Qiap[2];
+    for (int k = 0; k < 2; k++) {
+        Aiap[k] = new double[naux * max_nia];
+        Qiap[k] = new double[max_nia * naux];
+    }
     double** Jp   = Jm12->pointer();
 
-    // Loop through blocks
+    DiskBlock reads[2];
+    DiskBlock writes[2];
+    reads[0].label = "(A|ia)"; reads[0].buf = Aiap[0];
+    reads[0].nrow = naux; reads[0].len = ia_starts[1]; reads[0].stride = nia; reads[0].start = 0L;
+
+    // Loop through blocks, reading block+1 and writing block-1 during the fitting of block
     psio_->open(file, PSIO_OPEN_OLD);
-    psio_address next_AIA = PSIO_ZERO;
-    psio_address next_QIA = PSIO_ZERO;
-    for (int block = 0; block < ia_starts.size() - 1; block++) {
+
+    boost::shared_ptr<AIOHandler> aio(new AIOHandler(psio_));
+
+    timer_on("DFMP2 Aia Read");
+    aio_read_block(aio, file, reads[0]);
+    aio->synchronize();
+    timer_off("DFMP2 Aia Read");
+
+    for (int block = 0; block < nblock; block++) {
 
         // Sizing
         ULI ia_start = ia_starts[block];
         ULI ia_stop  = ia_starts[block+1];
         ULI ncols = ia_stop - ia_start;
-
-        // Read Aia
-        timer_on("DFMP2 Aia Read");
-        for (ULI Q = 0; Q < naux; Q++) {
-            next_AIA = psio_get_address(PSIO_ZERO,sizeof(double)*(Q*nia+ia_start));
-            psio_->read(file,"(A|ia)",(char*)Aiap[Q],sizeof(double)*ncols,next_AIA,&next_AIA);
+        int cur = block % 2;
+        int nxt = (block + 1) % 2;
+
+        if (block + 1 < nblock) {
+            ULI ncols_next = ia_starts[block+2] - ia_starts[block+1];
+            reads[nxt].label = "(A|ia)"; reads[nxt].buf = Aiap[nxt];
+            reads[nxt].nrow = naux; reads[nxt].len = ncols_next; reads[nxt].stride = nia;
+            reads[nxt].start = ia_starts[block+1];
         }
-        timer_off("DFMP2 Aia Read");
+        bool pending = (block > 0 || block + 1 < nblock);
+        if (block > 0) aio_write_block(aio, file, writes[nxt]);
+        if (block + 1 < nblock) aio_read_block(aio, file, reads[nxt]);
 
         // Apply Fitting
         timer_on("DFMP2 (Q|A)(A|ia)");
-        C_DGEMM('T','N',ncols,naux,naux,1.0,Aiap[0],max_nia,Jp[0],naux,0.0,Qiap[0],naux);
+        C_DGEMM('T','N',ncols,naux,naux,1.0,Aiap[cur],ncols,Jp[0],naux,0.0,Qiap[cur],naux);
         timer_off("DFMP2 (Q|A)(A|ia)");
 
-        // Write Qia
-        timer_on("DFMP2 Qia Write");
-        psio_->write(file,"(Q|ia)",(char*)Qiap[0],sizeof(double)*ncols*naux,next_QIA,&next_QIA);
-        timer_off("DFMP2 Qia Write");
+        timer_on("DFMP2 Qia I/O Wait");
+        if (pending) aio->synchronize();
+        timer_off("DFMP2 Qia I/O Wait");
 
+        writes[cur].label = "(Q|ia)"; writes[cur].buf = Qiap[cur];
+        writes[cur].nrow = 1L; writes[cur].len = ncols * naux; writes[cur].stride = ncols * naux;
+        writes[cur].start = ia_start * naux;
     }
+
+    // Write the last Qia
+    timer_on("DFMP2 Qia Write");
+    aio_write_block(aio, file, writes[(nblock - 1) % 2]);
+    aio->synchronize();
+    timer_off("DFMP2 Qia Write");
+
     psio_->close(file, 1);
+
+    for (int k = 0; k < 2; k++) {
+        delete[] Aiap[k];
+        delete[] Qiap[k];
+    }
 }
 void DFMP2::apply_fitting_grad(SharedMatrix Jm12, unsigned int file, ULI naux, ULI nia)
 {
@@ -594,122 +673,186 @@ void DFMP2::apply_gamma(unsigned int file, ULI naux, ULI nia)
 
     psio_->close(file,1);
 }
-void DFMP2::apply_G_transpose(unsigned int file, ULI naux, ULI nia)
+void DFMP2::transpose_disk(unsigned int file, const char* in_label, const char* out_label,
+    ULI nrow, ULI ncol, ULI nelem)
 {
-    // Memory constraints
+    // Memory constraints: two input and two output blocks for double buffering
     ULI doubles = (ULI) (options_.get_double("DFMP2_MEM_FACTOR") * (memory_ / 8L));
-    ULI max_nia = (doubles / naux);
-    max_nia = (max_nia > nia ? nia : max_nia);
-    max_nia = (max_nia < 1L ? 1L : max_nia);
+    ULI max_block = doubles / 4L;
+
+    // Block over input rows (contiguous reads, strided writes) or input
+    // columns (strided reads, contiguous writes), whichever gives the
+    // longer strided pieces
+    bool by_rows = (ncol < nrow);
+    ULI ntot = (by_rows ? nrow : ncol);
+    ULI stripe = (by_rows ? ncol : nrow) * nelem;
+    if (max_block < stripe) {
+        throw PSIEXCEPTION("DFMP2: More memory required for tractable disk transpose");
+    }
+    ULI max_n = max_block / stripe;
+    max_n = (max_n > ntot ? ntot : max_n);
 
     // Block sizing
-    std::vector<ULI> ia_starts;
-    ia_starts.push_back(0);
-    for (ULI ia = 0L; ia < nia; ia+=max_nia) {
-        if (ia + max_nia >= nia) {
-            ia_starts.push_back(nia);
-        } else {
-            ia_starts.push_back(ia + max_nia);
-        }
+    std::vector<ULI> starts;
+    for (ULI n = 0L; n < ntot; n += max_n) {
+        starts.push_back(n);
     }
-    //block_status(ia_starts, __FILE__,__LINE__);
+    starts.push_back(ntot);
+    //block_status(starts, __FILE__,__LINE__);
+    int nblock = starts.size() - 1;
 
-    // Prestripe
-    psio_->open(file, PSIO_OPEN_OLD);
-    psio_address next_AIA = PSIO_ZERO;
-    psio_address next_QIA = PSIO_ZERO;
-    double* temp = new double[nia];
-    ::memset((void*) temp, '\0', sizeof(double) * nia);
-    for (int Q = 0; Q < naux; Q++) {
-        psio_->write(file,"(G|ia) T",(char*)temp,sizeof(double)*nia,next_QIA,&next_QIA);
+    double* in[2];
+    double* out[2];
+    for (int k = 0; k < 2; k++) {
+        in[k]  = new double[max_n * stripe];
+        out[k] = new double[max_n * stripe];
     }
-    delete[] temp;
-    next_QIA = PSIO_ZERO; 
 
-    // Tensor blocks
-    SharedMatrix Aia(new Matrix("Aia", naux, max_nia));
-    SharedMatrix Qia(new Matrix("Qia", max_nia, naux));
-    double** Aiap = Aia->pointer();
-    double** Qiap = Qia->pointer();
-
-    // Loop through blocks
-    for (int block = 0; block < ia_starts.size() - 1; block++) {
-
-        // Sizing
-        ULI ia_start = ia_starts[block];
-        ULI ia_stop  = ia_starts[block+1];
-        ULI ncols = ia_stop - ia_start;
-
-        // Read Gia
-        timer_on("DFMP2 Gia Read");
-        psio_->read(file,"(G|ia)",(char*)Qiap[0],sizeof(double)*ncols*naux,next_QIA,&next_QIA);
-        timer_off("DFMP2 Gia Read");
+    psio_->open(file, PSIO_OPEN_OLD);
 
-        // Transpose
-        for (int Q = 0; Q < naux; Q++) {
-            C_DCOPY(ncols, &Qiap[0][Q], naux, Aiap[Q], 1);
-        } 
+    // Prestripe, as the strided writes do not land in order
+    if (by_rows) {
+        double* temp = new double[nrow * nelem];
+        ::memset((void*) temp, '\0', sizeof(double) * nrow * nelem);
+        psio_address next = PSIO_ZERO;
+        for (ULI c = 0L; c < ncol; c++) {
+            psio_->write(file,out_label,(char*)temp,sizeof(double)*nrow*nelem,next,&next);
+        }
+        delete[] temp;
+    }
+
+    // Input block n0..n0+n of the blocked index and its transposed output block
+    DiskBlock reads[2];
+    DiskBlock writes[2];
+    boost::shared_ptr<AIOHandler> aio(new AIOHandler(psio_));
+
+    for (int block = -1; block < nblock; block++) {
+        int nxt = (block + 1) % 2;
+
+        // Describe the next input block
+        if (block + 1 < nblock) {
+            ULI n0 = starts[block+1];
+            ULI n  = starts[block+2] - n0;
+            DiskBlock& r = reads[nxt];
+            r.label = in_label;
+            r.buf = in[nxt];
+            if (by_rows) {
+                r.nrow = 1L; r.len = n * ncol * nelem; r.stride = r.len; r.start = n0 * ncol * nelem;
+            } else {
+                r.nrow = nrow; r.len = n * nelem; r.stride = ncol * nelem; r.start = n0 * nelem;
+            }
+        }
 
-        // Write Gia^\dagger
-        timer_on("DFMP2 aiG Write");
-        for (ULI Q = 0; Q < naux; Q++) {
-            next_AIA = psio_get_address(PSIO_ZERO,sizeof(double)*(Q*nia+ia_start));
-            psio_->write(file,"(G|ia) T",(char*)Aiap[Q],sizeof(double)*ncols,next_AIA,&next_AIA);
+        // The first block is read up front, later ones behind the permutes
+        if (block < 0) {
+            timer_on("DFMP2 Transpose Read");
+            aio_read_block(aio, file, reads[0]);
+            aio->synchronize();
+            timer_off("DFMP2 Transpose Read");
+            continue;
         }
-        timer_off("DFMP2 aiG Write");
-    }
-    psio_->close(file, 1);
-}
-void DFMP2::apply_B_transpose(unsigned int file, ULI naux, ULI naocc, ULI navir)
-{
-    // Memory constraints
-    ULI doubles = (ULI) (options_.get_double("DFMP2_MEM_FACTOR") * (memory_ / 8L));
-    ULI rows = doubles / (1L * naocc * naux);
-    int max_A = (rows <= 0L ? 1L : rows);
-    max_A = (rows > navir ? navir : rows);
 
-    // Block sizing
-    std::vector<int> a_starts;
-    a_starts.push_back(0);
-    for (int a = 0; a < navir; a+= max_A) { 
-        if (a + max_A >= navir) {
-            a_starts.push_back(navir);
+        int cur = block % 2;
+        bool pending = (block > 0 || block + 1 < nblock);
+        if (block > 0) aio_write_block(aio, file, writes[nxt]);
+        if (block + 1 < nblock) aio_read_block(aio, file, reads[nxt]);
+
+        // In-memory permute of the R x C block of nelem-vectors to C x R
+        ULI n0 = starts[block];
+        ULI n  = starts[block+1] - n0;
+        ULI R = (by_rows ? n : nrow);
+        ULI C = (by_rows ? ncol : n);
+        double* inp  = in[cur];
+        double* outp = out[cur];
+        const long int tile = (nelem == 1L ? 64L : 1L);
+        timer_on("DFMP2 Transpose Permute");
+        #pragma omp parallel for schedule(static)
+        for (long int c0 = 0L; c0 < (long int) C; c0 += tile) {
+            ULI c1 = (c0 + tile > C ? C : c0 + tile);
+            for (ULI r0 = 0L; r0 < R; r0 += tile) {
+                ULI r1 = (r0 + tile > R ? R : r0 + tile);
+                for (ULI c = c0; c < c1; c++) {
+                    for (ULI r = r0; r < r1; r++) {
+                        if (nelem == 1L) {
+                            outp[c * R + r] = inp[r * C + c];
+                        } else {
+                            ::memcpy((void*) &outp[(c * R + r) * nelem], (void*) &inp[(r * C + c) * nelem], sizeof(double) * nelem);
+                        }
+                    }
+                }
+            }
+        }
+        timer_off("DFMP2 Transpose Permute");
+
+        timer_on("DFMP2 Transpose I/O Wait");
+        if (pending) aio->synchronize();
+        timer_off("DFMP2 Transpose I/O Wait");
+
+        // Describe this output block
+        DiskBlock& w = writes[cur];
+        w.label = out_label;
+        w.buf = out[cur];
+        if (by_rows) {
+            w.nrow = ncol; w.len = n * nelem; w.stride = nrow * nelem; w.start = n0 * nelem;
         } else {
-            a_starts.push_back(a + max_A);
+            w.nrow = 1L; w.len = n * nrow * nelem; w.stride = w.len; w.start = n0 * nrow * nelem;
         }
     }
-    //block_status(a_starts, __FILE__,__LINE__);
 
-    // Buffers
-    SharedMatrix iaQ(new Matrix("iaQ", max_A * naocc, naux)); 
-    double** iaQp = iaQ->pointer();
-    
-    // Loop through blocks
-    psio_->open(file, PSIO_OPEN_OLD);
-    psio_address next_AIA = PSIO_ZERO;
-    psio_address next_QIA = PSIO_ZERO;
-    for (int block = 0; block < a_starts.size() - 1; block++) {
-    
-        // Sizing
-        int a_start = a_starts[block];
-        int a_stop  = a_starts[block+1];
-        int na = a_stop - a_start;
-            
-        // Read iaQ
-        for (int a = 0; a < na; a++) {
-            for (int i = 0; i < naocc; i++) {
-                next_AIA = psio_get_address(PSIO_ZERO, sizeof(double) * (i * navir * naux + (a + a_start) * naux));
-                psio_->read(file, "(Q|ia)", (char*) iaQp[a * naocc + i], sizeof(double) * naux, next_AIA, &next_AIA);
-            }
-        }
+    // Write the last block
+    timer_on("DFMP2 Transpose Write");
+    aio_write_block(aio, file, writes[(nblock - 1) % 2]);
+    aio->synchronize();
+    timer_off("DFMP2 Transpose Write");
 
-        // Write aiQ
-        psio_->write(file, "(Q|ai)", (char*) iaQp[0], sizeof(double) * na * naocc * naux, next_QIA, &next_QIA);
-    }
     psio_->close(file, 1);
+
+    for (int k = 0; k < 2; k++) {
+        delete[] in[k];
+        delete[] out[k];
+    }
+}
+void DFMP2::apply_G_transpose(unsigned int file, ULI naux, ULI nia)
+{
+    // (G|ia) is nia x naux, (G|ia) T is naux x nia
+    transpose_disk(file, "(G|ia)", "(G|ia) T", nia, naux, 1L);
+}
+void DFMP2::apply_B_transpose(unsigned int file, ULI naux, ULI naocc, ULI navir)
+{
+    // (Q|ia) is naocc x navir of naux-vectors, (Q|ai) is navir x naocc
+    transpose_disk(file, "(Q|ia)", "(Q|ai)", naocc, navir, naux);
 }
 void DFMP2::print_energies()
 {
+    // The Laplace energy has no same-spin part, so only the SOS-MP2 energy is defined
+    if (laplace_) {
+        energies_["SOS Opposite-Spin Energy"] = oss_*energies_["Opposite-Spin Energy"];
+        energies_["SOS Correlation Energy"] = energies_["SOS Opposite-Spin Energy"] + energies_["Singles Energy"];
+        energies_["SOS Total Energy"] = energies_["Reference Energy"] + energies_["SOS Correlation Energy"];
+        energies_["Total Energy"] = energies_["SOS Total Energy"];
+
+        fprintf(outfile, "\t----------------------------------------------------------\n");
+        fprintf(outfile, "\t ============> DF-SOS-MP2 Energies (Laplace) <=========== \n");
+        fprintf(outfile, "\t----------------------------------------------------------\n");
+        fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Reference Energy",         energies_["Reference Energy"]);
+        fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Singles Energy",           energies_["Singles Energy"]);
+        fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Opposite-Spin Energy",     energies_["Opposite-Spin Energy"]);
+        fprintf(outfile, "\t %-25s = %24.16f [-]\n", "SOS Opposite-Spin Scale",  oss_);
+        fprintf(outfile, "\t %-25s = %24.16f [H]\n", "SOS Correlation Energy",   energies_["SOS Correlation Energy"]);
+        fprintf(outfile, "\t %-25s = %24.16f [H]\n", "SOS Total Energy",         energies_["SOS Total Energy"]);
+        fprintf(outfile, "\t----------------------------------------------------------\n");
+        fprintf(outfile, "\n");
+        fflush(outfile);
+
+        Process::environment.globals["CURRENT ENERGY"] = energies_["SOS Total Energy"];
+        Process::environment.globals["CURRENT CORRELATION ENERGY"] = energies_["SOS Correlation Energy"];
+        Process::environment.globals["MP2 SINGLES ENERGY"] = energies_["Singles Energy"];
+        Process::environment.globals["MP2 OPPOSITE-SPIN CORRELATION ENERGY"] = energies_["Opposite-Spin Energy"];
+        Process::environment.globals["SOS-MP2 TOTAL ENERGY"] = energies_["SOS Total Energy"];
+        Process::environment.globals["SOS-MP2 CORRELATION ENERGY"] = energies_["SOS Correlation Energy"];
+        return;
+    }
+
     energies_["Correlation Energy"] = energies_["Opposite-Spin Energy"] + energies_["Same-Spin Energy"] + energies_["Singles Energy"];
     energies_["Total Energy"] = energies_["Reference Energy"] + energies_["Correlation Energy"];
 
@@ -864,13 +1007,19 @@ void RDFMP2::form_Aia()
     int navir = Cavir_->colspi()[0];
     int maxQ = ribasis_->max_function_per_shell();
 
-    // Max block size in naux
-    ULI Amn_cost_per_row = nso * (ULI) nso;
-    ULI Ami_cost_per_row = nso * (ULI) naocc;
-    ULI Aia_cost_per_row = naocc * (ULI) navir;
-    ULI total_cost_per_row = Amn_cost_per_row + Ami_cost_per_row + Aia_cost_per_row;
+    // Per-thread (Q|mn) and (Q|mi) scratch for one aux shell
+    ULI Amn_cost_per_thread = maxQ * (ULI) nso * nso;
+    ULI Ami_cost_per_thread = nso * (ULI) naocc;
+    ULI thread_cost = nthread * (Amn_cost_per_thread + Ami_cost_per_thread);
+
+    // Max block size in naux, with two (A|ia) blocks so one can be written
+    // while the next is formed
+    ULI Aia_cost_per_row = 2L * naocc * (ULI) navir;
     ULI doubles = ((ULI) (options_.get_double("DFMP2_MEM_FACTOR") * memory_ / 8L));
-    ULI max_temp = doubles / (total_cost_per_row);
+    if (doubles < thread_cost) {
+        throw PSIEXCEPTION("DFMP2: Insufficient memory for (A|mn) buffers. Reduce OMP Threads or increase memory.");
+    }
+    ULI max_temp = (doubles - thread_cost) / Aia_cost_per_row;
     int max_naux = (max_temp > (ULI) naux ? naux : max_temp);
     max_naux = (max_naux < maxQ ? maxQ : max_naux);
 
@@ -890,19 +1039,24 @@ void RDFMP2::form_Aia()
     //block_status(block_Q_starts, __FILE__,__LINE__);
 
     // Tensor blocks
-    SharedMatrix Amn(new Matrix("(A|mn) Block", max_naux, nso * (ULI) nso));
-    SharedMatrix Ami(new Matrix("(A|mi) Block", max_naux, nso * (ULI) naocc));
-    SharedMatrix Aia(new Matrix("(A|ia) Block", max_naux, naocc * (ULI) navir));
-    double** Amnp = Amn->pointer();
-    double** Amip = Ami->pointer();
-    double** Aiap = Aia->pointer();
+    std::vector<SharedMatrix> Amn;
+    std::vector<SharedMatrix> Ami;
+    for (int thread = 0; thread < nthread; thread++) {
+        Amn.push_back(SharedMatrix(new Matrix("(A|mn) Block", maxQ, nso * (ULI) nso)));
+        Ami.push_back(SharedMatrix(new Matrix("(A|mi) Block", nso, naocc)));
+    }
+    SharedMatrix Aia[2];
+    Aia[0] = SharedMatrix(new Matrix("(A|ia) Block", max_naux, naocc * (ULI) navir));
+    Aia[1] = SharedMatrix(new Matrix("(A|ia) Block", max_naux, naocc * (ULI) navir));
 
     // C Matrices
     double** Caoccp = Caocc_->pointer();
     double** Cavirp = Cavir_->pointer();
 
     psio_->open(PSIF_DFMP2_AIA,PSIO_OPEN_NEW);
-    psio_address next_AIA = PSIO_ZERO;
+    DiskBlock writes[2];
+    boost::shared_ptr<AIOHandler> aio(new AIOHandler(psio_));
+    bool pending = false;
 
     // Loop over blocks of Qshell
     for (int block = 0; block < block_Q_starts.size() - 1; block++) {
@@ -916,68 +1070,81 @@ void RDFMP2::form_Aia()
                      ribasis_->shell(Qstart).function_index() :
                      ribasis_->shell(Qstop).function_index() -
                      ribasis_->shell(Qstart).function_index());
+        double** Aiap = Aia[block % 2]->pointer();
 
-        // Clear Amn for Schwarz sieve
-        ::memset((void*) Amnp[0], '\0', sizeof(double) * nrows * nso * nso);
-
-        // Compute TEI tensor block (A|mn)
-        timer_on("DFMP2 (A|mn)");
+        // Compute (A|ia) = (A|mn) C_mi C_na one aux shell at a time, without
+        // forming the (A|mn) or (A|mi) block
+        timer_on("DFMP2 (A|ia) Fused");
         #pragma omp parallel for schedule(dynamic) num_threads(nthread)
-        for (long int QMN = 0L; QMN < (Qstop - Qstart) * (ULI) npairs; QMN++) {
+        for (int Q = Qstart; Q < Qstop; Q++) {
 
             int thread = 0;
             #ifdef _OPENMP
                 thread = omp_get_thread_num();
             #endif
 
-            int Q =  QMN / npairs + Qstart;
-            int MN = QMN % npairs;
-
-            std::pair<int,int> pair = shell_pairs[MN];
-            int M = pair.first;
-            int N = pair.second;
+            double** Amnp = Amn[thread]->pointer();
+            double** Amip = Ami[thread]->pointer();
 
             int nq = ribasis_->shell(Q).nfunction();
-            int nm = basisset_->shell(M).nfunction();
-            int nn = basisset_->shell(N).nfunction();
+            int sq = ribasis_->shell(Q).function_index();
 
-            int sq =  ribasis_->shell(Q).function_index();
-            int sm =  basisset_->shell(M).function_index();
-            int sn =  basisset_->shell(N).function_index();
+            // Clear Amn for Schwarz sieve
+            ::memset((void*) Amnp[0], '\0', sizeof(double) * nq * nso * nso);
 
-            eri[thread]->compute_shell(Q,0,M,N);
+            for (size_t MN = 0; MN < npairs; MN++) {
 
-            for (int oq = 0; oq < nq; oq++) {
-                for (int om = 0; om < nm; om++) {
-                    for (int on = 0; on < nn; on++) {
-                        Amnp[sq + oq - qoff][(om + sm) * nso + (on + sn)] =
-                        Amnp[sq + oq - qoff][(on + sn) * nso + (om + sm)] =
-                        buffer[thread][oq * nm * nn + om * nn + on];
+                std::pair<int,int> pair = shell_pairs[MN];
+                int M = pair.first;
+                int N = pair.second;
+
+                int nm = basisset_->shell(M).nfunction();
+                int nn = basisset_->shell(N).nfunction();
+
+                int sm =  basisset_->shell(M).function_index();
+                int sn =  basisset_->shell(N).function_index();
+
+                eri[thread]->compute_shell(Q,0,M,N);
+
+                for (int oq = 0; oq < nq; oq++) {
+                    for (int om = 0; om < nm; om++) {
+                        for (int on = 0; on < nn; on++) {
+                            Amnp[oq][(om + sm) * nso + (on + sn)] =
+                            Amnp[oq][(on + sn) * nso + (om + sm)] =
+                            buffer[thread][oq * nm * nn + om * nn + on];
+                        }
                     }
                 }
             }
-        }
-        timer_off("DFMP2 (A|mn)");
 
-        // Compute (A|mi) tensor block (A|mn) C_ni
-        timer_on("DFMP2 (A|mn)C_mi");
-        C_DGEMM('N','N',nrows*(ULI)nso,naocc,nso,1.0,Amnp[0],nso,Caoccp[0],naocc,0.0,Amip[0],naocc);
-        timer_off("DFMP2 (A|mn)C_mi");
-
-        // Compute (A|ia) tensor block (A|ia) = (A|mi) C_ma
-        timer_on("DFMP2 (A|mi)C_na");
-        #pragma omp parallel for
-        for (int row = 0; row < nrows; row++) {
-            C_DGEMM('T','N',naocc,navir,nso,1.0,Amip[row],naocc,Cavirp[0],navir,0.0,Aiap[row],navir);
+            // (A|mi) = (A|mn) C_ni, then (A|ia) = (A|mi) C_ma, row by row while (A|mn) is in cache
+            for (int oq = 0; oq < nq; oq++) {
+                C_DGEMM('N','N',nso,naocc,nso,1.0,Amnp[oq],nso,Caoccp[0],naocc,0.0,Amip[0],naocc);
+                C_DGEMM('T','N',naocc,navir,nso,1.0,Amip[0],naocc,Cavirp[0],navir,0.0,Aiap[sq + oq - qoff],navir);
+            }
         }
-        timer_off("DFMP2 (A|mi)C_na");
+        timer_off("DFMP2 (A|ia) Fused");
 
-        // Stripe (A|ia) out to disk
+        // Stripe (A|ia) out to disk behind the next block
         timer_on("DFMP2 Aia Write");
-        psio_->write(PSIF_DFMP2_AIA,"(A|ia)",(char*)Aiap[0],sizeof(double)*nrows*naocc*navir,next_AIA,&next_AIA);
+        if (pending) aio->synchronize();
         timer_off("DFMP2 Aia Write");
+
+        DiskBlock& w = writes[block % 2];
+        w.label = "(A|ia)";
+        w.buf = Aiap[0];
+        w.nrow = 1L;
+        w.len = nrows * (ULI) naocc * navir;
+        w.stride = w.len;
+        w.start = qoff * (ULI) naocc * navir;
+        aio_write_block(aio, PSIF_DFMP2_AIA, w);
+        pending = true;
     }
 
+    timer_on("DFMP2 Aia Write");
+    if (pending) aio->synchronize();
+    timer_off("DFMP2 Aia Write");
+
     psio_->close(PSIF_DFMP2_AIA,1);
 }
 void RDFMP2::form_Qia()
@@ -997,6 +1164,11 @@ void RDFMP2::form_Qia_transpose()
 }
 void RDFMP2::form_energy()
 {
+    if (options_.get_str("DFMP2_ENERGY_ALGORITHM") == "LAPLACE") {
+        form_energy_laplace();
+        return;
+    }
+
     // Energy registers
     double e_ss = 0.0;
     double e_os = 0.0;
@@ -1122,6 +1294,111 @@ void RDFMP2::form_energy()
     energies_["Same-Spin Energy"] = e_ss;
     energies_["Opposite-Spin Energy"] = e_os;
 }
+void RDFMP2::form_energy_laplace()
+{
+    // E_os = - \sum_w \sum_PQ (X^w_PQ)^2, X^w_PQ = (Q|ia) tau^w_i tau^w_a (ia|P),
+    // which is O(N_w o v N_aux^2) rather than O(o^2 v^2 N_aux)
+
+    laplace_ = true;
+
+    // Sizing
+    int naux  = ribasis_->nbf();
+    int naocc = Caocc_->colspi()[0];
+    int navir = Cavir_->colspi()[0];
+
+    // Laplace factors, with the number of points set by the quadrature tolerance
+    boost::shared_ptr<LaplaceDenominator> denom(new LaplaceDenominator(eps_aocc_, eps_avir_,
+        options_.get_double("DFMP2_LAPLACE_TOLERANCE")));
+    int nw = denom->nvector();
+    double** tauop = denom->denominator_occ()->pointer();
+    double** tauvp = denom->denominator_vir()->pointer();
+
+    // Memory
+    ULI X_memory  = naux * (ULI) naux;
+    ULI Qa_memory = naux * (ULI) navir;
+    ULI doubles = ((ULI) (options_.get_double("DFMP2_MEM_FACTOR") * memory_ / 8L));
+    if (doubles < X_memory + 2L * Qa_memory) {
+        throw PSIEXCEPTION("DFMP2: Insufficient memory for Laplace X buffer.");
+    }
+    ULI max_i = (doubles - X_memory) / (2L * Qa_memory);
+    max_i = (max_i > naocc? naocc : max_i);
+    max_i = (max_i < 1L ? 1L : max_i);
+
+    // Blocks
+    std::vector<ULI> i_starts;
+    i_starts.push_back(0L);
+    for (ULI i = 0; i < naocc; i += max_i) {
+        if (i + max_i >= naocc) {
+            i_starts.push_back(naocc);
+        } else {
+            i_starts.push_back(i + max_i);
+        }
+    }
+    //block_status(i_starts, __FILE__,__LINE__);
+    int nblock = i_starts.size() - 1;
+
+    fprintf(outfile, "\t Laplace DF-MP2: %d quadrature points, %d occupied blocks.\n", nw, nblock);
+    fprintf(outfile, "\t Same-spin energy is not computed, use the SCS section with MP2_SS_SCALE = 0.\n\n");
+    fflush(outfile);
+
+    // Tensor blocks
+    SharedMatrix Qia (new Matrix("Qia", max_i * (ULI) navir, naux));
+    SharedMatrix Yia (new Matrix("Yia", max_i * (ULI) navir, naux));
+    SharedMatrix X (new Matrix("X", naux, naux));
+    double** Qiap = Qia->pointer();
+    double** Yiap = Yia->pointer();
+    double** Xp = X->pointer();
+
+    double e_os = 0.0;
+
+    // One pass through (Q|ia) per quadrature point, unless it fits in one block
+    psio_->open(PSIF_DFMP2_AIA,PSIO_OPEN_OLD);
+    psio_address next_AIA = PSIO_ZERO;
+    for (int w = 0; w < nw; w++) {
+
+        X->zero();
+
+        for (int block_i = 0; block_i < nblock; block_i++) {
+
+            // Sizing
+            ULI istart = i_starts[block_i];
+            ULI istop  = i_starts[block_i+1];
+            ULI ni     = istop - istart;
+
+            // Read iaQ chunk
+            if (nblock > 1 || w == 0) {
+                timer_on("DFMP2 Qia Read");
+                next_AIA = psio_get_address(PSIO_ZERO,sizeof(double)*(istart * navir * naux));
+                psio_->read(PSIF_DFMP2_AIA,"(Q|ia)",(char*)Qiap[0],sizeof(double)*(ni * navir * naux),next_AIA,&next_AIA);
+                timer_off("DFMP2 Qia Read");
+            }
+
+            // Y_ia^Q = tau^w_i tau^w_a (ia|Q)
+            timer_on("DFMP2 Laplace Scale");
+            #pragma omp parallel for schedule(static)
+            for (long int ia = 0L; ia < ni * navir; ia++) {
+                ULI i = ia / navir + istart;
+                ULI a = ia % navir;
+                double tau = tauop[w][i] * tauvp[w][a];
+                for (int Q = 0; Q < naux; Q++) {
+                    Yiap[ia][Q] = tau * Qiap[ia][Q];
+                }
+            }
+            timer_off("DFMP2 Laplace Scale");
+
+            // X_PQ += (P|ia) Y_ia^Q
+            timer_on("DFMP2 Laplace X");
+            C_DGEMM('T','N',naux,naux,ni*navir,1.0,Qiap[0],naux,Yiap[0],naux,1.0,Xp[0],naux);
+            timer_off("DFMP2 Laplace X");
+        }
+
+        e_os -= C_DDOT(X_memory,Xp[0],1,Xp[0],1);
+    }
+    psio_->close(PSIF_DFMP2_AIA,0);
+
+    energies_["Same-Spin Energy"] = 0.0;
+    energies_["Opposite-Spin Energy"] = e_os;
+}
 void RDFMP2::form_Pab()
 {
     // Energy registers
@@ -52,6 +52,8 @@ protected:
     double sss_;
     // Opposite-spin scale
     double oss_;
+    // Was the energy formed from Laplace-factored denominators (opposite-spin only)?
+    bool laplace_;
 
     void common_init();
     // Common printing of energies/SCS
@@ -107,6 +109,10 @@ protected:
     virtual void apply_G_transpose(unsigned int file, unsigned long int naux, unsigned long int nia);
     // Form a transposed copy of iaQ
     virtual void apply_B_transpose(unsigned int file, unsigned long int naux, unsigned long int naocc, unsigned long int navir);
+    // Out-of-core transpose of the nrow x ncol matrix of nelem-vectors in_label into out_label,
+    // in large double-buffered blocks with threaded in-memory permutes
+    void transpose_disk(unsigned int file, const char* in_label, const char* out_label,
+        unsigned long int nrow, unsigned long int ncol, unsigned long int nelem);
 
     // Debugging-routine: prints block sizing
     void block_status(std::vector<int> inds, const char* file, int line); 
@@ -151,6 +157,8 @@ protected:
     virtual void form_Qia_transpose();
     // Form the energy contributions
     virtual void form_energy();
+    // Form the opposite-spin energy from Laplace-factored denominators
+    void form_energy_laplace();
     // Form the energy contributions and gradients
     virtual void form_Pab();
     // Form the energy contributions and gradients
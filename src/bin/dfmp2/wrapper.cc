@@ -35,6 +35,7 @@
 #include <libiwl/iwl.h>
 #include <libqt/qt.h>
 #include <libmints/mints.h>
+#include <libthce/thcmp2.h>
 #include <psi4-dec.h>
 
 #include "mp2.h"
@@ -50,8 +51,16 @@ PsiReturnType dfmp2(Options & options)
     boost::shared_ptr<PSIO> psio(new PSIO);
     boost::shared_ptr<Chkpt> chkpt(new Chkpt(psio, PSIO_OPEN_OLD));
 
+    // The LAPLACE and THC energies are opposite-spin only, and RHF only
+    bool restricted = (options.get_str("REFERENCE") == "RHF" || options.get_str("REFERENCE") == "RKS");
+    if (options.get_str("DFMP2_ENERGY_ALGORITHM") != "DF" && !restricted)
+        throw PSIEXCEPTION("DFMP2: DFMP2_ENERGY_ALGORITHM " + options.get_str("DFMP2_ENERGY_ALGORITHM") +
+                           " requires an RHF reference");
+
     boost::shared_ptr<Wavefunction> dfmp2;
-    if (options.get_str("REFERENCE") == "RHF" || options.get_str("REFERENCE") == "RKS") {
+    if (restricted && options.get_str("DFMP2_ENERGY_ALGORITHM") == "THC") {
+        dfmp2 = boost::shared_ptr<Wavefunction>(new RTHCMP2());
+    } else if (options.get_str("REFERENCE") == "RHF" || options.get_str("REFERENCE") == "RKS") {
         dfmp2 = boost::shared_ptr<Wavefunction>(new RDFMP2(options,psio,chkpt));
     } else if (options.get_str("REFERENCE") == "UHF" || options.get_str("REFERENCE") == "UKS") {
         dfmp2 = boost::shared_ptr<Wavefunction>(new UDFMP2(options,psio,chkpt));
@@ -75,6 +84,11 @@ PsiReturnType dfmp2grad(Options & options)
     boost::shared_ptr<PSIO> psio(new PSIO);
     boost::shared_ptr<Chkpt> chkpt(new Chkpt(psio, PSIO_OPEN_OLD));
 
+    // The gradient is that of the full MP2 energy
+    if (options.get_str("DFMP2_ENERGY_ALGORITHM") != "DF")
+        throw PSIEXCEPTION("DFMP2: DFMP2_ENERGY_ALGORITHM " + options.get_str("DFMP2_ENERGY_ALGORITHM") +
+                           " has no gradient");
+
     boost::shared_ptr<Wavefunction> dfmp2;
     if (options.get_str("REFERENCE") == "RHF" || options.get_str("REFERENCE") == "RKS") {
         dfmp2 = boost::shared_ptr<Wavefunction>(new RDFMP2(options,psio,chkpt));
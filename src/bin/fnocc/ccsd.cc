@@ -40,6 +40,7 @@
 #include<libmints/basisset.h>
 #include<libmints/basisset_parser.h>
 #include<lib3index/3index.h>
+#include<libpsio/aiohandler.h>
 
 using namespace psi;
 using namespace boost;
@@ -127,6 +128,9 @@ void CoupledCluster::common_init() {
   maxiter = options_.get_int("MAXITER");
   maxdiis = options_.get_int("DIIS_MAX_VECS");
 
+  // overlap v(ab,cd) tile reads with the dgemms? set in AllocateMemory()
+  tile_prefetch = false;
+
   // memory is from process::environment
   memory = Process::environment.get_memory();
 
@@ -720,6 +724,78 @@ void CoupledCluster::DefineTilingCPU(){
   fflush(outfile);
 }
 
+/*===================================================================
+
+  tiling for the v(ab,cd) diagrams with prefetching: the integrals
+  buffer is split in two, and the next tile is read into one half
+  while the dgemm runs on the other.  returns false if not even one
+  row of v(ab,cd) fits into half the buffer.
+
+===================================================================*/
+bool CoupledCluster::DefineTilePrefetch(){
+  long int v = nvirt;
+  long int fulltile = v*(v+1L)/2L;
+
+  // at least two tiles, so there is something to overlap
+  pftilesize = maxelem/2L/fulltile;
+  if (pftilesize > (fulltile+1L)/2L) pftilesize = (fulltile+1L)/2L;
+  if (pftilesize < 1L) return false;
+
+  npftiles = fulltile/pftilesize;
+  if ( npftiles*pftilesize < fulltile ) npftiles++;
+  pflasttile = fulltile - (npftiles-1L)*pftilesize;
+  return true;
+}
+
+/*===================================================================
+
+  tempt(ij,cd) = tempv(ij,ab) v(ab,cd) for the packed integrals in
+  unit, one tile of v(ab,cd) at a time
+
+===================================================================*/
+void CoupledCluster::VabcdTiles(unsigned int unit,const char*label){
+  long int j,n,o,v,o2,v2;
+  o  = ndoccact;
+  v  = nvirt;
+  o2 = o*(o+1)/2;
+  v2 = v*(v+1)/2;
+  boost::shared_ptr<PSIO> psio(new PSIO());
+  psio->open(unit,PSIO_OPEN_OLD);
+
+  psio_address addr = PSIO_ZERO;
+
+  if (!tile_prefetch){
+     for (j=0; j<ntiles; j++){
+         n = (j<ntiles-1) ? tilesize : lasttile;
+         psio->read(unit,label,(char*)&integrals[0],n*v2*sizeof(double),addr,&addr);
+         F_DGEMM('n','n',o2,n,v2,1.0,tempv,o2,integrals,v2,0.0,tempt+j*tilesize*o2,o2);
+     }
+     psio->close(unit,1);
+     return;
+  }
+
+  double*buffer[2];
+  buffer[0] = integrals;
+  buffer[1] = integrals+pftilesize*v2;
+
+  // the next tile is read by the aio thread while this one is contracted
+  boost::shared_ptr<AIOHandler> aio(new AIOHandler(psio));
+  n = (npftiles>1) ? pftilesize : pflasttile;
+  psio->read(unit,label,(char*)buffer[0],n*v2*sizeof(double),addr,&addr);
+
+  for (j=0; j<npftiles; j++){
+      n = (j<npftiles-1) ? pftilesize : pflasttile;
+      bool next = (j+1<npftiles);
+      if (next){
+         long int nnext = (j+1<npftiles-1) ? pftilesize : pflasttile;
+         aio->read(unit,label,(char*)buffer[(j+1)%2],nnext*v2*sizeof(double),addr,&addr);
+      }
+      F_DGEMM('n','n',o2,n,v2,1.0,tempv,o2,buffer[j%2],v2,0.0,tempt+j*pftilesize*o2,o2);
+      if (next) aio->synchronize();
+  }
+  psio->close(unit,1);
+}
+
 /*===================================================================
 
   - allocate cpu memory
@@ -817,6 +893,12 @@ void CoupledCluster::AllocateMemory() {
 
   maxelem = dim;
 
+  if (options_.get_bool("CC_TILE_PREFETCH")) {
+     tile_prefetch = DefineTilePrefetch();
+     if (tile_prefetch)
+        fprintf(outfile,"        v(ab,cd) tiles will be prefetched in %3li blocks.\n",npftiles);
+  }
+
   long int oovv = o*o*v*v;
   double total_memory = 1.*dim+2.*(oovv+o*v)+1.*o*o*v*v+2.*o*v+2.*v*v;
   if (t2_on_disk) total_memory = 1.*dim+2.*(oovv+o*v)+2.*o*v+2.*v*v;
@@ -1392,7 +1474,6 @@ void CoupledCluster::Vabcd1(CCTaskParams params){
   o = ndoccact;
   v = nvirt;
   boost::shared_ptr<PSIO> psio(new PSIO());
-  psio_address addr;
   if (t2_on_disk){
      psio->open(PSIF_DCC_T2,PSIO_OPEN_OLD);
      psio->read_entry(PSIF_DCC_T2,"t2",(char*)&tempt[0],o*o*v*v*sizeof(double));
@@ -1423,16 +1504,7 @@ void CoupledCluster::Vabcd1(CCTaskParams params){
           }
       }
   }
-  psio->open(PSIF_DCC_ABCD1,PSIO_OPEN_OLD);
-  addr = PSIO_ZERO;
-  for (j=0; j<ntiles-1; j++){
-      psio->read(PSIF_DCC_ABCD1,"E2abcd1",(char*)&integrals[0],tilesize*v*(v+1)/2*sizeof(double),addr,&addr);
-      F_DGEMM('n','n',o*(o+1)/2,tilesize,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  }
-  j=ntiles-1;
-  psio->read(PSIF_DCC_ABCD1,"E2abcd1",(char*)&integrals[0],lasttile*v*(v+1)/2*sizeof(double),addr,&addr);
-  F_DGEMM('n','n',o*(o+1)/2,lasttile,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  psio->close(PSIF_DCC_ABCD1,1);
+  VabcdTiles(PSIF_DCC_ABCD1,"E2abcd1");
 
   // contribute to residual
   psio->open(PSIF_DCC_R2,PSIO_OPEN_OLD);
@@ -1461,7 +1533,6 @@ void CoupledCluster::Vabcd2(CCTaskParams params){
   o = ndoccact;
   v = nvirt;
   boost::shared_ptr<PSIO> psio(new PSIO());
-  psio_address addr;
   if (t2_on_disk){
      psio->open(PSIF_DCC_T2,PSIO_OPEN_OLD);
      psio->read_entry(PSIF_DCC_T2,"t2",(char*)&tempt[0],o*o*v*v*sizeof(double));
@@ -1491,16 +1562,7 @@ void CoupledCluster::Vabcd2(CCTaskParams params){
           }
       }
   }
-  psio->open(PSIF_DCC_ABCD2,PSIO_OPEN_OLD);
-  addr = PSIO_ZERO;
-  for (j=0; j<ntiles-1; j++){
-      psio->read(PSIF_DCC_ABCD2,"E2abcd2",(char*)&integrals[0],tilesize*v*(v+1)/2*sizeof(double),addr,&addr);
-      F_DGEMM('n','n',o*(o+1)/2,tilesize,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  }
-  j = ntiles-1;
-  psio->read(PSIF_DCC_ABCD2,"E2abcd2",(char*)&integrals[0],lasttile*v*(v+1)/2*sizeof(double),addr,&addr);
-  F_DGEMM('n','n',o*(o+1)/2,lasttile,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  psio->close(PSIF_DCC_ABCD2,1);
+  VabcdTiles(PSIF_DCC_ABCD2,"E2abcd2");
 
   // contribute to residual
   psio->open(PSIF_DCC_R2,PSIO_OPEN_OLD);
@@ -3426,16 +3488,35 @@ void DFCoupledCluster::AllocateMemory() {
   // for the df version, the dimension of the large buffer:
   long int nQmax = nQ > nQ_scf ? nQ : nQ_scf;
 
-  long int dim = 2L*v*v*v;
+  long int dim = 0;
   if (2*nQmax*o*v>dim)   dim = 2*nQmax*o*v;
   if (o*o*v*v>dim)       dim = o*o*v*v;
   if (nQmax*v*v>dim)     dim = nQmax*v*v;
   if (nQmax*nso*nso>dim) dim = nQmax*nso*nso;
 
-  double total_memory = dim+(o*o*v*v+o*v)+(o*(o+1)*v*(v+1)+o*v)+o*o*v*v+2.*o*v+2.*v*v;
   long int max = nvirt*nvirt*nQmax > (nfzv+ndocc+nvirt)*ndocc*nQmax ? nvirt*nvirt*nQmax : (nfzv+ndocc+nvirt)*ndocc*nQmax;
   double df_memory    = nQ*(o*o+o*v)+max;
 
+  // v(ab,cd) is built for a block of b at a time, v^2 + v(v+1)/2 doubles per b.
+  // all b at once (2v^3) unless that does not fit next to everything else
+  long int vabcd_per_b = v*v+v*(v+1)/2;
+  double other_memory  = (o*o*v*v+o*v)+(o*(o+1)*v*(v+1)+o*v)+o*o*v*v+2.*o*v+2.*v*v + df_memory;
+  double free_doubles  = (double)memory/8.0 - other_memory;
+  vabcd_batch = v;
+  if (2.0*v*v*v > dim && 2.0*v*v*v > free_doubles) {
+      vabcd_batch = (long int)(free_doubles > 0.0 ? free_doubles : 0.0) / vabcd_per_b;
+      if (vabcd_batch < dim / vabcd_per_b) vabcd_batch = dim / vabcd_per_b;
+      if (vabcd_batch < 1) vabcd_batch = 1;
+      if (vabcd_batch > v) vabcd_batch = v;
+  }
+  if (vabcd_batch == v) {
+      if (2L*v*v*v>dim) dim = 2L*v*v*v;
+  }else {
+      if (vabcd_batch*vabcd_per_b>dim) dim = vabcd_batch*vabcd_per_b;
+  }
+
+  double total_memory = dim+(o*o*v*v+o*v)+(o*(o+1)*v*(v+1)+o*v)+o*o*v*v+2.*o*v+2.*v*v;
+
   total_memory       *= 8./1024./1024.;
   df_memory          *= 8./1024./1024.;
 
@@ -3467,6 +3548,10 @@ void DFCoupledCluster::AllocateMemory() {
   fprintf(outfile,"        3-index integrals:               %9.2lf mb\n",df_memory);
   fprintf(outfile,"        CCSD intermediates:              %9.2lf mb\n",total_memory-size_of_t2*t2_on_disk);
   fprintf(outfile,"\n");
+  if (vabcd_batch < v) {
+      fprintf(outfile,"        v(ab,cd) diagram will be evaluated in blocks of %li virtuals.\n",vabcd_batch);
+      fprintf(outfile,"\n");
+  }
 
 
   if (options_.get_bool("COMPUTE_TRIPLES")) {
@@ -3661,7 +3746,7 @@ void DFCoupledCluster::Vabcd1(){
     int nthreads = omp_get_max_threads();
   
     double * Vcdb = integrals;
-    double * Vm   = integrals+v*v*v;
+    double * Vm   = integrals+v*v*vabcd_batch;
     double * Vp   = Vm;
   
     // qvv transpose
@@ -3675,16 +3760,18 @@ void DFCoupledCluster::Vabcd1(){
     double time2 = 0.0;
     double time3 = 0.0;
     for (long int a = 0; a < v; a++) {
+    for (long int b0 = a; b0 < v; b0 += vabcd_batch) {
   
         double start1 = omp_get_wtime();
-        int nb = v-a;
-        F_DGEMM('t','n',v,v*nb,nQ,1.0,Qvv+a*v*nQ,nQ,Qvv+a*v*nQ,nQ,0.0,Vcdb,v);
+        long int bend = b0+vabcd_batch < v ? b0+vabcd_batch : v;
+        int nb = bend-b0;
+        F_DGEMM('t','n',v,v*nb,nQ,1.0,Qvv+a*v*nQ,nQ,Qvv+b0*v*nQ,nQ,0.0,Vcdb,v);
   
         #pragma omp parallel for schedule (static)
-        for (long int b = a; b < v; b++){
+        for (long int b = b0; b < bend; b++){
             long int cd = 0;
-            long int ind1 = (b-a)*vtri;
-            long int ind2 = (b-a)*v*v;
+            long int ind1 = (b-b0)*vtri;
+            long int ind2 = (b-b0)*v*v;
             long int v1,v2;
             for (long int c=0; c<v; c++){
                 for (long int d=0; d<=c; d++){
@@ -3698,10 +3785,10 @@ void DFCoupledCluster::Vabcd1(){
         double start2 = omp_get_wtime();
         F_DGEMM('n','n',otri,nb,vtri,0.5,tempt,otri,Vp,vtri,0.0,Abij,otri);
         #pragma omp parallel for schedule (static)
-        for (long int b = a; b < v; b++){
+        for (long int b = b0; b < bend; b++){
             long int cd = 0;
-            long int ind1 = (b-a)*vtri;
-            long int ind2 = (b-a)*v*v;
+            long int ind1 = (b-b0)*vtri;
+            long int ind2 = (b-b0)*v*v;
             long int v1,v2;
             for (long int c=0; c<v; c++){
                 for (long int d=0; d<=c; d++){
@@ -3716,15 +3803,15 @@ void DFCoupledCluster::Vabcd1(){
         // contribute to residual
         double start3 = omp_get_wtime();
         #pragma omp parallel for schedule (static)
-        for (long int b = a; b < v; b++) {
+        for (long int b = b0; b < bend; b++) {
             for (long int i = 0; i < o; i++) {
                 for (long int j = 0; j < o; j++) {
                     int sg = ( i > j ) ? 1 : -1;
-                    tempv[a*oo*v+b*oo+i*o+j]    +=    Abij[(b-a)*otri+Position(i,j)]
-                                                +  sg*Sbij[(b-a)*otri+Position(i,j)];
+                    tempv[a*oo*v+b*oo+i*o+j]    +=    Abij[(b-b0)*otri+Position(i,j)]
+                                                +  sg*Sbij[(b-b0)*otri+Position(i,j)];
                     if (a!=b) {
-                       tempv[b*oov+a*oo+i*o+j] +=    Abij[(b-a)*otri+Position(i,j)]
-                                               -  sg*Sbij[(b-a)*otri+Position(i,j)];
+                       tempv[b*oov+a*oo+i*o+j] +=    Abij[(b-b0)*otri+Position(i,j)]
+                                               -  sg*Sbij[(b-b0)*otri+Position(i,j)];
                     }
                 }
             }
@@ -3735,6 +3822,7 @@ void DFCoupledCluster::Vabcd1(){
         time2 += end2 - start2;
         time3 += end3 - start3;
     }
+    }
   
     // contribute to residual
     psio->write_entry(PSIF_DCC_R2,"residual",(char*)&tempv[0],o*o*v*v*sizeof(double));
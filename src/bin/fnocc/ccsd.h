@@ -210,6 +210,14 @@ class CoupledCluster: public Wavefunction{
     long int ovtilesize,lastovtile,lastov2tile,ov2tilesize;
     long int tilesize,lasttile,maxelem;
     long int ntiles,novtiles,nov2tiles;
+
+    /// v(ab,cd) contraction over the tiles of an integral file
+    void VabcdTiles(unsigned int unit,const char*label);
+
+    /// tiling for v(ab,cd) with the next tile read during the current dgemm
+    bool DefineTilePrefetch();
+    bool tile_prefetch;
+    long int pftilesize,pflasttile,npftiles;
 };
 
 // DF CC class
@@ -243,6 +251,9 @@ class DFCoupledCluster : public CoupledCluster{
     /// v^4 CC diagram
     virtual void Vabcd1();
 
+    /// number of b built at once in Vabcd1 (the full v unless memory is short)
+    long int vabcd_batch;
+
     /// workspace buffers.
     double*Abij,*Sbij;
 
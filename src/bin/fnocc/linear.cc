@@ -438,7 +438,6 @@ void CoupledCluster::Vabcd1_linear(CCTaskParams params){
   o = ndoccact;
   v = nvirt;
   boost::shared_ptr<PSIO> psio(new PSIO());
-  psio_address addr;
   if (t2_on_disk){
      psio->open(PSIF_DCC_T2,PSIO_OPEN_OLD);
      psio->read_entry(PSIF_DCC_T2,"t2",(char*)&tempt[0],o*o*v*v*sizeof(double));
@@ -458,16 +457,7 @@ void CoupledCluster::Vabcd1_linear(CCTaskParams params){
           }
       }
   }
-  psio->open(PSIF_DCC_ABCD1,PSIO_OPEN_OLD);
-  addr = PSIO_ZERO;
-  for (j=0; j<ntiles-1; j++){
-      psio->read(PSIF_DCC_ABCD1,"E2abcd1",(char*)&integrals[0],tilesize*v*(v+1)/2*sizeof(double),addr,&addr);
-      F_DGEMM('n','n',o*(o+1)/2,tilesize,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  }
-  j=ntiles-1;
-  psio->read(PSIF_DCC_ABCD1,"E2abcd1",(char*)&integrals[0],lasttile*v*(v+1)/2*sizeof(double),addr,&addr);
-  F_DGEMM('n','n',o*(o+1)/2,lasttile,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  psio->close(PSIF_DCC_ABCD1,1);
+  VabcdTiles(PSIF_DCC_ABCD1,"E2abcd1");
 
   // contribute to residual
   psio->open(PSIF_DCC_R2,PSIO_OPEN_OLD);
@@ -495,7 +485,6 @@ void CoupledCluster::Vabcd2_linear(CCTaskParams params){
   o = ndoccact;
   v = nvirt;
   boost::shared_ptr<PSIO> psio(new PSIO());
-  psio_address addr;
   if (t2_on_disk){
      psio->open(PSIF_DCC_T2,PSIO_OPEN_OLD);
      psio->read_entry(PSIF_DCC_T2,"t2",(char*)&tempt[0],o*o*v*v*sizeof(double));
@@ -513,16 +502,7 @@ void CoupledCluster::Vabcd2_linear(CCTaskParams params){
           }
       }
   }
-  psio->open(PSIF_DCC_ABCD2,PSIO_OPEN_OLD);
-  addr = PSIO_ZERO;
-  for (j=0; j<ntiles-1; j++){
-      psio->read(PSIF_DCC_ABCD2,"E2abcd2",(char*)&integrals[0],tilesize*v*(v+1)/2*sizeof(double),addr,&addr);
-      F_DGEMM('n','n',o*(o+1)/2,tilesize,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  }
-  j = ntiles-1;
-  psio->read(PSIF_DCC_ABCD2,"E2abcd2",(char*)&integrals[0],lasttile*v*(v+1)/2*sizeof(double),addr,&addr);
-  F_DGEMM('n','n',o*(o+1)/2,lasttile,v*(v+1)/2,1.0,tempv,o*(o+1)/2,integrals,v*(v+1)/2,0.0,tempt+j*tilesize*o*(o+1)/2,o*(o+1)/2);
-  psio->close(PSIF_DCC_ABCD2,1);
+  VabcdTiles(PSIF_DCC_ABCD2,"E2abcd2");
 
   // contribute to residual
   psio->open(PSIF_DCC_R2,PSIO_OPEN_OLD);
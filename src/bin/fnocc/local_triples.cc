@@ -179,30 +179,72 @@ PsiReturnType CoupledCluster::local_triples() {
   int pct10,pct20,pct30,pct40,pct50,pct60,pct70,pct80,pct90;
   pct10=pct20=pct30=pct40=pct50=pct60=pct70=pct80=pct90=0;
 
+  // virtual-pair energies e(ab) = sum_ij t(ab,ij) [2(ia|jb) - (ib|ja)]
+  // for screening weak abc triples
+  double cutoff = options_.get_double("LOCAL_TRIPLES_CUTOFF");
+  int nsample = options_.get_int("LOCAL_TRIPLES_SAMPLE");
+  if (nsample < 1) nsample = 1;
+  double *epair = (double*)malloc(v*v*sizeof(double));
+  #pragma omp parallel for schedule (static) num_threads(nthreads)
+  for (int a=0; a<v; a++){
+      for (int b=0; b<v; b++){
+          double dum = 0.0;
+          for (int i=0; i<o; i++){
+              for (int j=0; j<o; j++){
+                  dum += tempt[a*o*o*v+b*o*o+i*o+j] * (2.0*E2klcd[i*v*v*o+a*v*o+j*v+b]
+                                                      -    E2klcd[i*v*v*o+b*v*o+j*v+a]);
+              }
+          }
+          epair[a*v+b] = fabs(dum);
+      }
+  }
+
+  // abc[ind][3] = 1 marks a screened triple that is evaluated only
+  // as a sample of the neglected energy
   int nabc = 0;
+  long int nskip = 0;
   for (int a=0; a<v; a++){
       for (int b=0; b<=a; b++){
           for (int c=0; c<=b; c++){
+              if (epair[a*v+b]+epair[a*v+c]+epair[b*v+c] < cutoff){
+                 if (nskip++ % nsample != 0) continue;
+              }
               nabc++;
           }
       }
   }
   int**abc = (int**)malloc(nabc*sizeof(int*));
-  nabc = 0;
+  nabc  = 0;
+  nskip = 0;
   for (int a=0; a<v; a++){
       for (int b=0; b<=a; b++){
           for (int c=0; c<=b; c++){
-              abc[nabc] = (int*)malloc(3*sizeof(int));
+              int sample = 0;
+              if (epair[a*v+b]+epair[a*v+c]+epair[b*v+c] < cutoff){
+                 if (nskip++ % nsample != 0) continue;
+                 sample = 1;
+              }
+              abc[nabc] = (int*)malloc(4*sizeof(int));
               abc[nabc][0] = a;
               abc[nabc][1] = b;
               abc[nabc][2] = c;
+              abc[nabc][3] = sample;
               nabc++;
           }
       }
   }
+  free(epair);
+  long int nsampled = (nskip + nsample - 1) / nsample;
   fprintf(outfile,"        Number of abc combinations: %i\n",nabc);
+  if (cutoff > 0.0){
+     fprintf(outfile,"        Screened abc combinations:  %li (%li sampled)\n",nskip,nsampled);
+  }
   fprintf(outfile,"\n");
   fflush(outfile);
+
+  double *esample  = (double*)malloc(nthreads*sizeof(double));
+  double *esample2 = (double*)malloc(nthreads*sizeof(double));
+  for (int i=0; i<nthreads; i++) esample[i] = esample2[i] = 0.0;
   for (int i=0; i<nthreads; i++) etrip[i] = 0.0;
 
   fprintf(outfile,"        Computing (T) correction...\n");
@@ -223,6 +265,7 @@ PsiReturnType CoupledCluster::local_triples() {
          #ifdef _OPENMP
              thread = omp_get_thread_num();
          #endif
+         double e0 = etrip[thread];
 
          boost::shared_ptr<PSIO> mypsio(new PSIO());
          mypsio->open(PSIF_DCC_ABCI4,PSIO_OPEN_OLD);
@@ -435,6 +478,14 @@ PsiReturnType CoupledCluster::local_triples() {
          }
          etrip[thread] += tripval*abcfac;
 
+         // a sampled screened triple only feeds the error estimate
+         if (abc[ind][3]){
+            double de = etrip[thread] - e0;
+            etrip[thread]    = e0;
+            esample[thread]  += de;
+            esample2[thread] += de*de;
+         }
+
          // print out update 
          if (thread==0){
             int print = 0;
@@ -466,6 +517,22 @@ PsiReturnType CoupledCluster::local_triples() {
   double myet = 0.0;
   for (int i=0; i<nthreads; i++) myet += etrip[i];
 
+  // neglected energy from the sampled screened triples: nskip times the
+  // sample mean, with its standard error
+  if (nskip > 0){
+     double sum = 0.0, sum2 = 0.0;
+     for (int i=0; i<nthreads; i++){
+         sum  += esample[i];
+         sum2 += esample2[i];
+     }
+     double mean = sum / nsampled;
+     double var  = sum2 / nsampled - mean*mean;
+     if (var < 0.0) var = 0.0;
+     fprintf(outfile,"\n");
+     fprintf(outfile,"        Estimated screening error:         %20.12lf +/- %.2le\n",
+             nskip*mean,nskip*sqrt(var/nsampled));
+  }
+
   // ccsd(t) or qcisd(t)
   if (ccmethod <= 1) {
       et = myet;
@@ -505,6 +572,10 @@ PsiReturnType CoupledCluster::local_triples() {
   free(Z4);
   free(E2abci);
   free(etrip);
+  free(esample);
+  free(esample2);
+  for (int i=0; i<nabc; i++) free(abc[i]);
+  free(abc);
             
   return Success;
 }
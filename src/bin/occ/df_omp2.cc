@@ -0,0 +1,488 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+#include <libqt/qt.h>
+#include <libmints/mints.h>
+#include <lib3index/dftensor.h>
+#include <libfock/jk.h>
+#include "occwave.h"
+#include "defines.h"
+
+using namespace boost;
+using namespace psi;
+using namespace std;
+
+namespace psi{ namespace occwave{
+
+// b(Q|pq) = \sum_{mn} b(Q|mn) C_mp C_nq for the nQb auxiliary functions starting at Q0
+static void df_omp2_form_bQpq(double **bQsop, double **Cp, int Q0, int nQb, int ns, int nm,
+                              double **bQmqp, double **bQpqp)
+{
+        C_DGEMM('N','N', nQb * ns, nm, ns, 1.0, bQsop[Q0], ns, Cp[0], nm, 0.0, bQmqp[0], nm);
+        for (int Q = 0; Q < nQb; Q++) {
+             C_DGEMM('T','N', nm, nm, ns, 1.0, Cp[0], nm, bQmqp[Q], nm, 0.0, bQpqp[Q], nm);
+        }
+}
+
+//=========================================================================================
+//  DF-OMP2: RHF, C1 symmetry.
+//  The MP2 Lagrangian and the generalized-Fock matrix are built every orbital iteration
+//  from the (Q|mn) integrals of DF_BASIS_CC, rotated to the current orbitals, and from
+//  J/K builds with DF_BASIS_SCF.  No four-index integrals are formed or transformed.
+//=========================================================================================
+void OCCWave::df_omp2_init()
+{
+        boost::shared_ptr<BasisSetParser> parser(new Gaussian94BasisSetParser());
+        boost::shared_ptr<BasisSet> auxiliary_scf = BasisSet::construct(parser, molecule(), "DF_BASIS_SCF");
+        boost::shared_ptr<BasisSet> auxiliary_cc = BasisSet::construct(parser, molecule(), "DF_BASIS_CC");
+
+        nQ_ = auxiliary_cc->nbf();
+        memory = Process::environment.get_memory();
+        ULI doubles = memory / 8L;
+
+        // (Q|mn) J^-1/2, kept for the whole computation; DFTensor forms it from a second
+        // nQ x nso^2 buffer and the nQ x nQ metric
+        ULI mem_Qso = (ULI)nQ_ * (ULI)nso_ * (ULI)nso_;
+        if (doubles < 2L * mem_Qso + (ULI)nQ_ * (ULI)nQ_) {
+            throw PSIEXCEPTION("DF-OMP2: Insufficient memory for the (Q|mn) integrals. Increase memory.");
+        }
+        timer_on("DF-OMP2 (Q|mn)");
+        boost::shared_ptr<DFTensor> df(new DFTensor(basisset(), auxiliary_cc, Ca_, nooA, nvoA, nooA, nvoA, options_));
+        bQso_ = df->Qso();
+        timer_off("DF-OMP2 (Q|mn)");
+
+        // Memory: b(Q|mn), b(Q|ia), G(Q|ia) and the K/T/U blocks are held for a whole iteration,
+        // b(Q|mq) and b(Q|pq) are formed in batches of maxQ_ auxiliary functions, and the J/K
+        // object gets what the batches leave
+        ULI ov = (ULI)nooA * (ULI)nvoA;
+        ULI mem_fixed = mem_Qso + 2L * (ULI)nQ_ * ov + 3L * (ULI)nvoA * ov;
+        ULI mem_Q = (ULI)nso_ * (ULI)nmo_ + (ULI)nmo_ * (ULI)nmo_;
+        if (doubles < mem_fixed + mem_Q) {
+            throw PSIEXCEPTION("DF-OMP2: Insufficient memory for the (Q|pq) integrals. Increase memory.");
+        }
+        ULI remainder = doubles - mem_fixed;
+        ULI max_Q = (remainder / 2L) / mem_Q;
+        max_Q = (max_Q > (ULI)nQ_ ? (ULI)nQ_ : max_Q);
+        max_Q = (max_Q < 1L ? 1L : max_Q);
+        maxQ_ = (int)max_Q;
+        ULI mem_jk = remainder - max_Q * mem_Q;
+
+        // J/K object for the reference Fock and the separable part of the Lagrangian
+        jk_ = boost::shared_ptr<JK>(new DFJK(basisset(), auxiliary_scf));
+        jk_->set_memory(mem_jk);
+        jk_->initialize();
+        if (print_ > 1) jk_->print_header();
+
+        fprintf(outfile,"\n\tNumber of DF_BASIS_CC functions   : %6d \n", nQ_);
+        fprintf(outfile,"\tNumber of DF_BASIS_SCF functions  : %6d \n", auxiliary_scf->nbf());
+        fprintf(outfile,"\tMemory for (Q|pq) integrals       : %6lu MB \n", 8L * (mem_fixed + max_Q * mem_Q) / (1000000L));
+        fprintf(outfile,"\t(Q|pq) batches                    : %6d \n", (nQ_ + maxQ_ - 1) / maxQ_);
+        fflush(outfile);
+}// end of df_omp2_init
+
+
+//=========================================================================================
+//  Builds FockA, HmoA, GFock, g1symm and gamma1corr for the current Ca_, along with Eref,
+//  the MP2 energy components and Emp2L.  The amplitudes are formed in the semicanonical
+//  basis of the current orbitals, where they are exact first-order amplitudes, and all
+//  matrices are rotated back to the basis of Ca_ at the end.
+//=========================================================================================
+void OCCWave::df_omp2_gfock()
+{
+        int no = nooA;
+        int nv = nvoA;
+        int nm = nmo_;
+        int ns = nso_;
+        int ov = no * nv;
+
+/********************************************************************************************/
+/************************** Reference Fock matrix *******************************************/
+/********************************************************************************************/
+        SharedMatrix Cocc(new Matrix("C occupied", ns, no));
+        double **Cp = Ca_->pointer();
+        double **Coccp = Cocc->pointer();
+        for (int m = 0; m < ns; m++) C_DCOPY(no, Cp[m], 1, Coccp[m], 1);
+
+        std::vector<SharedMatrix>& C_left = jk_->C_left();
+        std::vector<SharedMatrix>& C_right = jk_->C_right();
+        C_left.clear();
+        C_right.clear();
+        C_left.push_back(Cocc);
+        C_right.push_back(Cocc);
+        jk_->compute();
+
+        SharedMatrix Fso(new Matrix("SO-basis Fock matrix", ns, ns));
+        Fso->copy(jk_->J()[0]);
+        Fso->scale(2.0);
+        Fso->subtract(jk_->K()[0]);
+        Fso->add(Hso);
+
+        HmoA->transform(Hso, Ca_);
+        FockA->transform(Fso, Ca_);
+
+        Eref = Enuc;
+        for (int i = 0; i < no; i++) Eref += HmoA->get(0, i, i) + FockA->get(0, i, i);
+
+/********************************************************************************************/
+/************************** Semicanonical orbitals ******************************************/
+/********************************************************************************************/
+        SharedMatrix Foo(new Matrix("Foo", no, no));
+        SharedMatrix Fvv(new Matrix("Fvv", nv, nv));
+        for (int i = 0; i < no; i++) {
+             for (int j = 0; j < no; j++) Foo->set(0, i, j, FockA->get(0, i, j));
+        }
+        for (int a = 0; a < nv; a++) {
+             for (int b = 0; b < nv; b++) Fvv->set(0, a, b, FockA->get(0, a + no, b + no));
+        }
+
+        SharedMatrix Uoo(new Matrix("Uoo", no, no));
+        SharedMatrix Uvv(new Matrix("Uvv", nv, nv));
+        SharedVector eps_o(new Vector("eps_o", no));
+        SharedVector eps_v(new Vector("eps_v", nv));
+        Foo->diagonalize(Uoo, eps_o);
+        Fvv->diagonalize(Uvv, eps_v);
+        double *eop = eps_o->pointer();
+        double *evp = eps_v->pointer();
+
+        SharedMatrix Usc(new Matrix("Semicanonical rotation", nm, nm));
+        for (int i = 0; i < no; i++) {
+             for (int j = 0; j < no; j++) Usc->set(0, i, j, Uoo->get(0, i, j));
+        }
+        for (int a = 0; a < nv; a++) {
+             for (int b = 0; b < nv; b++) Usc->set(0, a + no, b + no, Uvv->get(0, a, b));
+        }
+
+        SharedMatrix Csc(new Matrix("Semicanonical MO coefficients", ns, nm));
+        Csc->gemm(false, false, 1.0, Ca_, Usc, 0.0);
+        double **Cscp = Csc->pointer();
+
+/********************************************************************************************/
+/************************** (Q|pq) in the semicanonical basis *******************************/
+/********************************************************************************************/
+        // Only b(Q|ia) is kept for all Q; the batch buffers are reused for the GFM below
+        timer_on("DF-OMP2 (Q|pq)");
+        int nbatch = (nQ_ + maxQ_ - 1) / maxQ_;
+        SharedMatrix bQmq(new Matrix("DF_BASIS_CC B (Q|mq) batch", maxQ_, ns * nm));
+        SharedMatrix bQpq(new Matrix("DF_BASIS_CC B (Q|pq) batch", maxQ_, nm * nm));
+        double **bQmqp = bQmq->pointer();
+        double **bQpqp = bQpq->pointer();
+        double **bQsop = bQso_->pointer();
+
+        SharedMatrix bQia(new Matrix("DF_BASIS_CC B (Q|ia)", nQ_, ov));
+        double **bQiap = bQia->pointer();
+        for (int Q0 = 0; Q0 < nQ_; Q0 += maxQ_) {
+             int nQb = (Q0 + maxQ_ > nQ_ ? nQ_ - Q0 : maxQ_);
+             df_omp2_form_bQpq(bQsop, Cscp, Q0, nQb, ns, nm, bQmqp, bQpqp);
+             for (int Q = 0; Q < nQb; Q++) {
+                  for (int i = 0; i < no; i++) C_DCOPY(nv, &bQpqp[Q][i * nm + no], 1, &bQiap[Q0 + Q][i * nv], 1);
+             }
+        }
+        timer_off("DF-OMP2 (Q|pq)");
+
+/********************************************************************************************/
+/************************** Amplitudes, energy, OPDM and 3-index TPDM ***********************/
+/********************************************************************************************/
+        // K_i(a,jb) = (ia|jb), T_i(a,jb) = t_ij^ab, U_i(a,jb) = 2 t_ij^ab - t_ij^ba
+        timer_on("DF-OMP2 T2 and PDMs");
+        SharedMatrix Ki(new Matrix("K_i (a,jb)", nv, ov));
+        SharedMatrix Ti(new Matrix("T_i (a,jb)", nv, ov));
+        SharedMatrix Ui(new Matrix("U_i (a,jb)", nv, ov));
+        SharedMatrix GQia(new Matrix("3-index TPDM G (Q|ia)", nQ_, ov));
+        SharedMatrix Goo(new Matrix("Correlation OPDM OO", no, no));
+        SharedMatrix Gvv(new Matrix("Correlation OPDM VV", nv, nv));
+        double **Kp = Ki->pointer();
+        double **Tp = Ti->pointer();
+        double **Up = Ui->pointer();
+        double **GQiap = GQia->pointer();
+
+        double Eos = 0.0;
+        double Ess = 0.0;
+        for (int i = 0; i < no; i++) {
+             C_DGEMM('T','N', nv, ov, nQ_, 1.0, &bQiap[0][i * nv], ov, bQiap[0], ov, 0.0, Kp[0], ov);
+
+             for (int a = 0; a < nv; a++) {
+                  for (int j = 0; j < no; j++) {
+                       for (int b = 0; b < nv; b++) {
+                            Tp[a][j * nv + b] = Kp[a][j * nv + b] / (eop[i] + eop[j] - evp[a] - evp[b]);
+                       }
+                  }
+             }
+
+             for (int a = 0; a < nv; a++) {
+                  for (int j = 0; j < no; j++) {
+                       for (int b = 0; b < nv; b++) {
+                            double t_ab = Tp[a][j * nv + b];
+                            double t_ba = Tp[b][j * nv + a];
+                            double k_ab = Kp[a][j * nv + b];
+                            Up[a][j * nv + b] = 2.0 * t_ab - t_ba;
+                            Eos += t_ab * k_ab;
+                            Ess += (t_ab - t_ba) * k_ab;
+                       }
+                  }
+             }
+
+             // G(Q|ia) = \sum_{jb} U_ij^ab b(Q|jb)
+             C_DGEMM('N','T', nQ_, nv, ov, 1.0, bQiap[0], ov, Up[0], ov, 0.0, &GQiap[0][i * nv], ov);
+
+             // G_ab += 2 \sum_{jc} U_ij^ac T_ij^bc
+             C_DGEMM('N','T', nv, nv, ov, 2.0, Up[0], ov, Tp[0], ov, 1.0, Gvv->pointer()[0], nv);
+
+             // G_jk -= 2 \sum_{ab} U_ij^ba T_ik^ba
+             for (int b = 0; b < nv; b++) {
+                  C_DGEMM('N','T', no, no, nv, -2.0, Up[b], nv, Tp[b], nv, 1.0, Goo->pointer()[0], no);
+             }
+        }
+        Ki.reset();
+        Ti.reset();
+        Ui.reset();
+        bQia.reset();
+        Goo->hermitivitize();
+        Gvv->hermitivitize();
+        timer_off("DF-OMP2 T2 and PDMs");
+
+        // Energies
+        Emp2AB = Eos;
+        Emp2AA = 0.5 * Ess;
+        Emp2BB = Emp2AA;
+        Ecorr = Emp2AA + Emp2AB + Emp2BB;
+        Emp2 = Eref + Ecorr;
+        Emp2L = Emp2;
+        EcorrL = Emp2L - Escf;
+        rms_t2 = 0.0;
+
+        Escsmp2AA = ss_scale * Emp2AA;
+        Escsmp2BB = Escsmp2AA;
+        Escsnmp2AA = 1.76 * Emp2AA;
+        Escsnmp2BB = Escsnmp2AA;
+        Escsmimp2AA = 1.29 * Emp2AA;
+        Escsmimp2BB = Escsmimp2AA;
+        Escsmp2vdwAA = 0.50 * Emp2AA;
+        Escsmp2vdwBB = Escsmp2vdwAA;
+        Escsmp2AB = os_scale * Emp2AB;
+        if (mo_optimized == 0) Esosmp2AB = sos_scale * Emp2AB;
+        else if (mo_optimized == 1) Esosmp2AB = sos_scale2 * Emp2AB;
+        Escsmimp2AB = 0.40 * Emp2AB;
+        Escsmp2vdwAB = 1.28 * Emp2AB;
+        Esospimp2AB = 1.40 * Emp2AB;
+
+        Escsmp2 = Eref + Escsmp2AA + Escsmp2AB + Escsmp2BB;
+        Esosmp2 = Eref + Esosmp2AB;
+        Escsnmp2 = Eref + Escsnmp2AA + Escsnmp2BB;
+        Escsmimp2 = Eref + Escsmimp2AA + Escsmimp2AB + Escsmimp2BB;
+        Escsmp2vdw = Eref + Escsmp2vdwAA + Escsmp2vdwAB + Escsmp2vdwBB;
+        Esospimp2 = Eref + Esospimp2AB;
+
+/********************************************************************************************/
+/************************** Generalized-Fock matrix *****************************************/
+/********************************************************************************************/
+        timer_on("DF-OMP2 GFM");
+        // Correlation and total OPDMs in the semicanonical basis
+        SharedMatrix G1c(new Matrix("Semicanonical correlation OPDM", nm, nm));
+        for (int i = 0; i < no; i++) {
+             for (int j = 0; j < no; j++) G1c->set(0, i, j, Goo->get(0, i, j));
+        }
+        for (int a = 0; a < nv; a++) {
+             for (int b = 0; b < nv; b++) G1c->set(0, a + no, b + no, Gvv->get(0, a, b));
+        }
+        SharedMatrix G1(G1c->clone());
+        for (int i = 0; i < no; i++) G1->add(0, i, i, 2.0);
+
+        // J and K of the correlation OPDM
+        SharedMatrix CG1c(new Matrix("C * correlation OPDM", ns, nm));
+        CG1c->gemm(false, false, 1.0, Csc, G1c, 0.0);
+        C_left.clear();
+        C_right.clear();
+        C_left.push_back(CG1c);
+        C_right.push_back(Csc);
+        jk_->compute();
+
+        SharedMatrix JKso(new Matrix("SO-basis 2J-K of the correlation OPDM", ns, ns));
+        JKso->copy(jk_->J()[0]);
+        JKso->scale(2.0);
+        JKso->subtract(jk_->K()[0]);
+        SharedMatrix JKmo(new Matrix("MO-basis 2J-K of the correlation OPDM", nm, nm));
+        JKmo->transform(JKso, Csc);
+
+        // Separable part: GF_pq = \sum_r f_pr G_rq + \delta_{q occ} (2J-K)[G^corr]_pq
+        SharedMatrix Fsc(new Matrix("Semicanonical Fock matrix", nm, nm));
+        Fsc->transform(Fso, Csc);
+        SharedMatrix GFsc(new Matrix("Semicanonical GFM", nm, nm));
+        GFsc->gemm(false, false, 1.0, Fsc, G1, 0.0);
+        double **GFp = GFsc->pointer();
+        double **JKmop = JKmo->pointer();
+        for (int p = 0; p < nm; p++) {
+             for (int i = 0; i < no; i++) GFp[p][i] += JKmop[p][i];
+        }
+
+        // Nonseparable part:
+        // GF_pi += 2 \sum_{Qa} b(Q|pa) G(Q|ia),  GF_pa += 2 \sum_{Qi} b(Q|pi) G(Q|ia)
+        // With a single batch b(Q|pq) is still in core from above
+        for (int Q0 = 0; Q0 < nQ_; Q0 += maxQ_) {
+             int nQb = (Q0 + maxQ_ > nQ_ ? nQ_ - Q0 : maxQ_);
+             if (nbatch > 1) df_omp2_form_bQpq(bQsop, Cscp, Q0, nQb, ns, nm, bQmqp, bQpqp);
+             for (int Q = 0; Q < nQb; Q++) {
+                  C_DGEMM('N','T', nm, no, nv, 2.0, &bQpqp[Q][no], nm, GQiap[Q0 + Q], nv, 1.0, GFp[0], nm);
+                  C_DGEMM('N','N', nm, nv, no, 2.0, bQpqp[Q], nm, GQiap[Q0 + Q], nv, 1.0, &GFp[0][no], nm);
+             }
+        }
+
+        // Back to the basis of Ca_
+        GFock->back_transform(GFsc, Usc);
+        gamma1corr->back_transform(G1c, Usc);
+        g1symm->back_transform(G1, Usc);
+        timer_off("DF-OMP2 GFM");
+}// end of df_omp2_gfock
+
+
+//======================================================================
+//             DF-OMP2 Manager
+//======================================================================
+void OCCWave::df_omp2_manager()
+{
+	mo_optimized = 0;
+	orbs_already_opt = 0;
+	orbs_already_sc = 0;
+        timer_on("DF-OMP2 GFock");
+	df_omp2_gfock();
+        timer_off("DF-OMP2 GFock");
+	Emp2L_old = Emp2L;
+
+	fprintf(outfile,"\n");
+	fprintf(outfile,"\tComputing DF-MP2 energy using SCF MOs (Canonical DF-MP2)... \n");
+	fprintf(outfile,"\t============================================================================== \n");
+	fprintf(outfile,"\tNuclear Repulsion Energy (a.u.)    : %20.14f\n", Enuc);
+	fprintf(outfile,"\tSCF Energy (a.u.)                  : %20.14f\n", Escf);
+	fprintf(outfile,"\tREF Energy (a.u.)                  : %20.14f\n", Eref);
+	fprintf(outfile,"\tAlpha-Alpha Contribution (a.u.)    : %20.14f\n", Emp2AA);
+	fprintf(outfile,"\tAlpha-Beta Contribution (a.u.)     : %20.14f\n", Emp2AB);
+	fprintf(outfile,"\tBeta-Beta Contribution (a.u.)      : %20.14f\n", Emp2BB);
+	fprintf(outfile,"\tScaled_SS Correlation Energy (a.u.): %20.14f\n", Escsmp2AA+Escsmp2BB);
+	fprintf(outfile,"\tScaled_OS Correlation Energy (a.u.): %20.14f\n", Escsmp2AB);
+	fprintf(outfile,"\tSCS-MP2 Total Energy (a.u.)        : %20.14f\n", Escsmp2);
+	fprintf(outfile,"\tSOS-MP2 Total Energy (a.u.)        : %20.14f\n", Esosmp2);
+	fprintf(outfile,"\tSCSN-MP2 Total Energy (a.u.)       : %20.14f\n", Escsnmp2);
+	fprintf(outfile,"\tSCS-MP2-VDW Total Energy (a.u.)    : %20.14f\n", Escsmp2vdw);
+	fprintf(outfile,"\tSOS-PI-MP2 Total Energy (a.u.)     : %20.14f\n", Esospimp2);
+	fprintf(outfile,"\tMP2 Correlation Energy (a.u.)      : %20.14f\n", Ecorr);
+	fprintf(outfile,"\tMP2 Total Energy (a.u.)            : %20.14f\n", Emp2);
+	fprintf(outfile,"\t============================================================================== \n");
+	fflush(outfile);
+	Process::environment.globals["MP2 TOTAL ENERGY"] = Emp2;
+	Process::environment.globals["SCS-MP2 TOTAL ENERGY"] = Escsmp2;
+	Process::environment.globals["SOS-MP2 TOTAL ENERGY"] = Esosmp2;
+	Process::environment.globals["SCSN-MP2 TOTAL ENERGY"] = Escsnmp2;
+	Process::environment.globals["SCS-MP2-VDW TOTAL ENERGY"] = Escsmp2vdw;
+	Process::environment.globals["SOS-PI-MP2 TOTAL ENERGY"] = Esospimp2;
+
+        Process::environment.globals["MP2 CORRELATION ENERGY"] = Emp2 - Escf;
+        Process::environment.globals["SCS-MP2 CORRELATION ENERGY"] = Escsmp2 - Escf;
+        Process::environment.globals["SOS-MP2 CORRELATION ENERGY"] = Esosmp2 - Escf;
+        Process::environment.globals["SCSN-MP2 CORRELATION ENERGY"] = Escsnmp2 - Escf;
+        Process::environment.globals["SCS-MP2-VDW CORRELATION ENERGY"] = Escsmp2vdw - Escf;
+        Process::environment.globals["SOS-PI-MP2 CORRELATION ENERGY"] = Esospimp2 - Escf;
+
+       Process::environment.globals["MP2 OPPOSITE-SPIN CORRELATION ENERGY"] = Emp2AB;
+       Process::environment.globals["MP2 SAME-SPIN CORRELATION ENERGY"] = Emp2AA+Emp2BB;
+
+	idp();
+	mograd();
+        occ_iterations();
+
+  if (conver == 1) {
+        // SOS scaling for optimized orbitals
+        Esosmp2AB = sos_scale2 * Emp2AB;
+        Esosmp2 = Eref + Esosmp2AB;
+
+	fprintf(outfile,"\n");
+	fprintf(outfile,"\t============================================================================== \n");
+	fprintf(outfile,"\t================ DF-OMP2 FINAL RESULTS ======================================= \n");
+	fprintf(outfile,"\t============================================================================== \n");
+	fprintf(outfile,"\tNuclear Repulsion Energy (a.u.)    : %20.14f\n", Enuc);
+	fprintf(outfile,"\tSCF Energy (a.u.)                  : %20.14f\n", Escf);
+	fprintf(outfile,"\tREF Energy (a.u.)                  : %20.14f\n", Eref);
+	fprintf(outfile,"\tSCS-OMP2 Total Energy (a.u.)       : %20.14f\n", Escsmp2);
+	fprintf(outfile,"\tSOS-OMP2 Total Energy (a.u.)       : %20.14f\n", Esosmp2);
+	fprintf(outfile,"\tSCSN-OMP2 Total Energy (a.u.)      : %20.14f\n", Escsnmp2);
+	fprintf(outfile,"\tSCS-OMP2-VDW Total Energy (a.u.)   : %20.14f\n", Escsmp2vdw);
+	fprintf(outfile,"\tSOS-PI-OMP2 Total Energy (a.u.)    : %20.14f\n", Esospimp2);
+	fprintf(outfile,"\tOMP2 Correlation Energy (a.u.)     : %20.14f\n", Emp2L-Escf);
+	fprintf(outfile,"\tEomp2 - Eref (a.u.)                : %20.14f\n", Emp2L-Eref);
+	fprintf(outfile,"\tOMP2 Total Energy (a.u.)           : %20.14f\n", Emp2L);
+	fprintf(outfile,"\t============================================================================== \n");
+	fprintf(outfile,"\n");
+	fflush(outfile);
+
+	// Set the global variables with the energies
+	Process::environment.globals["OMP2 TOTAL ENERGY"] = Emp2L;
+	Process::environment.globals["SCS-OMP2 TOTAL ENERGY"] =  Escsmp2;
+	Process::environment.globals["SOS-OMP2 TOTAL ENERGY"] =  Esosmp2;
+	Process::environment.globals["SCSN-OMP2 TOTAL ENERGY"] = Escsnmp2;
+	Process::environment.globals["SCS-OMP2-VDW TOTAL ENERGY"] = Escsmp2vdw;
+	Process::environment.globals["SOS-PI-OMP2 TOTAL ENERGY"] = Esospimp2;
+	Process::environment.globals["CURRENT ENERGY"] = Emp2L;
+	Process::environment.globals["CURRENT REFERENCE ENERGY"] = Escf;
+	Process::environment.globals["CURRENT CORRELATION ENERGY"] = Emp2L-Escf;
+
+        Process::environment.globals["OMP2 CORRELATION ENERGY"] = Emp2L - Escf;
+        Process::environment.globals["SCS-OMP2 CORRELATION ENERGY"] =  Escsmp2 - Escf;
+        Process::environment.globals["SOS-OMP2 CORRELATION ENERGY"] =  Esosmp2 - Escf;
+        Process::environment.globals["SCSN-OMP2 CORRELATION ENERGY"] = Escsnmp2 - Escf;
+        Process::environment.globals["SCS-OMP2-VDW CORRELATION ENERGY"] = Escsmp2vdw - Escf;
+        Process::environment.globals["SOS-PI-OMP2 CORRELATION ENERGY"] = Esospimp2 - Escf;
+
+        // if scs on
+	if (do_scs == "TRUE") {
+	    if (scs_type_ == "SCS") {
+	       Process::environment.globals["CURRENT ENERGY"] = Escsmp2;
+	       Process::environment.globals["CURRENT CORRELATION ENERGY"] = Escsmp2 - Escf;
+            }
+
+	    else if (scs_type_ == "SCSN") {
+	       Process::environment.globals["CURRENT ENERGY"] = Escsnmp2;
+	       Process::environment.globals["CURRENT CORRELATION ENERGY"] = Escsnmp2 - Escf;
+            }
+
+	    else if (scs_type_ == "SCSVDW") {
+	       Process::environment.globals["CURRENT ENERGY"] = Escsmp2vdw;
+	       Process::environment.globals["CURRENT CORRELATION ENERGY"] = Escsmp2vdw - Escf;
+            }
+	}
+
+        // else if sos on
+	else if (do_sos == "TRUE") {
+	     if (sos_type_ == "SOS") {
+	         Process::environment.globals["CURRENT ENERGY"] = Esosmp2;
+  	         Process::environment.globals["CURRENT CORRELATION ENERGY"] = Esosmp2 - Escf;
+             }
+
+	     else if (sos_type_ == "SOSPI") {
+	             Process::environment.globals["CURRENT ENERGY"] = Esospimp2;
+	             Process::environment.globals["CURRENT CORRELATION ENERGY"] = Esospimp2 - Escf;
+             }
+	}
+
+	if (natorb == "TRUE") nbo();
+	if (occ_orb_energy == "TRUE") semi_canonic();
+  }// end if (conver == 1)
+}// end df_omp2_manager
+
+}} // End Namespaces
@@ -26,6 +26,9 @@
 #include "occwave.h"
 #include "defines.h"
 #include "dpd.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace boost;
 using namespace psi;
@@ -33,6 +36,20 @@ using namespace std;
 
 namespace psi{ namespace occwave{
 
+// Number of threads for the out-of-core GFock loops.  Each thread needs its own copy of
+// GFock, so fewer threads are used if the copies do not fit in the free DPD memory.
+static int gfock_threads(SharedMatrix GFock)
+{
+        int nthread = 1;
+#ifdef _OPENMP
+        nthread = omp_get_max_threads();
+#endif
+        long int size = 0;
+        for (int h = 0; h < GFock->nirrep(); h++) size += (long int)GFock->rowspi()[h] * (long int)GFock->colspi()[h];
+        while (nthread > 1 && nthread * size > dpd_memfree()) nthread--;
+        return nthread;
+}
+
 void OCCWave::gfock()
 {
 
@@ -143,26 +160,36 @@ if (wfn_type_ == "OMP2" && incore_iabc_ == 1) {
 
 else if (wfn_type_ == "OMP2" && incore_iabc_ == 0) { 
       	IWL ERIIN(psio_.get(), PSIF_OCC_IABC, 0.0, 1, 1);
-	int ilsti,nbuf,index,fi;
-	double value = 0.0;
-        double summ = 0.0;
+	int ilsti,nbuf;
+
+        // Each thread adds into its own copy of GFock; they are summed at the end
+        int nthread = gfock_threads(GFock);
+        std::vector<SharedMatrix> GFock_thread(nthread);
+        for (int t = 0; t < nthread; t++) {
+             GFock_thread[t] = GFock->clone();
+             GFock_thread[t]->zero();
+        }
 
  do
  {
         ilsti = ERIIN.last_buffer(); 
         nbuf = ERIIN.buffer_count();
 	
-   fi = 0;
+   #pragma omp parallel for schedule(static) num_threads(nthread)
    for (int idx=0; idx < nbuf; idx++ )
    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        int fi = 4 * idx;
 
         int i = ERIIN.labels()[fi];
             i = abs(i);
         int e = ERIIN.labels()[fi+1];
         int a = ERIIN.labels()[fi+2];
         int f = ERIIN.labels()[fi+3];
-        value = ERIIN.values()[idx];
-        fi += 4;
+        double value = ERIIN.values()[idx];
 
         int i_pitzer = qt2pitzerA[i];
         int e_pitzer = qt2pitzerA[e];
@@ -179,8 +206,8 @@ else if (wfn_type_ == "OMP2" && incore_iabc_ == 0) {
             int ee = pitzer2symblk[e_pitzer];
             int aa = pitzer2symblk[a_pitzer];
             int ff = pitzer2symblk[f_pitzer];
-            summ = 2.0 * value * gamma1corr->get(he,ee,ff);  
-            GFock->add(ha, aa, ii, summ); 
+            double summ = 2.0 * value * gamma1corr->get(he,ee,ff);  
+            GFock_thread[thread]->add(ha, aa, ii, summ); 
         }
 
    }
@@ -188,6 +215,8 @@ else if (wfn_type_ == "OMP2" && incore_iabc_ == 0) {
 	  ERIIN.fetch();
 
  } while(!ilsti);
+
+        for (int t = 0; t < nthread; t++) GFock->add(GFock_thread[t]);
 }// end else if (wfn_type_ == "OMP2" && incore_iabc_ == 0)  
 
 else if (wfn_type_ != "OMP2") { 
@@ -204,8 +233,15 @@ else if (wfn_type_ != "OMP2") {
 if (wfn_type_ == "OMP2" && incore_iabc_ == 0) { 
       // Fai += 8 * \sum{e,m,f} <ma|ef> * G_mief 
       	IWL ERIIN(psio_.get(), PSIF_OCC_IABC, 0.0, 1, 1);
-	int ilsti,nbuf,index,fi;
-	double value = 0;
+	int ilsti,nbuf;
+
+        // Each thread adds into its own copy of GFock; they are summed at the end
+        int nthread = gfock_threads(GFock);
+        std::vector<SharedMatrix> GFock_thread(nthread);
+        for (int t = 0; t < nthread; t++) {
+             GFock_thread[t] = GFock->clone();
+             GFock_thread[t]->zero();
+        }
 
        SymBlockMatrix *Goovv = new SymBlockMatrix("TPDM <OO|VV>", nirrep_, oo_pairpiAA, vv_pairpiAA); 
        Goovv->zero();
@@ -219,17 +255,21 @@ if (wfn_type_ == "OMP2" && incore_iabc_ == 0) {
         ilsti = ERIIN.last_buffer(); 
         nbuf = ERIIN.buffer_count();
 	
-   fi = 0;
+   #pragma omp parallel for schedule(static) num_threads(nthread)
    for (int idx=0; idx < nbuf; idx++ )
    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        int fi = 4 * idx;
 
         int m = ERIIN.labels()[fi];
             m = abs(m);
         int a = ERIIN.labels()[fi+1];
         int e = ERIIN.labels()[fi+2];
         int f = ERIIN.labels()[fi+3];
-        value = ERIIN.values()[idx];
-        fi += 4;
+        double value = ERIIN.values()[idx];
 
         int m_pitzer = qt2pitzerA[m];
         int a_pitzer = qt2pitzerA[a];
@@ -255,7 +295,7 @@ if (wfn_type_ == "OMP2" && incore_iabc_ == 0) {
                  int ef = vv_pairidxAA->get(hef, E, F);
                  summ = 8.0 * value * Goovv->get(hma, mi, ef);  
                  int aa = pitzer2symblk[a_pitzer];
-                 GFock->add(ha, aa, i, summ); 
+                 GFock_thread[thread]->add(ha, aa, i, summ); 
             }
         }
 
@@ -266,6 +306,8 @@ if (wfn_type_ == "OMP2" && incore_iabc_ == 0) {
  } while(!ilsti);
        delete Goovv;
 
+       for (int t = 0; t < nthread; t++) GFock->add(GFock_thread[t]);
+
 } // end if (wfn_type_ == "OMP2" && incore_iabc_ == 0)
 
 else {
@@ -156,9 +156,24 @@ do
         update_mo();
         timer_off("update_mo");
 
+/********************************************************************************************/
+/************************** DF-OMP2: Lagrangian and GFM from three-index integrals **********/
+/********************************************************************************************/
+     if (omp2_type_ == "DF") {
+        timer_on("DF-OMP2 GFock");
+        df_omp2_gfock();
+        timer_off("DF-OMP2 GFock");
+        DE = Emp2L - Emp2L_old;
+        Emp2L_old = Emp2L;
+     }
+
+     else {
+
 /********************************************************************************************/ 
 /************************** Transform TEI from SO to MO space *******************************/
 /********************************************************************************************/
+        // Rotating the previous MO integrals by the orbital rotation would be exact too, but it
+        // needs every (pq|rs) block in the MO basis and costs O(N^5) like the retransformation
         timer_on("trans_ints");
 	if (reference_ == "RESTRICTED") trans_ints_rhf();  
 	else if (reference_ == "UNRESTRICTED") trans_ints_uhf();  
@@ -255,6 +270,7 @@ do
            EcepaL_old = EcepaL;
         }
      }
+     }// end else (omp2_type_ == "DF")
 
 /********************************************************************************************/
 /************************** new orbital gradient ********************************************/
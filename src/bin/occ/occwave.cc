@@ -51,6 +51,7 @@ void OCCWave::common_init()
     if (print_ > 0) options_.print();
     wfn_type_=options_.get_str("WFN_TYPE");
     orb_opt_=options_.get_str("ORB_OPT");
+    omp2_type_=options_.get_str("OMP2_TYPE");
     title();
 
     tol_Eod=options_.get_double("E_CONVERGENCE");
@@ -160,6 +161,29 @@ void OCCWave::common_init()
            throw PSIEXCEPTION("ROHF-MP2 analytic gradients are not available, UHF-MP2 is recommended.");
         }
 
+        // DF-OMP2 is only available for RHF energies in C1 symmetry
+        if (omp2_type_ == "DF") {
+           if (wfn_type_ != "OMP2" || orb_opt_ == "FALSE") {
+              throw PSIEXCEPTION("OMP2_TYPE DF is only available for the OMP2 method.");
+           }
+           else if (reference_ != "RESTRICTED") {
+              throw FeatureNotImplemented("DF-OMP2", "Unrestricted references", __FILE__, __LINE__);
+           }
+           else if (nirrep_ != 1) {
+              throw FeatureNotImplemented("DF-OMP2", "Point-group symmetry (use symmetry c1)", __FILE__, __LINE__);
+           }
+           else if (dertype != "NONE") {
+              throw FeatureNotImplemented("DF-OMP2", "Analytic gradients", __FILE__, __LINE__);
+           }
+
+           // The orbital-response equations need the MO-basis integrals
+           if (opt_method == "ORB_RESP") {
+              opt_method = "MSD";
+              fprintf(outfile,"\tDF-OMP2 uses the MSD orbital steps, OPT_METHOD is changed to MSD.\n");
+              fflush(outfile);
+           }
+        }
+
         if (options_.get_str("DO_DIIS") == "TRUE") do_diis_ = 1;
         else if (options_.get_str("DO_DIIS") == "FALSE") do_diis_ = 0;
 
@@ -210,7 +234,7 @@ if (reference_ == "RESTRICTED") {
         cost_abcd_ *= (ULI)sizeof(double);
 
         // print
-    if (wfn_type_ == "OMP2") {
+    if (wfn_type_ == "OMP2" && omp2_type_ != "DF") {
         // Print memory
         memory = Process::environment.get_memory();
         memory_mb_ = memory/1000000L;
@@ -248,6 +272,13 @@ if (reference_ == "RESTRICTED") {
     spaces.push_back(MOSpace::occ);
     spaces.push_back(MOSpace::vir);
 
+if (omp2_type_ == "DF") {
+    // DF-OMP2 works with three-index integrals only
+    ints = NULL;
+    df_omp2_init();
+}
+
+else {
 if (wfn_type_ == "OMP2" && incore_iabc_ == 0) {
     ints = new IntegralTransform(reference_wavefunction_, spaces,
                            IntegralTransform::Restricted,
@@ -273,6 +304,7 @@ else {
     ints->set_keep_dpd_so_ints(true);
     ints->initialize();
     dpd_set_default(ints->get_dpd_id());
+}// end else
 
 }  // end if (reference_ == "RESTRICTED")
 
@@ -391,7 +423,8 @@ double OCCWave::compute_energy()
     }
 
         // Call the appropriate manager
-        if (wfn_type_ == "OMP2" && orb_opt_ == "TRUE") omp2_manager();
+        if (wfn_type_ == "OMP2" && orb_opt_ == "TRUE" && omp2_type_ == "DF") df_omp2_manager();
+        else if (wfn_type_ == "OMP2" && orb_opt_ == "TRUE") omp2_manager();
         else if (wfn_type_ == "OMP2" && orb_opt_ == "FALSE") mp2_manager();
         else if (wfn_type_ == "OMP3" && orb_opt_ == "TRUE") omp3_manager();
         else if (wfn_type_ == "OMP3" && orb_opt_ == "FALSE") mp3_manager();
@@ -566,6 +599,8 @@ void OCCWave::mem_release()
     Vso.reset();
     HmoA.reset();
     FockA.reset();
+    jk_.reset();
+    bQso_.reset();
     gamma1corr.reset();
     g1symm.reset();
     GFock.reset();
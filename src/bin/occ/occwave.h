@@ -26,6 +26,7 @@
 #include <libmints/wavefunction.h>
 #include <libdiis/diismanager.h>
 #include <libdpd/dpd.h>
+#include <libfock/jk.h>
 #include "arrays.h"
 
 using namespace std;
@@ -110,6 +111,11 @@ protected:
     void omp2_ea_poles();
     void ep2_ip();
 
+    // DF-OMP2
+    void df_omp2_manager();
+    void df_omp2_init();
+    void df_omp2_gfock();
+
     // OMP3
     void omp3_manager();
     void mp3_manager();
@@ -383,6 +389,7 @@ protected:
      string ekt_ip_;
      string ekt_ea_;
      string orb_opt_;
+     string omp2_type_;
 
 
      int *mopi; 		/* number of all MOs per irrep */
@@ -541,6 +548,12 @@ protected:
      SharedMatrix t1B;
      SharedMatrix t1newA;
      SharedMatrix t1newB;
+
+     // DF-OMP2
+     boost::shared_ptr<JK> jk_;	// JK object for the reference and separable terms
+     SharedMatrix bQso_;	// (Q|mn) with the metric applied, DF_BASIS_CC
+     int nQ_;			// Number of DF_BASIS_CC functions
+     int maxQ_;			// Number of auxiliary functions per (Q|pq) batch
     
 };
 
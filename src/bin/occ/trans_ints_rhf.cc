@@ -211,6 +211,7 @@ void OCCWave::denominators_rhf()
                   ID("[O,O]"), ID("[V,V]"), 0, "D <OO|VV>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
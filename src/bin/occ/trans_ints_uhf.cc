@@ -282,6 +282,7 @@ if (wfn_type_ != "OMP2") {
         global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             for(int kl = 0; kl < K.params->coltot[h]; ++kl){
                 int k = K.params->colorb[h][kl][0];
@@ -312,6 +313,7 @@ if (wfn_type_ != "OMP2") {
         global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             for(int kl = 0; kl < K.params->coltot[h]; ++kl){
                 int k = K.params->colorb[h][kl][0];
@@ -344,6 +346,7 @@ if (wfn_type_ != "OMP2") {
         global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             int i = K.params->roworb[h][ij][0];
             int j = K.params->roworb[h][ij][1];
@@ -375,6 +378,7 @@ if (wfn_type_ != "OMP2") {
         global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             int i = K.params->roworb[h][ij][0];
             int j = K.params->roworb[h][ij][1];
@@ -408,6 +412,7 @@ if (wfn_type_ != "OMP2") {
 	global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             for(int ab = 0; ab < K.params->coltot[h]; ++ab){
                 int a = K.params->colorb[h][ab][0];
@@ -438,6 +443,7 @@ if (wfn_type_ != "OMP2") {
 	global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             for(int ab = 0; ab < K.params->coltot[h]; ++ab){
                 int a = K.params->colorb[h][ab][0];
@@ -470,6 +476,7 @@ if (wfn_type_ != "OMP2") {
         global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int row = 0; row < K.params->rowtot[h]; ++row){
             for(int col = 0; col < K.params->coltot[h]; ++col){
                 K.matrix[h][row][col] -= G.matrix[h][row][col];
@@ -502,6 +509,7 @@ if (wfn_type_ != "OMP2") {
         global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int row = 0; row < K.params->rowtot[h]; ++row){
             for(int col = 0; col < K.params->coltot[h]; ++col){
                 K.matrix[h][row][col] -= G.matrix[h][row][col];
@@ -800,6 +808,7 @@ void OCCWave::denominators_uhf()
                   ID("[O,O]"), ID("[V,V]"), 0, "D <OO|VV>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
@@ -821,6 +830,7 @@ void OCCWave::denominators_uhf()
                   ID("[o,o]"), ID("[v,v]"), 0, "D <oo|vv>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
@@ -842,6 +852,7 @@ void OCCWave::denominators_uhf()
                   ID("[O,o]"), ID("[V,v]"), 0, "D <Oo|Vv>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
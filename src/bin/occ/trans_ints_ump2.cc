@@ -102,6 +102,7 @@ void OCCWave::trans_ints_ump2()
 	global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             for(int ab = 0; ab < K.params->coltot[h]; ++ab){
                 int a = K.params->colorb[h][ab][0];
@@ -132,6 +133,7 @@ void OCCWave::trans_ints_ump2()
 	global_dpd_->buf4_mat_irrep_init(&G, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&G, h);
+        #pragma omp parallel for
         for(int ij = 0; ij < K.params->rowtot[h]; ++ij){
             for(int ab = 0; ab < K.params->coltot[h]; ++ab){
                 int a = K.params->colorb[h][ab][0];
@@ -214,6 +216,7 @@ void OCCWave::denominators_ump2()
                   ID("[O,O]"), ID("[V,V]"), 0, "D <OO|VV>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
@@ -235,6 +238,7 @@ void OCCWave::denominators_ump2()
                   ID("[o,o]"), ID("[v,v]"), 0, "D <oo|vv>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
@@ -256,6 +260,7 @@ void OCCWave::denominators_ump2()
                   ID("[O,o]"), ID("[V,v]"), 0, "D <Oo|Vv>");
     for(int h = 0; h < nirrep_; ++h){
         global_dpd_->buf4_mat_irrep_init(&D, h);
+        #pragma omp parallel for
         for(int row = 0; row < D.params->rowtot[h]; ++row){
             int i = D.params->roworb[h][row][0];
             int j = D.params->roworb[h][row][1];
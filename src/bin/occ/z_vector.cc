@@ -80,6 +80,7 @@ if (reference_ == "RESTRICTED") {
         int h =0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -98,6 +99,7 @@ if (reference_ == "RESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -116,6 +118,7 @@ if (reference_ == "RESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -248,6 +251,7 @@ else if (reference_ == "UNRESTRICTED") {
         int h =0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -266,6 +270,7 @@ else if (reference_ == "UNRESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -284,6 +289,7 @@ else if (reference_ == "UNRESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -326,6 +332,7 @@ else if (reference_ == "UNRESTRICTED") {
         h =0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -344,6 +351,7 @@ else if (reference_ == "UNRESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -362,6 +370,7 @@ else if (reference_ == "UNRESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -402,6 +411,7 @@ else if (reference_ == "UNRESTRICTED") {
         h = 0;
         global_dpd_->buf4_mat_irrep_init(&K, h);
         global_dpd_->buf4_mat_irrep_rd(&K, h);
+        #pragma omp parallel for
         for(int ai = 0; ai < K.params->rowtot[h]; ++ai){
             int a = K.params->roworb[h][ai][0];
             int i = K.params->roworb[h][ai][1];
@@ -194,6 +194,19 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     /*- Number of threads for DETCI. -*/
     options.add_int("CI_NUM_THREADS", 1);
 
+    /*- Precision in which the old Davidson-Liu subspace vectors (b and
+    sigma) are kept on disk. SINGLE halves their disk space and I/O, but
+    rounds their elements to about 7 significant digits. The b and sigma
+    vectors of the current iteration, vectors in core, and the final CI
+    vectors are always double precision. Not used with |detci__no_dfile|.
+    On a restart the precision of the existing files is kept. -*/
+    options.add_str("CI_VECTOR_PRECISION", "DOUBLE", "DOUBLE SINGLE");
+
+    /*- Do read the next buffer of the C vector in the background while the
+    sigma vector is formed from the current one? Applies to
+    |detci__icore| = 2 and costs memory for one more buffer. -*/
+    options.add_bool("CI_VECTOR_PREFETCH", false);
+
     /*- Do print the sigma overlap matrix?  Not generally useful.  !expert -*/
     options.add_bool("SIGMA_OVERLAP", false);
 
@@ -693,9 +706,9 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     used. -*/
     options.add_bool("NO_RESPONSE",false);
 
-    /*- Do use asynchronous disk I/O in the solution of the CPHF equations?
-    Use may speed up the computation slightly at the cost of spawning an
-    additional thread. -*/
+    /*- Deprecated, has no effect, and prints a warning when set. SAPT0
+    always reads the next block of DF integrals ahead when they do not fit
+    in memory. !expert -*/
     options.add_bool("AIO_CPHF",false);
 
     /*- Do use asynchronous disk I/O in the formation of the DF integrals?
@@ -745,6 +758,12 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     options.add_double("INTS_TOLERANCE",1.0E-12);
     /*- Memory safety -*/
     options.add_double("SAPT_MEM_SAFETY",0.9);
+    /*- Do start the monomer SCFs from the orbitals of the previous SAPT
+    computation? The saved orbitals are rotated onto the current monomer frame
+    when the monomer has moved as a rigid body, as in a potential energy surface
+    scan, and are kept when the scratch files are cleaned. Only the orbitals
+    are reused; the DF integrals and CPHF responses are recomputed. -*/
+    options.add_bool("SAPT_MONOMER_CACHE",false);
     /*- Do force SAPT2 and higher to die if it thinks there isn't enough
     memory?  Turning this off is ill-advised. -*/
     options.add_bool("SAPT_MEM_CHECK",true);
@@ -825,8 +844,10 @@ int read_options(const std::string &name, Options & options, bool suppress_print
       (<VV||VV>) by computing the corresponding terms in the AO basis. AO_BASIS = DISK algorithm reduces the memory
       requirements and can significantly reduce the cost of the energy computation if SIMULTANEOUS
       algorithm is used. For the TWOSTEP algorithm, however, AO_BASIS = DISK
-      option is not recommended due to the extra I/O. -*/
-      options.add_str("AO_BASIS", "NONE", "NONE DISK");
+      option is not recommended due to the extra I/O. AO_BASIS = DIRECT computes the SO-basis integrals
+      for these terms on the fly, with Schwarz screening (INTS_TOLERANCE) and thread parallelism, instead
+      of reading them from disk. -*/
+      options.add_str("AO_BASIS", "NONE", "NONE DISK DIRECT");
       /*- The amount (percentage) of damping to apply to the orbital update procedure:
       0 will result in a full update, 100 will completely stall the
       update. A value around 20 (which corresponds to 20\% of the previous
@@ -1001,6 +1022,33 @@ int read_options(const std::string &name, Options & options, bool suppress_print
         by. !expert -*/
     options.add_double("FOLLOW_STEP_SCALE", 0.5);
 
+    /*- SUBSECTION Fock Matrix Diagonalization -*/
+
+    /*- LAPACK eigensolver used to diagonalize the Fock matrix. DSYEVD
+    (divide-and-conquer) and DSYEVR (MRRR) are usually faster than DSYEV for
+    large irrep blocks. -*/
+    options.add_str("DIAG_SOLVER", "DSYEV", "DSYEV DSYEVD DSYEVR");
+    /*- Number of irrep blocks of the Fock matrix to diagonalize concurrently -*/
+    options.add_int("DIAG_NUM_THREADS", 1);
+    /*- RMS orbital gradient below which the full diagonalization of the Fock
+    matrix is replaced by occupied-virtual Jacobi rotations of the current
+    orbitals. A final full diagonalization is always performed. 0.0 disables
+    pseudo-diagonalization. -*/
+    options.add_double("PSEUDO_DIAG_CONVERGENCE", 0.0);
+
+    /*- SUBSECTION Density Purification RHF/UHF -*/
+
+    /*- The iteration to start replacing the diagonalization of the Fock matrix
+    by canonical density purification (or 0 for no purification) -*/
+    options.add_int("PURIFY_START", 0);
+    /*- Maximum number of purification steps per SCF iteration -*/
+    options.add_int("PURIFY_MAXITER", 100);
+    /*- Idempotency criterion, tr(P - P^2), for density purification -*/
+    options.add_double("PURIFY_CONVERGENCE", 1.0E-10);
+    /*- Number of purified iterations without a decrease in the orbital gradient
+    before falling back to diagonalization -*/
+    options.add_int("PURIFY_MAX_STALLS", 2);
+
     /*- SUBSECTION Fractional Occupation UHF/UKS -*/
 
     /*- The iteration to start fractionally occupying orbitals (or 0 for no fractional occupation) -*/
@@ -1128,8 +1176,18 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     options.add_int("DFT_BLOCK_MIN_POINTS",1000);
     /*- The maximum radius to terminate subdivision of an octree block [au]. !expert -*/
     options.add_double("DFT_BLOCK_MAX_RADIUS",3.0);
-    /*- The blocking scheme for DFT. !expert -*/
-    options.add_str("DFT_BLOCK_SCHEME","OCTREE","NAIVE OCTREE");
+    /*- The blocking scheme for DFT. HILBERT sorts the points along a space-filling
+    curve and balances the blocks by points times significant functions. !expert -*/
+    options.add_str("DFT_BLOCK_SCHEME","OCTREE","NAIVE OCTREE HILBERT");
+    /*- Do save the blocked DFT grid to scratch and reuse it when the same
+    molecule, basis, and grid options come up again? !expert -*/
+    options.add_bool("DFT_GRID_CACHE",false);
+    /*- Do keep basis function values on the DFT grid between SCF iterations?
+    CORE holds up to |scf__dft_collocation_memory| in memory and recomputes
+    the remaining blocks, DISK writes the remaining blocks to scratch. -*/
+    options.add_str("DFT_COLLOCATION_CACHE","NONE","NONE CORE DISK");
+    /*- Memory [MiB] for cached DFT basis function values -*/
+    options.add_int("DFT_COLLOCATION_MEMORY",256);
     /*- Parameters defining the dispersion correction. See Table
     :ref:`-D Functionals <table:dft_disp>` for default values and Table
     :ref:`Dispersion Corrections <table:dashd>` for the order in which
@@ -1667,6 +1725,9 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     options.add_bool("PR", false);
     /*- Number of components of transition amplitudes printed -*/
     options.add_int("NUM_AMPS_PRINT", 5);
+    /*- Do build the sigma vectors of all trial vectors of an irrep in one pass
+    over the integrals? Recommended when many roots are sought. -*/
+    options.add_bool("BLOCK_SIGMA", false);
   }
   if(name == "CCHBAR"|| options.read_globals()) {
      /*- MODULEDESCRIPTION Assembles the coupled cluster effective Hamiltonian. Called whenever CC
@@ -1976,14 +2037,17 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     If AO_BASIS is ``NONE``, the MO-basis integrals will be used;
     if AO_BASIS is ``DISK``, the AO-basis integrals stored on disk will
     be used; if AO_BASIS is ``DIRECT``, the AO-basis integrals will be computed
-    on the fly as necessary.  NB: The ``DIRECT`` option is not fully
-    implemented and should only be used by experts.  Default is NONE.
+    on the fly as necessary, so that no four-index integral file is needed.
+    Default is NONE.
     Note: The developers recommend use of this keyword only as a last
     resort because it significantly slows the calculation. The current
     algorithms for handling the MO-basis four-virtual-index integrals have
     been significantly improved and are preferable to the AO-based approach.
     !expert -*/
     options.add_str("AO_BASIS", "NONE", "NONE DISK DIRECT");
+    /*- Schwarz screening threshold for the shell quartets computed
+    with AO_BASIS = DIRECT. Integrals smaller than this are also dropped. -*/
+    options.add_double("INTS_TOLERANCE", 1e-14);
     /*- Cacheing level for libdpd governing the storage of amplitudes,
     integrals, and intermediates in the CC procedure. A value of 0 retains
     no quantities in cache, while a level of 6 attempts to store all
@@ -1996,8 +2060,12 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     cache used by the libdpd codes. A value of ``LOW`` selects a "low priority"
     scheme in which the deletion of items from the cache is based on
     pre-programmed priorities. A value of LRU selects a "least recently used"
-    scheme in which the oldest item in the cache will be the first one deleted. -*/
-    options.add_str("CACHETYPE", "LOW", "LOW LRU");
+    scheme in which the oldest item in the cache will be the first one deleted.
+    A value of ``TRACE`` records the cache accesses of the first iteration and,
+    in later iterations, deletes the item whose next access is farthest away
+    and prefetches items into free memory; hit rates and bytes read per
+    iteration are printed after the iterations. -*/
+    options.add_str("CACHETYPE", "LOW", "LOW LRU TRACE");
     /*- Number of threads -*/
     options.add_int("CC_NUM_THREADS",1);
     /*- Do use DIIS extrapolation to accelerate convergence? -*/
@@ -2010,6 +2078,12 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     options.add_str("PROPERTY", "POLARIZABILITY", "POLARIZABILITY ROTATION MAGNETIZABILITY ROA ALL");
     /*- Type of ABCD algorithm will be used -*/
     options.add_str("ABCD", "NEW", "NEW OLD");
+    /*- Precision of the B(+)/B(-) integrals in the RHF ``NEW`` ABCD
+    algorithm. ``SINGLE`` keeps a single-precision copy of them on disk,
+    halving the I/O of the out-of-core ladder term, and contracts it with
+    SGEMM, accumulating in double. The first iteration is done in both
+    precisions and the difference is printed. -*/
+    options.add_str("ABCD_PRECISION", "DOUBLE", "DOUBLE SINGLE");
     /*- Do simulate the effects of local correlation techniques? -*/
     options.add_bool("LOCAL", 0);
     /*- Value (always between one and zero) for the Broughton-Pulay completeness
@@ -2175,6 +2249,59 @@ int read_options(const std::string &name, Options & options, bool suppress_print
     options.add_double("MP2_SS_SCALE", 1.0/3.0);
     /*- \% of memory for DF-MP2 three-index buffers -*/
     options.add_double("DFMP2_MEM_FACTOR", 0.9);
+    /*- Algorithm for the RHF DF-MP2 energy. LAPLACE forms only the
+    opposite-spin energy, from Laplace-factored denominators, at O(N^4) cost,
+    and reports the SOS-MP2 energy with |dfmp2__mp2_os_scale| as the
+    opposite-spin scale; the MP2 and SCS-MP2 energies are not computed.
+    Note that the default scale, 1.2, is the SCS-MP2 one; set it to 1.3 for
+    the usual SOS-MP2 energy. LAPLACE and THC need an RHF reference and
+    have no gradient. THC also factors the (ia|jb) integrals by
+    least-squares tensor hypercontraction on the pseudospectral grid, for
+    an O(N^3) opposite-spin energy. THC likewise reports only the SOS-MP2
+    energy: the same-spin term is not implemented, as its THC form costs
+    O(N_grid^4) per quadrature point, and there is no THC path for SAPT
+    dispersion. -*/
+    options.add_str("DFMP2_ENERGY_ALGORITHM", "DF", "DF LAPLACE THC");
+    /*- Maximum error in the Laplace quadrature of the denominators, which sets
+    the number of quadrature points for |dfmp2__dfmp2_energy_algorithm| LAPLACE
+    and THC. -*/
+    options.add_double("DFMP2_LAPLACE_TOLERANCE", 1.0E-6);
+    /*- Relative eigenvalue cutoff in the inverse of the fitting metric for
+    |dfmp2__dfmp2_energy_algorithm| THC. !expert -*/
+    options.add_double("THC_J_CUTOFF", 1.0E-10);
+    /*- Relative eigenvalue cutoff in the inverse of the grid overlap for
+    |dfmp2__dfmp2_energy_algorithm| THC. !expert -*/
+    options.add_double("THC_S_CUTOFF", 1.0E-10);
+    /*- Do balance the least-squares THC factors between the two sides of
+    (ia|jb)? !expert -*/
+    options.add_bool("THC_BALANCE", false);
+    /*- Number of spherical points (A :ref:`Lebedev Points <table:lebedevorder>` number)
+    of the THC grid. -*/
+    options.add_int("PS_SPHERICAL_POINTS", 50);
+    /*- Number of radial points of the THC grid. -*/
+    options.add_int("PS_RADIAL_POINTS", 35);
+    /*- Radial Scheme of the THC grid. -*/
+    options.add_str("PS_RADIAL_SCHEME", "TREUTLER", "TREUTLER BECKE MULTIEXP EM MURA");
+    /*- Nuclear Scheme of the THC grid. -*/
+    options.add_str("PS_NUCLEAR_SCHEME", "TREUTLER", "TREUTLER BECKE NAIVE STRATMANN");
+    /*- Factor for effective BS radius in the radial THC grid. -*/
+    options.add_double("PS_BS_RADIUS_ALPHA",1.0);
+    /*- Basis cutoff on the THC grid. -*/
+    options.add_double("PS_BASIS_TOLERANCE", 1.0E-12);
+    /*- The THC grid specification, such as SG1.!expert -*/
+    options.add_str("PS_GRID_NAME","","SG0 SG1");
+    /*- Pruning Scheme of the THC grid. !expert -*/
+    options.add_str("PS_PRUNING_SCHEME", "FLAT", "FLAT P_GAUSSIAN D_GAUSSIAN P_SLATER D_SLATER LOG_GAUSSIAN LOG_SLATER");
+    /*- Spread alpha for logarithmic pruning of the THC grid. !expert -*/
+    options.add_double("PS_PRUNING_ALPHA",1.0);
+    /*- The maximum number of THC grid points per evaluation block. !expert -*/
+    options.add_int("PS_BLOCK_MAX_POINTS",5000);
+    /*- The minimum number of THC grid points per evaluation block. !expert -*/
+    options.add_int("PS_BLOCK_MIN_POINTS",1000);
+    /*- The maximum radius to terminate subdivision of an octree block of the THC grid [au]. !expert -*/
+    options.add_double("PS_BLOCK_MAX_RADIUS",3.0);
+    /*- The blocking scheme for the THC grid. !expert -*/
+    options.add_str("DFT_BLOCK_SCHEME","OCTREE","NAIVE OCTREE HILBERT");
     /*- Minimum absolute value below which integrals are neglected. -*/
     options.add_double("INTS_TOLERANCE", 0.0);
     /*- Minimum error in the 2-norm of the P(2) matrix for corrections to Lia and P. -*/
@@ -2471,6 +2598,16 @@ int read_options(const std::string &name, Options & options, bool suppress_print
 
     /*- Algorithm to use for non-OO MP2 computation -*/
     options.add_str("MP2_TYPE", "DF", "DF CONV");
+    /*- Algorithm to use for OMP2 computation. DF builds the MP2 Lagrangian
+    from three-index integrals every orbital iteration instead of
+    retransforming the four-index integrals (RHF, C1 symmetry only). -*/
+    options.add_str("OMP2_TYPE", "CONV", "CONV DF");
+    /*- Auxiliary basis set for the reference (JK) part of DF-OMP2.
+    Defaults to a JKFIT basis. -*/
+    options.add_str("DF_BASIS_SCF", "");
+    /*- Auxiliary basis set for the correlation part of DF-OMP2.
+    Defaults to a RI basis. -*/
+    options.add_str("DF_BASIS_CC", "");
     /*- Maximum number of iterations to determine the amplitudes -*/
     options.add_int("CC_MAXITER",50);
     /*- Maximum number of iterations to determine the orbitals -*/
@@ -2682,6 +2819,9 @@ int read_options(const std::string &name, Options & options, bool suppress_print
   if (name == "FNOCC"|| options.read_globals()) {
       /*- Do time each cc diagram? -*/
       options.add_bool("CC_TIMINGS",false);
+      /*- Do read the next block of (ab|cd) integrals while the current
+      one is contracted?  This halves the block size. -*/
+      options.add_bool("CC_TILE_PREFETCH",true);
       /*- Convergence criterion for CC energy. See Table :ref:`Post-SCF
       Convergence <table:conv_corl>` for default convergence criteria for
       different calculation types.  Note that convergence is
@@ -2702,6 +2842,13 @@ int read_options(const std::string &name, Options & options, bool suppress_print
           option is enabled automatically if the memory requirements of the
           conventional algorithm would exceed the available resources -*/
       options.add_bool("TRIPLES_LOW_MEMORY",false);
+      /*- Virtual triples abc whose summed virtual-pair energies
+          |e(ab)|+|e(ac)|+|e(bc)| fall below this value are skipped in the
+          CIM local (T) correction.  Zero disables the screening. !expert -*/
+      options.add_double("LOCAL_TRIPLES_CUTOFF", 0.0);
+      /*- Every nth triple skipped by |fnocc__local_triples_cutoff| is still
+          evaluated to estimate the neglected energy. !expert -*/
+      options.add_int("LOCAL_TRIPLES_SAMPLE", 20);
       /*- Do compute triples contribution? !expert -*/
       options.add_bool("COMPUTE_TRIPLES", true);
       /*- Do compute MP4 triples contribution? !expert -*/
@@ -92,6 +92,15 @@ DPD::dpd_block_matrix(size_t n, size_t m)
             }
         }
 
+        /* Trace-driven cache */
+        else if(dpd_main.cachetype == 2) {
+            if(file4_cache_del_trace()) {
+                file4_cache_print(stderr);
+                fprintf(stderr, "dpd_block_matrix: n = %zd  m = %zd\n", n, m);
+                dpd_error("dpd_block_matrix: No memory left.", stderr);
+            }
+        }
+
         else dpd_error("LIBDPD Error: invalid cachetype.", stderr);
     }
 
@@ -129,6 +138,15 @@ DPD::dpd_block_matrix(size_t n, size_t m)
                 dpd_error("dpd_block_matrix: No memory left.", stderr);
             }
         }
+
+        /* Trace-driven cache */
+        else if(dpd_main.cachetype == 2) {
+            if(file4_cache_del_trace()) {
+                file4_cache_print(stderr);
+                fprintf(stderr, "dpd_block_matrix: n = %zd  m = %zd\n", n, m);
+                dpd_error("dpd_block_matrix: No memory left.", stderr);
+            }
+        }
     }
 
     /*  memset((void *) B, 0, m*n*sizeof(double)); */
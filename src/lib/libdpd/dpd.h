@@ -150,10 +150,29 @@ struct dpd_file4_cache_entry {
     unsigned int priority;              /* priority level */
     int lock;                           /* auto-deletion allowed? */
     int clean;                          /* has this file4 changed? */
+    long int next_use;                  /* predicted next access (trace cache) */
     dpd_file4_cache_entry *next; /* pointer to next cache entry */
     dpd_file4_cache_entry *last; /* pointer to previous cache entry */
 };
 
+/* One file4 access recorded by the trace-driven cache (cachetype 2) */
+struct dpd_file4_trace_entry {
+    int dpdnum;                         /* dpd structure reference */
+    int filenum;                        /* libpsio unit number */
+    int irrep;                          /* overall symmetry */
+    int pqnum;                          /* dpd pq value */
+    int rsnum;                          /* dpd rs value */
+    char label[PSIO_KEYLEN];            /* libpsio TOC keyword */
+    long int next;                      /* trace position of the next access */
+};
+
+/* Per-iteration file4 cache statistics of the trace-driven cache */
+struct dpd_file4_cache_stats {
+    long int hits;                      /* cacheable file4_init()s found in core */
+    long int misses;                    /* cacheable file4_init()s read from disk */
+    long int bytes_read;                /* bytes read by all file4 reads */
+};
+
 /* DPD File2 Cache entries */
 struct dpd_file2_cache_entry {
     dpd_file2_cache_entry():
@@ -215,7 +234,11 @@ struct dpd_gbl {
         file4_cache_least_recent(1),
         file4_cache_most_recent(0),
         file4_cache_low_del(0),
-        file4_cache_lru_del(0)
+        file4_cache_lru_del(0),
+        file4_trace_mode(0),
+        file4_trace_busy(0),
+        file4_trace_pos(0),
+        file4_trace_base(0)
     {}
     dpd_file2_cache_entry *file2_cache;
     dpd_file4_cache_entry *file4_cache;
@@ -227,6 +250,16 @@ struct dpd_gbl {
     int *cachefiles;
     int **cachelist;
     dpd_file4_cache_entry *file4_cache_priority;
+
+    /* Trace-driven cache (cachetype 2): the file4 accesses of the first
+       iteration are recorded and replayed to evict, in later iterations,
+       the entry whose next access is farthest away (Belady's MIN). */
+    int file4_trace_mode;               /* 0 = off, 1 = recording, 2 = replaying */
+    int file4_trace_busy;               /* nonzero during internal file4_init()s */
+    long int file4_trace_pos;           /* position in the recorded trace */
+    long int file4_trace_base;          /* virtual time of trace position 0 */
+    std::vector<dpd_file4_trace_entry> file4_trace;
+    std::vector<dpd_file4_cache_stats> file4_trace_stats;
 };
 
 /* Useful for the generalized 4-index sorting function */
@@ -423,6 +456,12 @@ public:
     void file4_cache_lock(dpdfile4 *File);
     void file4_cache_unlock(dpdfile4 *File);
 
+    void file4_cache_trace_next(void);
+    void file4_cache_trace_print(FILE *outfile);
+    void file4_cache_trace_access(dpdfile4 *File, int hit);
+    void file4_cache_trace_read(long int bytes);
+    int file4_cache_del_trace(void);
+
     void sort_3d(double ***Win, double ***Wout, int nirreps, int h, int *rowtot, int **rowidx,
                  int ***roworb, int *asym, int *bsym, int *aoff, int *boff,
                  int *cpi, int *coff, int **rowidx_out, enum pattern index, int sum);
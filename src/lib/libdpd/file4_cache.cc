@@ -27,6 +27,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <climits>
 #include <libqt/qt.h>
 #include "dpd.h"
 
@@ -39,6 +40,10 @@ void DPD::file4_cache_init(void)
     dpd_main.file4_cache_least_recent = 1;
     dpd_main.file4_cache_lru_del = 0;
     dpd_main.file4_cache_low_del = 0;
+    dpd_main.file4_trace_mode = 0;
+    dpd_main.file4_trace_busy = 0;
+    dpd_main.file4_trace.clear();
+    dpd_main.file4_trace_stats.clear();
 }
 
 void DPD::file4_cache_close(void)
@@ -192,6 +197,9 @@ int DPD::file4_cache_add(dpdfile4 *File, unsigned int priority)
         /* Set the priority level */
         this_entry->priority = priority;
 
+        /* No predicted access until the trace-driven cache sees one */
+        this_entry->next_use = LONG_MAX;
+
         this_entry->matrix = File->matrix;
 
         File->incore = 1;
@@ -0,0 +1,293 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+/*! \file
+    \ingroup DPD
+    \brief Trace-driven file4 cache replacement (cachetype 2)
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <map>
+#include <string>
+#include <libpsio/psio.h>
+#include "dpd.h"
+
+namespace psi {
+
+namespace {
+
+bool trace_match(const dpd_file4_trace_entry &t, int dpdnum, int filenum, int irrep,
+                 int pqnum, int rsnum, const char *label)
+{
+    return (t.filenum == filenum && t.irrep == irrep && t.pqnum == pqnum &&
+            t.rsnum == rsnum && t.dpdnum == dpdnum && !strcmp(t.label, label));
+}
+
+std::string trace_key(const dpd_file4_trace_entry &t)
+{
+    char key[PSIO_KEYLEN+64];
+    sprintf(key, "%d %d %d %d %d %s", t.dpdnum, t.filenum, t.irrep, t.pqnum, t.rsnum, t.label);
+    return std::string(key);
+}
+
+/* Looks up a cache entry without touching its access and usage counters */
+dpd_file4_cache_entry *trace_find(const dpd_file4_trace_entry &t)
+{
+    dpd_file4_cache_entry *this_entry = dpd_main.file4_cache;
+
+    while(this_entry != NULL) {
+        if(this_entry->filenum == t.filenum && this_entry->irrep == t.irrep &&
+                this_entry->pqnum == t.pqnum && this_entry->rsnum == t.rsnum &&
+                this_entry->dpdnum == t.dpdnum && !strcmp(this_entry->label, t.label))
+            return this_entry;
+        this_entry = this_entry->next;
+    }
+
+    return NULL;
+}
+
+}
+
+/* file4_cache_trace_next(): Marks the start of an iteration for the
+** trace-driven cache.  The first call starts recording the sequence of
+** cacheable file4_init() calls.  The second call turns that recording
+** into a replacement plan: each access is linked to the next access of
+** the same file4, with the last access of each file4 pointing at its
+** first access in the following iteration.  Later calls rewind the
+** trace and prefetch, in trace order, the file4s that fit into the free
+** memory without evicting anything.
+**
+** Does nothing unless the cache type is 2.
+*/
+void DPD::file4_cache_trace_next(void)
+{
+    long int k, N, size;
+    int h, dpdnum;
+    dpdfile4 File;
+    dpdparams4 *Params;
+    dpd_file4_cache_entry *this_entry;
+    std::map<std::string, long int> first, next;
+
+    if(dpd_main.cachetype != 2) return;
+
+    std::vector<dpd_file4_trace_entry> &trace = dpd_main.file4_trace;
+
+    if(dpd_main.file4_trace_mode == 0) {
+        trace.clear();
+        dpd_main.file4_trace_stats.clear();
+        dpd_main.file4_trace_mode = 1;
+    }
+    else if(dpd_main.file4_trace_mode == 1) {
+        N = trace.size();
+
+        for(k=0; k < N; k++) {
+            std::string key = trace_key(trace[k]);
+            if(first.find(key) == first.end()) first[key] = k;
+        }
+        for(k=N-1; k >= 0; k--) {
+            std::string key = trace_key(trace[k]);
+            if(next.find(key) == next.end()) trace[k].next = first[key] + N;
+            else trace[k].next = next[key];
+            next[key] = k;
+        }
+
+        dpd_main.file4_trace_mode = 2;
+        dpd_main.file4_trace_base = N;
+        dpd_main.file4_trace_pos = 0;
+
+        /* Entries already in core are next needed at their first access */
+        for(this_entry = dpd_main.file4_cache; this_entry != NULL; this_entry = this_entry->next)
+            this_entry->next_use = LONG_MAX;
+        for(k=0; k < N; k++) {
+            this_entry = trace_find(trace[k]);
+            if(this_entry != NULL && this_entry->next_use == LONG_MAX)
+                this_entry->next_use = dpd_main.file4_trace_base + k;
+        }
+    }
+    else {
+        dpd_main.file4_trace_base += trace.size();
+        dpd_main.file4_trace_pos = 0;
+    }
+
+    dpd_main.file4_trace_stats.push_back(dpd_file4_cache_stats());
+    dpd_main.file4_trace_stats.back().hits = 0;
+    dpd_main.file4_trace_stats.back().misses = 0;
+    dpd_main.file4_trace_stats.back().bytes_read = 0;
+
+    if(dpd_main.file4_trace_mode != 2) return;
+
+    /* Prefetch */
+    dpdnum = dpd_default;
+    dpd_main.file4_trace_busy++;
+    for(k=0; k < (long int) trace.size(); k++) {
+        if(trace_find(trace[k]) != NULL) continue;
+        if(!psio_open_check(trace[k].filenum)) continue;
+        if(psio_tocscan(trace[k].filenum, trace[k].label) == NULL) continue;
+
+        Params = &(dpd_list[trace[k].dpdnum]->params4[trace[k].pqnum][trace[k].rsnum]);
+        for(h=0,size=0; h < Params->nirreps; h++)
+            size += ((long) Params->rowtot[h]) * ((long) Params->coltot[h^trace[k].irrep]);
+        if(size > dpd_memfree()) continue;
+
+        dpd_set_default(trace[k].dpdnum);
+        file4_init(&File, trace[k].filenum, trace[k].irrep, trace[k].pqnum,
+                   trace[k].rsnum, trace[k].label);
+        this_entry = trace_find(trace[k]);
+        if(this_entry != NULL) this_entry->next_use = dpd_main.file4_trace_base + k;
+        file4_close(&File);
+    }
+    dpd_main.file4_trace_busy--;
+    dpd_set_default(dpdnum);
+}
+
+/* file4_cache_trace_access(): Records (first iteration) or follows
+** (later iterations) a cacheable file4_init() of File.  hit is nonzero
+** if File was already in core.
+*/
+void DPD::file4_cache_trace_access(dpdfile4 *File, int hit)
+{
+    long int k, N, pos, next_use;
+    dpd_file4_trace_entry access;
+    dpd_file4_cache_entry *this_entry;
+
+    if(dpd_main.file4_trace_mode == 0 || dpd_main.file4_trace_busy) return;
+
+    if(hit) dpd_main.file4_trace_stats.back().hits++;
+    else dpd_main.file4_trace_stats.back().misses++;
+
+    access.dpdnum = File->dpdnum;
+    access.filenum = File->filenum;
+    access.irrep = File->my_irrep;
+    access.pqnum = File->params->pqnum;
+    access.rsnum = File->params->rsnum;
+    strcpy(access.label, File->label);
+    access.next = -1;
+
+    if(dpd_main.file4_trace_mode == 1) {
+        dpd_main.file4_trace.push_back(access);
+        return;
+    }
+
+    /* Find this access in the trace, searching forward from the current
+       position first, as later iterations may skip or add a few accesses */
+    std::vector<dpd_file4_trace_entry> &trace = dpd_main.file4_trace;
+    N = trace.size();
+    pos = dpd_main.file4_trace_pos;
+    for(k=pos; k < N; k++)
+        if(trace_match(trace[k], access.dpdnum, access.filenum, access.irrep,
+                       access.pqnum, access.rsnum, access.label)) break;
+    if(k == N) {
+        for(k=0; k < pos; k++)
+            if(trace_match(trace[k], access.dpdnum, access.filenum, access.irrep,
+                           access.pqnum, access.rsnum, access.label)) break;
+        if(k == pos) k = N;
+    }
+
+    if(k < N) {
+        if(k >= pos) dpd_main.file4_trace_pos = k+1;
+        next_use = dpd_main.file4_trace_base + trace[k].next;
+    }
+    else next_use = LONG_MAX;
+
+    this_entry = trace_find(access);
+    if(this_entry != NULL) this_entry->next_use = next_use;
+}
+
+/* file4_cache_trace_read(): Counts bytes read from disk by the file4 readers */
+void DPD::file4_cache_trace_read(long int bytes)
+{
+    if(dpd_main.file4_trace_mode == 0) return;
+    dpd_main.file4_trace_stats.back().bytes_read += bytes;
+}
+
+/* file4_cache_del_trace(): Deletes the unlocked cache entry whose next
+** access is farthest in the future.  Entries not in the trace, or whose
+** predicted access has already passed, go first.  Falls back to LRU
+** while the first iteration is being recorded.
+**
+** Returns 1 if there is no cache or all entries are locked.
+*/
+int DPD::file4_cache_del_trace(void)
+{
+    int dpdnum;
+    long int now, next_use, victim_use=0;
+    dpdfile4 File;
+    dpd_file4_cache_entry *this_entry, *victim;
+
+    if(dpd_main.file4_trace_mode != 2) return file4_cache_del_lru();
+
+    now = dpd_main.file4_trace_base + dpd_main.file4_trace_pos;
+
+    victim = NULL;
+    for(this_entry = dpd_main.file4_cache; this_entry != NULL; this_entry = this_entry->next) {
+        if(this_entry->lock) continue;
+        next_use = (this_entry->next_use < now) ? LONG_MAX : this_entry->next_use;
+        if(victim == NULL || next_use > victim_use ||
+                (next_use == victim_use && this_entry->access < victim->access)) {
+            victim = this_entry;
+            victim_use = next_use;
+        }
+    }
+
+    if(victim == NULL) return 1;
+
+    dpd_main.file4_cache_lru_del++;
+
+    dpdnum = dpd_default;
+    dpd_set_default(victim->dpdnum);
+    dpd_main.file4_trace_busy++;
+
+    file4_init(&File, victim->filenum, victim->irrep, victim->pqnum, victim->rsnum, victim->label);
+    file4_cache_del(&File);
+    file4_close(&File);
+
+    dpd_main.file4_trace_busy--;
+    dpd_set_default(dpdnum);
+
+    return 0;
+}
+
+void DPD::file4_cache_trace_print(FILE *outfile)
+{
+    int i;
+    long int accesses;
+    dpd_file4_cache_stats *stats;
+
+    if(dpd_main.file4_trace_stats.empty()) return;
+
+    fprintf(outfile, "\n\tDPD File4 Cache Statistics (trace-driven, %ld accesses in trace):\n\n",
+            (long int) dpd_main.file4_trace.size());
+    fprintf(outfile, "\t Iter      Hits    Misses   Hit Rate    Read (MB)\n");
+    fprintf(outfile, "\t ----   -------   -------   --------   ----------\n");
+    for(i=0; i < (int) dpd_main.file4_trace_stats.size(); i++) {
+        stats = &(dpd_main.file4_trace_stats[i]);
+        accesses = stats->hits + stats->misses;
+        fprintf(outfile, "\t %4d   %7ld   %7ld   %7.1f%%   %10.1f%s\n", i+1, stats->hits, stats->misses,
+                accesses ? 100.0*stats->hits/accesses : 0.0, stats->bytes_read/1e6,
+                i ? "" : "  (recorded)");
+    }
+    fflush(outfile);
+}
+
+}
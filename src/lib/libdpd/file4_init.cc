@@ -113,6 +113,9 @@ int DPD::file4_init(dpdfile4 *File, int filenum, int irrep, int pqnum,
 
         /* Make sure this cache entry can't be deleted until we're done */
         file4_cache_lock(File);
+
+        /* Record or follow the access for the trace-driven cache */
+        file4_cache_trace_access(File, this_entry != NULL);
     }
 
     return 0;
@@ -52,9 +52,11 @@ int DPD::file4_mat_irrep_rd(dpdfile4 *File, int irrep)
     coltot = File->params->coltot[irrep^my_irrep];
     size = ((long) rowtot) * ((long) coltot);
 
-    if(rowtot && coltot)
+    if(rowtot && coltot) {
         psio_read(File->filenum, File->label, (char *) File->matrix[irrep][0],
                 size*((long) sizeof(double)), irrep_ptr, &next_address);
+        file4_cache_trace_read(size*((long) sizeof(double)));
+    }
 
 #ifdef DPD_TIMER
     timer_off("file4_rd");
@@ -59,9 +59,11 @@ int DPD::file4_mat_irrep_rd_block(dpdfile4 *File, int irrep, int start_pq,
         irrep_ptr = psio_get_address(irrep_ptr, start_pq*coltot*sizeof(double));
     }
 
-    if(rowtot && coltot)
+    if(rowtot && coltot) {
         psio_read(File->filenum, File->label, (char *) File->matrix[irrep][0],
                 size * ((long) sizeof(double)), irrep_ptr, &next_address);
+        file4_cache_trace_read(size * ((long) sizeof(double)));
+    }
 
     return 0;
 
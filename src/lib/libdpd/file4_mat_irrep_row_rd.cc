@@ -59,9 +59,11 @@ int DPD::file4_mat_irrep_row_rd(dpdfile4 *File, int irrep, int row)
         row_ptr = psio_get_address(row_ptr, row*coltot*sizeof(double));
     }
 
-    if(coltot)
+    if(coltot) {
         psio_read(File->filenum, File->label, (char *) File->matrix[irrep][0],
                 coltot*sizeof(double), row_ptr, &next_address);
+        file4_cache_trace_read(coltot*sizeof(double));
+    }
 
 #ifdef DPD_TIMER
     timer_off("f4_rowrd");
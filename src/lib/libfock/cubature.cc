@@ -25,12 +25,16 @@
 #include "gridblocker.h"
 #include <libciomr/libciomr.h>
 #include <libqt/qt.h>
+#include <libpsio/psio.hpp>
+#include <psifiles.h>
 
 #include <vector>
 #include <string>
 #include <sstream>
 #include <cstdio>
 #include <limits>
+#include <algorithm>
+#include <stdint.h>
 #include <ctype.h>
 
 using namespace boost;
@@ -3516,10 +3520,14 @@ void MolecularGrid::buildGridFromOptions(MolecularGridOptions const& opt)
     RadialPruneMgr prune(opt);
     NuclearWeightMgr nuc(molecule_, opt.nucscheme);
 
+    // Owning atom of each point in grid
+    std::vector<int> owner;
+    std::vector<double> stratmannCutoffs(molecule_->natom());
+
     // Iterate over atoms
     for (int A = 0; A < molecule_->natom(); A++) {
         int Z = molecule_->true_atomic_number(A);
-        double stratmannCutoff = nuc.GetStratmannCutoff(A);
+        stratmannCutoffs[A] = nuc.GetStratmannCutoff(A);
 
         if (opt.namedGrid == -1) { // Not using a named grid
             double r[opt.nradpts];
@@ -3531,11 +3539,8 @@ void MolecularGrid::buildGridFromOptions(MolecularGridOptions const& opt)
                 const MassPoint *anggrid = LebedevGridMgr::findGridByNPoints(numAngPts);
                 for (int j = 0; j < numAngPts; j++) {
                     MassPoint mp = { r[i] * anggrid[j].x, r[i]*anggrid[j].y, r[i]*anggrid[j].z, wr[i]*anggrid[j].w };
-                    mp = std_orientation.MoveIntoPosition(mp, A);
-                    mp.w *= nuc.computeNuclearWeight(mp, A, stratmannCutoff);
-                    if (mp.w != 0) // Skip points with weight zero
-                        grid.push_back(mp);
-                    assert(!isnan(mp.w));
+                    grid.push_back(std_orientation.MoveIntoPosition(mp, A));
+                    owner.push_back(A);
                 }
             }
         } else {
@@ -3544,25 +3549,38 @@ void MolecularGrid::buildGridFromOptions(MolecularGridOptions const& opt)
             const MassPoint *sg = (opt.namedGrid == 0) ? StandardGridMgr::GetSG0grid(Z) : StandardGridMgr::GetSG1grid(Z);
 
             for (int i = 0; i < npts; i++) {
-                MassPoint mp = std_orientation.MoveIntoPosition(sg[i], A);
-                mp.w *= nuc.computeNuclearWeight(mp, A, stratmannCutoff);
-                if (mp.w != 0) // Skip points with weight zero
-                    grid.push_back(mp);
-                assert(!isnan(mp.w));
+                grid.push_back(std_orientation.MoveIntoPosition(sg[i], A));
+                owner.push_back(A);
             }
         }
     }
 
-    npoints_ = grid.size();
+    // The nuclear weights are the O(natom^2) part of grid setup, and independent per point
+    long int ngrid = grid.size();
+    #pragma omp parallel for schedule(dynamic,1024)
+    for (long int P = 0; P < ngrid; P++) {
+        int A = owner[P];
+        grid[P].w *= nuc.computeNuclearWeight(grid[P], A, stratmannCutoffs[A]);
+        assert(!isnan(grid[P].w));
+    }
+
+    // Skip points with weight zero
+    npoints_ = 0;
+    for (long int P = 0; P < ngrid; P++) {
+        if (grid[P].w != 0) npoints_++;
+    }
     x_ = new double[npoints_];
     y_ = new double[npoints_];
     z_ = new double[npoints_];
     w_ = new double[npoints_];
-    for (int i = 0; i < npoints_; i++) {
-        x_[i] = grid[i].x;
-        y_[i] = grid[i].y;
-        z_[i] = grid[i].z;
-        w_[i] = grid[i].w;
+    int index = 0;
+    for (long int P = 0; P < ngrid; P++) {
+        if (grid[P].w == 0) continue;
+        x_[index] = grid[P].x;
+        y_[index] = grid[P].y;
+        z_[index] = grid[P].z;
+        w_[index] = grid[P].w;
+        index++;
     }
 }
 
@@ -3857,15 +3875,28 @@ void DFTGrid::buildGridFromOptions()
         throw PSIEXCEPTION("Invalid number of spherical points (not a Lebedev number)");
     }
 
-    MolecularGrid::buildGridFromOptions(opt);
-
     // Blocking/sieving info
     int max_points = options_.get_int("DFT_BLOCK_MAX_POINTS");
     int min_points = options_.get_int("DFT_BLOCK_MIN_POINTS");
     double max_radius = options_.get_double("DFT_BLOCK_MAX_RADIUS");
     double epsilon = options_.get_double("DFT_BASIS_TOLERANCE");
     boost::shared_ptr<BasisExtents> extents(new BasisExtents(primary_, epsilon));
+
+    // Reuse the blocked grid of an identical earlier setup, if cached
+    bool cache = options_.get_bool("DFT_GRID_CACHE");
+    std::string key;
+    if (cache) {
+        key = cache_key(opt, primary_, max_points, min_points, max_radius, epsilon);
+        if (load_grid(key, extents)) {
+            MolecularGrid::options_ = opt;
+            return;
+        }
+    }
+
+    MolecularGrid::buildGridFromOptions(opt);
     postProcess(extents, max_points, min_points, max_radius);
+
+    if (cache) save_grid(key);
 }
 
 
@@ -4095,6 +4126,36 @@ void PseudospectralGrid::buildGridFromOptions()
     postProcess(extents, max_points, min_points, max_radius);
 }
 
+// Build BlockOPoints over consecutive runs of points. The significant-function
+// search in each BlockOPoints is independent, so the blocks are built in parallel.
+static void build_blocks(const std::vector<int>& sizes, double* x, double* y, double* z, double* w,
+    boost::shared_ptr<BasisExtents> extents, std::vector<boost::shared_ptr<BlockOPoints> >& blocks)
+{
+    std::vector<int> offsets(sizes.size(), 0);
+    for (size_t A = 1; A < sizes.size(); A++) {
+        offsets[A] = offsets[A-1] + sizes[A-1];
+    }
+
+    size_t nstart = blocks.size();
+    blocks.resize(nstart + sizes.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long int A = 0; A < (long int) sizes.size(); A++) {
+        int off = offsets[A];
+        blocks[nstart + A] = boost::shared_ptr<BlockOPoints>(new BlockOPoints(sizes[A],&x[off],&y[off],&z[off],&w[off],extents));
+    }
+}
+
+// Simple FNV-1a hash, for the grid cache keys
+static void hash_bytes(unsigned long int& hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211UL;
+    }
+}
+
 MolecularGrid::MolecularGrid(boost::shared_ptr<Molecule> molecule) :
     molecule_(molecule), npoints_(0), max_points_(0), max_functions_(0), debug_(0)
 {
@@ -4120,6 +4181,10 @@ void MolecularGrid::block(int max_points, int min_points, double max_radius)
         blocker = boost::shared_ptr<GridBlocker>(new NaiveGridBlocker(npoints_,x_,y_,z_,w_,max_points,min_points,max_radius,extents_));
     } else if (options_.get_str("DFT_BLOCK_SCHEME") == "OCTREE") {
         blocker = boost::shared_ptr<GridBlocker>(new OctreeGridBlocker(npoints_,x_,y_,z_,w_,max_points,min_points,max_radius,extents_));
+    } else if (options_.get_str("DFT_BLOCK_SCHEME") == "HILBERT") {
+        blocker = boost::shared_ptr<GridBlocker>(new HilbertGridBlocker(npoints_,x_,y_,z_,w_,max_points,min_points,max_radius,extents_));
+    } else {
+        throw PSIEXCEPTION("MolecularGrid: Unknown DFT_BLOCK_SCHEME");
     }
 
     blocker->set_print(options_.get_int("PRINT"));
@@ -4148,6 +4213,116 @@ void MolecularGrid::block(int max_points, int min_points, double max_radius)
     }
 }
 
+std::string MolecularGrid::cache_key(MolecularGridOptions const& opt, boost::shared_ptr<BasisSet> primary,
+    int max_points, int min_points, double max_radius, double epsilon) const
+{
+    unsigned long int hash = 14695981039346656037UL;
+
+    // Geometry
+    int natom = molecule_->natom();
+    hash_bytes(hash, &natom, sizeof(int));
+    for (int A = 0; A < natom; A++) {
+        int Z = molecule_->true_atomic_number(A);
+        double xyz[3] = {molecule_->x(A), molecule_->y(A), molecule_->z(A)};
+        hash_bytes(hash, &Z, sizeof(int));
+        hash_bytes(hash, xyz, 3 * sizeof(double));
+    }
+
+    // Quadrature (field by field, the struct has padding)
+    hash_bytes(hash, &opt.bs_radius_alpha, sizeof(double));
+    hash_bytes(hash, &opt.pruning_alpha, sizeof(double));
+    hash_bytes(hash, &opt.radscheme, sizeof(short));
+    hash_bytes(hash, &opt.prunescheme, sizeof(short));
+    hash_bytes(hash, &opt.nucscheme, sizeof(short));
+    hash_bytes(hash, &opt.namedGrid, sizeof(short));
+    hash_bytes(hash, &opt.nradpts, sizeof(int));
+    hash_bytes(hash, &opt.nangpts, sizeof(int));
+
+    // Basis, through the extents
+    for (int P = 0; P < primary->nshell(); P++) {
+        const GaussianShell& shell = primary->shell(P);
+        int am = shell.am();
+        hash_bytes(hash, &am, sizeof(int));
+        hash_bytes(hash, &shell.exps()[0], shell.nprimitive() * sizeof(double));
+        hash_bytes(hash, &shell.coefs()[0], shell.nprimitive() * sizeof(double));
+    }
+
+    // Blocking
+    std::string scheme = Process::environment.options.get_str("DFT_BLOCK_SCHEME");
+    hash_bytes(hash, scheme.c_str(), scheme.size());
+    hash_bytes(hash, &max_points, sizeof(int));
+    hash_bytes(hash, &min_points, sizeof(int));
+    hash_bytes(hash, &max_radius, sizeof(double));
+    hash_bytes(hash, &epsilon, sizeof(double));
+
+    char key[32];
+    sprintf(key, "Grid %016lx", hash);
+    return std::string(key);
+}
+bool MolecularGrid::load_grid(const std::string& key, boost::shared_ptr<BasisExtents> extents)
+{
+    boost::shared_ptr<PSIO> psio = PSIO::shared_object();
+    psio->open(PSIF_DFT_GRID, PSIO_OPEN_OLD);
+
+    std::string info_key = key + " Info";
+    if (psio->tocscan(PSIF_DFT_GRID, info_key.c_str()) == NULL) {
+        psio->close(PSIF_DFT_GRID, 1);
+        return false;
+    }
+
+    int info[2];
+    psio->read_entry(PSIF_DFT_GRID, info_key.c_str(), (char*) info, 2 * sizeof(int));
+    npoints_ = info[0];
+    int nblocks = info[1];
+
+    std::vector<int> sizes(nblocks);
+    x_ = new double[npoints_];
+    y_ = new double[npoints_];
+    z_ = new double[npoints_];
+    w_ = new double[npoints_];
+    if (nblocks) psio->read_entry(PSIF_DFT_GRID, (key + " Sizes").c_str(), (char*) &sizes[0], nblocks * sizeof(int));
+    psio->read_entry(PSIF_DFT_GRID, (key + " X").c_str(), (char*) x_, npoints_ * sizeof(double));
+    psio->read_entry(PSIF_DFT_GRID, (key + " Y").c_str(), (char*) y_, npoints_ * sizeof(double));
+    psio->read_entry(PSIF_DFT_GRID, (key + " Z").c_str(), (char*) z_, npoints_ * sizeof(double));
+    psio->read_entry(PSIF_DFT_GRID, (key + " W").c_str(), (char*) w_, npoints_ * sizeof(double));
+    psio->close(PSIF_DFT_GRID, 1);
+
+    extents_ = extents;
+    primary_ = extents_->basis();
+
+    blocks_.clear();
+    build_blocks(sizes, x_, y_, z_, w_, extents_, blocks_);
+
+    max_points_ = 0;
+    max_functions_ = 0;
+    for (size_t A = 0; A < blocks_.size(); A++) {
+        max_points_ = (max_points_ > blocks_[A]->npoints() ? max_points_ : blocks_[A]->npoints());
+        int nlocal = blocks_[A]->functions_local_to_global().size();
+        max_functions_ = (max_functions_ > nlocal ? max_functions_ : nlocal);
+    }
+
+    return true;
+}
+void MolecularGrid::save_grid(const std::string& key) const
+{
+    int nblocks = blocks_.size();
+    int info[2] = {npoints_, nblocks};
+    std::vector<int> sizes(nblocks);
+    for (int A = 0; A < nblocks; A++) {
+        sizes[A] = blocks_[A]->npoints();
+    }
+
+    boost::shared_ptr<PSIO> psio = PSIO::shared_object();
+    psio->open(PSIF_DFT_GRID, PSIO_OPEN_OLD);
+    // Data first, so an interrupted write is never found
+    if (nblocks) psio->write_entry(PSIF_DFT_GRID, (key + " Sizes").c_str(), (char*) &sizes[0], nblocks * sizeof(int));
+    psio->write_entry(PSIF_DFT_GRID, (key + " X").c_str(), (char*) x_, npoints_ * sizeof(double));
+    psio->write_entry(PSIF_DFT_GRID, (key + " Y").c_str(), (char*) y_, npoints_ * sizeof(double));
+    psio->write_entry(PSIF_DFT_GRID, (key + " Z").c_str(), (char*) z_, npoints_ * sizeof(double));
+    psio->write_entry(PSIF_DFT_GRID, (key + " W").c_str(), (char*) w_, npoints_ * sizeof(double));
+    psio->write_entry(PSIF_DFT_GRID, (key + " Info").c_str(), (char*) info, 2 * sizeof(int));
+    psio->close(PSIF_DFT_GRID, 1);
+}
 void MolecularGrid::remove_distant_points(double Rmax)
 {
     if (Rmax == std::numeric_limits<double>::max())
@@ -4211,6 +4386,16 @@ void MolecularGrid::print(FILE* out, int print) const
     fprintf(out,"    Total Blocks     = %14zu\n", blocks_.size());
     fprintf(out,"    Max Points       = %14d\n", max_points_);
     fprintf(out,"    Max Functions    = %14d\n", max_functions_);
+    if (blocks_.size()) {
+        double max_cost = 0.0;
+        double sum_cost = 0.0;
+        for (size_t A = 0; A < blocks_.size(); A++) {
+            double cost = blocks_[A]->cost();
+            max_cost = (max_cost > cost ? max_cost : cost);
+            sum_cost += cost;
+        }
+        fprintf(out,"    Cost Imbalance   = %14.3f\n", max_cost * blocks_.size() / sum_cost);
+    }
     fprintf(out,"\n");
 }
 
@@ -4503,4 +4688,177 @@ void OctreeGridBlocker::block()
     }
 }
 
+// Hilbert index of a point on a 2^bits grid (Skilling, AIP Conf. Proc. 707, 381 (2004))
+static uint64_t hilbert_index(unsigned int X[3], int bits)
+{
+    unsigned int M = 1U << (bits - 1);
+
+    // Inverse undo
+    for (unsigned int Q = M; Q > 1; Q >>= 1) {
+        unsigned int P = Q - 1;
+        for (int i = 0; i < 3; i++) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            } else {
+                unsigned int t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode
+    for (int i = 1; i < 3; i++) {
+        X[i] ^= X[i-1];
+    }
+    unsigned int t = 0;
+    for (unsigned int Q = M; Q > 1; Q >>= 1) {
+        if (X[2] & Q) t ^= Q - 1;
+    }
+    for (int i = 0; i < 3; i++) {
+        X[i] ^= t;
+    }
+
+    // Interleave the transposed index
+    uint64_t index = 0;
+    for (int b = bits - 1; b >= 0; b--) {
+        for (int i = 0; i < 3; i++) {
+            index = (index << 1) | ((X[i] >> b) & 1U);
+        }
+    }
+    return index;
+}
+HilbertGridBlocker::HilbertGridBlocker(const int npoints_ref, double const* x_ref, double const* y_ref, double const* z_ref,
+    double const* w_ref, const int max_points, const int min_points, const double max_radius,
+    boost::shared_ptr<BasisExtents> extents) :
+    GridBlocker(npoints_ref,x_ref,y_ref,z_ref,w_ref,max_points,min_points,max_radius,extents)
+{
+}
+HilbertGridBlocker::~HilbertGridBlocker()
+{
+}
+void HilbertGridBlocker::block()
+{
+    npoints_ = npoints_ref_;
+    max_points_ = 0;
+    max_functions_ = 0;
+    blocks_.clear();
+
+    x_ = new double[npoints_];
+    y_ = new double[npoints_];
+    z_ = new double[npoints_];
+    w_ = new double[npoints_];
+
+    if (npoints_ == 0) return;
+
+    // => Sort the points along the Hilbert curve <= //
+
+    double lo[3] = {x_ref_[0], y_ref_[0], z_ref_[0]};
+    double hi[3] = {x_ref_[0], y_ref_[0], z_ref_[0]};
+    for (int Q = 0; Q < npoints_; Q++) {
+        lo[0] = std::min(lo[0], x_ref_[Q]); hi[0] = std::max(hi[0], x_ref_[Q]);
+        lo[1] = std::min(lo[1], y_ref_[Q]); hi[1] = std::max(hi[1], y_ref_[Q]);
+        lo[2] = std::min(lo[2], z_ref_[Q]); hi[2] = std::max(hi[2], z_ref_[Q]);
+    }
+    double span = std::max(hi[0] - lo[0], std::max(hi[1] - lo[1], hi[2] - lo[2]));
+
+    // 20 bits per axis, 60-bit keys
+    const int bits = 20;
+    double scale = (span > 0.0 ? ((1U << bits) - 1) / span : 0.0);
+
+    std::vector<std::pair<uint64_t, int> > order(npoints_);
+    #pragma omp parallel for schedule(static)
+    for (int Q = 0; Q < npoints_; Q++) {
+        unsigned int X[3];
+        X[0] = (unsigned int) ((x_ref_[Q] - lo[0]) * scale);
+        X[1] = (unsigned int) ((y_ref_[Q] - lo[1]) * scale);
+        X[2] = (unsigned int) ((z_ref_[Q] - lo[2]) * scale);
+        order[Q] = std::make_pair(hilbert_index(X, bits), Q);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (int Q = 0; Q < npoints_; Q++) {
+        int delta = order[Q].second;
+        x_[Q] = x_ref_[delta];
+        y_[Q] = y_ref_[delta];
+        z_[Q] = z_ref_[delta];
+        w_[Q] = w_ref_[delta];
+    }
+
+    // => Significant shells of short curve segments <= //
+
+    int seg_points = std::max(1, tol_max_points_ / 16);
+    std::vector<int> seg_sizes;
+    for (int Q = 0; Q < npoints_; Q += seg_points) {
+        seg_sizes.push_back(std::min(seg_points, npoints_ - Q));
+    }
+    std::vector<boost::shared_ptr<BlockOPoints> > segments;
+    build_blocks(seg_sizes, x_, y_, z_, w_, extents_, segments);
+
+    // Target cost: a full block at the point-weighted mean function count
+    double mean_functions = 0.0;
+    for (size_t S = 0; S < segments.size(); S++) {
+        mean_functions += segments[S]->cost();
+    }
+    mean_functions /= npoints_;
+    double target = tol_max_points_ * std::max(mean_functions, 1.0);
+
+    // => Merge consecutive segments up to the target cost <= //
+
+    boost::shared_ptr<BasisSet> basis = extents_->basis();
+    std::vector<char> significant(basis->nshell(), 0);
+    std::vector<int> block_shells;
+    std::vector<int> block_sizes;
+    int block_points = 0;
+    int block_functions = 0;
+
+    for (size_t S = 0; S < segments.size(); S++) {
+        const std::vector<int>& shells = segments[S]->shells_local_to_global();
+        int seg_npoints = segments[S]->npoints();
+
+        int new_functions = 0;
+        for (size_t P = 0; P < shells.size(); P++) {
+            if (!significant[shells[P]]) new_functions += basis->shell(shells[P]).nfunction();
+        }
+
+        double new_cost = (double) (block_points + seg_npoints) * (block_functions + new_functions);
+        bool full = (block_points + seg_npoints > tol_max_points_) ||
+                    (block_points >= tol_min_points_ && new_cost > target);
+
+        if (block_points && full) {
+            block_sizes.push_back(block_points);
+            for (size_t P = 0; P < block_shells.size(); P++) {
+                significant[block_shells[P]] = 0;
+            }
+            block_shells.clear();
+            block_points = 0;
+            block_functions = 0;
+        }
+
+        for (size_t P = 0; P < shells.size(); P++) {
+            if (!significant[shells[P]]) {
+                significant[shells[P]] = 1;
+                block_shells.push_back(shells[P]);
+                block_functions += basis->shell(shells[P]).nfunction();
+            }
+        }
+        block_points += seg_npoints;
+    }
+    if (block_points) block_sizes.push_back(block_points);
+
+    build_blocks(block_sizes, x_, y_, z_, w_, extents_, blocks_);
+
+    for (size_t A = 0; A < blocks_.size(); A++) {
+        max_points_ = std::max(max_points_, blocks_[A]->npoints());
+        max_functions_ = std::max(max_functions_, (int) blocks_[A]->functions_local_to_global().size());
+    }
+
+    if (print_ > 1) {
+        fprintf(outfile, "  ==> Hilbert Grid Blocking <==\n\n");
+        fprintf(outfile, "    Segments    = %14zu\n", segments.size());
+        fprintf(outfile, "    Blocks      = %14zu\n", blocks_.size());
+        fprintf(outfile, "    Target Cost = %14.3E\n\n", target);
+    }
+}
+
 }
@@ -87,6 +87,13 @@ public:
 protected:
     /// A copy of the options used, for printing purposes.
     MolecularGridOptions options_;
+
+    /// Key of this grid in the PSIF_DFT_GRID cache, a hash of everything the blocked grid depends on
+    std::string cache_key(MolecularGridOptions const& opt, boost::shared_ptr<BasisSet> primary, int max_points, int min_points, double max_radius, double epsilon) const;
+    /// Read the blocked grid from the cache, if present
+    bool load_grid(const std::string& key, boost::shared_ptr<BasisExtents> extents);
+    /// Write the blocked grid to the cache
+    void save_grid(const std::string& key) const;
 public:
     MolecularGrid(boost::shared_ptr<Molecule> molecule);
     virtual ~MolecularGrid();   
@@ -224,6 +231,8 @@ public:
     const std::vector<int>& shells_local_to_global() const { return shells_local_to_global_; }
     /// Relevant functions, local -> global 
     const std::vector<int>& functions_local_to_global() const { return functions_local_to_global_; }
+    /// Estimated cost of this block (points x significant functions), for scheduling
+    double cost() const { return (double) npoints_ * functions_local_to_global_.size(); }
 };
 
 class BasisExtents {
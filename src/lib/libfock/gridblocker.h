@@ -126,6 +126,25 @@ public:
     virtual void block();
 };
 
+/**
+ * Space-filling curve blocking
+ *
+ * Points are sorted along a 3D Hilbert curve, cut into short segments,
+ * and consecutive segments are merged while the estimated block cost
+ * (points x significant functions) stays near a common target.
+ */
+class HilbertGridBlocker : public GridBlocker {
+
+public:
+
+    HilbertGridBlocker(const int npoints_ref, double const* x_ref, double const* y_ref, double const* z_ref,
+        double const* w_ref, const int max_points, const int min_points, const double max_radius,
+        boost::shared_ptr<BasisExtents> extents);
+    virtual ~HilbertGridBlocker();
+
+    virtual void block();
+};
+
 }
 #endif
 
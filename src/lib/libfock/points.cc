@@ -22,6 +22,9 @@
 
 #include <libmints/mints.h>
 #include <libqt/qt.h>
+#include <libpsio/psio.hpp>
+#include <libpsio/psio.h>
+#include <psifiles.h>
 #include <cmath>
 #include "points.h"
 #include "cubature.h"
@@ -444,13 +447,110 @@ SharedVector PointFunctions::point_value(const std::string& key)
 }
 
 BasisFunctions::BasisFunctions(boost::shared_ptr<BasisSet> primary, int max_points, int max_functions) :
-    primary_(primary), max_points_(max_points), max_functions_(max_functions)
+    primary_(primary), max_points_(max_points), max_functions_(max_functions),
+    cache_max_core_(0), cache_disk_(false), cache_core_(0), cache_disk_size_(0)
 {
     build_spherical();
     set_deriv(0);
 }
 BasisFunctions::~BasisFunctions()
 {
+    clear_cache();
+}
+void BasisFunctions::set_collocation_cache(size_t max_core, bool use_disk)
+{
+    clear_cache();
+    cache_max_core_ = max_core;
+    cache_disk_ = use_disk;
+}
+void BasisFunctions::clear_cache()
+{
+    cache_.clear();
+    cache_core_ = 0;
+    if (cache_psio_) {
+        cache_psio_->close(PSIF_DFT_COLLOCATION, 0);
+        cache_psio_.reset();
+    }
+    cache_disk_size_ = 0;
+}
+bool BasisFunctions::load_functions(boost::shared_ptr<BlockOPoints> block)
+{
+    std::map<const BlockOPoints*, CachedBlock>::iterator it = cache_.find(block.get());
+    if (it == cache_.end()) return false;
+
+    CachedBlock& entry = (*it).second;
+    int npoints = block->npoints();
+    int nlocal = block->functions_local_to_global().size();
+    size_t block_size = npoints * (size_t) nlocal;
+
+    std::vector<double> disk_values;
+    double* values;
+    if (entry.on_disk) {
+        disk_values.resize(block_size * basis_values_.size());
+        psio_address addr = psio_get_address(PSIO_ZERO, entry.disk_offset);
+        cache_psio_->read(PSIF_DFT_COLLOCATION, "PHI", (char*) &disk_values[0],
+            disk_values.size() * sizeof(double), addr, &addr);
+        values = &disk_values[0];
+    } else {
+        values = &entry.values[0];
+    }
+
+    for (std::map<std::string, SharedMatrix >::iterator key = basis_values_.begin();
+        key != basis_values_.end(); ++key) {
+        double** phip = (*key).second->pointer();
+        for (int P = 0; P < npoints; P++) {
+            ::memcpy(static_cast<void*>(phip[P]), static_cast<void*>(&values[P * (size_t) nlocal]), nlocal * sizeof(double));
+        }
+        values += block_size;
+    }
+
+    return true;
+}
+void BasisFunctions::store_functions(boost::shared_ptr<BlockOPoints> block)
+{
+    int npoints = block->npoints();
+    int nlocal = block->functions_local_to_global().size();
+    size_t block_size = npoints * (size_t) nlocal;
+    size_t total_size = block_size * basis_values_.size();
+
+    bool in_core = (cache_core_ + total_size <= cache_max_core_);
+    if (!in_core && !cache_disk_) return;
+
+    CachedBlock& entry = cache_[block.get()];
+    entry.on_disk = !in_core;
+    entry.disk_offset = cache_disk_size_;
+
+    std::vector<double> disk_values;
+    double* values;
+    if (in_core) {
+        entry.values.resize(total_size);
+        values = &entry.values[0];
+        cache_core_ += total_size;
+    } else {
+        disk_values.resize(total_size);
+        values = &disk_values[0];
+    }
+
+    double* target = values;
+    for (std::map<std::string, SharedMatrix >::iterator key = basis_values_.begin();
+        key != basis_values_.end(); ++key) {
+        double** phip = (*key).second->pointer();
+        for (int P = 0; P < npoints; P++) {
+            ::memcpy(static_cast<void*>(&target[P * (size_t) nlocal]), static_cast<void*>(phip[P]), nlocal * sizeof(double));
+        }
+        target += block_size;
+    }
+
+    if (!in_core) {
+        if (!cache_psio_) {
+            cache_psio_ = PSIO::shared_object();
+            cache_psio_->open(PSIF_DFT_COLLOCATION, PSIO_OPEN_NEW);
+        }
+        psio_address addr = psio_get_address(PSIO_ZERO, entry.disk_offset);
+        cache_psio_->write(PSIF_DFT_COLLOCATION, "PHI", (char*) values,
+            total_size * sizeof(double), addr, &addr);
+        cache_disk_size_ += total_size * sizeof(double);
+    }
 }
 void BasisFunctions::build_spherical()
 {
@@ -477,6 +577,9 @@ void BasisFunctions::build_spherical()
 }
 void BasisFunctions::allocate()
 {
+    // Cached blocks no longer match the registers
+    clear_cache();
+
     basis_values_.clear();
     basis_temps_.clear();
 
@@ -520,6 +623,18 @@ SharedMatrix BasisFunctions::basis_value(const std::string& key)
     return basis_values_[key];
 }
 void BasisFunctions::compute_functions(boost::shared_ptr<BlockOPoints> block)
+{
+    if (cache_max_core_ == 0 && !cache_disk_) {
+        evaluate_functions(block);
+        return;
+    }
+
+    if (load_functions(block)) return;
+
+    evaluate_functions(block);
+    store_functions(block);
+}
+void BasisFunctions::evaluate_functions(boost::shared_ptr<BlockOPoints> block)
 {
     int max_am = primary_->max_am();
     int max_cart = (max_am + 1) * (max_am + 2) / 2;
@@ -902,6 +1017,10 @@ void BasisFunctions::print(FILE* out, int print) const
             (*it).second->print();
         }
     }
+    if (cache_max_core_ || cache_disk_) {
+        fprintf(out, "\n    Collocation Cache: %zu blocks, %.1f MiB in core, %.1f MiB on disk\n",
+            cache_.size(), cache_core_ * sizeof(double) / 1048576.0, cache_disk_size_ / 1048576.0);
+    }
     fprintf(out,"\n\n");
 }
 
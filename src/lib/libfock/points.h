@@ -25,6 +25,7 @@
 
 #include <cstdio>
 #include <map>
+#include <vector>
 
 #include <libmints/typedefs.h>
 #include <boost/tuple/tuple.hpp>
@@ -61,10 +62,39 @@ protected:
     /// [L]: pure_index, cart_index, coef
     std::vector<std::vector<boost::tuple<int,int,double> > > spherical_transforms_;
 
+    // => Collocation cache <= //
+
+    /// Cached basis values of one block, npoints x nlocal per key, in core or on disk
+    struct CachedBlock {
+        bool on_disk;
+        size_t disk_offset;
+        std::vector<double> values;
+    };
+    /// Maximum number of doubles to cache in core (0 - no cache)
+    size_t cache_max_core_;
+    /// Spill blocks beyond cache_max_core_ to disk, or recompute them?
+    bool cache_disk_;
+    /// Doubles currently cached in core
+    size_t cache_core_;
+    /// Bytes currently cached on disk
+    size_t cache_disk_size_;
+    /// Cached blocks (the grid owns the blocks for the lifetime of this object)
+    std::map<const BlockOPoints*, CachedBlock> cache_;
+    /// PSIO object for the disk part of the cache
+    boost::shared_ptr<PSIO> cache_psio_;
+
     /// Setup spherical_transforms_
     void build_spherical();
     /// Allocate registers
     virtual void allocate();
+    /// Evaluate the basis values of a block into basis_values_
+    void evaluate_functions(boost::shared_ptr<BlockOPoints> block);
+    /// Copy the basis values of a block from the cache into basis_values_, if present
+    bool load_functions(boost::shared_ptr<BlockOPoints> block);
+    /// Copy the basis values of a block from basis_values_ into the cache
+    void store_functions(boost::shared_ptr<BlockOPoints> block);
+    /// Drop all cached blocks
+    void clear_cache();
 
 public:
     // => Constructors <= //
@@ -74,6 +104,7 @@ public:
 
     // => Computers <= //
 
+    /// Basis values of a block, from the collocation cache if enabled and present
     void compute_functions(boost::shared_ptr<BlockOPoints> block);
 
     // => Accessors <= //
@@ -92,6 +123,13 @@ public:
     void set_deriv(int deriv) { deriv_ = deriv; allocate(); }
     void set_max_functions(int max_functions) { max_functions_ = max_functions; allocate(); }
     void set_max_points(int max_points) { max_points_ = max_points; allocate(); }
+    /**
+     * Keep the basis values of each block between calls, for grids that are reused
+     * (e.g., across SCF iterations). Up to max_core doubles are held in core; the
+     * remaining blocks go to scratch if use_disk, or are recomputed otherwise.
+     * max_core = 0 disables the cache.
+     */
+    void set_collocation_cache(size_t max_core, bool use_disk);
 };
 
 class PointFunctions : public BasisFunctions {
@@ -354,6 +354,14 @@ void VBase::AO2USO()
     }    
     delete[] temp;
 }
+void VBase::set_collocation_cache()
+{
+    std::string cache = options_.get_str("DFT_COLLOCATION_CACHE");
+    if (cache == "NONE") return;
+
+    size_t max_core = options_.get_int("DFT_COLLOCATION_MEMORY") * 1048576L / sizeof(double);
+    properties_->set_collocation_cache(max_core, cache == "DISK");
+}
 void VBase::initialize()
 {
     timer_on("V: Grid");
@@ -408,6 +416,7 @@ void RV::initialize()
     int max_functions = grid_->max_functions(); 
     properties_ = boost::shared_ptr<PointFunctions>(new RKSFunctions(primary_,max_points,max_functions));
     properties_->set_ansatz(functional_->ansatz());
+    set_collocation_cache();
 }
 void RV::finalize()
 {
@@ -847,6 +856,7 @@ void UV::initialize()
     int max_functions = grid_->max_functions(); 
     properties_ = boost::shared_ptr<PointFunctions>(new UKSFunctions(primary_,max_points,max_functions));
     properties_->set_ansatz(functional_->ansatz());
+    set_collocation_cache();
 }
 void UV::finalize()
 {
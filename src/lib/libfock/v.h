@@ -99,6 +99,8 @@ protected:
     virtual void compute_V() = 0;
     /// Set things up
     void common_init();
+    /// Enable the basis function cache of properties_, if requested
+    void set_collocation_cache();
 public:
     VBase(boost::shared_ptr<SuperFunctional> functional,
         boost::shared_ptr<BasisSet> primary,
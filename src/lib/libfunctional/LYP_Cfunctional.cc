@@ -822,5 +822,202 @@ void LYP_CFunctional::compute_functional(const std::map<std::string,SharedVector
         }
     }
 }
+void LYP_CFunctional::compute_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha)
+{
+    // Parameter lookups are hoisted out of the point loop
+    const double A = parameters_["A"];
+    const double B = parameters_["B"];
+    const double C = parameters_["C"];
+    const double Dd = parameters_["Dd"];
+    const double CFext = parameters_["CFext"];
+
+    // Overall scale factor
+    const double scale = alpha_ * alpha;
+    const double cutoff = lsda_cutoff_;
+
+    // => Input variables <= //
+
+    const double* rho_ap = in[FunctionalPoints::RHO_A];
+    const double* rho_bp = in[FunctionalPoints::RHO_B];
+    const double* gamma_aap = in[FunctionalPoints::GAMMA_AA];
+    const double* gamma_abp = in[FunctionalPoints::GAMMA_AB];
+    const double* gamma_bbp = in[FunctionalPoints::GAMMA_BB];
+
+    // => Output variables <= //
+
+    double* v = out[FunctionalPoints::V];
+    double* v_rho_a = out[FunctionalPoints::V_RHO_A];
+    double* v_rho_b = out[FunctionalPoints::V_RHO_B];
+    double* v_gamma_aa = out[FunctionalPoints::V_GAMMA_AA];
+    double* v_gamma_ab = out[FunctionalPoints::V_GAMMA_AB];
+    double* v_gamma_bb = out[FunctionalPoints::V_GAMMA_BB];
+
+    // => Loop over points <= //
+
+    // LYP vanishes unless both spin densities are above the cutoff, so
+    // points below it are evaluated at a harmless dummy density and
+    // masked out, keeping the loop free of branches
+    for (int Q = 0; Q < npoints; Q++) {
+
+        bool on = (rho_ap[Q] >= cutoff) & (rho_bp[Q] >= cutoff);
+        double mask = (on ? 1.0 : 0.0);
+        double rho_a = (on ? rho_ap[Q] : 1.0);
+        double rho_b = (on ? rho_bp[Q] : 1.0);
+        double gamma_aa = (on ? gamma_aap[Q] : 0.0);
+        double gamma_ab = (on ? gamma_abp[Q] : 0.0);
+        double gamma_bb = (on ? gamma_bbp[Q] : 0.0);
+
+        // v
+        {
+            double t11709 = rho_a+rho_b;
+            double t11710 = 1.0/pow(t11709,1.0/3.0);
+            double t11711 = Dd*t11710;
+            double t11712 = t11711+1.0;
+            double t11713 = 1.0/t11712;
+            double t11714 = t11709*t11709;
+            double t11715 = t11714*(2.0/3.0);
+            double t11716 = gamma_ab*2.0;
+            double t11717 = gamma_aa+gamma_bb+t11716;
+            double t11718 = 1.0/t11709;
+            v[Q] += mask * scale * (A*rho_a*rho_b*t11713*t11718*-4.0-A*B*t11713*1.0/pow(t11709,1.1E1/3.0)*exp(-C*t11710)*(t11714*t11717*(-2.0/3.0)+gamma_aa*(t11715-rho_b*rho_b)+gamma_bb*(t11715-rho_a*rho_a)+rho_a*rho_b*((gamma_aa+gamma_bb)*(C*t11710*(1.0/1.8E1)+Dd*t11710*t11713*(1.0/1.8E1)-5.0/2.0)+CFext*(pow(rho_a,8.0/3.0)+pow(rho_b,8.0/3.0))-t11717*(C*t11710*(7.0/1.8E1)+Dd*t11710*t11713*(7.0/1.8E1)-4.7E1/1.8E1)-t11718*(gamma_aa*rho_a+gamma_bb*rho_b)*(C*t11710*(1.0/9.0)+Dd*t11710*t11713*(1.0/9.0)-1.1E1/9.0))));
+        }
+        
+        // v_rho_a
+        if (deriv >= 1) {
+            double t11720 = rho_a+rho_b;
+            double t11721 = 1.0/pow(t11720,1.0/3.0);
+            double t11722 = Dd*t11721;
+            double t11723 = t11722+1.0;
+            double t11724 = 1.0/t11723;
+            double t11725 = t11720*t11720;
+            double t11726 = t11725*(2.0/3.0);
+            double t11727 = gamma_ab*2.0;
+            double t11728 = gamma_aa+gamma_bb+t11727;
+            double t11729 = 1.0/t11720;
+            double t11756 = C*t11721;
+            double t11730 = exp(-t11756);
+            double t11731 = C*t11721*(7.0/1.8E1);
+            double t11732 = Dd*t11721*t11724*(7.0/1.8E1);
+            double t11733 = t11731+t11732-4.7E1/1.8E1;
+            double t11734 = t11733*t11728;
+            double t11735 = gamma_aa+gamma_bb;
+            double t11736 = C*t11721*(1.0/1.8E1);
+            double t11737 = Dd*t11721*t11724*(1.0/1.8E1);
+            double t11738 = t11736+t11737-5.0/2.0;
+            double t11739 = pow(rho_a,8.0/3.0);
+            double t11740 = pow(rho_b,8.0/3.0);
+            double t11741 = t11740+t11739;
+            double t11742 = gamma_aa*rho_a;
+            double t11743 = gamma_bb*rho_b;
+            double t11744 = t11742+t11743;
+            double t11745 = C*t11721*(1.0/9.0);
+            double t11746 = Dd*t11721*t11724*(1.0/9.0);
+            double t11747 = t11745+t11746-1.1E1/9.0;
+            double t11748 = t11744*t11729*t11747;
+            double t11764 = t11735*t11738;
+            double t11765 = CFext*t11741;
+            double t11749 = t11734-t11764-t11765+t11748;
+            double t11750 = rho_b*(4.0/3.0);
+            double t11751 = 1.0/pow(t11720,4.0/3.0);
+            double t11752 = 1.0/(t11723*t11723);
+            double t11753 = Dd*Dd;
+            double t11754 = 1.0/pow(t11720,5.0/3.0);
+            double t11755 = 1.0/(t11720*t11720);
+            double t11757 = rho_b*rho_b;
+            double t11758 = t11726-t11757;
+            double t11759 = gamma_aa*t11758;
+            double t11760 = rho_a*rho_a;
+            double t11761 = t11760-t11726;
+            double t11762 = gamma_bb*t11761;
+            double t11763 = t11725*t11728*(2.0/3.0);
+            double t11766 = rho_a*rho_b*t11749;
+            double t11767 = 1.0/(t11720*t11720*t11720*t11720*t11720);
+            v_rho_a[Q] += mask * scale * (A*rho_b*t11724*t11729*-4.0+A*rho_a*rho_b*t11724*t11755*4.0-A*Dd*rho_a*rho_b*1.0/pow(t11720,7.0/3.0)*t11752*(4.0/3.0)-A*B*1.0/pow(t11720,1.4E1/3.0)*t11730*t11724*(t11762+t11763+t11766-t11759)*(1.1E1/3.0)+A*B*1.0/pow(t11720,1.1E1/3.0)*t11730*t11724*(rho_b*t11749-gamma_aa*(rho_a*(4.0/3.0)+t11750)+gamma_bb*(rho_a*(2.0/3.0)-t11750)+t11728*(rho_a*2.0+rho_b*2.0)*(2.0/3.0)-rho_a*rho_b*(CFext*pow(rho_a,5.0/3.0)*(8.0/3.0)-t11735*(C*t11751*(1.0/5.4E1)+Dd*t11724*t11751*(1.0/5.4E1)-t11752*t11753*t11754*(1.0/5.4E1))+t11728*(C*t11751*(7.0/5.4E1)+Dd*t11724*t11751*(7.0/5.4E1)-t11752*t11753*t11754*(7.0/5.4E1))+t11744*t11729*(C*t11751*(1.0/2.7E1)+Dd*t11724*t11751*(1.0/2.7E1)-t11752*t11753*t11754*(1.0/2.7E1))-gamma_aa*t11729*t11747+t11744*t11755*t11747))+A*B*C*t11730*t11724*t11767*(t11762+t11763+t11766-t11759)*(1.0/3.0)+A*B*Dd*t11730*t11752*t11767*(t11762+t11763+t11766-t11759)*(1.0/3.0));
+        }
+        
+        // v_rho_b
+        if (deriv >= 1) {
+            double t11769 = rho_a+rho_b;
+            double t11770 = 1.0/pow(t11769,1.0/3.0);
+            double t11771 = Dd*t11770;
+            double t11772 = t11771+1.0;
+            double t11773 = 1.0/t11772;
+            double t11774 = t11769*t11769;
+            double t11775 = t11774*(2.0/3.0);
+            double t11776 = gamma_ab*2.0;
+            double t11777 = gamma_aa+gamma_bb+t11776;
+            double t11778 = 1.0/t11769;
+            double t11805 = C*t11770;
+            double t11779 = exp(-t11805);
+            double t11780 = C*t11770*(7.0/1.8E1);
+            double t11781 = Dd*t11770*t11773*(7.0/1.8E1);
+            double t11782 = t11780+t11781-4.7E1/1.8E1;
+            double t11783 = t11782*t11777;
+            double t11784 = gamma_aa+gamma_bb;
+            double t11785 = C*t11770*(1.0/1.8E1);
+            double t11786 = Dd*t11770*t11773*(1.0/1.8E1);
+            double t11787 = t11785+t11786-5.0/2.0;
+            double t11788 = pow(rho_a,8.0/3.0);
+            double t11789 = pow(rho_b,8.0/3.0);
+            double t11790 = t11788+t11789;
+            double t11791 = gamma_aa*rho_a;
+            double t11792 = gamma_bb*rho_b;
+            double t11793 = t11791+t11792;
+            double t11794 = C*t11770*(1.0/9.0);
+            double t11795 = Dd*t11770*t11773*(1.0/9.0);
+            double t11796 = t11794+t11795-1.1E1/9.0;
+            double t11797 = t11793*t11778*t11796;
+            double t11813 = t11784*t11787;
+            double t11814 = CFext*t11790;
+            double t11798 = -t11813-t11814+t11783+t11797;
+            double t11799 = rho_a*(4.0/3.0);
+            double t11800 = 1.0/pow(t11769,4.0/3.0);
+            double t11801 = 1.0/(t11772*t11772);
+            double t11802 = Dd*Dd;
+            double t11803 = 1.0/pow(t11769,5.0/3.0);
+            double t11804 = 1.0/(t11769*t11769);
+            double t11806 = rho_b*rho_b;
+            double t11807 = t11806-t11775;
+            double t11808 = gamma_aa*t11807;
+            double t11809 = rho_a*rho_a;
+            double t11810 = t11809-t11775;
+            double t11811 = gamma_bb*t11810;
+            double t11812 = t11774*t11777*(2.0/3.0);
+            double t11815 = rho_a*rho_b*t11798;
+            double t11816 = 1.0/(t11769*t11769*t11769*t11769*t11769);
+            v_rho_b[Q] += mask * scale * (A*rho_a*t11773*t11778*-4.0+A*rho_a*rho_b*t11804*t11773*4.0-A*Dd*rho_a*rho_b*t11801*1.0/pow(t11769,7.0/3.0)*(4.0/3.0)-A*B*t11773*1.0/pow(t11769,1.4E1/3.0)*t11779*(t11811+t11812+t11815+t11808)*(1.1E1/3.0)+A*B*t11773*1.0/pow(t11769,1.1E1/3.0)*t11779*(rho_a*t11798-gamma_bb*(rho_b*(4.0/3.0)+t11799)+gamma_aa*(rho_b*(2.0/3.0)-t11799)+t11777*(rho_a*2.0+rho_b*2.0)*(2.0/3.0)-rho_a*rho_b*(CFext*pow(rho_b,5.0/3.0)*(8.0/3.0)-t11784*(C*t11800*(1.0/5.4E1)+Dd*t11800*t11773*(1.0/5.4E1)-t11801*t11802*t11803*(1.0/5.4E1))+t11777*(C*t11800*(7.0/5.4E1)+Dd*t11800*t11773*(7.0/5.4E1)-t11801*t11802*t11803*(7.0/5.4E1))+t11793*t11778*(C*t11800*(1.0/2.7E1)+Dd*t11800*t11773*(1.0/2.7E1)-t11801*t11802*t11803*(1.0/2.7E1))-gamma_bb*t11778*t11796+t11804*t11793*t11796))+A*B*C*t11816*t11773*t11779*(t11811+t11812+t11815+t11808)*(1.0/3.0)+A*B*Dd*t11801*t11816*t11779*(t11811+t11812+t11815+t11808)*(1.0/3.0));
+        }
+        
+        // v_gamma_aa
+        if (deriv >= 1) {
+            double t11818 = rho_a+rho_b;
+            double t11819 = 1.0/pow(t11818,1.0/3.0);
+            double t11820 = Dd*t11819;
+            double t11821 = t11820+1.0;
+            double t11822 = 1.0/t11821;
+            v_gamma_aa[Q] += mask * scale * (A*B*t11822*1.0/pow(t11818,1.1E1/3.0)*exp(-C*t11819)*(rho_b*rho_b+rho_a*rho_b*(C*t11819*(1.0/3.0)+Dd*t11822*t11819*(1.0/3.0)+(rho_a*(C*t11819*(1.0/9.0)+Dd*t11822*t11819*(1.0/9.0)-1.1E1/9.0))/t11818-1.0/9.0)));
+        }
+        
+        // v_gamma_ab
+        if (deriv >= 1) {
+            double t11824 = rho_a+rho_b;
+            double t11825 = 1.0/pow(t11824,1.0/3.0);
+            double t11826 = Dd*t11825;
+            double t11827 = t11826+1.0;
+            double t11828 = 1.0/t11827;
+            v_gamma_ab[Q] += mask * scale * (A*B*1.0/pow(t11824,1.1E1/3.0)*t11828*exp(-C*t11825)*((t11824*t11824)*(4.0/3.0)+rho_a*rho_b*(C*t11825*(7.0/9.0)+Dd*t11825*t11828*(7.0/9.0)-4.7E1/9.0)));
+        }
+        
+        // v_gamma_bb
+        if (deriv >= 1) {
+            double t11830 = rho_a+rho_b;
+            double t11831 = 1.0/pow(t11830,1.0/3.0);
+            double t11832 = Dd*t11831;
+            double t11833 = t11832+1.0;
+            double t11834 = 1.0/t11833;
+            v_gamma_bb[Q] += mask * scale * (A*B*1.0/pow(t11830,1.1E1/3.0)*t11834*exp(-C*t11831)*(rho_a*rho_a+rho_a*rho_b*(C*t11831*(1.0/3.0)+Dd*t11831*t11834*(1.0/3.0)+(rho_b*(C*t11831*(1.0/9.0)+Dd*t11831*t11834*(1.0/9.0)-1.1E1/9.0))/t11830-1.0/9.0)));
+        }
+    }
+}
 
 }
@@ -39,6 +39,9 @@ public:
     virtual ~LYP_CFunctional(); 
     virtual void compute_functional(const std::map<std::string,SharedVector>& in, const std::map<std::string,SharedVector>& out, int npoints, int deriv, double alpha);
 
+    virtual bool has_kernel(int deriv) const { return deriv <= 1; }
+    virtual void compute_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha);
+
 };
 
 }
@@ -20,11 +20,33 @@
  *@END LICENSE
  */
 
+#include <libmints/vector.h>
 #include "functional.h"
 #include <psi4-dec.h>
 
 namespace psi {
 
+FunctionalPoints::FunctionalPoints()
+{
+    for (int k = 0; k < NKeys; k++) {
+        pointers_[k] = NULL;
+    }
+}
+const char* FunctionalPoints::key_name(Key key)
+{
+    static const char* names[NKeys] = {
+        "RHO_A", "RHO_B", "GAMMA_AA", "GAMMA_AB", "GAMMA_BB", "TAU_A", "TAU_B",
+        "V", "V_RHO_A", "V_RHO_B", "V_GAMMA_AA", "V_GAMMA_AB", "V_GAMMA_BB", "V_TAU_A", "V_TAU_B"};
+    return names[key];
+}
+void FunctionalPoints::bind(const std::map<std::string,SharedVector>& vals)
+{
+    for (int k = 0; k < NKeys; k++) {
+        std::map<std::string,SharedVector>::const_iterator it = vals.find(key_name((Key)k));
+        pointers_[k] = (it == vals.end() ? NULL : (*it).second->pointer());
+    }
+}
+
 Functional::Functional()
 {
     common_init();
@@ -82,5 +104,9 @@ void Functional::compute_functional(const std::map<std::string,SharedVector>& in
 {
     throw PSIEXCEPTION("Functional: pseudo-abstract class.");
 }
+void Functional::compute_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha)
+{
+    throw PSIEXCEPTION("Functional: no vectorized kernel for " + name_ + ".");
+}
 
 }
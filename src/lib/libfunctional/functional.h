@@ -29,6 +29,36 @@
 
 namespace psi {
 
+/**
+ * FunctionalPoints: Structure-of-arrays view of the functional
+ * inputs or first-order outputs for one block of points
+ *
+ * The arrays are bound once per block from the usual string-keyed
+ * maps, so that vectorized kernels index them by key instead of
+ * searching the map for every quantity. Unbound entries are NULL.
+ **/
+class FunctionalPoints {
+
+public:
+
+    enum Key { RHO_A, RHO_B, GAMMA_AA, GAMMA_AB, GAMMA_BB, TAU_A, TAU_B,
+               V, V_RHO_A, V_RHO_B, V_GAMMA_AA, V_GAMMA_AB, V_GAMMA_BB, V_TAU_A, V_TAU_B,
+               NKeys };
+
+    FunctionalPoints();
+
+    // Bind every key found in vals (missing keys are left NULL)
+    void bind(const std::map<std::string,SharedVector>& vals);
+
+    double* operator[](Key key) const { return pointers_[key]; }
+
+    static const char* key_name(Key key);
+
+protected:
+
+    double* pointers_[NKeys];
+};
+
 /** 
  * Functional: Generic Semilocal Exchange or Correlation DFA functional
  * 
@@ -89,6 +119,11 @@ public:
     
     virtual void compute_functional(const std::map<std::string,SharedVector>& in, const std::map<std::string,SharedVector>& out, int npoints, int deriv, double alpha) = 0;
 
+    // Does this functional have a vectorized kernel for this derivative level?
+    virtual bool has_kernel(int deriv) const { return false; }
+    // Vectorized version of compute_functional, only valid if has_kernel(deriv)
+    virtual void compute_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha);
+
     // => Parameters <= //
     
     const std::map<std::string, double>& parameters() { return parameters_; }
@@ -286,6 +286,7 @@ void SuperFunctional::allocate()
     for (int i = 0; i < list.size(); i++) {
         values_[list[i]] = SharedVector(new Vector(list[i],max_points_));
     }
+    out_points_.bind(values_);
 }
 std::map<std::string, SharedVector>& SuperFunctional::compute_functional(const std::map<std::string, SharedVector>& vals, int npoints)
 {
@@ -296,12 +297,23 @@ std::map<std::string, SharedVector>& SuperFunctional::compute_functional(const s
         ::memset((void*)((*it).second->pointer()),'\0',sizeof(double) * npoints);
     }
 
+    // Bind the input arrays once for the whole block
+    in_points_.bind(vals);
+
     for (int i = 0; i < x_functionals_.size(); i++) {
-        x_functionals_[i]->compute_functional(vals, values_, npoints, deriv_, (1.0 - x_alpha_));
+        if (x_functionals_[i]->has_kernel(deriv_)) {
+            x_functionals_[i]->compute_kernel(in_points_, out_points_, npoints, deriv_, (1.0 - x_alpha_));
+        } else {
+            x_functionals_[i]->compute_functional(vals, values_, npoints, deriv_, (1.0 - x_alpha_));
+        }
     }
     for (int i = 0; i < c_functionals_.size(); i++) {
 //        c_functionals_[i]->compute_functional(vals, values_, npoints, deriv_, (1.0 - c_alpha_));
-        c_functionals_[i]->compute_functional(vals, values_, npoints, deriv_, (1.0));
+        if (c_functionals_[i]->has_kernel(deriv_)) {
+            c_functionals_[i]->compute_kernel(in_points_, out_points_, npoints, deriv_, (1.0));
+        } else {
+            c_functionals_[i]->compute_functional(vals, values_, npoints, deriv_, (1.0));
+        }
     }
     
     return values_;
@@ -24,6 +24,7 @@
 #define SUPERFUNCTIONAL_H
 
 #include <libmints/typedefs.h>
+#include "functional.h"
 #include <map>
 #include <vector>
 
@@ -94,6 +95,9 @@ protected:
     int max_points_;
     int deriv_;
     std::map<std::string, SharedVector> values_;
+    // SoA views of the inputs and first-order values for the vectorized kernels
+    FunctionalPoints in_points_;
+    FunctionalPoints out_points_;
 
     // The omegas or alphas have changed, we're in a GKS environment. 
     // Update the short-range DFAs
@@ -28,6 +28,169 @@
 
 using namespace psi;
 
+namespace {
+
+// => Enhancement factors Fs(s) and dFs/ds for the vectorized kernels <= //
+// These are the GGA cases of XFunctional::compute_sigma_functional, one type per
+// case so that the point loop is specialized and contains no switch
+
+struct SlaterFs {
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        Fs = 1.0;
+        Fs_s = 0.0;
+    }
+};
+struct B88Fs {
+    double K0, a, d;
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        double s2p1 = s * s + 1.0;
+        double s2p1_12 = sqrt(s2p1);
+        double asinhs = log(s + s2p1_12);
+
+        double N = 2.0 / K0 * a * d * s * s;
+        double D = 1.0 + 6.0 * d * s * asinhs;
+
+        double N_s = 4.0 / K0 * a * d * s;
+        double D_s = 6.0 * d * asinhs + 6.0 * d * s / s2p1_12;
+
+        Fs = 1.0 + N / D;
+        Fs_s = (N_s * D - D_s * N) / (D * D);
+    }
+};
+struct PBEFs {
+    double k0, kp, mu;
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        double kk0 = (4 * k0 * k0);
+        double mus2 = 1.0 + mu * s * s / (kk0 * kp);
+        Fs = 1.0 + kp * (1.0 - 1.0 / mus2);
+        Fs_s = 2.0 / (mus2 * mus2) * mu * s / kk0;
+    }
+};
+struct RPBEFs {
+    double k0, kp, mu;
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        double kk0 = (4.1482496705 * k0 * k0);
+        double expv = exp(- mu * s * s / (kp * kk0));
+        Fs = 1.0 + kp * (1.0 - expv);
+        Fs_s = 2.0 * mu / kk0 * s * expv;
+    }
+};
+struct SOGGAFs {
+    double k0, kp, mu;
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        double kk0 = (4.9155 * k0 * k0);
+        double mus2 = 1.0 + mu * s * s / (kk0 * kp);
+        double expv = exp(- mu * s * s / (kp * kk0));
+        Fs = 1.0 + kp * (1.0 - 0.5 / mus2 - 0.5 * expv);
+        Fs_s = (1.0 * mu / kk0 * s * expv + 1.0 / (mus2 * mus2) * mu * s / kk0);
+    }
+};
+struct PW91Fs {
+    double a1, a2, a3, a4, a5, a6;
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        double bs = a2 * s;
+        double bs2 = bs * bs;
+        double bs2p1 = 1.0 + bs2;
+        double bs2p1_12 = sqrt(bs2p1);
+        double aasinhv = a1 * log(bs + bs2p1_12);
+        double dexpv = a4 * exp(-a5 * s * s);
+
+        double N = 1.0 + aasinhv * s + (a3 - dexpv) * s * s;
+        double D = 1.0 + aasinhv * s  + a6 * s * s * s * s;
+
+        double N_s =  aasinhv + a1 * a2 * s / bs2p1_12 + 2.0 * s * (a3 - dexpv) + 2.0 * s * s * s * a5 * dexpv;
+        double D_s =  aasinhv + a1 * a2 * s / bs2p1_12 + 4.0 * a6 * s * s * s;
+
+        Fs = N / D;
+        Fs_s = (N_s * D - D_s * N) / (D * D);
+    }
+};
+struct B97Fs {
+    double gamma;
+    const double* a;
+    int size;
+    void operator()(double s, double& Fs, double& Fs_s) const {
+        Fs = 0.0;
+        Fs_s = 0.0;
+        double s2 = s * s;
+        double gs2 = 1.0 + gamma * s2;
+        double g = gamma * s2 / gs2;
+        double g_s = 2.0 * gamma * s / (gs2 * gs2);
+
+        double buf = 1.0;
+        double buf2 = 0.0;
+
+        for (int A = 0; A < size; A++) {
+            Fs += a[A] * buf;
+            Fs_s += A * a[A] * buf2 * g_s;
+            buf2 = buf;
+            buf *= g;
+        }
+    }
+};
+
+// Spin-resolved LSDA/GGA exchange over a block of points.
+// Points below the density cutoff are evaluated at a dummy density and
+// masked out of the sums, so the loop has no data-dependent branches.
+template <class Enhancement, bool GGA>
+void sigma_kernel(const Enhancement& enhancement, double K0, double cutoff, double A,
+    const double* rho_s, const double* gamma_s, double* v, double* v_rho, double* v_gamma,
+    int npoints, int deriv)
+{
+    for (int Q = 0; Q < npoints; Q++) {
+
+        bool on = (rho_s[Q] >= cutoff);
+        double mask = (on ? 1.0 : 0.0);
+        double rho = (on ? rho_s[Q] : 1.0);
+        double gamma = (GGA ? (on ? gamma_s[Q] : 1.0) : 0.0);
+
+        // Powers of rho
+        double rho13 = pow(rho,1.0/3.0);
+        double rho43 = rho * rho13;
+        double rho73 = rho * rho * rho13;
+
+        // > LSDA < //
+        double E = - 0.5 * K0 * rho43;
+        double E_rho = -4.0/6.0 * K0 * rho13;
+
+        // > GGA < //
+        double s = 0.0;
+        double s_rho = 0.0;
+        double s_gamma = 0.0;
+        if (GGA) {
+            double gamma12 = sqrt(gamma);
+            s = gamma12 / rho43;
+            s_rho = - 4.0 / 3.0 * gamma12 / rho73;
+            s_gamma = 1.0 / 2.0 / (gamma12 * rho43);
+        }
+
+        double Fs, Fs_s;
+        enhancement(s, Fs, Fs_s);
+
+        // => Assembly <= //
+        v[Q] += mask * A * E * Fs;
+        if (deriv >= 1) {
+            v_rho[Q] += mask * A * (Fs * E_rho + E * Fs_s * s_rho);
+            if (GGA) {
+                v_gamma[Q] += mask * A * E * Fs_s * s_gamma;
+            }
+        }
+    }
+}
+template <class Enhancement>
+void run_sigma_kernel(const Enhancement& enhancement, bool gga, double K0, double cutoff, double A,
+    const double* rho_s, const double* gamma_s, double* v, double* v_rho, double* v_gamma,
+    int npoints, int deriv)
+{
+    if (gga) {
+        sigma_kernel<Enhancement,true>(enhancement,K0,cutoff,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+    } else {
+        sigma_kernel<Enhancement,false>(enhancement,K0,cutoff,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+    }
+}
+
+}
+
 namespace psi {
 
 XFunctional::XFunctional()
@@ -464,5 +627,74 @@ void XFunctional::compute_sigma_functional(const std::map<std::string,SharedVect
         }
     }
 }
+bool XFunctional::has_kernel(int deriv) const
+{
+    return (deriv <= 1 && !meta_ && meta_type_ == Meta_None && sr_type_ == SR_None);
+}
+void XFunctional::compute_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha)
+{
+    compute_sigma_kernel(in,out,npoints,deriv,alpha,true);
+    compute_sigma_kernel(in,out,npoints,deriv,alpha,false);
+}
+void XFunctional::compute_sigma_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha, bool spin)
+{
+    // Overall scale factor
+    double A = alpha_ * alpha;
+
+    const double* rho_s = in[spin ? FunctionalPoints::RHO_A : FunctionalPoints::RHO_B];
+    const double* gamma_s = in[spin ? FunctionalPoints::GAMMA_AA : FunctionalPoints::GAMMA_BB];
+
+    double* v = out[FunctionalPoints::V];
+    double* v_rho = out[spin ? FunctionalPoints::V_RHO_A : FunctionalPoints::V_RHO_B];
+    double* v_gamma = out[spin ? FunctionalPoints::V_GAMMA_AA : FunctionalPoints::V_GAMMA_BB];
+
+    // Without gga_ the enhancement factor is still applied, at s = 0
+    switch (gga_type_) {
+        case GGA_None: {
+            SlaterFs F;
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+        case B88: {
+            B88Fs F;
+            F.K0 = _K0_; F.a = _B88_a_; F.d = _B88_d_;
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+        case PBE: {
+            PBEFs F;
+            F.k0 = _k0_; F.kp = _PBE_kp_; F.mu = _PBE_mu_;
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+        case RPBE: {
+            RPBEFs F;
+            F.k0 = _k0_; F.kp = _PBE_kp_; F.mu = _PBE_mu_;
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+        case SOGGA: {
+            SOGGAFs F;
+            F.k0 = _k0_; F.kp = _PBE_kp_; F.mu = _PBE_mu_;
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+        case PW91: {
+            PW91Fs F;
+            F.a1 = _PW91_a1_; F.a2 = _PW91_a2_; F.a3 = _PW91_a3_;
+            F.a4 = _PW91_a4_; F.a5 = _PW91_a5_; F.a6 = _PW91_a6_;
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+        case B97: {
+            B97Fs F;
+            F.gamma = _B97_gamma_;
+            F.a = (_B97_a_.size() ? &_B97_a_[0] : NULL);
+            F.size = _B97_a_.size();
+            run_sigma_kernel(F,gga_,_K0_,lsda_cutoff_,A,rho_s,gamma_s,v,v_rho,v_gamma,npoints,deriv);
+            break;
+        }
+    }
+}
 
 }
@@ -107,6 +107,12 @@ public:
     virtual void compute_functional(const std::map<std::string,SharedVector>& in, const std::map<std::string,SharedVector>& out, int npoints, int deriv, double alpha);
 
     void compute_sigma_functional(const std::map<std::string,SharedVector>& in, const std::map<std::string,SharedVector>& out, int npoints, int deriv, double alpha, bool spin);
+
+    // Vectorized kernels cover the plain LSDA/GGA exchange functionals (no meta or SR parts)
+    virtual bool has_kernel(int deriv) const;
+    virtual void compute_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha);
+
+    void compute_sigma_kernel(const FunctionalPoints& in, const FunctionalPoints& out, int npoints, int deriv, double alpha, bool spin);
 };
 
 }
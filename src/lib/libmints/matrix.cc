@@ -1725,6 +1725,104 @@ void Matrix::diagonalize(SharedMatrix& metric, SharedMatrix& eigvectors, boost::
     }
     delete[] work;
 }
+
+namespace {
+
+/*
+ * Diagonalizes the n x n symmetric block A with the requested LAPACK driver.
+ * A is left untouched. On exit w holds the eigenvalues in ascending order and,
+ * if V is non-null, the columns of V hold the corresponding eigenvectors.
+ * Returns the LAPACK info value.
+ */
+int diagonalize_block(int n, double** A, double* w, double** V, diagonalize_driver driver)
+{
+    char jobz = (V ? 'V' : 'N');
+    std::vector<double> T(A[0], A[0] + (size_t)n * n);
+    std::vector<double> Z;
+    std::vector<int> isuppz;
+
+    // Workspace query, then the real call
+    double lwork_opt = 0.0;
+    int liwork_opt = 0;
+    int info = 0;
+    int m = 0;
+    if (driver == dsyevd_driver) {
+        info = C_DSYEVD(jobz, 'U', n, &T[0], n, w, &lwork_opt, -1, &liwork_opt, -1);
+    } else if (driver == dsyevr_driver) {
+        Z.resize((size_t)n * n);
+        isuppz.resize(2 * n);
+        info = C_DSYEVR(jobz, 'A', 'U', n, &T[0], n, 0.0, 0.0, 0, 0, 0.0, &m, w,
+                        &Z[0], n, &isuppz[0], &lwork_opt, -1, &liwork_opt, -1);
+    } else {
+        info = C_DSYEV(jobz, 'U', n, &T[0], n, w, &lwork_opt, -1);
+    }
+    if (info) return info;
+
+    int lwork = MAX((int)lwork_opt, 3*n);
+    int liwork = MAX(liwork_opt, 1);
+    std::vector<double> work(lwork);
+    std::vector<int> iwork(liwork);
+
+    if (driver == dsyevd_driver) {
+        info = C_DSYEVD(jobz, 'U', n, &T[0], n, w, &work[0], lwork, &iwork[0], liwork);
+    } else if (driver == dsyevr_driver) {
+        info = C_DSYEVR(jobz, 'A', 'U', n, &T[0], n, 0.0, 0.0, 0, 0, 0.0, &m, w,
+                        &Z[0], n, &isuppz[0], &work[0], lwork, &iwork[0], liwork);
+        T.swap(Z);
+    } else {
+        info = C_DSYEV(jobz, 'U', n, &T[0], n, w, &work[0], lwork);
+    }
+    if (info || !V) return info;
+
+    // LAPACK stores eigenvectors in rows (C ordering), we need them in columns
+    for (int r = 0; r < n; ++r)
+        for (int c = 0; c < n; ++c)
+            V[r][c] = T[(size_t)c * n + r];
+
+    return 0;
+}
+
+}
+
+void Matrix::diagonalize(SharedMatrix& eigvectors, boost::shared_ptr<Vector>& eigvalues, diagonalize_order nMatz,
+                         diagonalize_driver driver, int nthread)
+{
+    if (symmetry_) {
+        throw PSIEXCEPTION("Matrix::diagonalize: Matrix is non-totally symmetric.");
+    }
+
+    bool vectors = (nMatz == ascending || nMatz == descending);
+    bool reverse = (nMatz == evals_only_descending || nMatz == descending);
+
+    // Exceptions may not leave a parallel region, so collect the LAPACK errors
+    std::vector<int> info(nirrep_, 0);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(nthread)
+    for (int h = 0; h < nirrep_; ++h) {
+        int n = rowspi_[h];
+        if (!n) continue;
+
+        double* w = eigvalues->pointer(h);
+        double** V = (vectors ? eigvectors->pointer(h) : NULL);
+        info[h] = diagonalize_block(n, matrix_[h], w, V, driver);
+        if (info[h] || !reverse) continue;
+
+        for (int c = 0; c < n/2; ++c) {
+            std::swap(w[c], w[n-c-1]);
+            if (vectors)
+                for (int r = 0; r < n; ++r)
+                    std::swap(V[r][c], V[r][n-c-1]);
+        }
+    }
+
+    for (int h = 0; h < nirrep_; ++h) {
+        if (info[h]) {
+            char str[100];
+            sprintf(str, "Matrix::diagonalize: LAPACK eigensolver failed in irrep %d, info = %d", h, info[h]);
+            throw PSIEXCEPTION(str);
+        }
+    }
+}
 boost::tuple<SharedMatrix, SharedVector, SharedMatrix> Matrix::svd_temps()
 {
     Dimension rank(nirrep_);
@@ -63,6 +63,12 @@ enum diagonalize_order {
     descending = 3
 };
 
+enum diagonalize_driver {
+    dsyev_driver = 0,
+    dsyevd_driver = 1,
+    dsyevr_driver = 2
+};
+
 /*! \ingroup MINTS
  *  \class Matrix
  *  \brief Makes using matrices just a little easier.
@@ -817,6 +823,17 @@ public:
     void diagonalize(SharedMatrix& eigvectors, Vector& eigvalues, diagonalize_order nMatz = ascending);
     /// @}
 
+    /// @{
+    /**
+     * Diagonalizes this with the requested LAPACK driver (DSYEV, divide-and-conquer
+     * DSYEVD, or MRRR DSYEVR). Irrep blocks are diagonalized concurrently on up to
+     * nthread threads. eigvectors and eigvalues must be created by caller.
+     * Only for symmetric matrices.
+     */
+    void diagonalize(SharedMatrix& eigvectors, boost::shared_ptr<Vector>& eigvalues, diagonalize_order nMatz,
+                     diagonalize_driver driver, int nthread = 1);
+    /// @}
+
     /// @{
     /// Diagonalizes this, applying supplied metric, eigvectors and eigvalues must be created by caller.  Only for symmetric matrices.
     void diagonalize(SharedMatrix& metric, SharedMatrix& eigvectors, boost::shared_ptr<Vector>& eigvalues, diagonalize_order nMatz = ascending);
@@ -0,0 +1,174 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+#include <cmath>
+#include <psi4-dec.h>
+
+#include "sointegral_direct.h"
+#include "sointegral_twobody.h"
+#include "integral.h"
+#include "sobasis.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace psi {
+
+namespace {
+
+/* Largest |(pq|rs)| of a shell quartet, for the Schwarz bounds */
+class MaxIntegral {
+    double max_;
+public:
+    MaxIntegral() : max_(0.0) {}
+    void operator()(int, int, int, int, int, int, int, int, int, int, int, int, double value)
+    {
+        if(std::fabs(value) > max_) max_ = std::fabs(value);
+    }
+    double max() const { return max_; }
+};
+
+/* Stores the integrals of a shell quartet in consecutive columns of buf */
+class CollectIntegrals {
+    double **buf_;
+    long int n_;
+public:
+    CollectIntegrals(double **buf, long int first) : buf_(buf), n_(first) {}
+    void operator()(int p, int q, int r, int s, int, int, int, int, int, int, int, int, double value)
+    {
+        buf_[0][n_] = p;
+        buf_[1][n_] = q;
+        buf_[2][n_] = r;
+        buf_[3][n_] = s;
+        buf_[4][n_] = value;
+        ++n_;
+    }
+    long int end() const { return n_; }
+};
+
+}
+
+DirectSOIntegrals::DirectSOIntegrals(boost::shared_ptr<IntegralFactory> factory, int nthreads, double cutoff)
+    : nthreads_(nthreads < 1 ? 1 : nthreads), ntotal_(0), max_quartet_(1), max_total_(0), next_(0)
+{
+    // One SO integral object per thread; TwoBodySOInt cannot be shared
+    for(int t = 0; t < nthreads_; ++t)
+        eri_.push_back(boost::shared_ptr<TwoBodySOInt>(new TwoBodySOInt(
+                boost::shared_ptr<TwoBodyAOInt>(factory->eri()), factory)));
+    sobasis_ = eri_[0]->basis();
+    int nshell = sobasis_->nshell();
+
+    // Schwarz bounds: schwarz[PQ] = sqrt(max |(PQ|PQ)|)
+    std::vector<double> schwarz(nshell * nshell, 0.0);
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+    for(int PQ = 0; PQ < nshell * nshell; ++PQ){
+        int P = PQ / nshell;
+        int Q = PQ % nshell;
+        if(P < Q) continue;
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        MaxIntegral max;
+        eri_[t]->compute_shell(P, Q, P, Q, max);
+        schwarz[P * nshell + Q] = schwarz[Q * nshell + P] = std::sqrt(max.max());
+    }
+
+    SOShellCombinationsIterator shellIter(sobasis_, sobasis_, sobasis_, sobasis_);
+    for(shellIter.first(); !shellIter.is_done(); shellIter.next()){
+        ++ntotal_;
+        int P = shellIter.p(), Q = shellIter.q(), R = shellIter.r(), S = shellIter.s();
+        if(schwarz[P * nshell + Q] * schwarz[R * nshell + S] < cutoff) continue;
+        quartets_.push_back(P); quartets_.push_back(Q);
+        quartets_.push_back(R); quartets_.push_back(S);
+    }
+
+    for(long int quartet = 0; quartet < nquartet(); ++quartet){
+        long int size = quartet_size(quartet);
+        if(size > max_quartet_) max_quartet_ = size;
+        max_total_ += size;
+    }
+    if(max_total_ < max_quartet_) max_total_ = max_quartet_;
+
+    start_.resize(nquartet());
+    end_.resize(nquartet());
+}
+
+/* Upper bound on the integrals of a quartet from the SO shell sizes */
+long int DirectSOIntegrals::quartet_size(long int quartet) const
+{
+    return (long int) sobasis_->nfunction(quartets_[4*quartet]) * sobasis_->nfunction(quartets_[4*quartet+1])
+         * sobasis_->nfunction(quartets_[4*quartet+2]) * sobasis_->nfunction(quartets_[4*quartet+3]);
+}
+
+long int DirectSOIntegrals::compute_next(double **buf, long int size)
+{
+    if(size < max_quartet_)
+        throw PSIEXCEPTION("DirectSOIntegrals: the buffer cannot hold the largest shell quartet.");
+
+    long int first = next_;
+    long int last, nints = 0;
+    for(last = first; last < nquartet(); ++last){
+        long int qsize = quartet_size(last);
+        if(nints + qsize > size) break;
+        start_[last] = nints;
+        nints += qsize;
+    }
+    next_ = last;
+
+    // Disjoint ranges of the buffer, so the threads never write the same column
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+    for(long int quartet = first; quartet < last; ++quartet){
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        CollectIntegrals collect(buf, start_[quartet]);
+        eri_[t]->compute_shell(quartets_[4*quartet], quartets_[4*quartet+1],
+                               quartets_[4*quartet+2], quartets_[4*quartet+3], collect);
+        end_[quartet] = collect.end();
+    }
+
+    // Symmetry and the canonical ordering leave gaps behind most quartets
+    long int n = 0;
+    for(long int quartet = first; quartet < last; ++quartet){
+        for(long int m = start_[quartet]; m < end_[quartet]; ++m, ++n){
+            if(m == n) continue;
+            for(int row = 0; row < 5; ++row) buf[row][n] = buf[row][m];
+        }
+    }
+
+    return n;
+}
+
+void DirectSOIntegrals::split_columns(int nirreps, const int *coltot, int nparts, int **col0, int **ncol)
+{
+    for(int h = 0; h < nirreps; ++h){
+        for(int t = 0; t < nparts; ++t){
+            col0[t][h] = (int) (((long int) coltot[h] * t) / nparts);
+            ncol[t][h] = (int) (((long int) coltot[h] * (t+1)) / nparts) - col0[t][h];
+        }
+    }
+}
+
+}
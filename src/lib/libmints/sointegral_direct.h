@@ -0,0 +1,99 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+#ifndef _psi_src_lib_libmints_sointegral_direct_h_
+#define _psi_src_lib_libmints_sointegral_direct_h_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+namespace psi {
+
+class IntegralFactory;
+class SOBasisSet;
+class TwoBodySOInt;
+
+/**
+ * DirectSOIntegrals
+ *
+ * The Schwarz-screened SO two-electron integrals, recomputed in batches by
+ * several threads for integral-direct algorithms.  Each thread computes its
+ * shell quartets with its own TwoBodySOInt object.
+ *
+ * The integrals of a batch are stored in a buffer supplied by the caller, so
+ * that it can be charged to the caller's memory pool (e.g. a DPD block).  The
+ * buffer has five rows: the labels p, q, r and s in rows 0-3 and the values in
+ * row 4.  Its length must be at least max_quartet_size().
+ *
+ *     DirectSOIntegrals ints(factory, nthreads, cutoff);
+ *     double **buf = block_matrix(5, size);
+ *     long int nints;
+ *     for(ints.first(); !ints.is_done(); ){
+ *         nints = ints.compute_next(buf, size);
+ *         for(long int n = 0; n < nints; ++n) ... buf[0][n] ... buf[4][n] ...
+ *     }
+ */
+class DirectSOIntegrals {
+    int nthreads_;
+    std::vector<boost::shared_ptr<TwoBodySOInt> > eri_;
+    boost::shared_ptr<SOBasisSet> sobasis_;
+    /// The shell labels of the quartets surviving the screening, four per quartet
+    std::vector<int> quartets_;
+    /// Start of each quartet of the current batch in the buffer, and one past its end
+    std::vector<long int> start_;
+    std::vector<long int> end_;
+    /// Number of unique SO shell quartets before screening
+    long int ntotal_;
+    /// Upper bounds on the integrals of one quartet and of all quartets
+    long int max_quartet_;
+    long int max_total_;
+    /// The first quartet of the next batch
+    long int next_;
+
+    long int quartet_size(long int quartet) const;
+
+public:
+    DirectSOIntegrals(boost::shared_ptr<IntegralFactory> factory, int nthreads, double cutoff);
+
+    /// Number of shell quartets surviving the Schwarz screening
+    long int nquartet() const { return quartets_.size() / 4; }
+    /// Number of unique shell quartets before the screening
+    long int ntotal() const { return ntotal_; }
+    /// Smallest useful buffer length: the integrals of the largest quartet
+    long int max_quartet_size() const { return max_quartet_; }
+    /// Buffer length that holds all integrals in a single batch
+    long int max_total_size() const { return max_total_; }
+
+    void first() { next_ = 0; }
+    bool is_done() const { return next_ >= nquartet(); }
+    /// Computes the next batch into buf, which has room for size integrals,
+    /// and returns the number of integrals stored in its leading columns.
+    long int compute_next(double **buf, long int size);
+
+    /// Splits the coltot[h] columns of each irrep evenly into nparts contiguous
+    /// slices: slice t starts at col0[t][h] and has ncol[t][h] columns.
+    static void split_columns(int nirreps, const int *coltot, int nparts, int **col0, int **ncol);
+};
+
+}
+
+#endif
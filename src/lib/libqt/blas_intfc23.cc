@@ -35,6 +35,7 @@
 #if FC_SYMBOL==2
 #define F_DGBMV dgbmv_
 #define F_DGEMM dgemm_
+#define F_SGEMM sgemm_
 #define F_DGEMV dgemv_
 #define F_DGER dger_
 #define F_DSBMV dsbmv_
@@ -58,6 +59,7 @@
 #elif FC_SYMBOL==1
 #define F_DGBMV dgbmv
 #define F_DGEMM dgemm
+#define F_SGEMM sgemm
 #define F_DGEMV dgemv
 #define F_DGER dger
 #define F_DSBMV dsbmv
@@ -81,6 +83,7 @@
 #elif FC_SYMBOL==3
 #define F_DGBMV DGBMV
 #define F_DGEMM DGEMM
+#define F_SGEMM SGEMM
 #define F_DGEMV DGEMV
 #define F_DGER DGER
 #define F_DSBMV DSBMV
@@ -104,6 +107,7 @@
 #elif FC_SYMBOL==4
 #define F_DGBMV DGBMV_
 #define F_DGEMM DGEMM_
+#define F_SGEMM SGEMM_
 #define F_DGEMV DGEMV_
 #define F_DGER DGER_
 #define F_DSBMV DSBMV_
@@ -129,6 +133,7 @@
 extern "C" {
 extern void F_DGBMV(char*, int*, int*, int*, int*, double*, double*, int*, double*, int*, double*, double*, int*);
 extern void F_DGEMM(char*, char*, int*, int*, int*, double*, double*, int*, double*, int*, double*, double*, int*);
+extern void F_SGEMM(char*, char*, int*, int*, int*, float*, float*, int*, float*, int*, float*, float*, int*);
 extern void F_DGEMV(char*, int*, int*, double*, double*, int*, double*, int*, double*, double*, int*);
 extern void F_DGER(int*, int*, double*, double*, int*, double*, int*, double*, int*);
 extern void F_DSBMV(char*, int*, int*, double*, double*, int*, double*, int*, double*, double*, int*);
@@ -409,6 +414,17 @@ void C_DGEMM(char transa, char transb, int m, int n, int k, double alpha, double
     ::F_DGEMM(&transb, &transa, &n, &m, &k, &alpha, b, &ldb, a, &lda, &beta, c, &ldc);
 }
 
+/**
+*  Single-precision C_DGEMM: same arguments and row-major conventions,
+*  with float arrays.  Used where operands are stored in single precision
+*  to halve their size; callers accumulate the results in double.
+**/
+void C_SGEMM(char transa, char transb, int m, int n, int k, float alpha, float* a, int lda, float* b, int ldb, float beta, float* c, int ldc)
+{
+    if(m == 0 || n == 0 || k == 0) return;
+    ::F_SGEMM(&transb, &transa, &n, &m, &k, &alpha, b, &ldb, a, &lda, &beta, c, &ldc);
+}
+
 /**
 *  Purpose
 *  =======
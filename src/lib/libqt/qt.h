@@ -161,6 +161,9 @@ void C_DSYRK(char uplo, char trans, int n, int k, double alpha, double* a, int l
 void C_DSYR2K(char uplo, char trans, int n, int k, double alpha, double* a, int lda, double* b, int ldb, double beta, double* c, int ldc);
 void C_DTRSV(char uplo, char trans, char diag, int n, double* a, int lda, double* x, int incx);
 
+// BLAS 3 Single routines
+void C_SGEMM(char transa, char transb, int m, int n, int k, float alpha, float* a, int lda, float* b, int ldb, float beta, float* c, int ldc);
+
 
 // LAPACK 3.2 Double routines
 // Sorry guys, I know its rather epic
@@ -47,9 +47,12 @@ SAPT0::SAPT0(Options& options, boost::shared_ptr<PSIO> psio,
   e_conv_ = options_.get_double("E_CONVERGENCE");
   d_conv_ = options_.get_double("D_CONVERGENCE");
   no_response_ = options_.get_bool("NO_RESPONSE");
-  aio_cphf_ = options_.get_bool("AIO_CPHF");
   aio_dfints_ = options_.get_bool("AIO_DF_INTS");
 
+  if (options_["AIO_CPHF"].has_changed())
+    fprintf(outfile,"    AIO_CPHF is deprecated and has no effect; the DF integrals\n"
+      "    are always read ahead when they do not fit in memory.\n\n");
+
   wBAR_ = NULL;
   wABS_ = NULL;
 }
@@ -84,10 +84,12 @@ private:
   SAPTDFInts set_Q14_AR();
 
   Iterator get_iterator(long int, SAPTDFInts*, bool alloc=true);
-  Iterator set_iterator(int, SAPTDFInts*, bool alloc=true);
+  Iterator set_iterator(int, SAPTDFInts*, bool alloc=true,
+    bool prefetch=false);
 
   Iterator get_iterator(long int, SAPTDFInts*, SAPTDFInts*, bool alloc=true);
-  Iterator set_iterator(int, SAPTDFInts*, SAPTDFInts*, bool alloc=true);
+  Iterator set_iterator(int, SAPTDFInts*, SAPTDFInts*, bool alloc=true,
+    bool prefetch=false);
 
   void read_all(SAPTDFInts*);
   void read_block(Iterator *, SAPTDFInts *);
@@ -95,8 +97,6 @@ private:
 
   void ind20rA_B();
   void ind20rB_A();
-  void ind20rA_B_aio();
-  void ind20rB_A_aio();
 
   void get_denom();
 
@@ -124,7 +124,6 @@ private:
 
 protected:
   bool no_response_;
-  bool aio_cphf_;
   bool aio_dfints_;
 
   int maxiter_;
@@ -185,20 +184,34 @@ struct SAPTDFInts {
   double **B_p_;
   double **B_d_;
 
+  // Block next_block_ of the iterator, read ahead into B_n_ by prefetch_
+  // from next_start_ to next_end_ while B_p_ is in use
+  double **B_n_;
+  int next_block_;
+  psio_address next_start_;
+  psio_address next_end_;
+  boost::shared_ptr<boost::thread> prefetch_;
+
   int filenum_;
   const char *label_;
 
   psio_address next_DF_;
 
-  SAPTDFInts() { next_DF_ = PSIO_ZERO; B_p_ = NULL; B_d_ = NULL; };
+  SAPTDFInts() { next_DF_ = PSIO_ZERO; B_p_ = NULL; B_d_ = NULL;
+    B_n_ = NULL; next_block_ = 0; };
   ~SAPTDFInts() {
+    wait();
     if (B_p_ != NULL) free_block(B_p_);
-    if (B_d_ != NULL) free_block(B_d_); };
+    if (B_d_ != NULL) free_block(B_d_);
+    if (B_n_ != NULL) free_block(B_n_); };
+  void wait() { if (prefetch_) {
+    if (prefetch_->joinable()) prefetch_->join(); prefetch_.reset(); } };
   void rewind() { next_DF_ = PSIO_ZERO; };
-  void clear() { free_block(B_p_); B_p_ = NULL; next_DF_ = PSIO_ZERO; };
+  void clear() { wait(); free_block(B_p_); free_block(B_n_); B_p_ = NULL;
+    B_n_ = NULL; next_block_ = 0; next_DF_ = PSIO_ZERO; };
   void done() {
-    free_block(B_p_); if (dress_) free_block(B_d_);
-    B_p_ = NULL; B_d_ = NULL; };
+    wait(); free_block(B_p_); free_block(B_n_); if (dress_) free_block(B_d_);
+    B_p_ = NULL; B_n_ = NULL; B_d_ = NULL; next_block_ = 0; };
 };
 
 struct Iterator {
@@ -208,9 +221,10 @@ struct Iterator {
 
   int curr_block;
   long int curr_size;
+  int passes;
 
   ~Iterator() { free(block_size); };
-  void rewind() { curr_block = 1; curr_size = 0; };
+  void rewind() { curr_block = 1; curr_size = 0; passes++; };
 };
 
 }}
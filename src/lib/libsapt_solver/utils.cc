@@ -24,6 +24,9 @@
 #include "sapt0.h"
 #include "sapt2.h"
 
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
 namespace psi { namespace sapt {
 
 void SAPT::zero_disk(int file, const char *array, int rows, int columns)
@@ -38,14 +41,150 @@ void SAPT::zero_disk(int file, const char *array, int rows, int columns)
   free(zero);
 }
 
+namespace {
+
+/* Serializes the reads of the DF integrals between the main thread and the
+   prefetch threads, as PSIO does not lock a unit */
+boost::mutex df_read_lock;
+
+bool same_address(const psio_address &a, const psio_address &b)
+{
+  return(a.page == b.page && a.offset == b.offset);
+}
+
+/* Only the DF integral files are read ahead; PSIF_SAPT_TEMP is still being
+   written by the terms while its blocks are read */
+bool prefetchable(SAPTDFInts *ints)
+{
+  return(ints->filenum_ != PSIF_SAPT_TEMP);
+}
+
+void read_rows(PSIO *psio, SAPTDFInts *ints, double **buf,
+  long int block_length, bool last_block, psio_address *next)
+{
+  if (!ints->active_ && (!ints->dress_disk_ || !last_block)) {
+    psio->read(ints->filenum_,ints->label_,(char *) &(buf[0][0]),
+      sizeof(double)*block_length*ints->ij_length_,*next,next);
+  }
+  else if (!ints->active_) {
+    psio->read(ints->filenum_,ints->label_,(char *) &(buf[0][0]),
+      sizeof(double)*(block_length+3L)*ints->ij_length_,*next,next);
+  }
+  else {
+    for (int p=0; p<block_length; p++) {
+      *next = psio_get_address(*next,
+        sizeof(double)*ints->i_start_*ints->j_length_);
+      psio->read(ints->filenum_,ints->label_,(char *) &(buf[p][0]),
+        sizeof(double)*ints->ij_length_,*next,next);
+    }
+  }
+}
+
+/* Fills the dressing rows of the last block that are not on disk */
+void dress_rows(SAPTDFInts *ints, long int block_length)
+{
+  if (ints->dress_ && !ints->dress_disk_) {
+    C_DCOPY(3L*ints->ij_length_,&(ints->B_d_[0][0]),1,
+      &(ints->B_p_[block_length][0]),1);
+  }
+  else if (!ints->dress_disk_) {
+    memset(&(ints->B_p_[block_length][0]),'\0',sizeof(double)*3L*
+      ints->ij_length_);
+  }
+}
+
+/* Reads the next block of intA (and intB) into B_n_ */
+struct Prefetch {
+  PSIO *psio;
+  SAPTDFInts *intA;
+  SAPTDFInts *intB;
+  long int block_length;
+  bool last_block;
+
+  void operator()() {
+    boost::lock_guard<boost::mutex> lock(df_read_lock);
+    intA->next_end_ = intA->next_start_;
+    read_rows(psio,intA,intA->B_n_,block_length,last_block,&intA->next_end_);
+    if (intB != NULL) {
+      intB->next_end_ = intB->next_start_;
+      read_rows(psio,intB,intB->B_n_,block_length,last_block,
+        &intB->next_end_);
+    }
+  }
+};
+
+/* Makes the prefetched block current if it is the one the iterator asks
+   for; returns false if it still has to be read */
+bool take_prefetch(Iterator *iter, SAPTDFInts *ints)
+{
+  ints->wait();
+
+  bool found = (ints->next_block_ == iter->curr_block &&
+    same_address(ints->next_start_,ints->next_DF_));
+  ints->next_block_ = 0;
+  if (!found) return(false);
+
+  double **B_p = ints->B_p_;
+  ints->B_p_ = ints->B_n_;
+  ints->B_n_ = B_p;
+  ints->next_DF_ = ints->next_end_;
+
+  return(true);
+}
+
+/* Starts reading the block after the current one.  Once the iterator has
+   been rewound, the last block reads ahead the first block of the next
+   pass, which nested loops ask for next. */
+void start_prefetch(PSIO *psio, Iterator *iter, SAPTDFInts *intA,
+  SAPTDFInts *intB, bool dress)
+{
+  if (intA->B_n_ == NULL || (intB != NULL && intB->B_n_ == NULL)) return;
+
+  int block = iter->curr_block;
+  psio_address startA = intA->next_DF_;
+  psio_address startB = (intB != NULL ? intB->next_DF_ : PSIO_ZERO);
+
+  if (block > iter->num_blocks) {
+    if (!iter->passes) return;
+    block = 1;
+    startA = PSIO_ZERO;
+    startB = PSIO_ZERO;
+  }
+
+  bool last_block = (block == iter->num_blocks);
+  long int block_length = iter->block_size[block-1];
+  if (last_block && dress) block_length -= 3;
+
+  intA->next_block_ = block;
+  intA->next_start_ = startA;
+  if (intB != NULL) {
+    intB->next_block_ = block;
+    intB->next_start_ = startB;
+  }
+
+  Prefetch prefetch;
+  prefetch.psio = psio;
+  prefetch.intA = intA;
+  prefetch.intB = intB;
+  prefetch.block_length = block_length;
+  prefetch.last_block = last_block;
+
+  intA->prefetch_ = boost::shared_ptr<boost::thread>(
+    new boost::thread(prefetch));
+  if (intB != NULL) intB->prefetch_ = intA->prefetch_;
+}
+
+}
+
 void SAPT0::read_all(SAPTDFInts *ints)
 {
   long int nri = ndf_;
   if (ints->dress_) nri += 3L;
 
+  ints->wait();
   ints->B_p_ = block_matrix(nri,ints->ij_length_);
 
-  long int tot_i = ints->i_length_ + ints->i_start_;
+  boost::lock_guard<boost::mutex> lock(df_read_lock);
 
   if (!ints->active_ && !ints->dress_disk_) {
     psio_->read_entry(ints->filenum_,ints->label_,(char *)
@@ -69,6 +208,11 @@ void SAPT0::read_all(SAPTDFInts *ints)
       &(ints->B_p_[ndf_][0]),1);
 }
 
+/* read_block(): Makes the next block of the iterator current in B_p_.
+** If the iterator was set up to prefetch, the block was usually read by
+** the previous call in the background, and this call starts reading the
+** one after it, so the caller's work on B_p_ overlaps the disk.
+*/
 void SAPT0::read_block(Iterator *iter, SAPTDFInts *intA)
 {
   bool last_block = false;
@@ -76,43 +220,20 @@ void SAPT0::read_block(Iterator *iter, SAPTDFInts *intA)
   bool dress = false;
   if (intA->dress_) dress = true;
   long int block_length = iter->block_size[iter->curr_block-1];
-  iter->curr_block++;
-
-//  printf("%d %d %d %d %d %d\n",iter->num_blocks,block_length,
-//    iter->curr_block,block_length,last_block,dress);
 
   iter->curr_size = block_length;
   if (last_block && dress) block_length -= 3;
 
-  if (!intA->active_ && (!intA->dress_disk_ || !last_block)) {
-    psio_->read(intA->filenum_,intA->label_,(char *) &(intA->B_p_[0][0]),
-      sizeof(double)*block_length*intA->ij_length_,intA->next_DF_,
+  if (!take_prefetch(iter,intA)) {
+    boost::lock_guard<boost::mutex> lock(df_read_lock);
+    read_rows(psio_.get(),intA,intA->B_p_,block_length,last_block,
       &intA->next_DF_);
   }
-  else if (!intA->active_) {
-    psio_->read(intA->filenum_,intA->label_,(char *) &(intA->B_p_[0][0]),
-      sizeof(double)*(block_length+3L)*intA->ij_length_,intA->next_DF_,
-      &intA->next_DF_);
-  }
-  else {
-    for (int p=0; p<block_length; p++) {
-      intA->next_DF_ = psio_get_address(intA->next_DF_,
-        sizeof(double)*intA->i_start_*intA->j_length_);
-      psio_->read(intA->filenum_,intA->label_,(char *) &(intA->B_p_[p][0]),
-        sizeof(double)*intA->ij_length_,intA->next_DF_,&intA->next_DF_);
-    }
-  }
+  iter->curr_block++;
 
-  if (dress && last_block) {
-    if (intA->dress_ && !intA->dress_disk_) {
-      C_DCOPY(3L*intA->ij_length_,&(intA->B_d_[0][0]),1,
-        &(intA->B_p_[block_length][0]),1);
-    }
-    else if (!intA->dress_disk_) {
-      memset(&(intA->B_p_[block_length][0]),'\0',sizeof(double)*3L*
-        intA->ij_length_);
-    }
-  }
+  if (dress && last_block) dress_rows(intA,block_length);
+
+  start_prefetch(psio_.get(),iter,intA,NULL,dress);
 }
 
 void SAPT0::read_block(Iterator *iter, SAPTDFInts *intA, SAPTDFInts *intB)
@@ -122,73 +243,36 @@ void SAPT0::read_block(Iterator *iter, SAPTDFInts *intA, SAPTDFInts *intB)
   bool dress = false;
   if (intA->dress_ || intB->dress_) dress = true;
   long int block_length = iter->block_size[iter->curr_block-1];
-  iter->curr_block++;
-
-//  printf("%d %d %d %d %d %d\n",iter->num_blocks,block_length,
-//    iter->curr_block,block_length,last_block,dress);
 
   iter->curr_size = block_length;
   if (last_block && dress) block_length -= 3;
 
-  if (!intA->active_ && (!intA->dress_disk_ || !last_block)) {
-    psio_->read(intA->filenum_,intA->label_,(char *) &(intA->B_p_[0][0]),
-      sizeof(double)*block_length*intA->ij_length_,intA->next_DF_,
-      &intA->next_DF_);
-  }
-  else if (!intA->active_) {
-    psio_->read(intA->filenum_,intA->label_,(char *) &(intA->B_p_[0][0]),
-      sizeof(double)*(block_length+3L)*intA->ij_length_,intA->next_DF_,
-      &intA->next_DF_);
-  }
-  else {
-    for (int p=0; p<block_length; p++) {
-      intA->next_DF_ = psio_get_address(intA->next_DF_,
-        sizeof(double)*intA->i_start_*intA->j_length_);
-      psio_->read(intA->filenum_,intA->label_,(char *) &(intA->B_p_[p][0]),
-        sizeof(double)*intA->ij_length_,intA->next_DF_,&intA->next_DF_);
-    }
-  }
-
-  if (!intB->active_ && (!intB->dress_disk_ || !last_block)) {
-    psio_->read(intB->filenum_,intB->label_,(char *) &(intB->B_p_[0][0]),
-      sizeof(double)*block_length*intB->ij_length_,intB->next_DF_,
-      &intB->next_DF_);
-  }
-  else if (!intB->active_) {
-    psio_->read(intB->filenum_,intB->label_,(char *) &(intB->B_p_[0][0]),
-      sizeof(double)*(block_length+3L)*intB->ij_length_,intB->next_DF_,
-      &intB->next_DF_);
-  }
-  else {
-    for (int p=0; p<block_length; p++) {
-      intB->next_DF_ = psio_get_address(intB->next_DF_,
-        sizeof(double)*intB->i_start_*intB->j_length_);
-      psio_->read(intB->filenum_,intB->label_,(char *) &(intB->B_p_[p][0]),
-        sizeof(double)*intB->ij_length_,intB->next_DF_,&intB->next_DF_);
-    }
+  bool foundA = take_prefetch(iter,intA);
+  bool foundB = take_prefetch(iter,intB);
+  if (!foundA || !foundB) {
+    boost::lock_guard<boost::mutex> lock(df_read_lock);
+    if (!foundA)
+      read_rows(psio_.get(),intA,intA->B_p_,block_length,last_block,
+        &intA->next_DF_);
+    if (!foundB)
+      read_rows(psio_.get(),intB,intB->B_p_,block_length,last_block,
+        &intB->next_DF_);
   }
+  iter->curr_block++;
 
   if (dress && last_block) {
-    if (intA->dress_ && !intA->dress_disk_) {
-      C_DCOPY(3L*intA->ij_length_,&(intA->B_d_[0][0]),1,
-        &(intA->B_p_[block_length][0]),1);
-    }
-    else if (!intA->dress_disk_) {
-      memset(&(intA->B_p_[block_length][0]),'\0',sizeof(double)*3L*
-        intA->ij_length_);
-    }
-
-    if (intB->dress_ && !intB->dress_disk_) {
-      C_DCOPY(3L*intB->ij_length_,&(intB->B_d_[0][0]),1,
-        &(intB->B_p_[block_length][0]),1);
-    }
-    else if (!intB->dress_disk_) {
-      memset(&(intB->B_p_[block_length][0]),'\0',sizeof(double)*3L*
-        intB->ij_length_);
-    }
+    dress_rows(intA,block_length);
+    dress_rows(intB,block_length);
   }
+
+  start_prefetch(psio_.get(),iter,intA,intB,dress);
 }
 
+/* get_iterator(): Splits the DF index of intA into blocks that fit in mem.
+** When more than one block is needed, blocks of the DF integral files are
+** sized to half of mem so that the next block can be read while the
+** current one is used.
+*/
 Iterator SAPT0::get_iterator(long int mem, SAPTDFInts *intA, bool alloc)
 {
   long int ij_size = intA->ij_length_;
@@ -199,10 +283,15 @@ Iterator SAPT0::get_iterator(long int mem, SAPTDFInts *intA, bool alloc)
   int length = mem/ij_size;
   if (length > max_length) length = max_length;
 
-  return(set_iterator(length,intA,alloc));
+  bool prefetch = (length < max_length && mem/(2L*ij_size) > 3L &&
+    prefetchable(intA));
+  if (prefetch) length = mem/(2L*ij_size);
+
+  return(set_iterator(length,intA,alloc,prefetch));
 }
 
-Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, bool alloc)
+Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, bool alloc,
+  bool prefetch)
 {
   if (0 >= length)
     throw PsiException("Not enough memory", __FILE__,__LINE__);
@@ -222,6 +311,7 @@ Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, bool alloc)
   iter.curr_block = 1;
   iter.block_size = init_int_array(iter.num_blocks);
   iter.curr_size = 0;
+  iter.passes = 0;
 
   for (int i=0; i<num; i++) iter.block_size[i] = length;
   if (gimp > 3) {
@@ -235,6 +325,8 @@ Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, bool alloc)
 
   if (alloc)
     intA->B_p_ = block_matrix(max_block,intA->ij_length_);
+  if (alloc && prefetch && iter.num_blocks > 1)
+    intA->B_n_ = block_matrix(max_block,intA->ij_length_);
 
   return(iter);
 }
@@ -250,11 +342,15 @@ Iterator SAPT0::get_iterator(long int mem, SAPTDFInts *intA, SAPTDFInts *intB,
   int length = mem/ij_size;
   if (length > max_length) length = max_length;
 
-  return(set_iterator(length,intA,intB,alloc));
+  bool prefetch = (length < max_length && mem/(2L*ij_size) > 3L &&
+    prefetchable(intA) && prefetchable(intB));
+  if (prefetch) length = mem/(2L*ij_size);
+
+  return(set_iterator(length,intA,intB,alloc,prefetch));
 }
 
 Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, SAPTDFInts *intB,
-   bool alloc)
+   bool alloc, bool prefetch)
 {
   if (0 >= length)
     throw PsiException("Not enough memory", __FILE__,__LINE__);
@@ -274,6 +370,7 @@ Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, SAPTDFInts *intB,
   iter.curr_block = 1;
   iter.block_size = init_int_array(iter.num_blocks);
   iter.curr_size = 0;
+  iter.passes = 0;
 
   for (int i=0; i<num; i++) iter.block_size[i] = length;
   if (gimp > 3) {
@@ -289,6 +386,10 @@ Iterator SAPT0::set_iterator(int length, SAPTDFInts *intA, SAPTDFInts *intB,
     intA->B_p_ = block_matrix(max_block,intA->ij_length_);
     intB->B_p_ = block_matrix(max_block,intB->ij_length_);
   }
+  if (alloc && prefetch && iter.num_blocks > 1) {
+    intA->B_n_ = block_matrix(max_block,intA->ij_length_);
+    intB->B_n_ = block_matrix(max_block,intB->ij_length_);
+  }
 
   return(iter);
 }
@@ -54,6 +54,7 @@
 #include <liboptions/liboptions_python.h>
 #include <psifiles.h>
 #include <libfock/jk.h>
+#include <libutil/libutil.h>
 
 #include "hf.h"
 
@@ -338,6 +339,30 @@ void HF::common_init()
     frac_enabled_ = (options_.get_int("FRAC_START") != 0);
     frac_performed_ = false;
 
+    std::string diag_solver = options_.get_str("DIAG_SOLVER");
+    if (diag_solver == "DSYEVD")
+        diag_driver_ = dsyevd_driver;
+    else if (diag_solver == "DSYEVR")
+        diag_driver_ = dsyevr_driver;
+    else
+        diag_driver_ = dsyev_driver;
+    diag_nthread_ = options_.get_int("DIAG_NUM_THREADS");
+    if (diag_nthread_ < 1)
+        throw PSIEXCEPTION("DIAG_NUM_THREADS must be at least 1.");
+    pseudo_diag_convergence_ = options_.get_double("PSEUDO_DIAG_CONVERGENCE");
+    pseudo_diag_allowed_ = false;
+    pseudo_diag_performed_ = false;
+    diag_time_ = 0.0;
+
+    purify_start_ = options_.get_int("PURIFY_START");
+    purify_enabled_ = (purify_start_ != 0);
+    purify_maxiter_ = options_.get_int("PURIFY_MAXITER");
+    purify_convergence_ = options_.get_double("PURIFY_CONVERGENCE");
+    purify_max_stalls_ = options_.get_int("PURIFY_MAX_STALLS");
+    purify_stalls_ = 0;
+    purify_Drms_ = 0.0;
+    purify_performed_ = false;
+
     print_header();
 }
 
@@ -1200,6 +1225,20 @@ void HF::save_orbitals()
     int old_puream = (basisset_->has_puream() ? 1 : 0);
     psio_->write_entry(PSIF_SCF_MOS,"PUREAM",(char *)(&old_puream),sizeof(int));
 
+    // the geometry, so that a rigid-body move of the molecule can be undone
+    int natom = molecule_->natom();
+    double** geom = block_matrix(natom,4);
+    for (int A = 0; A < natom; A++) {
+        Vector3 xyz = molecule_->xyz(A);
+        geom[A][0] = molecule_->Z(A);
+        geom[A][1] = xyz[0];
+        geom[A][2] = xyz[1];
+        geom[A][3] = xyz[2];
+    }
+    psio_->write_entry(PSIF_SCF_MOS,"NATOM",(char *)(&natom),sizeof(int));
+    psio_->write_entry(PSIF_SCF_MOS,"GEOMETRY",(char *) geom[0],4*natom*sizeof(double));
+    free_block(geom);
+
     SharedMatrix Ctemp_a(new Matrix("ALPHA MOS", nirrep_, nsopi_, nalphapi_));
     for (int h = 0; h < nirrep_; h++)
         for (int m = 0; m<nsopi_[h]; m++)
@@ -1269,6 +1308,10 @@ void HF::load_orbitals()
         soccpi_[h] = nalphapi_[h] - nbetapi_[h];
     }
 
+    SharedMatrix R;
+    if (basisname == options_.get_str("BASIS"))
+        R = load_rotation();
+
     SharedMatrix Ctemp_a(new Matrix("ALPHA MOS", nirrep_, old_nsopi, nalphapi_));
     Ctemp_a->load(psio_, PSIF_SCF_MOS, Matrix::SubBlocks);
     SharedMatrix Ca;
@@ -1276,6 +1319,7 @@ void HF::load_orbitals()
         Ca = BasisProjection(Ctemp_a, nalphapi_, dual_basis, basisset_);
     } else {
         Ca = Ctemp_a;
+        if (R) rotate_orbitals(Ca, R);
     }
     for (int h = 0; h < nirrep_; h++)
         for (int m = 0; m<nsopi_[h]; m++)
@@ -1289,6 +1333,7 @@ void HF::load_orbitals()
         Cb = BasisProjection(Ctemp_b, nbetapi_, dual_basis, basisset_);
     } else {
         Cb = Ctemp_b;
+        if (R) rotate_orbitals(Cb, R);
     }
     for (int h = 0; h < nirrep_; h++)
         for (int m = 0; m<nsopi_[h]; m++)
@@ -1299,6 +1344,139 @@ void HF::load_orbitals()
     delete[] basisnamec;
 }
 
+SharedMatrix HF::load_rotation()
+{
+    // Only the C1 SO basis is the AO basis, shell by shell
+    if (nirrep_ != 1 || !psio_->tocentry_exists(PSIF_SCF_MOS,"GEOMETRY"))
+        return SharedMatrix();
+
+    int natom = molecule_->natom();
+    int old_natom;
+    psio_->read_entry(PSIF_SCF_MOS,"NATOM",(char *)(&old_natom),sizeof(int));
+    if (old_natom != natom)
+        return SharedMatrix();
+
+    double** geom = block_matrix(natom,4);
+    psio_->read_entry(PSIF_SCF_MOS,"GEOMETRY",(char *) geom[0],4*natom*sizeof(double));
+
+    // Centroids of the real atoms; ghosts may move with the other fragment
+    double old_c[3] = {0.0, 0.0, 0.0};
+    double new_c[3] = {0.0, 0.0, 0.0};
+    int nreal = 0;
+    for (int A = 0; A < natom; A++) {
+        if (geom[A][0] != molecule_->Z(A)) {
+            free_block(geom);
+            return SharedMatrix();
+        }
+        if (molecule_->Z(A) == 0.0) continue;
+        Vector3 xyz = molecule_->xyz(A);
+        for (int k = 0; k < 3; k++) {
+            old_c[k] += geom[A][k+1];
+            new_c[k] += xyz[k];
+        }
+        nreal++;
+    }
+    if (!nreal) {
+        free_block(geom);
+        return SharedMatrix();
+    }
+    for (int k = 0; k < 3; k++) {
+        old_c[k] /= nreal;
+        new_c[k] /= nreal;
+    }
+
+    // Kabsch: H = sum old new^T = U S V^T, R = V diag(1,1,d) U^T
+    SharedMatrix H(new Matrix("H", 3, 3));
+    double** Hp = H->pointer();
+    for (int A = 0; A < natom; A++) {
+        if (molecule_->Z(A) == 0.0) continue;
+        Vector3 xyz = molecule_->xyz(A);
+        for (int k = 0; k < 3; k++)
+            for (int l = 0; l < 3; l++)
+                Hp[k][l] += (geom[A][k+1] - old_c[k]) * (xyz[l] - new_c[l]);
+    }
+
+    SharedMatrix U(new Matrix("U", 3, 3));
+    SharedMatrix Vt(new Matrix("V^T", 3, 3));
+    SharedVector S(new Vector("S", 3));
+    H->svd(U, S, Vt);
+
+    SharedMatrix R(new Matrix("R", 3, 3));
+    R->gemm(true, true, 1.0, Vt, U, 0.0);
+    double** Rp = R->pointer();
+    double det = Rp[0][0] * (Rp[1][1] * Rp[2][2] - Rp[1][2] * Rp[2][1])
+               - Rp[0][1] * (Rp[1][0] * Rp[2][2] - Rp[1][2] * Rp[2][0])
+               + Rp[0][2] * (Rp[1][0] * Rp[2][1] - Rp[1][1] * Rp[2][0]);
+    if (det < 0.0) {
+        double** Up = U->pointer();
+        double** Vtp = Vt->pointer();
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                Rp[i][j] -= 2.0 * Vtp[2][i] * Up[j][2];
+    }
+
+    // Only undo moves that kept the real atoms rigid
+    double rms = 0.0;
+    for (int A = 0; A < natom; A++) {
+        if (molecule_->Z(A) == 0.0) continue;
+        Vector3 xyz = molecule_->xyz(A);
+        for (int i = 0; i < 3; i++) {
+            double d = xyz[i] - new_c[i];
+            for (int j = 0; j < 3; j++)
+                d -= Rp[i][j] * (geom[A][j+1] - old_c[j]);
+            rms += d * d;
+        }
+    }
+    rms = sqrt(rms / nreal);
+    free_block(geom);
+
+    if (rms > 1.0E-4)
+        return SharedMatrix();
+
+    double dev = 0.0;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            dev += fabs(Rp[i][j] - (i == j ? 1.0 : 0.0));
+    if (dev < 1.0E-12)
+        return SharedMatrix();
+
+    if (print_ && (WorldComm->me() == 0))
+        fprintf(outfile,"  Rotating orbitals onto the current frame (rigid-body fit RMS %8.2E).\n", rms);
+
+    return R;
+}
+
+void HF::rotate_orbitals(SharedMatrix C, SharedMatrix R)
+{
+    SymmetryOperation so;
+    so.zero();
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            so(i,j) = R->get(i,j);
+
+    IntegralFactory factory(basisset_, basisset_, basisset_, basisset_);
+
+    double** Cp = C->pointer();
+    int nmo = C->colspi()[0];
+    for (int P = 0; P < basisset_->nshell(); P++) {
+        const GaussianShell& shell = basisset_->shell(P);
+        int am = shell.am();
+        if (am == 0) continue;
+        int nP = shell.nfunction();
+        int oP = shell.function_index();
+
+        // New coefficient of function J is sum_I r(I,J) C_I
+        ShellRotation rot = factory.shell_rotation(am, so, shell.is_pure() ? 1 : 0);
+        std::vector<double> Cold(nP * (size_t) nmo);
+        for (int I = 0; I < nP; I++)
+            ::memcpy(&Cold[I * (size_t) nmo], Cp[oP + I], nmo * sizeof(double));
+        for (int J = 0; J < nP; J++) {
+            ::memset(Cp[oP + J], '\0', nmo * sizeof(double));
+            for (int I = 0; I < nP; I++)
+                C_DAXPY(nmo, rot(I,J), &Cold[I * (size_t) nmo], 1, Cp[oP + J], 1);
+        }
+    }
+}
 
 void HF::check_phases()
 {
@@ -1520,6 +1698,8 @@ double HF::compute_energy()
 
         compute_orbital_gradient(add_to_diis_subspace);
 
+        purify_check_stall();
+
         if (diis_enabled_ == true && iteration_ >= diis_start_ + min_diis_vectors_ - 1) {
             diis_performed_ = diis();
         } else {
@@ -1556,12 +1736,36 @@ double HF::compute_energy()
 
 
 
-        timer_on("Form C");
-        form_C();
-        timer_off("Form C");
-        timer_on("Form D");
-        form_D();
-        timer_off("Form D");
+        // Once the orbital gradient is small, the occupied space only needs a small rotation
+        pseudo_diag_allowed_ = (pseudo_diag_convergence_ > 0.0 && iteration_ > 1 &&
+                                Drms_ < pseudo_diag_convergence_ && !MOM_started_ && !frac_performed_);
+        pseudo_diag_performed_ = false;
+        diag_time_ = 0.0;
+
+        purify_performed_ = false;
+        if (purify_enabled_ && iteration_ >= purify_start_ && !MOM_started_ && !frac_performed_) {
+            timer_on("Purify D");
+            purify_performed_ = purify_D();
+            timer_off("Purify D");
+            purify_Drms_ = Drms_;
+        }
+
+        if(purify_performed_){
+            if(status != "") status += "/";
+            status += "PURIFY";
+        } else {
+            timer_on("Form C");
+            form_C();
+            timer_off("Form C");
+
+            if(pseudo_diag_performed_){
+                if(status != "") status += "/";
+                status += "PDIAG";
+            }
+            timer_on("Form D");
+            form_D();
+            timer_off("Form D");
+        }
 
         Process::environment.globals["SCF ITERATION ENERGY"] = E_;
 
@@ -1582,6 +1786,9 @@ double HF::compute_energy()
         if (WorldComm->me() == 0) {
             fprintf(outfile, "   @%s%s iter %3d: %20.14f   %12.5e   %-11.5e %s\n", df ? "DF-" : "",
                               reference.c_str(), iteration_, E_, E_ - Eold_, Drms_, status.c_str());
+            if (print_ > 1 || diag_driver_ != dsyev_driver || diag_nthread_ > 1 || pseudo_diag_convergence_ > 0.0)
+                fprintf(outfile, "      Fock diagonalization: %-6s %10.3f s\n",
+                        pseudo_diag_performed_ ? "PSEUDO" : options_.get_str("DIAG_SOLVER").c_str(), diag_time_);
             fflush(outfile);
         }
 
@@ -1608,6 +1815,16 @@ double HF::compute_energy()
 
     } while (!converged && iteration_ < maxiter_ );
 
+    Process::environment.globals["SCF ITERATIONS"] = iteration_;
+
+    // Pseudo-diagonalized or purified orbitals are not canonical; finish with a full diagonalization
+    if (pseudo_diag_performed_ || purify_performed_) {
+        pseudo_diag_allowed_ = false;
+        purify_performed_ = false;
+        form_C();
+        form_D();
+    }
+
     if (WorldComm->me() == 0)
         fprintf(outfile, "\n  ==> Post-Iterations <==\n\n");
 
@@ -1773,15 +1990,80 @@ void HF::print_occupation()
 
 void HF::diagonalize_F(const SharedMatrix& Fm, SharedMatrix& Cm, boost::shared_ptr<Vector>& epsm)
 {
+    Timer diag_timer;
+
+    // Late iterations: rotate the current orbitals instead of diagonalizing
+    if (pseudo_diag_allowed_ && (Cm == Ca_ || Cm == Cb_)) {
+        if (pseudo_diagonalize_F(Fm, Cm, epsm, Cm == Ca_ ? nalphapi_ : nbetapi_)) {
+            pseudo_diag_performed_ = true;
+            diag_time_ += diag_timer.get();
+            return;
+        }
+    }
+
     //Form F' = X'FX for canonical orthogonalization
     diag_temp_->gemm(true, false, 1.0, X_, Fm, 0.0);
     diag_F_temp_->gemm(false, false, 1.0, diag_temp_, X_, 0.0);
 
     //Form C' = eig(F')
-    diag_F_temp_->diagonalize(diag_C_temp_, epsm);
+    diag_F_temp_->diagonalize(diag_C_temp_, epsm, ascending, diag_driver_, diag_nthread_);
 
     //Form C = XC'
     Cm->gemm(false, false, 1.0, X_, diag_C_temp_, 0.0);
+
+    diag_time_ += diag_timer.get();
+}
+
+bool HF::pseudo_diagonalize_F(const SharedMatrix& Fm, SharedMatrix& Cm, boost::shared_ptr<Vector>& epsm, const Dimension& noccpi)
+{
+    //Form F(MO) = C'FC in the current orbital basis
+    diag_temp_->gemm(true, false, 1.0, Cm, Fm, 0.0);
+    diag_F_temp_->gemm(false, false, 1.0, diag_temp_, Cm, 0.0);
+
+    // The rotations are only small if every occupied level lies below every virtual one
+    for (int h = 0; h < nirrep_; ++h) {
+        int nmo = nmopi_[h];
+        int nocc = noccpi[h];
+        double** Fp = diag_F_temp_->pointer(h);
+        for (int i = 0; i < nocc; ++i)
+            for (int a = nocc; a < nmo; ++a)
+                if (Fp[i][i] >= Fp[a][a]) return false;
+    }
+
+    for (int h = 0; h < nirrep_; ++h) {
+        int nso = nsopi_[h];
+        int nmo = nmopi_[h];
+        int nocc = noccpi[h];
+        if (nso == 0 || nmo == 0) continue;
+
+        double** Fp = diag_F_temp_->pointer(h);
+        double** Cp = Cm->pointer(h);
+        double* ep = epsm->pointer(h);
+
+        for (int p = 0; p < nmo; ++p)
+            ep[p] = Fp[p][p];
+
+        // One Jacobi rotation per occupied-virtual pair, using the unrotated couplings
+        for (int i = 0; i < nocc; ++i) {
+            for (int a = nocc; a < nmo; ++a) {
+                double Fia = Fp[i][a];
+                if (fabs(Fia) < 1.0E-14) continue;
+
+                double theta = 0.5 * atan(2.0 * Fia / (ep[i] - ep[a]));
+                double c = cos(theta);
+                double s = sin(theta);
+
+                C_DROT(nso, &Cp[0][i], nmo, &Cp[0][a], nmo, c, s);
+
+                double ei = ep[i];
+                double ea = ep[a];
+                ep[i] = c * c * ei + 2.0 * c * s * Fia + s * s * ea;
+                ep[a] = s * s * ei - 2.0 * c * s * Fia + c * c * ea;
+            }
+        }
+    }
+
+    return true;
 }
 
 void HF::reset_SAD_occupation()
@@ -37,6 +37,7 @@
 #include <libmints/wavefunction.h>
 #include <libmints/basisset.h>
 #include <libmints/vector.h>
+#include <libmints/matrix.h>
 #include <libdiis/diismanager.h>
 #include <libdiis/diisentry.h>
 #include <psi4-dec.h>
@@ -70,6 +71,36 @@ protected:
     /// Temporary matrix for diagonalize_F
     SharedMatrix diag_C_temp_;
 
+    /// LAPACK driver used by diagonalize_F
+    diagonalize_driver diag_driver_;
+    /// Number of irrep blocks diagonalize_F may treat concurrently
+    int diag_nthread_;
+    /// Orbital gradient below which diagonalize_F only rotates the occupied space
+    double pseudo_diag_convergence_;
+    /// Whether pseudo-diagonalization may be used for this iteration
+    bool pseudo_diag_allowed_;
+    /// Whether pseudo-diagonalization was performed this iteration
+    bool pseudo_diag_performed_;
+    /// Wall time (seconds) spent in diagonalize_F this iteration
+    double diag_time_;
+
+    /// Whether density purification may still be used
+    bool purify_enabled_;
+    /// The iteration to start density purification
+    int purify_start_;
+    /// Maximum number of purification steps per SCF iteration
+    int purify_maxiter_;
+    /// Idempotency threshold, tr(P - P^2), for purification
+    double purify_convergence_;
+    /// Number of purified iterations without a decrease in the orbital gradient before giving up
+    int purify_max_stalls_;
+    /// Current number of consecutive stalled purified iterations
+    int purify_stalls_;
+    /// Orbital gradient at the last purified iteration
+    double purify_Drms_;
+    /// Whether purification was performed this iteration
+    bool purify_performed_;
+
     /// Old C Alpha matrix (if needed for MOM)
     SharedMatrix Ca_old_;
     /// Old C Beta matrix (if needed for MOM)
@@ -295,6 +326,11 @@ protected:
     /** Transformation, diagonalization, and backtransform of Fock matrix */
     virtual void diagonalize_F(const SharedMatrix& F, SharedMatrix& C, boost::shared_ptr<Vector>& eps);
 
+    /** Zeros the occupied-virtual block of F in the basis of the current C by
+     *  Jacobi rotations, instead of a full diagonalization. Returns false
+     *  (leaving C and eps untouched) if the occupied and virtual levels overlap. */
+    bool pseudo_diagonalize_F(const SharedMatrix& F, SharedMatrix& C, boost::shared_ptr<Vector>& eps, const Dimension& noccpi);
+
     /** Computes the Fock matrix */
     virtual void form_F() =0;
 
@@ -322,6 +358,19 @@ protected:
     /** Performs DIIS extrapolation */
     virtual bool diis() { return false; }
 
+    /** Forms D (and the occupied part of C) by density purification instead of
+     *  diagonalization. Returns false if the iteration should diagonalize instead. */
+    virtual bool purify_D() { return false; }
+
+    /** Canonical purification of F into a density D with noccpi electrons per irrep */
+    bool purify_density(const SharedMatrix& F, SharedMatrix& D, const Dimension& noccpi);
+
+    /** Overwrites the occupied columns of C with a Cholesky factor of D */
+    bool occupied_from_density(const SharedMatrix& D, SharedMatrix& C, const Dimension& noccpi);
+
+    /** Disables purification once the orbital gradient stops decreasing */
+    void purify_check_stall();
+
     /** Form Fia (for DIIS) **/
     virtual SharedMatrix form_Fia(SharedMatrix Fso, SharedMatrix Cso, int* noccpi);
 
@@ -334,6 +383,13 @@ protected:
     /** Load orbitals from previous computation, projecting if needed **/
     virtual void load_orbitals();
 
+    /** Rotation taking the saved orbitals onto the current frame, if the
+        real atoms moved as a rigid body since they were saved **/
+    SharedMatrix load_rotation();
+
+    /** C <- R C, shell by shell **/
+    void rotate_orbitals(SharedMatrix C, SharedMatrix R);
+
     /** Save SAPT info (TODO: Move to Python driver **/
     virtual void save_sapt_info() {}
 
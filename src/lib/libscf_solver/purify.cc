@@ -0,0 +1,187 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+/*
+ * purify.cc. Diagonalization-free density updates.
+ * The way this works:
+ * 1) From PURIFY_START on, form_C/form_D are replaced by purify_D, which runs
+ *    canonical (trace-conserving) purification of X'FX into the density X'DX
+ *    at fixed occupations per irrep (Palser and Manolopoulos, PRB 58, 12704 (1998)).
+ * 2) The occupied columns of C are overwritten with a pivoted Cholesky factor
+ *    of D, so the JK object and DIIS keep working on C_occ/D as usual.
+ *    The virtual columns of C are stale while purification is active.
+ * 3) If purification fails, the iteration falls back to diagonalization. If the
+ *    orbital gradient stops decreasing for PURIFY_MAX_STALLS purified iterations,
+ *    purification is switched off for the rest of the SCF.
+ * 4) A full diagonalization always follows the last purified iteration, so the
+ *    final orbitals are canonical.
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <libmints/mints.h>
+#include <libqt/qt.h>
+#include <libparallel/parallel.h>
+
+#include "hf.h"
+
+using namespace boost;
+using namespace std;
+using namespace psi;
+
+namespace psi { namespace scf {
+
+bool HF::purify_density(const SharedMatrix& Fm, SharedMatrix& Dm, const Dimension& noccpi)
+{
+    //Form F' = X'FX in the orthonormal basis
+    diag_temp_->gemm(true, false, 1.0, X_, Fm, 0.0);
+    diag_F_temp_->gemm(false, false, 1.0, diag_temp_, X_, 0.0);
+
+    for (int h = 0; h < nirrep_; ++h) {
+        int n = nmopi_[h];
+        int nso = nsopi_[h];
+        int nocc = noccpi[h];
+        if (n == 0 || nso == 0) continue;
+
+        double** Fp = diag_F_temp_->pointer(h);
+        // The purified density X'DX, stored in diag_C_temp_
+        double** Pp = diag_C_temp_->pointer(h);
+
+        if (nocc == 0 || nocc == n) {
+            ::memset(static_cast<void*>(Pp[0]), '\0', sizeof(double) * n * n);
+            if (nocc == n)
+                for (int p = 0; p < n; ++p)
+                    Pp[p][p] = 1.0;
+            continue;
+        }
+
+        // Gershgorin bounds on the spectrum of F'
+        double emin = Fp[0][0];
+        double emax = Fp[0][0];
+        double mu = 0.0;
+        for (int p = 0; p < n; ++p) {
+            double radius = 0.0;
+            for (int q = 0; q < n; ++q)
+                if (q != p) radius += fabs(Fp[p][q]);
+            emin = min(emin, Fp[p][p] - radius);
+            emax = max(emax, Fp[p][p] + radius);
+            mu += Fp[p][p];
+        }
+        mu /= (double) n;
+
+        double lambda = min(nocc / (emax - mu), (n - nocc) / (mu - emin));
+
+        // Initial guess with eigenvalues in [0,1] and trace nocc
+        for (int p = 0; p < n; ++p) {
+            for (int q = 0; q < n; ++q)
+                Pp[p][q] = -lambda / n * Fp[p][q];
+            Pp[p][p] += lambda / n * mu + nocc / (double) n;
+        }
+
+        std::vector<double> P2((size_t)n * n);
+        std::vector<double> P3((size_t)n * n);
+
+        bool converged = false;
+        for (int iter = 0; iter < purify_maxiter_; ++iter) {
+            C_DGEMM('N','N',n,n,n,1.0,Pp[0],n,Pp[0],n,0.0,&P2[0],n);
+            C_DGEMM('N','N',n,n,n,1.0,&P2[0],n,Pp[0],n,0.0,&P3[0],n);
+
+            double tP = 0.0, tP2 = 0.0, tP3 = 0.0;
+            for (int p = 0; p < n; ++p) {
+                tP  += Pp[p][p];
+                tP2 += P2[(size_t)p * n + p];
+                tP3 += P3[(size_t)p * n + p];
+            }
+
+            // tr(P - P^2) vanishes only for an idempotent P
+            if (fabs(tP - tP2) < purify_convergence_) {
+                converged = true;
+                break;
+            }
+
+            double c = (tP2 - tP3) / (tP - tP2);
+            if (c < 0.0 || c > 1.0) break;
+
+            double* P = Pp[0];
+            if (c >= 0.5) {
+                for (size_t pq = 0; pq < (size_t)n * n; ++pq)
+                    P[pq] = ((1.0 + c) * P2[pq] - P3[pq]) / c;
+            } else {
+                for (size_t pq = 0; pq < (size_t)n * n; ++pq)
+                    P[pq] = ((1.0 - 2.0 * c) * P[pq] + (1.0 + c) * P2[pq] - P3[pq]) / (1.0 - c);
+            }
+        }
+
+        if (!converged) return false;
+    }
+
+    //Form D = XPX'
+    diag_temp_->gemm(false, true, 1.0, diag_C_temp_, X_, 0.0);
+    Dm->gemm(false, false, 1.0, X_, diag_temp_, 0.0);
+
+    return true;
+}
+
+bool HF::occupied_from_density(const SharedMatrix& Dm, SharedMatrix& Cm, const Dimension& noccpi)
+{
+    // D = LL' with L'SL = 1 for an idempotent D, so L is a valid set of occupied orbitals
+    SharedMatrix L = Dm->partial_cholesky_factorize(1.0E-10);
+
+    for (int h = 0; h < nirrep_; ++h)
+        if (L->colspi()[h] != noccpi[h]) return false;
+
+    for (int h = 0; h < nirrep_; ++h) {
+        int nso = nsopi_[h];
+        int nocc = noccpi[h];
+        if (nso == 0 || nocc == 0) continue;
+
+        double** Lp = L->pointer(h);
+        double** Cp = Cm->pointer(h);
+        for (int m = 0; m < nso; ++m)
+            ::memcpy(static_cast<void*>(Cp[m]), static_cast<void*>(Lp[m]), sizeof(double) * nocc);
+    }
+
+    return true;
+}
+
+void HF::purify_check_stall()
+{
+    if (!purify_performed_) return;
+
+    if (Drms_ >= purify_Drms_)
+        purify_stalls_++;
+    else
+        purify_stalls_ = 0;
+
+    if (purify_stalls_ >= purify_max_stalls_) {
+        purify_enabled_ = false;
+        if (WorldComm->me() == 0)
+            fprintf(outfile, "    Density purification stalled, falling back to diagonalization.\n");
+    }
+}
+
+}} // Namespaces
@@ -244,6 +244,20 @@ void RHF::form_D()
     }
 }
 
+bool RHF::purify_D()
+{
+    if (!purify_density(Fa_, D_, doccpi_))
+        return false;
+    if (!occupied_from_density(D_, Ca_, doccpi_))
+        return false;
+
+    if (debug_) {
+        fprintf(outfile, "in RHF::purify_D:\n");
+        D_->print();
+    }
+    return true;
+}
+
 void RHF::damp_update()
 {
     for(int h = 0; h < nirrep_; ++h){
@@ -60,6 +60,7 @@ protected:
 
     void form_C();
     void form_D();
+    virtual bool purify_D();
     virtual void damp_update();
     double compute_initial_E();
     virtual double compute_E();
@@ -232,6 +232,24 @@ void UHF::form_D()
     }
 }
 
+bool UHF::purify_D()
+{
+    if (!purify_density(Fa_, Da_, nalphapi_) || !purify_density(Fb_, Db_, nbetapi_))
+        return false;
+    if (!occupied_from_density(Da_, Ca_, nalphapi_) || !occupied_from_density(Db_, Cb_, nbetapi_))
+        return false;
+
+    Dt_->copy(Da_);
+    Dt_->add(Db_);
+
+    if (debug_) {
+        fprintf(outfile, "in UHF::purify_D:\n");
+        Da_->print();
+        Db_->print();
+    }
+    return true;
+}
+
 // TODO: Once Dt_ is refactored to D_ the only difference between this and RHF::compute_initial_E is a factor of 0.5
 double UHF::compute_initial_E()
 {
@@ -43,6 +43,7 @@ protected:
     void form_initialF();
     void form_C();
     void form_D();
+    virtual bool purify_D();
     double compute_initial_E();
     virtual double compute_E();
     virtual void stability_analysis();
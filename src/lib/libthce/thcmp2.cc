@@ -0,0 +1,339 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+
+#include <cmath>
+#include <vector>
+#include <libmints/mints.h>
+#include <libfock/cubature.h>
+#include <libfock/points.h>
+#include <libqt/qt.h>
+#include "thce.h"
+#include "thcmp2.h"
+#include <psi4-dec.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef HAVE_MKL
+#include <mkl.h>
+#endif
+
+using namespace boost;
+
+namespace psi {
+
+RTHCMP2::RTHCMP2() :
+    RTHCEW()
+{
+    common_init();
+}
+RTHCMP2::~RTHCMP2()
+{
+}
+void RTHCMP2::common_init()
+{
+    energies_["Reference Energy"] = reference_wavefunction_->reference_energy();
+}
+void RTHCMP2::print_header()
+{
+    fprintf(outfile, "\t --------------------------------------------------------\n");
+    fprintf(outfile, "\t                        THC-SOS-MP2                      \n");
+    fprintf(outfile, "\t --------------------------------------------------------\n\n");
+    fprintf(outfile, "\t %-12s %12s\n", "Dimension", "Size");
+    fprintf(outfile, "\t %-12s %12d\n", "naocc", thce_->dimensions()["naocc"]);
+    fprintf(outfile, "\t %-12s %12d\n", "navir", thce_->dimensions()["navir"]);
+    fprintf(outfile, "\n");
+    fflush(outfile);
+}
+double RTHCMP2::compute_energy()
+{
+    print_header();
+
+    timer_on("THCMP2 Laplace");
+    build_laplace(options_.get_double("DFMP2_LAPLACE_TOLERANCE"));
+    timer_off("THCMP2 Laplace");
+
+    timer_on("THCMP2 Grid");
+    boost::shared_ptr<Matrix> X = build_grid();
+    timer_off("THCMP2 Grid");
+
+    boost::shared_ptr<BasisSetParser> parser(new Gaussian94BasisSetParser());
+    boost::shared_ptr<BasisSet> auxiliary = BasisSet::construct(parser, molecule_, "DF_BASIS_MP2");
+
+    timer_on("THCMP2 LS-THC");
+    build_lsthc_ia(auxiliary, X);
+    timer_off("THCMP2 LS-THC");
+    X.reset();
+
+    timer_on("THCMP2 Energy");
+    form_energy();
+    timer_off("THCMP2 Energy");
+
+    print_energies();
+
+    return energies_["Total Energy"];
+}
+boost::shared_ptr<Matrix> RTHCMP2::build_grid()
+{
+    boost::shared_ptr<PseudospectralGrid> grid(new PseudospectralGrid(molecule_, basisset_, options_));
+    int npoints = grid->npoints();
+    int nbf = basisset_->nbf();
+    int max_points = grid->max_points();
+    int max_functions = grid->max_functions();
+    double* w = grid->w();
+
+    fprintf(outfile, "\t Pseudospectral grid points = %d\n\n", npoints);
+    fflush(outfile);
+
+    // Collocation, one block at a time as in PSJK
+    boost::shared_ptr<Matrix> X(new Matrix("X", nbf, npoints));
+    double** Xp = X->pointer();
+    boost::shared_ptr<BasisFunctions> points(new BasisFunctions(basisset_, max_points, max_functions));
+    const std::vector<boost::shared_ptr<BlockOPoints> >& blocks = grid->blocks();
+    int offset = 0;
+    for (size_t index = 0; index < blocks.size(); index++) {
+        points->compute_functions(blocks[index]);
+        SharedMatrix phi = points->basis_value("PHI");
+        double** phip = phi->pointer();
+        const std::vector<int>& funmap = blocks[index]->functions_local_to_global();
+        int nP = blocks[index]->npoints();
+
+        for (size_t i = 0; i < funmap.size(); i++) {
+            int iglobal = funmap[i];
+            C_DCOPY(nP,&phip[0][i],max_functions,&Xp[iglobal][offset],1);
+        }
+
+        offset += nP;
+    }
+
+    // Quarter-power weights, so that products of four X's carry one weight
+    for (int P = 0; P < npoints; P++) {
+        C_DSCAL(nbf,pow(w[P],0.25),&Xp[0][P],npoints);
+    }
+
+    return X;
+}
+void RTHCMP2::form_E(int w, double* T, double* E, double* Ea)
+{
+    boost::shared_ptr<Tensor> pi_i = (*thce_)["pi_i"];
+    boost::shared_ptr<Tensor> pi_a = (*thce_)["pi_a"];
+    boost::shared_ptr<Tensor> Xi = (*thce_)["Xi"];
+    boost::shared_ptr<Tensor> Xa = (*thce_)["Xa"];
+
+    int naocc = thce_->dimensions()["naocc"];
+    int navir = thce_->dimensions()["navir"];
+    int ngrid = thce_->dimensions()["ngrid"];
+    size_t ngrid2 = ngrid * (size_t) ngrid;
+
+    double* pip = pi_i->pointer();
+    double* pap = pi_a->pointer();
+    double* Xip = Xi->pointer();
+    double* Xap = Xa->pointer();
+
+    // Ei_PQ = X_i^P pi_i^w X_i^Q
+    for (int i = 0; i < naocc; i++) {
+        for (int P = 0; P < ngrid; P++) {
+            T[i * (size_t) ngrid + P] = pip[w * naocc + i] * Xip[i * (size_t) ngrid + P];
+        }
+    }
+    C_DGEMM('T','N',ngrid,ngrid,naocc,1.0,T,ngrid,Xip,ngrid,0.0,E,ngrid);
+
+    // Ea_PQ = X_a^P pi_a^w X_a^Q
+    for (int a = 0; a < navir; a++) {
+        for (int P = 0; P < ngrid; P++) {
+            T[a * (size_t) ngrid + P] = pap[w * navir + a] * Xap[a * (size_t) ngrid + P];
+        }
+    }
+    C_DGEMM('T','N',ngrid,ngrid,navir,1.0,T,ngrid,Xap,ngrid,0.0,Ea,ngrid);
+
+    // E = Ei o Ea
+    for (size_t PQ = 0L; PQ < ngrid2; PQ++) {
+        E[PQ] *= Ea[PQ];
+    }
+}
+double RTHCMP2::trace_square(double* EZ)
+{
+    int ngrid = thce_->dimensions()["ngrid"];
+
+    double val = 0.0;
+    for (int P = 0; P < ngrid; P++) {
+        val += C_DDOT(ngrid,&EZ[P * (size_t) ngrid],1,&EZ[P],ngrid);
+    }
+    return val;
+}
+void RTHCMP2::form_energy()
+{
+    int nw    = thce_->dimensions()["nw"];
+    int naocc = thce_->dimensions()["naocc"];
+    int navir = thce_->dimensions()["navir"];
+    int ngrid = thce_->dimensions()["ngrid"];
+
+    size_t ngrid2 = ngrid * (size_t) ngrid;
+    int nmax = (naocc > navir ? naocc : navir);
+
+    // => Memory <= //
+
+    // Z is already in core; T, E, and Ea/EZ per concurrent quadrature point
+    size_t doubles = (size_t) (0.9 * memory_ / 8L);
+    size_t per_w = nmax * (size_t) ngrid + 2L * ngrid2;
+
+    int nthread = 1;
+    #ifdef _OPENMP
+        nthread = omp_get_max_threads();
+    #endif
+
+    int nwthread = 0;
+    if (doubles > ngrid2) {
+        size_t max_w = (doubles - ngrid2) / per_w;
+        nwthread = (max_w < (size_t) nthread ? (int) max_w : nthread);
+        nwthread = (nwthread < nw ? nwthread : nw);
+    }
+
+    double e_os = 0.0;
+
+    if (nwthread > 0) {
+
+        // => Core Z, one quadrature point per thread <= //
+
+        boost::shared_ptr<Tensor> Z = (*thce_)["Ziaia"];
+        bool swapped = Z->swapped();
+        if (swapped) Z->swap_in();
+        double* Zp = Z->pointer();
+
+        std::vector<std::vector<double> > T(nwthread);
+        std::vector<std::vector<double> > E(nwthread);
+        std::vector<std::vector<double> > Ea(nwthread);
+        for (int thread = 0; thread < nwthread; thread++) {
+            T[thread].resize(nmax * (size_t) ngrid);
+            E[thread].resize(ngrid2);
+            Ea[thread].resize(ngrid2);
+        }
+
+        fprintf(outfile, "\t Contracting %d quadrature points on %d threads.\n\n", nw, nwthread);
+        fflush(outfile);
+
+#ifdef HAVE_MKL
+        int old_threads = mkl_get_max_threads();
+        if (nwthread > 1) mkl_set_num_threads(1);
+#endif
+
+        #pragma omp parallel for schedule(dynamic) num_threads(nwthread) reduction(+: e_os)
+        for (int w = 0; w < nw; w++) {
+            int thread = 0;
+            #ifdef _OPENMP
+                thread = omp_get_thread_num();
+            #endif
+
+            form_E(w,&T[thread][0],&E[thread][0],&Ea[thread][0]);
+
+            // E_os -= (E Z) . (Z E) = tr(E Z E Z), E and Z being symmetric
+            C_DGEMM('N','N',ngrid,ngrid,ngrid,1.0,&E[thread][0],ngrid,Zp,ngrid,0.0,&Ea[thread][0],ngrid);
+            e_os -= trace_square(&Ea[thread][0]);
+        }
+
+#ifdef HAVE_MKL
+        mkl_set_num_threads(old_threads);
+#endif
+
+        if (swapped) Z->swap_out();
+
+    } else {
+
+        // => Disk Z, streamed in row blocks for each quadrature point <= //
+
+        size_t min_doubles = per_w + ngrid;
+        if (doubles < min_doubles) {
+            throw PSIEXCEPTION("THCMP2: Out of memory for the energy contraction.");
+        }
+        int max_rows = (int) ((doubles - per_w) / ngrid);
+        max_rows = (max_rows > ngrid ? ngrid : max_rows);
+
+        // Move Z to disk before the scratch is allocated
+        boost::shared_ptr<Tensor> Zd = DiskTensor::build("Ziaia Disk","ngrid",ngrid,"ngrid",ngrid,false,false);
+        {
+            boost::shared_ptr<Tensor> Z = (*thce_)["Ziaia"];
+            bool swapped = Z->swapped();
+            if (swapped) Z->swap_in();
+            FILE* fh = Zd->file_pointer();
+            if (fwrite(Z->pointer(),sizeof(double),ngrid2,fh) != ngrid2) {
+                throw PSIEXCEPTION("THCMP2: Short write of Z to disk.");
+            }
+            fflush(fh);
+        }
+        thce_->delete_tensor("Ziaia");
+        thce_->add_tensor("Ziaia",Zd);
+
+        std::vector<double> T(nmax * (size_t) ngrid);
+        std::vector<double> E(ngrid2);
+        std::vector<double> EZ(ngrid2);
+        std::vector<double> Zb(max_rows * (size_t) ngrid);
+
+        fprintf(outfile, "\t Streaming Z from disk in blocks of %d rows.\n\n", max_rows);
+        fflush(outfile);
+
+        FILE* fh = Zd->file_pointer();
+        for (int w = 0; w < nw; w++) {
+            form_E(w,&T[0],&E[0],&EZ[0]);
+
+            // EZ = \sum_R E_PR Z_RQ, one block of rows R at a time
+            fseek(fh,0L,SEEK_SET);
+            for (int R = 0; R < ngrid; R += max_rows) {
+                int nR = (R + max_rows > ngrid ? ngrid - R : max_rows);
+                if (fread(&Zb[0],sizeof(double),nR * (size_t) ngrid,fh) != nR * (size_t) ngrid) {
+                    throw PSIEXCEPTION("THCMP2: Short read of Z from disk.");
+                }
+                C_DGEMM('N','N',ngrid,ngrid,nR,1.0,&E[R],ngrid,&Zb[0],ngrid,(R ? 1.0 : 0.0),&EZ[0],ngrid);
+            }
+
+            e_os -= trace_square(&EZ[0]);
+        }
+    }
+
+    energies_["Opposite-Spin Energy"] = e_os;
+}
+void RTHCMP2::print_energies()
+{
+    double os_scale = options_.get_double("MP2_OS_SCALE");
+
+    energies_["Correlation Energy"] = os_scale * energies_["Opposite-Spin Energy"];
+    energies_["Total Energy"] = energies_["Reference Energy"] + energies_["Correlation Energy"];
+
+    fprintf(outfile, "\t----------------------------------------------------------\n");
+    fprintf(outfile, "\t ================> THC-SOS-MP2 Energies <================ \n");
+    fprintf(outfile, "\t----------------------------------------------------------\n");
+    fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Reference Energy",         energies_["Reference Energy"]);
+    fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Opposite-Spin Energy",     energies_["Opposite-Spin Energy"]);
+    fprintf(outfile, "\t %-25s = %24.16f [-]\n", "Opposite-Spin Scale",      os_scale);
+    fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Correlation Energy",       energies_["Correlation Energy"]);
+    fprintf(outfile, "\t %-25s = %24.16f [H]\n", "Total Energy",             energies_["Total Energy"]);
+    fprintf(outfile, "\t----------------------------------------------------------\n");
+    fprintf(outfile, "\n");
+    fflush(outfile);
+
+    Process::environment.globals["CURRENT ENERGY"] = energies_["Total Energy"];
+    Process::environment.globals["CURRENT CORRELATION ENERGY"] = energies_["Correlation Energy"];
+    Process::environment.globals["MP2 OPPOSITE-SPIN CORRELATION ENERGY"] = energies_["Opposite-Spin Energy"];
+    Process::environment.globals["SOS-MP2 TOTAL ENERGY"] = energies_["Total Energy"];
+    Process::environment.globals["SOS-MP2 CORRELATION ENERGY"] = energies_["Correlation Energy"];
+}
+
+} // End namespace
@@ -0,0 +1,77 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *@END LICENSE
+ */
+
+
+#ifndef THCMP2_H
+#define THCMP2_H
+
+#include "thcew.h"
+
+namespace psi {
+
+class Matrix;
+
+/**
+ * RTHCMP2 computes the RHF THC-SOS-MP2 opposite-spin energy
+ *
+ * (ia|jb) is taken in LS-THC form X_i^P X_a^P Z_PQ X_j^Q X_b^Q on the
+ * pseudospectral grid, and the denominator in Laplace form
+ * \sum_w pi_i^w pi_a^w pi_j^w pi_b^w, so that
+ *
+ * E_os = - \sum_w (E^w Z) . (Z E^w),  E^w_PQ = (X_i^P pi_i^w X_i^Q)(X_a^P pi_a^w X_a^Q)
+ *
+ * which is O(N_w N_grid^2 (o + v + N_grid)). Z and E^w are symmetric, so
+ * Z E^w = (E^w Z)^T and one grid-sized DGEMM per quadrature point suffices.
+ *
+ * The quadrature points are distributed over the threads if the per-thread
+ * E^w and (E^w Z) fit in memory next to Z. Otherwise Z is moved to a
+ * DiskTensor and streamed in blocks of rows for each quadrature point.
+ *
+ * The same-spin energy has no quartic THC form and is not computed.
+ **/
+class RTHCMP2 : public RTHCEW {
+
+protected:
+
+    void common_init();
+    void print_header();
+
+    /// Primary basis on the pseudospectral grid, nso x ngrid, scaled by w^1/4
+    boost::shared_ptr<Matrix> build_grid();
+    /// E^w into E, using T (nmax x ngrid) and Ea (ngrid x ngrid) as scratch
+    void form_E(int w, double* T, double* E, double* Ea);
+    /// tr(A A) of an ngrid x ngrid matrix A
+    double trace_square(double* A);
+    /// E_os from the pi_i, pi_a, Xi, Xa, and Ziaia tensors
+    void form_energy();
+    void print_energies();
+
+public:
+    RTHCMP2();
+    virtual ~RTHCMP2();
+
+    virtual double compute_energy();
+};
+
+} // End namespace
+
+#endif
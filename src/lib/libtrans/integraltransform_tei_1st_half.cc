@@ -33,6 +33,12 @@
 #include "mospace.h"
 #define EXTERN
 #include <libdpd/dpd.gbl>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef HAVE_MKL
+#include <mkl.h>
+#endif
 
 using namespace psi;
 using namespace boost;
@@ -68,7 +74,24 @@ IntegralTransform::transform_tei_first_half(const shared_ptr<MOSpace> s1, const
     size_t rowsLeft;
     size_t memFree;
 
-    double **TMP = block_matrix(nso_, nso_);
+    // One scratch matrix per thread; the rows of a bucket are transformed in parallel.
+    // The scratch matrices are charged to the DPD memory, so the buckets shrink to make
+    // room for them, and fewer threads are used if they would take more than half of it.
+    int nthread = 1;
+#ifdef _OPENMP
+    nthread = omp_get_max_threads();
+#endif
+    long int nso2 = (long int) nso_ * (long int) nso_;
+    while(nthread > 1 && nthread * nso2 > dpd_memfree() / 2) nthread--;
+    double ***thread_TMP = new double**[nthread];
+    for(int t=0; t < nthread; t++)
+        thread_TMP[t] = global_dpd_->dpd_block_matrix(nso_, nso_);
+
+    // The DGEMMs run inside the threaded loops, so keep the BLAS serial
+#ifdef HAVE_MKL
+    int old_threads = mkl_get_max_threads();
+    if(nthread > 1) mkl_set_num_threads(1);
+#endif
 
     /*** AA/AB two-electron integral transformation ***/
 
@@ -129,7 +152,13 @@ IntegralTransform::transform_tei_first_half(const shared_ptr<MOSpace> s1, const
             else
                 thisBucketRows = (n < nBuckets-1) ? rowsPerBucket : rowsLeft;
             global_dpd_->buf4_mat_irrep_rd_block(&J, h, n*rowsPerBucket, thisBucketRows);
+            #pragma omp parallel for schedule(static) num_threads(nthread)
             for(int pq=0; pq < thisBucketRows; pq++) {
+                int thread = 0;
+#ifdef _OPENMP
+                thread = omp_get_thread_num();
+#endif
+                double **TMP = thread_TMP[thread];
                 for(int Gr=0; Gr < nirreps_; Gr++) {
                     // Transform ( n n | n n ) -> ( n n | n S2 )
                     int Gs = h^Gr;
@@ -242,7 +271,13 @@ IntegralTransform::transform_tei_first_half(const shared_ptr<MOSpace> s1, const
                 else
                     thisBucketRows = (n < nBuckets-1) ? rowsPerBucket : rowsLeft;
                 global_dpd_->buf4_mat_irrep_rd_block(&J, h, n*rowsPerBucket, thisBucketRows);
+                #pragma omp parallel for schedule(static) num_threads(nthread)
                 for(int pq=0; pq < thisBucketRows; pq++) {
+                    int thread = 0;
+#ifdef _OPENMP
+                    thread = omp_get_thread_num();
+#endif
+                    double **TMP = thread_TMP[thread];
                     for(int Gr=0; Gr < nirreps_; Gr++) {
                         // Transform ( n n | n n ) -> ( n n | n s2 )
                         int Gs = h^Gr;
@@ -303,7 +338,12 @@ IntegralTransform::transform_tei_first_half(const shared_ptr<MOSpace> s1, const
 
     psio_->close(PSIF_SO_PRESORT, keepDpdSoInts_);
 
-    free_block(TMP);
+#ifdef HAVE_MKL
+    mkl_set_num_threads(old_threads);
+#endif
+    for(int t=0; t < nthread; t++)
+        global_dpd_->free_dpd_block(thread_TMP[t], nso_, nso_);
+    delete [] thread_TMP;
     delete [] label;
 
     if(print_){
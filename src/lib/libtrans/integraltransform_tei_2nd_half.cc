@@ -33,6 +33,12 @@
 #include "mospace.h"
 #define EXTERN
 #include <libdpd/dpd.gbl>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef HAVE_MKL
+#include <mkl.h>
+#endif
 
 using namespace psi;
 using namespace boost;
@@ -82,7 +88,24 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
     size_t memFree;
     dpdbuf4 J, K;
 
-    double **TMP = block_matrix(nso_, nso_);
+    // One scratch matrix per thread; the rows of a bucket are transformed in parallel.
+    // The scratch matrices are charged to the DPD memory, so the buckets shrink to make
+    // room for them, and fewer threads are used if they would take more than half of it.
+    int nthread = 1;
+#ifdef _OPENMP
+    nthread = omp_get_max_threads();
+#endif
+    long int nso2 = (long int) nso_ * (long int) nso_;
+    while(nthread > 1 && nthread * nso2 > dpd_memfree() / 2) nthread--;
+    double ***thread_TMP = new double**[nthread];
+    for(int t=0; t < nthread; t++)
+        thread_TMP[t] = global_dpd_->dpd_block_matrix(nso_, nso_);
+
+    // The DGEMMs run inside the threaded loops, so keep the BLAS serial
+#ifdef HAVE_MKL
+    int old_threads = mkl_get_max_threads();
+    if(nthread > 1) mkl_set_num_threads(1);
+#endif
 
     if(print_) {
         if(transformationType_ == Restricted){
@@ -154,7 +177,13 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
             else
                 thisBucketRows = (n < nBuckets-1) ? rowsPerBucket : rowsLeft;
             global_dpd_->buf4_mat_irrep_rd_block(&J, h, n*rowsPerBucket, thisBucketRows);
+            #pragma omp parallel for schedule(static) num_threads(nthread)
             for(int pq=0; pq < thisBucketRows; pq++) {
+                int thread = 0;
+#ifdef _OPENMP
+                thread = omp_get_thread_num();
+#endif
+                double **TMP = thread_TMP[thread];
                 for(int Gr=0; Gr < nirreps_; Gr++) {
                     // Transform ( S1 S2 | n n ) -> ( S1 S2 | n S4 )
                     int Gs = h^Gr;
@@ -179,7 +208,9 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                                 TMP[0], nso_, 0.0, &K.matrix[h][pq][rs], ncols);
                     //TODO else if s3->label() == MOSPACE_NIL, copy buffer...
                 } /* Gr */
-                if(useIWL_){
+            } /* pq */
+            if(useIWL_){
+                for(int pq=0; pq < thisBucketRows; pq++) {
                     int P = aIndex1[K.params->roworb[h][pq+n*rowsPerBucket][0]];
                     int Q = aIndex2[K.params->roworb[h][pq+n*rowsPerBucket][1]];
                     size_t PQ = INDEX(P,Q);
@@ -196,8 +227,8 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                         iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs],
                                          printTei_, outfile, 0);
                     } /* rs */
-                }
-            } /* pq */
+                } /* pq */
+            }
             global_dpd_->buf4_mat_irrep_wrt_block(&K, h, n*rowsPerBucket, thisBucketRows);
         }
         global_dpd_->buf4_mat_irrep_close_block(&J, h, rowsPerBucket);
@@ -275,7 +306,13 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                 else
                     thisBucketRows = (n < nBuckets-1) ? rowsPerBucket : rowsLeft;
                 global_dpd_->buf4_mat_irrep_rd_block(&J, h, n*rowsPerBucket, thisBucketRows);
+                #pragma omp parallel for schedule(static) num_threads(nthread)
                 for(int pq=0; pq < thisBucketRows; pq++) {
+                    int thread = 0;
+#ifdef _OPENMP
+                    thread = omp_get_thread_num();
+#endif
+                    double **TMP = thread_TMP[thread];
                     for(int Gr=0; Gr < nirreps_; Gr++) {
                         // Transform ( S1 S2 | n n ) -> ( S1 S2 | n s4 )
                         int Gs = h^Gr;
@@ -300,7 +337,9 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                                     TMP[0], nso_, 0.0, &K.matrix[h][pq][rs], ncols);
                         //TODO else if s3->label() == MOSPACE_NIL, copy buffer...
                     } /* Gr */
-                    if(useIWL_){
+                } /* pq */
+                if(useIWL_){
+                    for(int pq=0; pq < thisBucketRows; pq++) {
                         int P = aIndex1[K.params->roworb[h][pq+n*rowsPerBucket][0]];
                         int Q = aIndex2[K.params->roworb[h][pq+n*rowsPerBucket][1]];
                         // dpd is smart enough to index only unique pairs in the bra
@@ -314,8 +353,8 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                             iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs],
                                              printTei_, outfile, 0);
                         } /* rs */
-                    }
-                } /* pq */
+                    } /* pq */
+                }
                 global_dpd_->buf4_mat_irrep_wrt_block(&K, h, n*rowsPerBucket, thisBucketRows);
             }
             global_dpd_->buf4_mat_irrep_close_block(&J, h, rowsPerBucket);
@@ -398,7 +437,13 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                 else
                     thisBucketRows = (n < nBuckets-1) ? rowsPerBucket : rowsLeft;
                 global_dpd_->buf4_mat_irrep_rd_block(&J, h, n*rowsPerBucket, thisBucketRows);
+                #pragma omp parallel for schedule(static) num_threads(nthread)
                 for(int pq=0; pq < thisBucketRows; pq++) {
+                    int thread = 0;
+#ifdef _OPENMP
+                    thread = omp_get_thread_num();
+#endif
+                    double **TMP = thread_TMP[thread];
                     for(int Gr=0; Gr < nirreps_; Gr++) {
                         // Transform ( s1 s2 | n n ) -> ( s1 s2 | n s4 )
                         int Gs = h^Gr;
@@ -421,7 +466,9 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                             C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0, pc3b[0], nrows,
                                     TMP[0], nso_, 0.0, &K.matrix[h][pq][rs], ncols);
                     } /* Gr */
-                    if(useIWL_){
+                } /* pq */
+                if(useIWL_){
+                    for(int pq=0; pq < thisBucketRows; pq++) {
                         int P = bIndex1[K.params->roworb[h][pq+n*rowsPerBucket][0]];
                         int Q = bIndex2[K.params->roworb[h][pq+n*rowsPerBucket][1]];
                         // dpd is smart enough to index only unique pairs in the bra
@@ -438,8 +485,8 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
                             iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs],
                                              printTei_, outfile, 0);
                         } /* rs */
-                    }
-                } /* pq */
+                    } /* pq */
+                }
                 global_dpd_->buf4_mat_irrep_wrt_block(&K, h, n*rowsPerBucket, thisBucketRows);
             }
             global_dpd_->buf4_mat_irrep_close_block(&J, h, rowsPerBucket);
@@ -463,7 +510,12 @@ IntegralTransform::transform_tei_second_half(const shared_ptr<MOSpace> s1, const
     psio_->close(dpdIntFile_, 1);
     psio_->close(aHtIntFile_, keepHtInts_);
 
-    free_block(TMP);
+#ifdef HAVE_MKL
+    mkl_set_num_threads(old_threads);
+#endif
+    for(int t=0; t < nthread; t++)
+        global_dpd_->free_dpd_block(thread_TMP[t], nso_, nso_);
+    delete [] thread_TMP;
     delete [] label;
 
     if(print_){